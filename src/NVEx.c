@@ -14,66 +14,148 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdarg.h>
+#include "libntgrbak.h"
 #include "nvram.h"
+#include "text.h"
+#include "store.h"
+#include "batch.h"
+#include "fileio.h"
+#include "trace.h"
 
 /* Defines */
-#define BUFFER_SIZE		(0x20000)
-#define MAX_FILE_SIZE	BUFFER_SIZE
+#define BUFFER_SIZE		(0x20000)	//Smallest input and output buffers, bigger for the bigger NVRAM images
+#define ARENA_ALIGN(x)	(((x) + 15) & ~15)
 
 #define USAGE	\
 "Usage:\n\
 		./NVEx <mode> [options] <input_file >output_file\n\
+		./NVEx <key mode> [keys] [options] <input_file >output_file\n\
+		./NVEx diff A B [options] >output_file\n\
 		./NVEx <mode> [options] -i input_file -o output_file\n\
+		./NVEx <mode> [options] -b input_files -o output_dir\n\
 Modes:\n\
 		X	eXtract the raw input file to a string file. Editable by all text editors.\n\
 		W	Wrap the string input file to a raw NVRAM image.\n\
+			With -F, X and W use a records stream instead, for the values holding new lines or any byte but null\n\
+		S	Self-tests the optimized CRC8 and text kernels against the reference ones\n\
+Key modes (on a raw NVRAM image):\n\
+		get KEY...		Prints the value of the keys, one per line\n\
+		set KEY=VALUE...	Sets the keys, outputs the edited NVRAM image\n\
+		unset KEY...		Removes the keys, outputs the edited NVRAM image\n\
+		list [PREFIX...]	Prints the \"key=value\" lines of the keys starting with a prefix (all without one)\n\
+		diff A B		Prints the keys removed (\"-key=value\"), added (\"+key=value\") or changed (both) from A to B\n\
+				A and B can be NVRAM images or configurations. Exits with 0 if they match, 1 if they differ, 2 on errors\n\
 Options:\n\
 		General:\n\
 		-v[erbose]:	Dumps some informations\n\
 		-f[orce]:	Avoid checks\n\
 		-i[nput]:	Specify the input file path. Otherwise stdin is used\n\
-		-o[utput]:	Specify the output file path. Otherwise stdout is used\n"
+		-o[utput]:	Specify the output file path. Otherwise stdout is used\n\
+		-T[race]:	Records the time spent in every stage: Chrome trace events if the file ends in .json, a text summary otherwise (\"-\" for stderr)\n\
+		-M[etrics]:	Writes the counters and the stage latency histograms to a file, in the Prometheus text format\n\
+		-F[ormat]:	The format X writes and W reads: \"text\" (default), \"binary\" (length-prefixed records) or \"jsonl\" (JSON Lines)\n\
+\n\
+		NVRAM image (W, set, unset):\n\
+		-n[vram]:	Specify the NVRAM image size, a multiple of 8 bytes (eg. \"131072\")\n\
+		-m[odel]:	Use the NVRAM image size of a router model. (eg. \"WNDR4500v2\")\n\
+				Otherwise W builds a 64 KB image, the edited images keep their size\n\
+				Only the WNDR4500v2 size is known, the other models get 64 KB: give their size with -n, which wins over -m\n\
+\n\
+		diff:\n\
+		-p[atch]:	Prints a compact patch instead: \"+key=value\" for the keys to set, \"-key\" for the ones to unset\n\
+\n\
+		Batch:\n\
+		-b[atch]:	Process many files: a directory, a @list_file (one path per line) or a quoted glob pattern\n\
+				The output (-o) is a directory, each output file keeps the input file name, which must be unique\n\
+		-j[obs]:	Number of files processed at once. (eg. \"4\")\n"
 
 /* Typdefs */
+struct job;
+
 struct main_opts {
-	int (*option_routine)(unsigned char*, int, unsigned char*, int*);
+	int (*option_routine)(const struct job*, unsigned char*, int, unsigned char*, int*);
 	char * input_file_name;
 	char * output_file_name;
+	char * batch_input;
+	char * trace_file_name;
+	char * metrics_file_name;
+	struct ntgrbak_trace * trace;		//Stage timings and metrics, NULL when neither is written
+	char ** keys;			//Arguments of the key modes
+	int keys_count;
+	int jobs;
+	int image_size;				//NVRAM image built or edited, 0 for the default one
+	int model_image_size;		//NVRAM image of the -m model, -n wins over it
+	int buffer_size;			//Input and output buffers: the image, BUFFER_SIZE at least
+	int output_size;			//Output buffer: buffer_size, but the records stream of X
+	int format;					//NTGRBAK_FORMAT_* of X and W
 	union {
 		unsigned int main_sets;
 		struct {
 			unsigned int main_set_verbose	:1;
 			unsigned int main_set_force		:1;
-			unsigned int 					:30;
+			unsigned int main_set_diff		:1;
+			unsigned int main_set_patch		:1;
+			unsigned int 					:28;
 		};
 	};
 };
 
+/* Per-file state */
+struct job {
+	const struct main_opts * opt;
+	const char * input_file_name;
+	const char * output_file_name;
+	const char * prefix;		//Prepended to the messages in batch mode
+	int buffer_size;			//Of the input and output buffers
+	int output_size;			//Of the output buffer
+};
+
+/* An input of diff */
+struct diff_input {
+	struct io_file file;
+	unsigned char * buffer;		//Read and decrypted image fallbacks
+	struct nvram_store store;
+};
+
 /* Fuctions signs */
 // Routine
-int				routine_extract				(unsigned char*, int, unsigned char*, int*);
-int				routine_wrap				(unsigned char*, int, unsigned char*, int*);
+int				routine_extract				(const struct job*, unsigned char*, int, unsigned char*, int*);
+int				routine_wrap				(const struct job*, unsigned char*, int, unsigned char*, int*);
+int				routine_get					(const struct job*, unsigned char*, int, unsigned char*, int*);
+int				routine_set					(const struct job*, unsigned char*, int, unsigned char*, int*);
+int				routine_unset				(const struct job*, unsigned char*, int, unsigned char*, int*);
+int				routine_list				(const struct job*, unsigned char*, int, unsigned char*, int*);
+int				store_load					(const struct job*, unsigned char*, int, int, struct nvram_store*);
+
+// File processing
+int				process_file				(const struct job*, unsigned char*, unsigned char*);
+int				process_batch				(void*, const char*, const char*, unsigned char*);
+int				process_diff				(const struct job*, const char*, const char*);
 
 // Misc
+int				main_output_size			(const struct main_opts*, int);
+int				self_test					(void);
 void			console_output				(char*, ...);
-
-
-/* Global variables */
-struct main_opts main_opt;
+void			job_output					(const struct job*, char*, ...);
 
 
 /* Funtions definitions */
 int main (int argc, char **argv)
 {
-	unsigned char buffer_input[BUFFER_SIZE];
-	unsigned char buffer_output[BUFFER_SIZE];
-	int buffer_output_len, buffer_input_len;
-	FILE *input_file, *output_file;
-	unsigned char i;
+	unsigned char *buffer_input, *buffer_output;
+	struct main_opts main_opt;
+	struct batch_list batch;
+	struct ntgrbak_arena arena;
+	struct job job;
+	uint64_t span;
+	long long file_size;
+	char metrics_labels[64];
+	int i, ret, key_mode;
 
 
 	/* Initial setup */
 	memset (&main_opt, 0, sizeof (struct main_opts));
+	memset (&job, 0, sizeof (struct job));
 
 	/* Parse the arguments */
 	if (argc < 2)
@@ -81,18 +163,39 @@ int main (int argc, char **argv)
 		console_output ("Error: Need more arguments!\n" USAGE);
 		return 1;
 	}
-	switch (argv[1][0])
+	key_mode = 1;
+	if (!strcmp (argv[1], "get"))
+		main_opt.option_routine = routine_get;
+	else if (!strcmp (argv[1], "set"))
+		main_opt.option_routine = routine_set;
+	else if (!strcmp (argv[1], "unset"))
+		main_opt.option_routine = routine_unset;
+	else if (!strcmp (argv[1], "list"))
+		main_opt.option_routine = routine_list;
+	else if (!strcmp (argv[1], "diff"))
+		main_opt.main_set_diff = 1;
+	else
 	{
-		case 'X':
-			main_opt.option_routine = routine_extract;
-			break;
-		case 'W':
-			main_opt.option_routine = routine_wrap;
-			break;
-		default:
-			console_output ("Error: Select a mode!\n" USAGE);
-			return 1;
+		key_mode = 0;
+		switch (argv[1][0])
+		{
+			case 'X':
+				main_opt.option_routine = routine_extract;
+				break;
+			case 'W':
+				main_opt.option_routine = routine_wrap;
+				break;
+			case 'S':
+				return self_test ();
+			default:
+				console_output ("Error: Select a mode!\n" USAGE);
+				return 1;
+		}
 	}
+
+	main_opt.keys = malloc (sizeof (char *) * argc);
+	if (!main_opt.keys)
+		return 1;
 	for (i = 2; i < argc; i++)
 	{
 		if (argv[i][0] == '-')
@@ -111,69 +214,197 @@ int main (int argc, char **argv)
 			case 'o':
 				main_opt.output_file_name = argv[++i];
 				break;
+			case 'j':
+				main_opt.jobs = atoi (argv[++i]);
+				break;
+			case 'b':
+				main_opt.batch_input = argv[++i];
+				break;
+			case 'T':
+				main_opt.trace_file_name = argv[++i];
+				break;
+			case 'M':
+				main_opt.metrics_file_name = argv[++i];
+				break;
+			case 'n':
+				main_opt.image_size = atoi (argv[++i]);
+				break;
+			case 'm':
+				main_opt.model_image_size = (int) ntgrbak_model_image_size (ntgrbak_model_magic (argv[++i]));
+				break;
+			case 'p':
+				main_opt.main_set_patch = 1;
+				break;
+			case 'F':
+				i++;
+				if (i < argc && !strcmp (argv[i], "text"))
+					main_opt.format = NTGRBAK_FORMAT_TEXT;
+				else if (i < argc && !strcmp (argv[i], "binary"))
+					main_opt.format = NTGRBAK_FORMAT_BINARY;
+				else if (i < argc && !strcmp (argv[i], "jsonl"))
+					main_opt.format = NTGRBAK_FORMAT_JSONL;
+				else
+				{
+					console_output ("Error: Unknown format \"%s\".\n" USAGE, i < argc ? argv[i] : "");
+					return 1;
+				}
+				break;
 			default:
 				console_output ("Error: Unknown option \"%s\".\n" USAGE, argv[i]);
 				return 1;
 			}
 		}
+		else if (key_mode)
+			main_opt.keys[main_opt.keys_count++] = argv[i];
 		else
 		{
 			console_output ("Error: Unknown option \"%s\".\n" USAGE, argv[i]);
 			return 1;
 		}
 	}
+	if (key_mode && !main_opt.keys_count && main_opt.option_routine != routine_list && !main_opt.main_set_diff)
+	{
+		console_output ("Error: Specify the keys!\n" USAGE);
+		return 1;
+	}
+	if (main_opt.main_set_diff && (main_opt.keys_count != 2 || main_opt.batch_input))
+	{
+		console_output ("Error: Specify the two inputs to compare!\n" USAGE);
+		return 2;
+	}
+	if (!main_opt.image_size)
+		main_opt.image_size = main_opt.model_image_size;
+	if (main_opt.image_size < 0 || main_opt.image_size % 8 || main_opt.image_size > NVRAM_IMAGE_SIZE_MAX)
+	{
+		console_output ("Error: The NVRAM image size must be a multiple of 8 bytes, up to %u bytes!\n" USAGE, NVRAM_IMAGE_SIZE_MAX);
+		return 1;
+	}
+	main_opt.buffer_size = ARENA_ALIGN (main_opt.image_size ? main_opt.image_size : NVRAM_IMAGE_SIZE_DEFAULT);
+	if (main_opt.buffer_size < BUFFER_SIZE)
+		main_opt.buffer_size = BUFFER_SIZE;
+	main_opt.output_size = main_output_size (&main_opt, main_opt.buffer_size);
 
-	/* Getting the input */
-	if (main_opt.input_file_name)
+	/* Stage timings and metrics */
+	if (main_opt.trace_file_name || main_opt.metrics_file_name)
 	{
-		input_file = fopen (main_opt.input_file_name, "r");
-		if (input_file == NULL)
+		main_opt.trace = ntgrbak_trace_new ((main_opt.trace_file_name ? NTGRBAK_TRACE_EVENTS : 0) | (main_opt.metrics_file_name ? NTGRBAK_TRACE_METRICS : 0));
+		if (!main_opt.trace)
 		{
-			console_output ("Error opening file: %s\n", main_opt.input_file_name);
+			console_output ("Error allocating the trace\n");
 			return 1;
 		}
 	}
-	else
-		input_file = stdin;
+	span = trace_begin (main_opt.trace);
 
-	buffer_input_len = fread (buffer_input, 1, BUFFER_SIZE, input_file);	//TODO: Consider using Memory Mapped IO
-	if (!buffer_input_len)
+	/* Batch mode */
+	job.opt = &main_opt;
+	if (main_opt.batch_input)
 	{
-		console_output ("Error reading the input\n");
-		return 1;
-	}
-	if (main_opt.main_set_verbose)
-		console_output ("Read %u bytes from input\n", buffer_input_len);
-
+		if (!main_opt.output_file_name)
+		{
+			console_output ("Error: Specify the output directory!\n" USAGE);
+			return 1;
+		}
 
-	/* Run the selected routine */
-	if (main_opt.option_routine (buffer_input, buffer_input_len, buffer_output, &buffer_output_len))
-		return 1;
+		if (batch_list_load (&batch, main_opt.batch_input))
+			return 1;
 
+		/* Every worker keeps its arena for all its files */
+		ret = batch_run (&batch, main_opt.output_file_name, main_opt.jobs, process_batch, &job, (size_t) main_opt.buffer_size + main_opt.output_size) ? 1 : 0;
 
-	/* Writing to output */
-	if (main_opt.output_file_name)
+		batch_list_free (&batch);
+	}
+	else if (main_opt.main_set_diff)
+	{
+		job.output_file_name = main_opt.output_file_name;
+		ret = process_diff (&job, main_opt.keys[0], main_opt.keys[1]);
+		if (ret > 1)
+			trace_count (main_opt.trace, TRACE_FILES_FAILED, 1);
+	}
+	else
 	{
-		output_file = fopen (main_opt.output_file_name, "w");
-		if (output_file == NULL)
+		/* Single file, the buffers are carved from an arena sized to the image, or to the input */
+		job.input_file_name = main_opt.input_file_name;
+		job.output_file_name = main_opt.output_file_name;
+		job.buffer_size = main_opt.buffer_size;
+		file_size = io_file_size (main_opt.input_file_name);
+		if (file_size > job.buffer_size && (file_size <= NVRAM_IMAGE_SIZE_MAX
+				|| (main_opt.option_routine == routine_wrap && file_size <= (long long) NTGRBAK_RECORDS_SIZE (main_opt.format, NVRAM_IMAGE_SIZE_MAX))))
+			job.buffer_size = (int) ARENA_ALIGN (file_size);
+		job.output_size = main_output_size (&main_opt, job.buffer_size);
+
+		buffer_input = malloc ((size_t) job.buffer_size + job.output_size);
+		if (!buffer_input)
 		{
-			console_output ("Error writing to file: %s\n", main_opt.output_file_name);
+			console_output ("Error allocating the buffers\n");
 			return 1;
 		}
+		ntgrbak_arena_init (&arena, buffer_input, (size_t) job.buffer_size + job.output_size);
+		buffer_input = ntgrbak_arena_alloc (&arena, job.buffer_size);
+		buffer_output = ntgrbak_arena_alloc (&arena, job.output_size);
+		ret = process_file (&job, buffer_input, buffer_output);
+		if (ret)
+			trace_count (main_opt.trace, TRACE_FILES_FAILED, 1);
+		free (arena.base);
 	}
-	else
-		output_file = stdout;
 
-	if (fwrite (buffer_output, 1, buffer_output_len, output_file) != buffer_output_len)		//TODO: Consider using Memory Mapped IO
+	if (main_opt.trace)
 	{
-		console_output ("Error writing the output, it can be incomplete!\n");
-		return 1;
+		trace_end (main_opt.trace, "total", span, 0);
+		if (main_opt.trace_file_name && ntgrbak_trace_write (main_opt.trace, main_opt.trace_file_name))
+		{
+			console_output ("Error writing the trace: %s\n", main_opt.trace_file_name);
+			ret = main_opt.main_set_diff ? 2 : 1;
+		}
+		snprintf (metrics_labels, sizeof (metrics_labels), "tool=\"%s\",mode=\"%.16s\"", "NVEx", argv[1]);
+		if (main_opt.metrics_file_name && ntgrbak_trace_write_metrics (main_opt.trace, main_opt.metrics_file_name, metrics_labels))
+		{
+			console_output ("Error writing the metrics: %s\n", main_opt.metrics_file_name);
+			ret = main_opt.main_set_diff ? 2 : 1;
+		}
+		ntgrbak_trace_free (main_opt.trace);
 	}
 
-	if (main_opt.main_set_verbose)
-		console_output ("Done! %u bytes in, %u bytes out\n", buffer_input_len, buffer_output_len);
+	return ret;
+}
 
-	return 0;
+/* Sizes the output buffer of a job
+ * opt:				The options
+ * buffer_size:		The input buffer size
+ * RETURN:			The output buffer size: the input one, but the records stream of X
+ */
+int main_output_size (const struct main_opts *opt, int buffer_size)
+{
+	if (opt->option_routine == routine_extract && opt->format != NTGRBAK_FORMAT_TEXT)
+		return (int) ARENA_ALIGN (NTGRBAK_RECORDS_SIZE (opt->format, buffer_size));
+
+	return buffer_size;
+}
+
+/* Runs the CRC8 and text self-tests and prints their results
+ * RETURN:		0: All the kernels passed, 1: A kernel failed
+ */
+int self_test (void)
+{
+	static const char * const status[] = { "passed", "FAILED", "skipped (not supported)" };
+	struct self_test_result result[SELF_TEST_RESULTS_MAX];
+	int i, n, failed;
+
+	n = crc8_self_test (result, SELF_TEST_RESULTS_MAX);
+	failed = n < 0;
+	if (n < 0)
+		n = 0;
+	i = text_self_test (result + n, SELF_TEST_RESULTS_MAX - n);
+	failed |= i < 0;
+	if (i > 0)
+		n += i;
+	for (i = 0; i < n; i++)
+	{
+		printf ("%-12s %-12s %s\n", result[i].test, result[i].kernel, status[result[i].result]);
+		failed |= result[i].result == SELF_TEST_FAILED;
+	}
+
+	return failed;
 }
 
 void console_output(char *format, ...)
@@ -185,115 +416,636 @@ void console_output(char *format, ...)
 	va_end(args);
 }
 
+void job_output(const struct job *job, char *format, ...)
+{
+	char line[1024];
+	va_list args;
+
+	va_start(args, format);
+	vsnprintf(line, sizeof (line), format, args);
+	va_end(args);
+
+	if (job->prefix)
+		console_output("%s: %s", job->prefix, line);
+	else
+		console_output("%s", line);
+}
+
+/* Reads the input, runs the routine and writes the output of a job
+ * job:				The job
+ * buffer_input:	The input buffer (job->buffer_size bytes)
+ * buffer_output:	The output buffer (job->output_size bytes)
+ * RETURN:			0: Success, 1: Failure
+ */
+int process_file (const struct job *job, unsigned char *buffer_input, unsigned char *buffer_output)
+{
+	const struct main_opts *opt = job->opt;
+	struct io_file input, output;
+	uint64_t span, span_file;
+	int buffer_output_len, ret;
+
+
+	/* Getting the input */
+	trace_count (opt->trace, TRACE_FILES, 1);
+	span_file = trace_begin (opt->trace);
+	span = trace_begin (opt->trace);
+	ret = io_input_open (&input, job->input_file_name, buffer_input, job->buffer_size);
+	if (ret == IO_OPEN_ERROR)
+	{
+		job_output (job, "Error opening file: %s\n", job->input_file_name);
+		return 1;
+	}
+	if (ret)
+	{
+		io_input_close (&input);
+		job_output (job, "Error reading the input\n");
+		return 1;
+	}
+	if (input.more)
+	{
+		io_input_close (&input);
+		job_output (job, "Input is too big! (max: %d bytes)\n", job->buffer_size);
+		return 1;
+	}
+	trace_end (opt->trace, "read", span, input.len);
+	trace_count (opt->trace, TRACE_BYTES_IN, input.len);
+	if (opt->main_set_verbose)
+		job_output (job, "Read %u bytes from input\n", (unsigned int) input.len);
+
+	/* The output is written in place when it can be mapped */
+	if (io_output_open (&output, job->output_file_name, buffer_output, job->output_size, job->prefix ? 0 : IO_OUTPUT_SPLICE))
+	{
+		io_input_close (&input);
+		job_output (job, "Error writing to file: %s\n", job->output_file_name);
+		return 1;
+	}
+
+
+	/* Run the selected routine */
+	buffer_output_len = 0;
+	ret = opt->option_routine (job, input.data, input.len, output.data, &buffer_output_len);
+	io_input_close (&input);
+
+
+	/* Writing to output, a failed run writes nothing */
+	if (ret)
+	{
+		io_output_discard (&output);
+		trace_end (opt->trace, "file", span_file, input.len);
+		return 1;
+	}
+	span = trace_begin (opt->trace);
+	if (io_output_close (&output, buffer_output_len))
+	{
+		job_output (job, "Error writing the output, it can be incomplete!\n");
+		return 1;
+	}
+	trace_end (opt->trace, "write", span, buffer_output_len);
+	trace_count (opt->trace, TRACE_BYTES_OUT, buffer_output_len);
+	trace_end (opt->trace, "file", span_file, input.len);
+
+	if (opt->main_set_verbose)
+		job_output (job, "Done! %u bytes in, %u bytes out\n", (unsigned int) input.len, buffer_output_len);
 
-int routine_extract (unsigned char* buffer_input, int buffer_input_len, unsigned char* buffer_output, int* buffer_output_len)
+	return 0;
+}
+
+/* Batch routine: processes a file with the worker scratch buffer
+ * arg:					The batch job template
+ * input_file_name:		The input file
+ * output_file_name:	The output file
+ * scratch:				The worker buffer, its arena (buffer_size + output_size bytes)
+ * RETURN:				0: Success, 1: Failure
+ */
+int process_batch (void *arg, const char *input_file_name, const char *output_file_name, unsigned char *scratch)
+{
+	struct ntgrbak_arena arena;
+	unsigned char *buffer_input, *buffer_output;
+	struct job job;
+
+	job = *(const struct job *) arg;
+	job.input_file_name = input_file_name;
+	job.output_file_name = output_file_name;
+	job.prefix = input_file_name;
+
+	/* The arena starts empty on every file, nothing is allocated */
+	job.buffer_size = job.opt->buffer_size;
+	job.output_size = job.opt->output_size;
+	ntgrbak_arena_init (&arena, scratch, (size_t) job.buffer_size + job.output_size);
+	buffer_input = ntgrbak_arena_alloc (&arena, job.buffer_size);
+	buffer_output = ntgrbak_arena_alloc (&arena, job.output_size);
+
+	if (process_file (&job, buffer_input, buffer_output))
+	{
+		trace_count (job.opt->trace, TRACE_FILES_FAILED, 1);
+		return 1;
+	}
+
+	return 0;
+}
+
+
+/* Passes the library messages to the job output */
+static void job_log (void *opaque, const char *message)
+{
+	job_output ((const struct job *) opaque, "%s", message);
+}
+
+
+/* Fills the library call options of a job
+ * job:			The job
+ * lib_opt:		The library call options
+ */
+static void job_lib_opts (const struct job *job, struct ntgrbak_opts *lib_opt)
+{
+	lib_opt->flags = 0;
+	if (job->opt->main_set_verbose)
+		lib_opt->flags |= NTGRBAK_VERBOSE;
+	if (job->opt->main_set_force)
+		lib_opt->flags |= NTGRBAK_FORCE;
+	lib_opt->log = job_log;
+	lib_opt->log_opaque = (void *) job;
+	lib_opt->trace = job->opt->trace;
+	lib_opt->alloc = NULL;
+	lib_opt->image_size = job->opt->image_size;
+}
+
+
+int routine_extract (const struct job *job, unsigned char* buffer_input, int buffer_input_len, unsigned char* buffer_output, int* buffer_output_len)
+{
+	struct ntgrbak_opts lib_opt;
+	size_t len;
+
+	job_lib_opts (job, &lib_opt);
+	if (ntgrbak_records_extract (&lib_opt, buffer_input, buffer_input_len, job->opt->format, buffer_output, job->output_size, &len))
+		return 1;
+
+	*buffer_output_len = (int) len;
+	return 0;
+}
+
+int routine_wrap (const struct job *job, unsigned char* buffer_input, int buffer_input_len, unsigned char* buffer_output, int* buffer_output_len)
 {
-	uint32_t magic;
+	struct ntgrbak_opts lib_opt;
+	size_t len;
+
+	job_lib_opts (job, &lib_opt);
+	if (ntgrbak_records_wrap (&lib_opt, buffer_input, buffer_input_len, job->opt->format, buffer_output, job->output_size, &len))
+		return 1;
+
+	*buffer_output_len = (int) len;
+	return 0;
+}
+
+
+/* Checks a raw NVRAM image and indexes its keys
+ * job:					The job
+ * buffer_input:		The NVRAM image (image_size bytes)
+ * buffer_input_len:	The NVRAM image length as read
+ * image_size:			The NVRAM image size, the edits are kept within it
+ * store:				The store to open
+ * RETURN:				0: Success, 1: Failure
+ */
+int store_load (const struct job *job, unsigned char* buffer_input, int buffer_input_len, int image_size, struct nvram_store* store)
+{
+	const struct main_opts *opt = job->opt;
 	uint32_t length;
-	uint8_t crc, crc_calc;
-	int i, j;
+	uint64_t span;
 
-	/* Acquire infos */
-	magic = get_magic(buffer_input);
-	length = get_length(buffer_input);
-	crc = get_crc(buffer_input);
+	if (buffer_input_len < NVRAM_INDEX_DATA)
+	{
+		job_output (job, "Input is too short!\n");
+		return 1;
+	}
 
-	/* Magic check */
-	if (main_opt.main_set_verbose) console_output ("NVRAM Magic: %08x\n", magic);
-	if (main_opt.main_set_force)
+	if (get_nvram_magic (buffer_input) != NVRAM_CONTENT_MAGIC && !opt->main_set_force)
 	{
-		if (main_opt.main_set_verbose) console_output ("Skipping magic check.\n");
+		trace_count (opt->trace, TRACE_MAGIC_MISMATCHES, 1);
+		job_output (job, "Magic check failed!\n");
+		return 1;
 	}
-	else
+
+	length = get_length (buffer_input);
+	if (length < NVRAM_INDEX_DATA || length > NVRAM_IMAGE_SIZE_MAX || length > buffer_input_len)
+	{
+		job_output (job, "Invalid data size! (%u bytes)\n", length);
+		return 1;
+	}
+
+	span = trace_begin (opt->trace);
+	if (get_crc (buffer_input) != calculate_crc (buffer_input) && !opt->main_set_force)
+	{
+		trace_count (opt->trace, TRACE_CRC_FAILURES, 1);
+		job_output (job, "CRC8 check failed!\n");
+		return 1;
+	}
+	trace_end (opt->trace, "crc", span, length);
+
+	span = trace_begin (opt->trace);
+	if (nvram_store_open (store, buffer_input, image_size))
 	{
-		if (magic != NVRAM_CONTENT_MAGIC)
+		job_output (job, "Error indexing the NVRAM image!\n");
+		return 1;
+	}
+	trace_end (opt->trace, "store_open", span, length);
+
+	if (opt->main_set_verbose)
+		job_output (job, "Indexed %d records, %u bytes\n", store->records, length);
+
+	return 0;
+}
+
+
+int routine_get (const struct job *job, unsigned char* buffer_input, int buffer_input_len, unsigned char* buffer_output, int* buffer_output_len)
+{
+	const struct main_opts *opt = job->opt;
+	struct nvram_store store;
+	const struct nvram_record *record;
+	int i, rec, ret, j;
+
+	if (store_load (job, buffer_input, buffer_input_len, buffer_input_len, &store))
+		return 1;
+
+	j = 0;
+	ret = 0;
+	for (i = 0; i < opt->keys_count; i++)
+	{
+		rec = nvram_store_get (&store, opt->keys[i], strlen (opt->keys[i]));
+		if (rec < 0)
 		{
-			console_output ("Magic check failed!\n");
-			return 1;
+			job_output (job, "Key not found: %s\n", opt->keys[i]);
+			ret = 1;
+			continue;
 		}
-		if (main_opt.main_set_verbose) console_output ("Magic check passed.\n");
+
+		record = &store.record[rec];
+		if (j + record->len + 1 > job->output_size)
+		{
+			job_output (job, "Output is too big!\n");
+			ret = 1;
+			break;
+		}
+		if (record->len > record->key_len)
+		{
+			memcpy (buffer_output + j, nvram_store_string (&store, rec) + record->key_len + 1, record->len - record->key_len - 1);
+			j += record->len - record->key_len - 1;
+		}
+		buffer_output[j++] = '\n';
+	}
+
+	nvram_store_close (&store);
+	*buffer_output_len = j;
+	return ret;
+}
+
+
+int routine_list (const struct job *job, unsigned char* buffer_input, int buffer_input_len, unsigned char* buffer_output, int* buffer_output_len)
+{
+	const struct main_opts *opt = job->opt;
+	struct nvram_store store;
+	const struct nvram_record *record;
+	const char *string;
+	int i, rec, j;
+
+	if (store_load (job, buffer_input, buffer_input_len, buffer_input_len, &store))
+		return 1;
+
+	/* Prefixes need a scan anyway: keep the image order */
+	j = 0;
+	for (rec = 0; rec < store.records; rec++)
+	{
+		record = &store.record[rec];
+		string = nvram_store_string (&store, rec);
+		for (i = 0; i < opt->keys_count; i++)
+			if (strlen (opt->keys[i]) <= record->key_len && !memcmp (string, opt->keys[i], strlen (opt->keys[i])))
+				break;
+		if (opt->keys_count && i == opt->keys_count)
+			continue;
+
+		memcpy (buffer_output + j, string, record->len);
+		j += record->len;
+		buffer_output[j++] = '\n';
 	}
 
-	/* Length check */
-	if (main_opt.main_set_verbose) console_output ("NVRAM Length: %u bytes\n", length);
-	if (length > NVRAM_SIZE_DATA_MAX)
+	nvram_store_close (&store);
+	*buffer_output_len = j;
+	return 0;
+}
+
+
+/* Copies the input image to the output one and indexes it for editing
+ * job:					The job
+ * buffer_input:		The NVRAM image
+ * buffer_input_len:	The NVRAM image length
+ * buffer_output:		The output NVRAM image buffer (job->output_size bytes)
+ * store:				The store to open on the output image
+ * RETURN:				0: Success, 1: Failure
+ * NOTE: The output image has the size set by the options, otherwise the input one (NVRAM_IMAGE_SIZE_DEFAULT at least)
+ */
+static int store_edit (const struct job *job, unsigned char* buffer_input, int buffer_input_len, unsigned char* buffer_output, struct nvram_store* store)
+{
+	int image_size;
+
+	image_size = job->opt->image_size;
+	if (!image_size)
+		image_size = buffer_input_len > NVRAM_IMAGE_SIZE_DEFAULT ? buffer_input_len : NVRAM_IMAGE_SIZE_DEFAULT;
+	if (image_size > job->output_size)
 	{
-		if (main_opt.main_set_force)
+		job_output (job, "Input is bigger than a NVRAM image!\n");
+		return 1;
+	}
+	if (buffer_input_len > image_size)
+		buffer_input_len = image_size;
+
+	memcpy (buffer_output, buffer_input, buffer_input_len);
+	memset (buffer_output + buffer_input_len, NVRAM_CONTENT_PADDING, image_size - buffer_input_len);
+
+	return store_load (job, buffer_output, buffer_input_len, image_size, store);
+}
+
+
+/* Writes the edits back to the output image */
+static int store_save (const struct job *job, struct nvram_store* store, int* buffer_output_len)
+{
+	uint64_t span;
+	int ret;
+
+	span = trace_begin (job->opt->trace);
+	ret = nvram_store_commit (store);
+	trace_end (job->opt->trace, "store_commit", span, get_length (store->image));
+	if (ret)
+		job_output (job, "Error rebuilding the NVRAM image!\n");
+	else if (job->opt->main_set_verbose)
+		job_output (job, "NVRAM Length: %u bytes, CRC8: %02x\n", get_length (store->image), get_crc (store->image));
+
+	*buffer_output_len = ret ? 0 : (int) store->image_size;
+	nvram_store_close (store);
+	return ret;
+}
+
+
+int routine_set (const struct job *job, unsigned char* buffer_input, int buffer_input_len, unsigned char* buffer_output, int* buffer_output_len)
+{
+	const struct main_opts *opt = job->opt;
+	struct nvram_store store;
+	const char *eq;
+	int i;
+
+	if (store_edit (job, buffer_input, buffer_input_len, buffer_output, &store))
+		return 1;
+
+	for (i = 0; i < opt->keys_count; i++)
+	{
+		eq = strchr (opt->keys[i], '=');
+		if (!eq)
 		{
-			length = NVRAM_SIZE_DATA_MAX;
-			console_output ("Data size is too big! Output will be truncated to %u bytes.\n", length);
+			job_output (job, "Expected KEY=VALUE: %s\n", opt->keys[i]);
+			nvram_store_close (&store);
+			return 1;
 		}
-		else
+
+		if (nvram_store_set (&store, opt->keys[i], eq - opt->keys[i], eq + 1, strlen (eq + 1)))
 		{
-			console_output ("Data size is too big!\n");
+			job_output (job, "Error setting %.*s (the image is full?)\n", (int) (eq - opt->keys[i]), opt->keys[i]);
+			nvram_store_close (&store);
 			return 1;
 		}
 	}
 
-	/* CRC8 check */
-	if (main_opt.main_set_verbose) console_output ("NVRAM CRC8: %02x\n", crc);
-	if (main_opt.main_set_force)
-	{
-		if (main_opt.main_set_verbose) console_output ("Skipping CRC8 check.\n");
-	}
-	else
+	return store_save (job, &store, buffer_output_len);
+}
+
+
+int routine_unset (const struct job *job, unsigned char* buffer_input, int buffer_input_len, unsigned char* buffer_output, int* buffer_output_len)
+{
+	const struct main_opts *opt = job->opt;
+	struct nvram_store store;
+	int i;
+
+	if (store_edit (job, buffer_input, buffer_input_len, buffer_output, &store))
+		return 1;
+
+	for (i = 0; i < opt->keys_count; i++)
 	{
-		crc_calc = calculate_crc(buffer_input);
-		if (main_opt.main_set_verbose) console_output ("NVRAM calculated CRC8: %02x\n", crc_calc);
-		if (crc != crc_calc)
+		if (nvram_store_unset (&store, opt->keys[i], strlen (opt->keys[i])) && !opt->main_set_force)
 		{
-			console_output ("CRC8 check failed!\n");
+			job_output (job, "Key not found: %s\n", opt->keys[i]);
+			nvram_store_close (&store);
 			return 1;
 		}
-		if (main_opt.main_set_verbose) console_output ("CRC8 check passed.\n");
 	}
 
-	/* Copy the input buffer data to the output swapping null bytes with newlines */
-	j = 0;
-	for (i = NVRAM_INDEX_DATA; i < length; i++)
+	return store_save (job, &store, buffer_output_len);
+}
+
+
+/* Loads an input of diff: a NVRAM image, or a configuration decrypted to its image, indexed by key
+ * job:			The job
+ * name:		The input file
+ * input:		The input, zeroed
+ * RETURN:		0: Success, 1: Failure
+ */
+static int diff_load (const struct job *job, const char *name, struct diff_input *input)
+{
+	struct ntgrbak_opts lib_opt;
+	struct ntgrbak_ctx *ctx;
+	struct job file_job;
+	unsigned char *image;
+	long long file_size;
+	size_t buffer_size, image_len;
+	int ret;
+
+	file_job = *job;
+	file_job.prefix = name;
+
+	buffer_size = job->opt->buffer_size;
+	file_size = io_file_size (name);
+	if (file_size > (long long) buffer_size && file_size <= NVRAM_IMAGE_SIZE_MAX + NTGRBAK_HEADER_SIZE)
+		buffer_size = ARENA_ALIGN (file_size);
+	input->buffer = malloc (2 * buffer_size);
+	if (!input->buffer)
+	{
+		job_output (&file_job, "Error allocating the buffers\n");
+		return 1;
+	}
+
+	ret = io_input_open (&input->file, name, input->buffer, buffer_size);
+	if (ret)
+	{
+		job_output (&file_job, ret == IO_OPEN_ERROR ? "Error opening the file\n" : "Error reading the input\n");
+		return 1;
+	}
+	if (input->file.more)
+	{
+		job_output (&file_job, "Input is too big! (max: %u bytes)\n", (unsigned int) buffer_size);
+		return 1;
+	}
+	trace_count (job->opt->trace, TRACE_BYTES_IN, input->file.len);
+
+	/* Anything but a NVRAM image is taken for a configuration */
+	image = input->file.data;
+	image_len = input->file.len;
+	if (image_len < NVRAM_INDEX_DATA || get_nvram_magic (image) != NVRAM_CONTENT_MAGIC)
 	{
-		if (buffer_input[i] == '\0')
+		job_lib_opts (&file_job, &lib_opt);
+		ctx = ntgrbak_ctx_new (0, 1, NULL);
+		ret = ctx ? ntgrbak_extract (ctx, &lib_opt, input->file.data, input->file.len, input->buffer + buffer_size, buffer_size, &image_len, NULL) : NTGRBAK_ERR_NOMEM;
+		ntgrbak_ctx_free (ctx);
+		if (!ret)
+			image = input->buffer + buffer_size;
+		else if (!job->opt->main_set_force)
 		{
-			if (buffer_output[j-1] != '\n')	//Skip multiple \0\0 (at the end)
-				buffer_output[j++] = '\n';
+			job_output (&file_job, "Neither a NVRAM image nor a configuration!\n");
+			return 1;
 		}
 		else
-			buffer_output[j++] = buffer_input[i];
+			image_len = input->file.len;
 	}
-	*buffer_output_len = j;
 
-	return 0;
+	return store_load (&file_job, image, image_len, image_len, &input->store);
+}
+
+
+/* Writes a line of diff
+ * out:			The output
+ * sign:		'+' or '-'
+ * string:		The "key=value" string, or the key
+ * len:			The string length
+ * RETURN:		The line length
+ */
+static int diff_line (unsigned char *out, char sign, const char *string, int len)
+{
+	out[0] = sign;
+	memcpy (out + 1, string, len);
+	out[len + 1] = '\n';
+
+	return len + 2;
 }
 
-int routine_wrap (unsigned char* buffer_input, int buffer_input_len, unsigned char* buffer_output, int* buffer_output_len)
+
+/* Writes the keys removed, added or changed from A to B, see process_diff()
+ * job:			The job
+ * a:			The input A
+ * b:			The input B
+ * RETURN:		0: A and B match, 1: They differ, 2: Failure
+ */
+static int diff_write (const struct job *job, struct diff_input *a, struct diff_input *b)
 {
-	int i, j;
+	const struct main_opts *opt = job->opt;
+	const struct nvram_record *record, *record_b;
+	const char *string;
+	struct io_file output;
+	unsigned char *buffer_output, *matched;
+	uint64_t span;
+	size_t out_max;
+	int rec, other, j, added, removed, changed, ret;
+
+	/* A line per record at most, as long as the record and its null byte plus its sign */
+	out_max = 2 * ((size_t) a->store.data_len + b->store.data_len) + 16;
+	buffer_output = malloc (out_max);
+	matched = calloc (b->store.records + 1, 1);
+	if (!buffer_output || !matched)
+	{
+		free (buffer_output);
+		free (matched);
+		job_output (job, "Error allocating the buffers\n");
+		return 2;
+	}
+	if (io_output_open (&output, job->output_file_name, buffer_output, out_max, IO_OUTPUT_SPLICE))
+	{
+		free (buffer_output);
+		free (matched);
+		job_output (job, "Error writing to file: %s\n", job->output_file_name);
+		return 2;
+	}
 
-	/* Copy the input data to the buffer swapping new lines with null bytes */
-	j = NVRAM_INDEX_DATA;
-	for (i = 0; i < buffer_input_len; i++)
+	span = trace_begin (opt->trace);
+	j = 0;
+	added = removed = changed = 0;
+	for (rec = 0; rec < a->store.records; rec++)
 	{
-		if (buffer_input[i] == '\n')
-			buffer_output[j++] = '\0';
+		record = &a->store.record[rec];
+		string = nvram_store_string (&a->store, rec);
+		if (nvram_store_get (&a->store, string, record->key_len) != rec)
+			continue;
+
+		other = nvram_store_get (&b->store, string, record->key_len);
+		record_b = NULL;
+		if (other >= 0)
+		{
+			matched[other] = 1;
+			record_b = &b->store.record[other];
+			if (record_b->len == record->len && !memcmp (nvram_store_string (&b->store, other), string, record->len))
+				continue;
+			changed++;
+		}
 		else
-			buffer_output[j++] = buffer_input[i];
+			removed++;
+
+		/* The patch needs the new values only */
+		if (!opt->main_set_patch)
+			j += diff_line (output.data + j, '-', string, record->len);
+		else if (!record_b)
+			j += diff_line (output.data + j, '-', string, record->key_len);
+		if (record_b)
+			j += diff_line (output.data + j, '+', nvram_store_string (&b->store, other), record_b->len);
+	}
+	for (rec = 0; rec < b->store.records; rec++)
+	{
+		record = &b->store.record[rec];
+		string = nvram_store_string (&b->store, rec);
+		if (matched[rec] || nvram_store_get (&b->store, string, record->key_len) != rec)
+			continue;
+
+		added++;
+		j += diff_line (output.data + j, '+', string, record->len);
 	}
+	trace_end (opt->trace, "diff", span, a->file.len + b->file.len);
 
-	/* Even the output data to multiple of 4 bytes */
-	while (j % 4)
-		buffer_output[j++] = '\0';
+	ret = added || removed || changed ? 1 : 0;
+	span = trace_begin (opt->trace);
+	if (io_output_close (&output, j))
+	{
+		job_output (job, "Error writing the output, it can be incomplete!\n");
+		ret = 2;
+	}
+	trace_end (opt->trace, "write", span, j);
+	trace_count (opt->trace, TRACE_BYTES_OUT, j);
+	if (opt->main_set_verbose)
+		job_output (job, "%d keys added, %d removed, %d changed\n", added, removed, changed);
 
-	/* Setup the header */
-	set_magic(buffer_output, NVRAM_CONTENT_MAGIC);
-	set_length(buffer_output, j);
-	set_field1(buffer_output);
-	set_field2(buffer_output);
-	set_crc(buffer_output, calculate_crc(buffer_output));
+	free (buffer_output);
+	free (matched);
+	return ret;
+}
 
-	/* Add the padding */
-	while (j < NVRAM_IMAGE_SIZE_MAX)
-		buffer_output[j++] = NVRAM_CONTENT_PADDING;
 
-	*buffer_output_len = NVRAM_IMAGE_SIZE_MAX;
-	return 0;
+/* Compares two NVRAM images, or configurations, and writes the keys removed, added or changed from A to B
+ * job:			The job, its output the differences
+ * name_a:		The input A
+ * name_b:		The input B
+ * RETURN:		0: A and B match, 1: They differ, 2: Failure
+ * NOTE: Both are indexed by key, the cost is linear. The removed and changed keys come in the A image order, then the added ones in the B image order.
+ * Of a key set more than once the indexed record counts, as the store looks it up
+ */
+int process_diff (const struct job *job, const char *name_a, const char *name_b)
+{
+	struct diff_input a, b;
+	int ret;
+
+	trace_count (job->opt->trace, TRACE_FILES, 2);
+	memset (&a, 0, sizeof (struct diff_input));
+	memset (&b, 0, sizeof (struct diff_input));
+
+	ret = 2;
+	if (!diff_load (job, name_a, &a) && !diff_load (job, name_b, &b))
+		ret = diff_write (job, &a, &b);
+
+	nvram_store_close (&a.store);
+	nvram_store_close (&b.store);
+	io_input_close (&a.file);
+	io_input_close (&b.file);
+	free (a.buffer);
+	free (b.buffer);
+	return ret;
 }
@@ -12,48 +12,74 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdarg.h>
+#include <unistd.h>
+#include "libntgrbak.h"
 #include "config.h"
-#include "crypt.h"
+#include "batch.h"
+#include "fileio.h"
+#include "trace.h"
+#include "serve.h"
 
 /* Defines */
-#define BUFFER_SIZE		(0x20000)
-#define MAX_FILE_SIZE	BUFFER_SIZE
+#define BUFFER_SIZE		(0x20000)	//Smallest input and output buffers, bigger for the bigger NVRAM images
+#define ARENA_BUFFERS	4			//Input, output and the library working buffers (a configuration and the patches map)
+#define ARENA_ALIGN(x)	(((x) + 15) & ~15)
+#define HEADER_SIZE		(0x10)		//Magic, length, checksum and version: the first two blocks
+#define STREAM_PIECE_SIZE	(0x10000)	//Read at a time by the streams
 
 #define USAGE	\
 "Usage:\n\
 		./NtgrBak <mode> [options] <input_file.bin >output_file.bin\n\
 		./NtgrBak <mode> [options] -i input_file.bin -o output_file.bin\n\
+		./NtgrBak <mode> [options] -b input_files -o output_dir\n\
+		./NtgrBak P [patches] [options] -i input_file.bin -o output_file.bin\n\
+		./NtgrBak serve [options] -U socket\n\
 Modes:\n\
 		X	eXtracts the configuration internal NVRAM image to the output file\n\
 		D	Decripts without extracting the configuration\n\
 		W	Wraps a NVRAM image to the output file with the info supplied by options\n\
+		I	Prints the configuration Info, decrypting only its header\n\
+		T	eXtracts the configuration straight to the editable Text file (X then NVEx X)\n\
+		C	Wraps an editable text file straight to a Configuration file (NVEx W then W)\n\
+		P	Patches the NVRAM image of a configuration in place, re-encrypting only the changed blocks\n\
+			Patches are OFFSET:HEX or OFFSET=TEXT, the offset within the NVRAM image (eg. \"0x1234=on\")\n\
+			The patches can not change the image length\n\
+		S	Self-tests the optimized checksum kernels against the reference one, and the server refusing a too big request\n\
+		serve	Answers the D, X, W, I, T and C requests of the clients (-U) on a Unix socket until SIGINT or SIGTERM\n\
+			The block keys are computed once for all the requests, the connections are served at once\n\
 Options:\n\
 		General:\n\
 		-v[erbose]:	Dumps some informations\n\
 		-f[orce]:	Avoid checks\n\
 		-i[nput]:	Specify the input file path. Otherwise stdin is used\n\
 		-o[utput]:	Specify the output file path. Otherwise stdout is used\n\
+		-T[race]:	Records the time spent in every stage: Chrome trace events if the file ends in .json, a text summary otherwise (\"-\" for stderr)\n\
+		-M[etrics]:	Writes the counters and the stage latency histograms to a file, in the Prometheus text format\n\
+		-j[obs]:	Split the decryption/encryption between N threads. (eg. \"4\")\n\
+		-s[tream]:	D, X and W modes: process the input N bytes at a time, in constant memory (eg. \"65536\")\n\
+				Regular input files bigger than the buffers (128 KB, or the NVRAM image) are always streamed, pipes only with -s\n\
+				Wrapping needs a regular input file and a seekable output\n\
+		-U[nix]:	The socket of a NtgrBak server: serve mode listens on it, the other modes send it their files\n\
 \n\
-		Wrap mode:\n\
+		Batch:\n\
+		-b[atch]:	Process many files: a directory, a @list_file (one path per line) or a quoted glob pattern\n\
+				The output (-o) is a directory, each output file keeps the input file name, which must be unique\n\
+				-j sets the number of files processed at once\n\
+\n\
+		Info mode:\n\
+		-p[arsable]:	Prints a single machine-readable \"key=value\" line\n\
+\n\
+		Wrap modes (W, C):\n\
 		-m[odel]:	Specify the router model. (eg. \"WNDR4500v2\")\n\
-		-V[ersion]:	Specify the configuration version. (eg. \"1\")\n"
+		-V[ersion]:	Specify the configuration version. (eg. \"1\")\n\
+		-n[vram]:	Specify the NVRAM image size, a multiple of 8 bytes. Otherwise the model one is used, 64 KB if not known (eg. \"131072\")\n\
+				Only the WNDR4500v2 size is known: -n gives the size of the other models (eg. a 128 KB partition)\n\
+				The buffers are sized to it\n"
 
 //TODO: Get wrap model based on configuration (system_name key)
 
 /* Typdefs */
-struct main_opts {
-	int (*option_routine)(unsigned char*, int, unsigned char*, int*);
-	char * input_file_name;
-	char * output_file_name;
-	union {
-		unsigned int main_sets;
-		struct {
-			unsigned int main_set_verbose	:1;
-			unsigned int main_set_force		:1;
-			unsigned int 					:30;
-		};
-	};
-};
+struct job;
 
 struct wrap_opts {
 	unsigned int magic;
@@ -68,6 +94,49 @@ struct wrap_opts {
 	};
 };
 
+struct main_opts {
+	int (*option_routine)(const struct job*, unsigned char*, int, unsigned char*, int*);
+	char mode;
+	char * input_file_name;
+	char * output_file_name;
+	char * batch_input;
+	char * trace_file_name;
+	char * metrics_file_name;
+	char * socket_name;
+	struct ntgrbak_trace * trace;		//Stage timings and metrics, NULL when neither is written
+	char ** patches;			//Arguments of the patch mode
+	int patches_count;
+	int jobs;
+	int stream_size;
+	int input_size;				//Read of every input, 0 for the whole buffer
+	int image_size;				//NVRAM image of the text wraps, 0 for the model one
+	int buffer_size;			//Input and output buffers: a configuration of the image, BUFFER_SIZE at least
+	struct wrap_opts wrap_opt;
+	union {
+		unsigned int main_sets;
+		struct {
+			unsigned int main_set_verbose	:1;
+			unsigned int main_set_force		:1;
+			unsigned int main_set_parsable	:1;
+			unsigned int main_set_keyed		:1;		//The routine derives the few block keys it needs: no codec context
+			unsigned int main_set_serve		:1;
+			unsigned int main_set_stream	:1;		//The mode can stream its input
+			unsigned int 					:26;
+		};
+	};
+};
+
+/* Per-file state */
+struct job {
+	const struct main_opts * opt;
+	const struct ntgrbak_ctx * ctx;
+	struct ntgrbak_arena * arena;		//Working buffers of the library calls, NULL for malloc()
+	int buffer_size;					//Of the input and output buffers
+	const char * input_file_name;
+	const char * output_file_name;
+	const char * prefix;		//Prepended to the messages in batch mode
+};
+
 typedef enum {
 	wrap_opt_model,
 	wrap_opt_version,
@@ -76,33 +145,46 @@ typedef enum {
 
 /* Fuctions signs */
 // Routine
-int				routine_decrypt				(unsigned char*, int, unsigned char*, int*);
-int				routine_extract				(unsigned char*, int, unsigned char*, int*);
-int				routine_wrap				(unsigned char*, int, unsigned char*, int*);
-void			routine_wrap_set_option		(wrap_options, void *);
+int				routine_decrypt				(const struct job*, unsigned char*, int, unsigned char*, int*);
+int				routine_extract				(const struct job*, unsigned char*, int, unsigned char*, int*);
+int				routine_wrap				(const struct job*, unsigned char*, int, unsigned char*, int*);
+void			routine_wrap_set_option		(struct wrap_opts*, wrap_options, void *);
+int				routine_info				(const struct job*, unsigned char*, int, unsigned char*, int*);
+int				routine_text_extract		(const struct job*, unsigned char*, int, unsigned char*, int*);
+int				routine_text_wrap			(const struct job*, unsigned char*, int, unsigned char*, int*);
+int				routine_patch				(const struct job*, unsigned char*, int, unsigned char*, int*);
+int				routine_remote				(const struct job*, unsigned char*, int, unsigned char*, int*);
+int				routine_serve				(void*, const struct serve_request*, const unsigned char*, unsigned char*, size_t, size_t*);
+
+// File processing
+int				process_file				(const struct job*, unsigned char*, unsigned char*);
+int				process_batch				(void*, const char*, const char*, unsigned char*);
+int				process_stream				(const struct job*);
 
 // Misc
+int				self_test					(void);
 void			console_output				(char*, ...);
-
-
-/* Global variables */
-struct wrap_opts wrap_opt;
-struct main_opts main_opt;
+void			job_output					(const struct job*, char*, ...);
+int				info_print					(const struct job*, const struct ntgrbak_info*, unsigned char*);
 
 
 /* Funtions definitions */
 int main (int argc, char **argv)
 {
-	unsigned char buffer_input[BUFFER_SIZE];
-	unsigned char buffer_output[BUFFER_SIZE];
-	int buffer_output_len, buffer_input_len;
-	FILE *input_file, *output_file;
-	unsigned char i;
+	unsigned char *buffer_input, *buffer_output;
+	struct main_opts main_opt;
+	struct batch_list batch;
+	struct ntgrbak_arena arena;
+	struct job job;
+	uint64_t span, span_keys;
+	long long file_size;
+	char metrics_labels[64];
+	int i, ret, image_size;
 
 
 	/* Initial setup */
 	memset (&main_opt, 0, sizeof (struct main_opts));
-	memset (&wrap_opt, 0, sizeof (struct wrap_opts));
+	memset (&job, 0, sizeof (struct job));
 
 	/* Parse the arguments */
 	if (argc < 2)
@@ -110,22 +192,46 @@ int main (int argc, char **argv)
 		console_output ("Error: Need more arguments!\n" USAGE);
 		return 1;
 	}
-	switch (argv[1][0])
+	main_opt.mode = argv[1][0];
+	if (!strcmp (argv[1], "serve"))
+		main_opt.main_set_serve = 1;
+	else switch (argv[1][0])
 	{
 		case 'D':
 			main_opt.option_routine = routine_decrypt;
+			main_opt.main_set_stream = 1;
 			break;
 		case 'X':
 			main_opt.option_routine = routine_extract;
+			main_opt.main_set_stream = 1;
 			break;
 		case 'W':
 			main_opt.option_routine = routine_wrap;
+			main_opt.main_set_stream = 1;
+			break;
+		case 'I':
+			main_opt.option_routine = routine_info;
+			main_opt.input_size = HEADER_SIZE;
 			break;
+		case 'T':
+			main_opt.option_routine = routine_text_extract;
+			break;
+		case 'C':
+			main_opt.option_routine = routine_text_wrap;
+			break;
+		case 'P':
+			main_opt.option_routine = routine_patch;
+			main_opt.main_set_keyed = 1;
+			break;
+		case 'S':
+			return self_test ();
 		default:
 			console_output ("Error: Select a mode!\n" USAGE);
 			return 1;
 	}
-	wrap_opt.wrap_sets = 0;
+	main_opt.patches = malloc (sizeof (char *) * argc);
+	if (!main_opt.patches)
+		return 1;
 	for (i = 2; i < argc; i++)
 	{
 		if (argv[i][0] == '-')
@@ -144,77 +250,242 @@ int main (int argc, char **argv)
 			case 'o':
 				main_opt.output_file_name = argv[++i];
 				break;
+			case 'j':
+				main_opt.jobs = atoi (argv[++i]);
+				break;
+			case 's':
+				main_opt.stream_size = atoi (argv[++i]);
+				break;
+			case 'b':
+				main_opt.batch_input = argv[++i];
+				break;
+			case 'T':
+				main_opt.trace_file_name = argv[++i];
+				break;
+			case 'M':
+				main_opt.metrics_file_name = argv[++i];
+				break;
+			case 'U':
+				main_opt.socket_name = argv[++i];
+				break;
+			case 'p':
+				main_opt.main_set_parsable = 1;
+				break;
 			case 'm':
-				routine_wrap_set_option(wrap_opt_model, argv[++i]);
+				routine_wrap_set_option(&main_opt.wrap_opt, wrap_opt_model, argv[++i]);
 				break;
 			case 'V':
-				routine_wrap_set_option(wrap_opt_version, argv[++i]);
+				routine_wrap_set_option(&main_opt.wrap_opt, wrap_opt_version, argv[++i]);
+				break;
+			case 'n':
+				main_opt.image_size = atoi (argv[++i]);
 				break;
 			default:
 				console_output ("Error: Unknown option \"%s\".\n" USAGE, argv[i]);
+				free (main_opt.patches);
 				return 1;
 			}
 		}
+		else if (main_opt.option_routine == routine_patch)
+			main_opt.patches[main_opt.patches_count++] = argv[i];
 		else
 		{
 			console_output ("Error: Unknown option \"%s\".\n" USAGE, argv[i]);
+			free (main_opt.patches);
 			return 1;
 		}
 	}
-
-	/* Getting the input */
-	if (main_opt.input_file_name)
+	if (main_opt.option_routine == routine_patch && !main_opt.patches_count)
 	{
-		input_file = fopen (main_opt.input_file_name, "r");
-		if (input_file == NULL)
+		console_output ("Error: Specify the patches!\n" USAGE);
+		free (main_opt.patches);
+		return 1;
+	}
+	if (main_opt.image_size < 0 || main_opt.image_size % 8)
+	{
+		console_output ("Error: The NVRAM image size must be a multiple of 8 bytes!\n" USAGE);
+		free (main_opt.patches);
+		return 1;
+	}
+	if (main_opt.main_set_serve && !main_opt.socket_name)
+	{
+		console_output ("Error: Specify the socket!\n" USAGE);
+		free (main_opt.patches);
+		return 1;
+	}
+	if (main_opt.socket_name && !main_opt.main_set_serve)
+	{
+		/* The server does the work: no local keys */
+		if (main_opt.option_routine == routine_patch)
 		{
-			console_output ("Error opening file: %s\n", main_opt.input_file_name);
+			console_output ("Error: The patch mode is not served!\n");
+			free (main_opt.patches);
 			return 1;
 		}
+		main_opt.option_routine = routine_remote;
+		main_opt.main_set_keyed = 1;
+		main_opt.main_set_stream = 0;
 	}
-	else
-		input_file = stdin;
 
-	buffer_input_len = fread (buffer_input, 1, BUFFER_SIZE, input_file);	//TODO: Consider using Memory Mapped IO
-	if (!buffer_input_len)
+	/* The buffers hold a configuration of the NVRAM image, the keys of the text wraps cover it */
+	image_size = main_opt.image_size;
+	if (!image_size)
+		image_size = main_opt.wrap_opt.wrap_set_magic ? (int) ntgrbak_model_image_size (main_opt.wrap_opt.magic) : NTGRBAK_IMAGE_SIZE;
+	main_opt.buffer_size = ARENA_ALIGN (image_size + NTGRBAK_HEADER_SIZE);
+	if (main_opt.buffer_size < BUFFER_SIZE)
+		main_opt.buffer_size = BUFFER_SIZE;
+
+	/* Stage timings and metrics */
+	if (main_opt.trace_file_name || main_opt.metrics_file_name)
 	{
-		console_output ("Error reading the input\n");
-		return 1;
+		main_opt.trace = ntgrbak_trace_new ((main_opt.trace_file_name ? NTGRBAK_TRACE_EVENTS : 0) | (main_opt.metrics_file_name ? NTGRBAK_TRACE_METRICS : 0));
+		if (!main_opt.trace)
+		{
+			console_output ("Error allocating the trace\n");
+			free (main_opt.patches);
+			return 1;
+		}
 	}
-	if (main_opt.main_set_verbose)
-		console_output ("Read %u bytes from input\n", buffer_input_len);
+	span = trace_begin (main_opt.trace);
 
+	/* Server: the block keys are shared by all the requests */
+	if (main_opt.main_set_serve)
+	{
+		job.opt = &main_opt;
+		span_keys = trace_begin (main_opt.trace);
+		job.ctx = ntgrbak_ctx_new (main_opt.buffer_size + NTGRBAK_HEADER_SIZE, main_opt.jobs, NULL);
+		if (!job.ctx)
+		{
+			console_output ("Error allocating the codec context\n");
+			free (main_opt.patches);
+			ntgrbak_trace_free (main_opt.trace);
+			return 1;
+		}
+		trace_end (main_opt.trace, "key_setup", span_keys, main_opt.buffer_size + NTGRBAK_HEADER_SIZE);
 
+		if (main_opt.main_set_verbose)
+			console_output ("Serving on %s\n", main_opt.socket_name);
+		ret = serve_run (main_opt.socket_name, routine_serve, &job, main_opt.buffer_size);
 
-	/* Run the selected routine */
-	if (main_opt.option_routine (buffer_input, buffer_input_len, buffer_output, &buffer_output_len))
-		return 1;
+		ntgrbak_ctx_free ((struct ntgrbak_ctx *) job.ctx);
+	}
+	/* Batch mode */
+	else if (main_opt.batch_input)
+	{
+		if (!main_opt.output_file_name && main_opt.mode != 'I')
+		{
+			console_output ("Error: Specify the output directory!\n" USAGE);
+			free (main_opt.patches);
+			ntgrbak_trace_free (main_opt.trace);
+			return 1;
+		}
+
+		if (batch_list_load (&batch, main_opt.batch_input))
+		{
+			free (main_opt.patches);
+			ntgrbak_trace_free (main_opt.trace);
+			return 1;
+		}
 
+		/* The block keys are shared by all the files */
+		job.opt = &main_opt;
+		if (!main_opt.main_set_keyed)
+		{
+			span_keys = trace_begin (main_opt.trace);
+			job.ctx = ntgrbak_ctx_new (main_opt.buffer_size + NTGRBAK_HEADER_SIZE, 1, NULL);
+			if (!job.ctx)
+			{
+				console_output ("Error allocating the codec context\n");
+				batch_list_free (&batch);
+				free (main_opt.patches);
+				ntgrbak_trace_free (main_opt.trace);
+				return 1;
+			}
+			trace_end (main_opt.trace, "key_setup", span_keys, main_opt.buffer_size + NTGRBAK_HEADER_SIZE);
+		}
 
+		/* Every worker keeps its arena for all its files */
+		ret = batch_run (&batch, main_opt.output_file_name, main_opt.jobs, process_batch, &job, ARENA_BUFFERS * main_opt.buffer_size) ? 1 : 0;
 
-	/* Writing to output */
-	if (main_opt.output_file_name)
+		ntgrbak_ctx_free ((struct ntgrbak_ctx *) job.ctx);
+		batch_list_free (&batch);
+	}
+	else
 	{
-		output_file = fopen (main_opt.output_file_name, "w");
-		if (output_file == NULL)
+		/* Single file, the buffers are carved from an arena sized to the image, or to the input when it is not streamed */
+		job.opt = &main_opt;
+		job.input_file_name = main_opt.input_file_name;
+		job.output_file_name = main_opt.output_file_name;
+		job.buffer_size = main_opt.buffer_size;
+		file_size = io_file_size (main_opt.input_file_name);
+		if (!main_opt.main_set_stream && !main_opt.input_size && file_size > job.buffer_size && file_size <= NTGRBAK_IMAGE_SIZE_MAX + NTGRBAK_HEADER_SIZE)
+			job.buffer_size = (int) ARENA_ALIGN (file_size);
+
+		buffer_input = malloc ((size_t) ARENA_BUFFERS * job.buffer_size);
+		if (!buffer_input)
 		{
-			console_output ("Error writing to file: %s\n", main_opt.output_file_name);
+			console_output ("Error allocating the buffers\n");
+			free (main_opt.patches);
+			ntgrbak_trace_free (main_opt.trace);
 			return 1;
 		}
+		ntgrbak_arena_init (&arena, buffer_input, (size_t) ARENA_BUFFERS * job.buffer_size);
+		job.arena = &arena;
+		buffer_input = ntgrbak_arena_alloc (&arena, job.buffer_size);
+		buffer_output = ntgrbak_arena_alloc (&arena, job.buffer_size);
+		ret = process_file (&job, buffer_input, buffer_output);
+		if (ret)
+			trace_count (main_opt.trace, TRACE_FILES_FAILED, 1);
+		free (arena.base);
 	}
-	else
-		output_file = stdout;
 
-	if (fwrite (buffer_output, 1, buffer_output_len, output_file) != buffer_output_len)		//TODO: Consider using Memory Mapped IO
+	if (main_opt.trace)
 	{
-		console_output ("Error writing the output, it can be incomplete!\n");
-		return 1;
+		trace_end (main_opt.trace, "total", span, 0);
+		if (main_opt.trace_file_name && ntgrbak_trace_write (main_opt.trace, main_opt.trace_file_name))
+		{
+			console_output ("Error writing the trace: %s\n", main_opt.trace_file_name);
+			ret = 1;
+		}
+		snprintf (metrics_labels, sizeof (metrics_labels), "tool=\"%s\",mode=\"%.16s\"", "NtgrBak", argv[1]);
+		if (main_opt.metrics_file_name && ntgrbak_trace_write_metrics (main_opt.trace, main_opt.metrics_file_name, metrics_labels))
+		{
+			console_output ("Error writing the metrics: %s\n", main_opt.metrics_file_name);
+			ret = 1;
+		}
+		ntgrbak_trace_free (main_opt.trace);
 	}
 
-	if (main_opt.main_set_verbose)
-		console_output ("Done! %u bytes in, %u bytes out\n", buffer_input_len, buffer_output_len);
+	free (main_opt.patches);
+	return ret;
+}
 
-	return 0;
+/* Runs the checksum self-test and prints its results
+ * RETURN:		0: All the kernels passed, 1: A kernel failed
+ */
+int self_test (void)
+{
+	static const char * const status[] = { "passed", "FAILED", "skipped (not supported)" };
+	struct self_test_result result[SELF_TEST_RESULTS_MAX];
+	int i, n, failed;
+
+	n = checksum_self_test (result, SELF_TEST_RESULTS_MAX);
+	failed = n < 0;
+	for (i = 0; i < n; i++)
+	{
+		printf ("%s %-12s %s\n", result[i].test, result[i].kernel, status[result[i].result]);
+		failed |= result[i].result == SELF_TEST_FAILED;
+	}
+
+	n = serve_self_test (result, SELF_TEST_RESULTS_MAX);
+	failed |= n < 0;
+	for (i = 0; i < n; i++)
+	{
+		printf ("%s %-12s %s\n", result[i].test, result[i].kernel, status[result[i].result]);
+		failed |= result[i].result == SELF_TEST_FAILED;
+	}
+
+	return failed;
 }
 
 void console_output(char *format, ...)
@@ -226,137 +497,692 @@ void console_output(char *format, ...)
 	va_end(args);
 }
 
-int routine_decrypt (unsigned char* buffer_input, int buffer_input_len, unsigned char* buffer_output, int* buffer_output_len)
+void job_output(const struct job *job, char *format, ...)
 {
-	if (run_codec(buffer_input, buffer_input_len, buffer_output, buffer_output_len, 0))
+	char line[1024];
+	va_list args;
+
+	va_start(args, format);
+	vsnprintf(line, sizeof (line), format, args);
+	va_end(args);
+
+	if (job->prefix)
+		console_output("%s: %s", job->prefix, line);
+	else
+		console_output("%s", line);
+}
+
+/* Reads the input, runs the routine and writes the output of a job
+ * job:				The job
+ * buffer_input:	The input buffer (job->buffer_size bytes)
+ * buffer_output:	The output buffer (job->buffer_size bytes)
+ * RETURN:			0: Success, 1: Failure
+ */
+int process_file (const struct job *job, unsigned char *buffer_input, unsigned char *buffer_output)
+{
+	const struct main_opts *opt = job->opt;
+	struct ntgrbak_ctx *ctx;
+	struct io_file input, output;
+	struct job job_file;
+	uint64_t span, span_file;
+	int buffer_output_len, ret;
+
+
+	/* The inputs too big for the buffers go through a stream (wrapping adds the 0x18 bytes header) */
+	if (opt->main_set_stream && (opt->stream_size > 0 || io_file_size (job->input_file_name) > job->buffer_size - NTGRBAK_HEADER_SIZE))
+		return process_stream (job);
+
+	/* Getting the input */
+	trace_count (opt->trace, TRACE_FILES, 1);
+	span_file = trace_begin (opt->trace);
+	span = trace_begin (opt->trace);
+	ret = io_input_open (&input, job->input_file_name, buffer_input, opt->input_size ? opt->input_size : job->buffer_size);
+	if (ret == IO_OPEN_ERROR)
+	{
+		job_output (job, "Error opening file: %s\n", job->input_file_name);
+		return 1;
+	}
+	if (ret)
+	{
+		io_input_close (&input);
+		job_output (job, "Error reading the input\n");
+		return 1;
+	}
+
+	/* Only the regular files are known to be too big before reading them */
+	if (input.more && !opt->input_size)
+	{
+		io_input_close (&input);
+		if (opt->main_set_stream)
+			job_output (job, "Input is bigger than the buffers (%d bytes): stream it with -s\n", job->buffer_size);
+		else
+			job_output (job, "Input is too big! (max: %d bytes)\n", job->buffer_size);
+		return 1;
+	}
+	trace_end (opt->trace, "read", span, input.len);
+	trace_count (opt->trace, TRACE_BYTES_IN, input.len);
+	if (opt->main_set_verbose)
+		job_output (job, "Read %u bytes from input\n", (unsigned int) input.len);
+
+	/* A single file derives its block keys on the fly, each one is used once: only the shared ones are precomputed */
+	job_file = *job;
+	ctx = NULL;
+	if (!job_file.ctx && !opt->main_set_keyed)
 	{
-		console_output ("Error processing the input!\nMake sure the input data size is a multiple of 8 bytes.");
+		ctx = ntgrbak_ctx_new (0, opt->jobs, NULL);
+		if (!ctx)
+		{
+			io_input_close (&input);
+			job_output (job, "Error allocating the codec context\n");
+			return 1;
+		}
+		job_file.ctx = ctx;
+	}
+
+	/* The output is written in place when it can be mapped */
+	if (io_output_open (&output, job->output_file_name, buffer_output, job->buffer_size, job->prefix ? 0 : IO_OUTPUT_SPLICE))
+	{
+		io_input_close (&input);
+		ntgrbak_ctx_free (ctx);
+		job_output (job, "Error writing to file: %s\n", job->output_file_name);
 		return 1;
 	}
 
+
+
+	/* Run the selected routine */
+	buffer_output_len = 0;
+	ret = opt->option_routine (&job_file, input.data, input.len, output.data, &buffer_output_len);
+	io_input_close (&input);
+	ntgrbak_ctx_free (ctx);
+
+
+
+	/* Writing to output, a failed run writes nothing */
+	if (ret)
+	{
+		io_output_discard (&output);
+		trace_end (opt->trace, "file", span_file, input.len);
+		return 1;
+	}
+	span = trace_begin (opt->trace);
+	if (io_output_close (&output, buffer_output_len))
+	{
+		job_output (job, "Error writing the output, it can be incomplete!\n");
+		return 1;
+	}
+	trace_end (opt->trace, "write", span, buffer_output_len);
+	trace_count (opt->trace, TRACE_BYTES_OUT, buffer_output_len);
+	trace_end (opt->trace, "file", span_file, input.len);
+
+	if (opt->main_set_verbose)
+		job_output (job, "Done! %u bytes in, %u bytes out\n", (unsigned int) input.len, buffer_output_len);
+
 	return 0;
 }
 
-int routine_extract (unsigned char* buffer_input, int buffer_input_len, unsigned char* buffer_output, int* buffer_output_len)
+/* Batch routine: processes a file with the worker scratch buffer
+ * arg:					The batch job template
+ * input_file_name:		The input file
+ * output_file_name:	The output file, NULL for stdout
+ * scratch:				The worker buffer, its arena (ARENA_BUFFERS * buffer_size bytes)
+ * RETURN:				0: Success, 1: Failure
+ */
+int process_batch (void *arg, const char *input_file_name, const char *output_file_name, unsigned char *scratch)
 {
-	unsigned char buffer_dec[BUFFER_SIZE];
-	int buffer_dec_len;
-	unsigned int payload_size, magic;
+	struct ntgrbak_arena arena;
+	unsigned char *buffer_input, *buffer_output;
+	struct job job;
 
-	/* First decrypt the data */
-	if (routine_decrypt (buffer_input, buffer_input_len, buffer_dec, &buffer_dec_len))
-		return 1;
+	job = *(const struct job *) arg;
+	job.input_file_name = input_file_name;
+	job.output_file_name = output_file_name;
+	job.prefix = input_file_name;
+
+	/* The arena starts empty on every file, nothing is allocated */
+	job.buffer_size = job.opt->buffer_size;
+	ntgrbak_arena_init (&arena, scratch, (size_t) ARENA_BUFFERS * job.buffer_size);
+	job.arena = &arena;
+	buffer_input = ntgrbak_arena_alloc (&arena, job.buffer_size);
+	buffer_output = ntgrbak_arena_alloc (&arena, job.buffer_size);
 
-	/* Check for consistency */
-	if (main_opt.main_set_force)
+	if (process_file (&job, buffer_input, buffer_output))
 	{
-		if (main_opt.main_set_verbose) console_output ("Skipping checksum verify.\n");
+		trace_count (job.opt->trace, TRACE_FILES_FAILED, 1);
+		return 1;
 	}
-	else
+
+	return 0;
+}
+
+/* Passes the library messages to the job output */
+static void job_log (void *opaque, const char *message)
+{
+	job_output ((const struct job *) opaque, "%s", message);
+}
+
+
+/* Fills the library call options of a job
+ * job:			The job
+ * lib_opt:		The library call options
+ */
+static void job_lib_opts (const struct job *job, struct ntgrbak_opts *lib_opt)
+{
+	lib_opt->flags = 0;
+	if (job->opt->main_set_verbose)
+		lib_opt->flags |= NTGRBAK_VERBOSE;
+	if (job->opt->main_set_force)
+		lib_opt->flags |= NTGRBAK_FORCE;
+	lib_opt->log = job_log;
+	lib_opt->log_opaque = (void *) job;
+	lib_opt->trace = job->opt->trace;
+	lib_opt->alloc = job->arena ? &job->arena->allocator : NULL;
+	lib_opt->image_size = job->opt->image_size;
+}
+
+
+/* Streams a file a piece at a time, in constant memory whatever its size
+ * job:				The job
+ * RETURN:			0: Success, 1: Failure
+ */
+int process_stream (const struct job *job)
+{
+	const struct main_opts *opt = job->opt;
+	struct ntgrbak_opts lib_opt;
+	struct ntgrbak_stream *stream;
+	struct io_file input, output;
+	unsigned char *buffer_input, *buffer_output;
+	long long input_size;
+	uint64_t bytes_in, bytes_out, span, span_file;
+	ssize_t piece_len;
+	size_t piece, len;
+	int mode, ret;
+
+
+	trace_count (opt->trace, TRACE_FILES, 1);
+	span_file = trace_begin (opt->trace);
+	piece = opt->stream_size > 0 ? (size_t) opt->stream_size : STREAM_PIECE_SIZE;
+	mode = opt->mode == 'W' ? NTGRBAK_STREAM_WRAP : opt->mode == 'X' ? NTGRBAK_STREAM_EXTRACT : NTGRBAK_STREAM_DECRYPT;
+
+	/* The wrap header holds the length */
+	input_size = io_file_size (job->input_file_name);
+	if (mode == NTGRBAK_STREAM_WRAP)
 	{
-		if (!verify_checksum(buffer_dec, buffer_dec_len))
+		if (opt->wrap_opt.wrap_sets != 0x00000003)
 		{
-			console_output ("Checksum verify failed.\n");
+			job_output (job, "Error, provide wrap settings!\n" USAGE);
+			return 1;
+		}
+		if (input_size < 0)
+		{
+			job_output (job, "Error: Wrapping a stream needs a regular input file\n");
 			return 1;
 		}
-
-		if (main_opt.main_set_verbose) console_output ("Checksum verify passed.\n");
 	}
 
-	/* Print info */
-	if (main_opt.main_set_verbose)
+	if (io_stream_open (&input, job->input_file_name, 0))
 	{
-		magic = get_magic(buffer_dec);
-		console_output ("Router Model: %s\n", get_model(magic));
-		console_output ("Configuration version: %u\n", get_config_version(buffer_dec));
-		console_output ("Configuration magic: 0x%08x\n", magic);
+		job_output (job, "Error opening file: %s\n", job->input_file_name);
+		return 1;
+	}
+	if (io_stream_open (&output, job->output_file_name, 1))
+	{
+		io_stream_close (&input, 0);
+		job_output (job, "Error writing to file: %s\n", job->output_file_name);
+		return 1;
 	}
 
-	/* Check lengths */
-	payload_size = get_config_length(buffer_dec) - 0x18;
-	if (main_opt.main_set_force)
+	job_lib_opts (job, &lib_opt);
+	buffer_input = malloc (2 * piece + NTGRBAK_STREAM_SLACK);
+	stream = ntgrbak_stream_new (&lib_opt, mode, input_size > 0 ? (size_t) input_size : 0, opt->wrap_opt.magic, opt->wrap_opt.version, NULL);
+	if (!buffer_input || !stream)
 	{
-		if (main_opt.main_set_verbose) console_output ("Skipping length check.\n");
+		free (buffer_input);
+		ntgrbak_stream_free (stream);
+		io_stream_close (&input, 0);
+		io_stream_close (&output, 0);
+		job_output (job, "Error allocating the stream\n");
+		return 1;
 	}
-	else
+	buffer_output = buffer_input + piece;
+
+	/* Read, process and write a piece at a time */
+	bytes_in = 0;
+	bytes_out = 0;
+	ret = 0;
+	while (!ret)
 	{
-		if (payload_size > MAX_FILE_SIZE)
+		span = trace_begin (opt->trace);
+		piece_len = io_stream_read (input.fd, buffer_input, piece);
+		if (piece_len < 0)
 		{
-			console_output ("Configuration NVRAM image is too big. (%u bytes, max: %u bytes)\n", payload_size, MAX_FILE_SIZE);
-			return 1;
+			job_output (job, "Error reading the input\n");
+			ret = 1;
+			break;
 		}
+		if (!piece_len)
+			break;
+		trace_end (opt->trace, "read", span, piece_len);
+		bytes_in += piece_len;
 
-		if (payload_size != (buffer_input_len - 0x18))
+		if (ntgrbak_stream_update (stream, buffer_input, piece_len, buffer_output, piece + NTGRBAK_STREAM_SLACK, &len))
+			ret = 1;
+		else
 		{
-			console_output ("Configuration NVRAM image size is not what expected. Expecting %u bytes instead of %u bytes\n", payload_size, buffer_input_len - 0x18);
-			return 1;
+			span = trace_begin (opt->trace);
+			if (io_stream_write (output.fd, buffer_output, len, -1))
+			{
+				job_output (job, "Error writing the output, it can be incomplete!\n");
+				ret = 1;
+			}
+			trace_end (opt->trace, "write", span, len);
+			bytes_out += len;
 		}
 	}
-	if (main_opt.main_set_verbose) console_output ("Configuration NVRAM image size: %u bytes\n", payload_size);
+	if (!ret && !bytes_in)
+	{
+		job_output (job, "Error reading the input\n");
+		ret = 1;
+	}
+
+	/* The checks needing the whole input, then the wrap header goes over the first one */
+	if (!ret && ntgrbak_stream_final (stream, buffer_output, piece + NTGRBAK_STREAM_SLACK, &len, NULL))
+		ret = 1;
+	if (!ret && len && io_stream_write (output.fd, buffer_output, len, 0))
+	{
+		job_output (job, "Error: Wrapping a stream needs a seekable output\n");
+		ret = 1;
+	}
+
+	ntgrbak_stream_free (stream);
+	free (buffer_input);
+	/* A failed stream output is not a configuration: the named output file is left as it was */
+	io_stream_close (&input, 0);
+	if (io_stream_close (&output, !ret) && !ret)
+	{
+		job_output (job, "Error writing the output, it can be incomplete!\n");
+		ret = 1;
+	}
+	trace_count (opt->trace, TRACE_BYTES_IN, bytes_in);
+	trace_count (opt->trace, TRACE_BYTES_OUT, bytes_out);
+	trace_end (opt->trace, "file", span_file, bytes_in);
+
+	if (ret)
+		return 1;
+
+	if (opt->main_set_verbose)
+		job_output (job, "Done! %llu bytes in, %llu bytes out\n", (unsigned long long) bytes_in, (unsigned long long) bytes_out);
+
+	return 0;
+}
+
+
+int routine_decrypt (const struct job *job, unsigned char* buffer_input, int buffer_input_len, unsigned char* buffer_output, int* buffer_output_len)
+{
+	struct ntgrbak_opts lib_opt;
+	size_t len;
+
+	job_lib_opts (job, &lib_opt);
+	if (ntgrbak_decrypt (job->ctx, &lib_opt, buffer_input, buffer_input_len, buffer_output, job->buffer_size, &len))
+		return 1;
 
-	/* Check padding */
-	//TODO: Check if bytes from 0x10 to 0x18 are 0s
+	*buffer_output_len = (int) len;
+	return 0;
+}
 
+int routine_extract (const struct job *job, unsigned char* buffer_input, int buffer_input_len, unsigned char* buffer_output, int* buffer_output_len)
+{
+	struct ntgrbak_opts lib_opt;
+	size_t len;
 
-	/* Copy the payload */
-	memcpy (buffer_output, buffer_dec + 0x18, payload_size);
-	*buffer_output_len = (int)payload_size;
+	job_lib_opts (job, &lib_opt);
+	if (ntgrbak_extract (job->ctx, &lib_opt, buffer_input, buffer_input_len, buffer_output, job->buffer_size, &len, NULL))
+		return 1;
 
+	*buffer_output_len = (int) len;
 	return 0;
 }
 
+int routine_text_extract (const struct job *job, unsigned char* buffer_input, int buffer_input_len, unsigned char* buffer_output, int* buffer_output_len)
+{
+	struct ntgrbak_opts lib_opt;
+	size_t len;
+
+	job_lib_opts (job, &lib_opt);
+	if (ntgrbak_config_to_text (job->ctx, &lib_opt, buffer_input, buffer_input_len, buffer_output, job->buffer_size, &len, NULL))
+		return 1;
+
+	*buffer_output_len = (int) len;
+	return 0;
+}
 
-void routine_wrap_set_option (wrap_options opt, void * value)
+
+void routine_wrap_set_option (struct wrap_opts *wrap_opt, wrap_options opt, void * value)
 {
 	switch (opt)
 	{
 	case wrap_opt_model:
-		wrap_opt.magic = generate_magic((unsigned char *) value);
-		wrap_opt.wrap_set_magic = 1;
+		wrap_opt->magic = ntgrbak_model_magic((const char *) value);
+		wrap_opt->wrap_set_magic = 1;
 		break;
 	case wrap_opt_version:
-		wrap_opt.version = (unsigned int) atoi ((char *) value);
-		wrap_opt.wrap_set_version = 1;
+		wrap_opt->version = (unsigned int) atoi ((char *) value);
+		wrap_opt->wrap_set_version = 1;
 		break;
 	}
 }
 
-int routine_wrap (unsigned char* buffer_input, int buffer_input_len, unsigned char* buffer_output, int* buffer_output_len)
+int routine_wrap (const struct job *job, unsigned char* buffer_input, int buffer_input_len, unsigned char* buffer_output, int* buffer_output_len)
+{
+	const struct wrap_opts *wrap_opt = &job->opt->wrap_opt;
+	struct ntgrbak_opts lib_opt;
+	size_t len;
+
+	if (wrap_opt->wrap_sets != 0x00000003)
+	{
+		job_output (job, "Error, provide wrap settings!\n" USAGE);
+		return 1;
+	}
+
+	job_lib_opts (job, &lib_opt);
+	if (ntgrbak_wrap (job->ctx, &lib_opt, buffer_input, buffer_input_len, wrap_opt->magic, wrap_opt->version, buffer_output, job->buffer_size, &len))
+		return 1;
+
+	*buffer_output_len = (int) len;
+	return 0;
+}
+
+int routine_text_wrap (const struct job *job, unsigned char* buffer_input, int buffer_input_len, unsigned char* buffer_output, int* buffer_output_len)
+{
+	const struct wrap_opts *wrap_opt = &job->opt->wrap_opt;
+	struct ntgrbak_opts lib_opt;
+	size_t len;
+
+	if (wrap_opt->wrap_sets != 0x00000003)
+	{
+		job_output (job, "Error, provide wrap settings!\n" USAGE);
+		return 1;
+	}
+
+	job_lib_opts (job, &lib_opt);
+	if (ntgrbak_text_to_config (job->ctx, &lib_opt, buffer_input, buffer_input_len, wrap_opt->magic, wrap_opt->version, buffer_output, job->buffer_size, &len))
+		return 1;
+
+	*buffer_output_len = (int) len;
+	return 0;
+}
+
+int routine_info (const struct job *job, unsigned char* buffer_input, int buffer_input_len, unsigned char* buffer_output, int* buffer_output_len)
+{
+	struct ntgrbak_opts lib_opt;
+	struct ntgrbak_info info;
+
+	/* Only the header blocks are decrypted */
+	job_lib_opts (job, &lib_opt);
+	if (ntgrbak_info (job->ctx, &lib_opt, buffer_input, buffer_input_len, &info))
+		return 1;
+
+	*buffer_output_len = info_print (job, &info, buffer_output);
+	return 0;
+}
+
+
+/* Prints the info of a configuration, naming the file in batch mode
+ * job:				The job
+ * info:			The configuration info
+ * buffer_output:	The output buffer (job->buffer_size bytes)
+ * RETURN:			The output length
+ */
+int info_print (const struct job *job, const struct ntgrbak_info *info, unsigned char *buffer_output)
+{
+	if (job->opt->main_set_parsable)
+		return snprintf ((char *) buffer_output, job->buffer_size, "%s%s%smodel=%s magic=0x%08x version=%u length=%u\n",
+				job->prefix ? "file=" : "", job->prefix ? job->prefix : "", job->prefix ? " " : "",
+				info->model, info->magic, info->version, info->length);
+	else
+		return snprintf ((char *) buffer_output, job->buffer_size, "%s%sRouter Model: %s\nConfiguration version: %u\nConfiguration magic: 0x%08x\nConfiguration length: %u bytes\n",
+				job->prefix ? job->prefix : "", job->prefix ? ":\n" : "",
+				info->model, info->version, info->magic, info->length);
+}
+
+
+/* Parses a patch argument
+ * arg:			The patch, OFFSET:HEX or OFFSET=TEXT
+ * patch:		The parsed patch
+ * data:		The patch data buffer (at least strlen (arg) bytes)
+ * RETURN:		0: Success, 1: Failure
+ */
+static int patch_parse (const char *arg, struct ntgrbak_patch *patch, unsigned char *data)
+{
+	char *end;
+	unsigned int byte;
+
+	patch->offset = (unsigned int) strtoul (arg, &end, 0);
+	patch->data = data;
+	patch->len = 0;
+	if (end == arg)
+		return 1;
+
+	if (*end == '=')
+	{
+		patch->len = strlen (end + 1);
+		memcpy (data, end + 1, patch->len);
+	}
+	else if (*end == ':')
+	{
+		for (end++; *end; end += 2)
+		{
+			if (sscanf (end, "%2x", &byte) != 1 || !end[1])
+				return 1;
+			data[patch->len++] = (unsigned char) byte;
+		}
+	}
+	else
+		return 1;
+
+	return patch->len ? 0 : 1;
+}
+
+
+int routine_patch (const struct job *job, unsigned char* buffer_input, int buffer_input_len, unsigned char* buffer_output, int* buffer_output_len)
 {
-	unsigned char buffer_wrap[BUFFER_SIZE];
-	int buffer_wrap_len;
+	const struct main_opts *opt = job->opt;
+	struct ntgrbak_opts lib_opt;
+	struct ntgrbak_patch *patch;
+	unsigned char *data;
+	size_t data_len, len;
+	int i, ret;
 
-	if (wrap_opt.wrap_sets != 0x00000003)
+	/* The patches data is no longer than their arguments */
+	data_len = 0;
+	for (i = 0; i < opt->patches_count; i++)
+		data_len += strlen (opt->patches[i]);
+	patch = malloc (sizeof (struct ntgrbak_patch) * opt->patches_count);
+	data = malloc (data_len + 1);
+	if (!patch || !data)
 	{
-		console_output("Error, provide wrap settings!\n" USAGE);
+		free (patch);
+		free (data);
+		job_output (job, "Error allocating the patches\n");
 		return 1;
 	}
 
-	/* Clean the output buffer */
-	memset (buffer_wrap, 0x00, 0x18);
+	ret = 0;
+	data_len = 0;
+	for (i = 0; i < opt->patches_count && !ret; i++)
+	{
+		if (patch_parse (opt->patches[i], &patch[i], data + data_len))
+		{
+			job_output (job, "Invalid patch: %s\n", opt->patches[i]);
+			ret = 1;
+		}
+		data_len += patch[i].len;
+	}
+
+	if (!ret)
+	{
+		job_lib_opts (job, &lib_opt);
+		ret = ntgrbak_patch (job->ctx, &lib_opt, buffer_input, buffer_input_len, patch, opt->patches_count, buffer_output, job->buffer_size, &len, NULL) ? 1 : 0;
+	}
+
+	free (patch);
+	free (data);
+	if (ret)
+		return 1;
+
+	*buffer_output_len = (int) len;
+	return 0;
+}
 
-	/* Dump the payload in output buffer */
-	memcpy (buffer_wrap + 0x18, buffer_input, buffer_input_len);
 
-	/* Build the header */
-	buffer_wrap_len = buffer_input_len + 0x18;
-	set_magic(buffer_wrap, wrap_opt.magic);
-	set_config_length(buffer_wrap, buffer_wrap_len);
-	set_config_version(buffer_wrap, wrap_opt.version);
-	generate_checksum(buffer_wrap, buffer_wrap_len);
+/* Sends the input to a server (-U) and gets the output back */
+int routine_remote (const struct job *job, unsigned char* buffer_input, int buffer_input_len, unsigned char* buffer_output, int* buffer_output_len)
+{
+	const struct main_opts *opt = job->opt;
+	struct serve_request request;
+	struct ntgrbak_info info;
+	char model[64];
+	size_t len;
+	int fd, ret;
 
-	if (main_opt.main_set_verbose)
+	if ((opt->mode == 'W' || opt->mode == 'C') && opt->wrap_opt.wrap_sets != 0x00000003)
 	{
-		console_output ("Generated configuration:\n");
-		console_output ("Router Model: %s\n", get_model(get_magic(buffer_wrap)));
-		console_output ("Configuration version: %u\n", get_config_version(buffer_wrap));
+		job_output (job, "Error, provide wrap settings!\n" USAGE);
+		return 1;
 	}
 
-	/* Encrypting the result */
-	if (run_codec (buffer_wrap, buffer_wrap_len, buffer_output, buffer_output_len, 1))
+	request.mode = opt->mode;
+	request.flags = (opt->main_set_verbose ? SERVE_VERBOSE : 0) | (opt->main_set_force ? SERVE_FORCE : 0);
+	request.magic = opt->wrap_opt.magic;
+	request.version = opt->wrap_opt.version;
+	request.length = buffer_input_len;
+
+	fd = serve_connect (opt->socket_name);
+	if (fd < 0)
+	{
+		job_output (job, "Error connecting to the server: %s\n", opt->socket_name);
 		return 1;
+	}
+	ret = serve_call (fd, &request, buffer_input, buffer_output, job->buffer_size, &len);
+	close (fd);
+	if (ret < 0)
+	{
+		job_output (job, "Error talking to the server\n");
+		return 1;
+	}
+	if (ret)
+	{
+		/* The response holds the error messages */
+		job_output (job, "%.*s", (int) len, (char *) buffer_output);
+		return 1;
+	}
 
-	if (main_opt.main_set_verbose) console_output ("Successfully encoded configuration.\n");
+	/* The info is answered in the parsable form */
+	if (opt->mode == 'I')
+	{
+		buffer_output[len < (size_t) job->buffer_size ? len : (size_t) job->buffer_size - 1] = '\0';
+		if (sscanf ((char *) buffer_output, "model=%63s magic=0x%x version=%u length=%u", model, &info.magic, &info.version, &info.length) != 4)
+		{
+			job_output (job, "Error parsing the server info\n");
+			return 1;
+		}
+		info.model = model;
+		len = info_print (job, &info, buffer_output);
+	}
 
+	*buffer_output_len = (int) len;
 	return 0;
 }
+
+
+/* Messages of a served request, sent back when it fails */
+struct serve_log {
+	char message[1024];
+	size_t len;
+};
+
+static void serve_log_append (void *opaque, const char *message)
+{
+	struct serve_log *log = opaque;
+
+	log->len += snprintf (log->message + log->len, sizeof (log->message) - log->len, "%s", message);
+	if (log->len >= sizeof (log->message))
+		log->len = sizeof (log->message) - 1;
+}
+
+
+/* Server routine: runs a request with the shared block keys
+ * arg:			The server job
+ * request:		The request
+ * in:			The request payload
+ * out:			The response payload buffer
+ * out_max:		The response payload buffer size
+ * out_len:		The response payload length
+ * RETURN:		NTGRBAK_OK or the error code, the out buffer then holds the messages
+ */
+int routine_serve (void *arg, const struct serve_request *request, const unsigned char *in, unsigned char *out, size_t out_max, size_t *out_len)
+{
+	const struct job *job = arg;
+	struct ntgrbak_trace *trace = job->opt->trace;
+	struct ntgrbak_opts lib_opt;
+	struct ntgrbak_info info;
+	struct serve_log log;
+	uint64_t span;
+	int ret;
+
+	trace_count (trace, TRACE_FILES, 1);
+	trace_count (trace, TRACE_BYTES_IN, request->length);
+	span = trace_begin (trace);
+
+	log.len = 0;
+	log.message[0] = '\0';
+	lib_opt.flags = (request->flags & SERVE_VERBOSE ? NTGRBAK_VERBOSE : 0) | (request->flags & SERVE_FORCE ? NTGRBAK_FORCE : 0);
+	lib_opt.log = serve_log_append;
+	lib_opt.log_opaque = &log;
+	lib_opt.trace = trace;
+	lib_opt.alloc = NULL;
+	lib_opt.image_size = job->opt->image_size;
+
+	switch (request->mode)
+	{
+	case 'D':
+		ret = ntgrbak_decrypt (job->ctx, &lib_opt, in, request->length, out, out_max, out_len);
+		break;
+	case 'X':
+		ret = ntgrbak_extract (job->ctx, &lib_opt, in, request->length, out, out_max, out_len, NULL);
+		break;
+	case 'W':
+		ret = ntgrbak_wrap (job->ctx, &lib_opt, in, request->length, request->magic, request->version, out, out_max, out_len);
+		break;
+	case 'T':
+		ret = ntgrbak_config_to_text (job->ctx, &lib_opt, in, request->length, out, out_max, out_len, NULL);
+		break;
+	case 'C':
+		ret = ntgrbak_text_to_config (job->ctx, &lib_opt, in, request->length, request->magic, request->version, out, out_max, out_len);
+		break;
+	case 'I':
+		ret = ntgrbak_info (job->ctx, &lib_opt, in, request->length, &info);
+		if (!ret)
+			*out_len = snprintf ((char *) out, out_max, "model=%s magic=0x%08x version=%u length=%u\n",
+					info.model, info.magic, info.version, info.length);
+		break;
+	default:
+		serve_log_append (&log, "Mode not served!\n");
+		ret = NTGRBAK_ERR_ARGS;
+		break;
+	}
+
+	if (ret)
+	{
+		if (!log.len)
+			serve_log_append (&log, ntgrbak_strerror (ret));
+		memcpy (out, log.message, log.len);
+		*out_len = log.len;
+		trace_count (trace, TRACE_FILES_FAILED, 1);
+	}
+	else
+		trace_count (trace, TRACE_BYTES_OUT, *out_len);
+	trace_end (trace, "request", span, request->length);
+
+	return ret;
+}
@@ -0,0 +1,443 @@
+/*
+ ============================================================================
+ Name        : NtgrGen.c
+ Author      : Marco Giorgi (multigiorgiplex)
+ Version     :
+ Copyright   : See Apache License 2.0
+ Description : Synthetic Netgear configuration backups generator, for performance testing
+ ============================================================================
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "libntgrbak.h"
+#include "nvram.h"
+#include "fileio.h"
+
+/* Defines */
+#define GEN_COUNT		100
+#define GEN_SEED		1
+#define GEN_FILL_MIN	20		//Percent of GEN_TEXT_MAX
+#define GEN_FILL_MAX	95
+#define GEN_MODELS		"WNDR4500v2,R7000,R8000,R6400v2,WNR3500Lv2,WNDR3700v4,D7000"
+#define GEN_RECORD_MAX	256		//Longest "key=value" line generated
+#define GEN_TEXT_MAX	(NVRAM_IMAGE_SIZE_DEFAULT - NVRAM_INDEX_DATA)	//The models generated have the default NVRAM image
+#define GEN_OUTPUT_MAX	(NVRAM_IMAGE_SIZE_DEFAULT + NTGRBAK_HEADER_SIZE)
+
+#define USAGE	\
+"Usage:\n\
+		./NtgrGen [options] -o output_dir\n\
+Generates valid encrypted configurations of random router-like \"key=value\" records, named 000000.cfg, 000001.cfg...\n\
+The same options and seed always generate the same files.\n\
+Options:\n\
+		-n[umber]:	Number of configurations. (default: 100)\n\
+		-s[eed]:	Random seed. (default: 1)\n\
+		-l[evel]:	NVRAM image fill level range, percent of the data size. (eg. \"20-95\", the default)\n\
+		-m[odels]:	Comma separated router models, picked at random. (default: \"" GEN_MODELS "\")\n\
+		-v[erbose]:	Prints every generated configuration\n\
+		-o[utput]:	The output directory\n"
+
+/* Typdefs */
+typedef enum {
+	gen_value_ip,
+	gen_value_mac,
+	gen_value_int,
+	gen_value_bool,
+	gen_value_word,			//A short identifier
+	gen_value_secret,		//A long random string
+	gen_value_host,
+	gen_value_rule,			//A firewall or forwarding rule
+	gen_value_reservation,	//A DHCP reservation
+	gen_value_empty,
+} gen_value;
+
+/* Record family: the base ones are set once, the indexed ones (key with a %d) are appended until the fill level */
+struct gen_family {
+	const char * key;
+	gen_value value;
+	int weight;				//Relative frequency of the indexed families
+};
+
+struct main_opts {
+	char * output_dir;
+	char * models;
+	int count;
+	int fill_min;
+	int fill_max;
+	uint64_t seed;
+	union {
+		unsigned int main_sets;
+		struct {
+			unsigned int main_set_verbose	:1;
+			unsigned int 					:31;
+		};
+	};
+};
+
+/* Fuctions signs */
+int				gen_text					(uint64_t*, int, unsigned char*);
+int				gen_config					(const struct main_opts*, const struct ntgrbak_ctx*, const char**, int, int, unsigned char*, unsigned char*);
+
+// Misc
+void			console_output				(char*, ...);
+
+static const struct gen_family gen_families_base[] = {
+	{ "lan_ipaddr",				gen_value_ip,			0 },
+	{ "lan_netmask",			gen_value_ip,			0 },
+	{ "lan_hwaddr",				gen_value_mac,			0 },
+	{ "wan_hwaddr",				gen_value_mac,			0 },
+	{ "wan_ipaddr",				gen_value_ip,			0 },
+	{ "wan_gateway",			gen_value_ip,			0 },
+	{ "wan_proto",				gen_value_word,			0 },
+	{ "wan_dns",				gen_value_ip,			0 },
+	{ "dhcp_start",				gen_value_ip,			0 },
+	{ "dhcp_end",				gen_value_ip,			0 },
+	{ "lan_lease",				gen_value_int,			0 },
+	{ "http_username",			gen_value_word,			0 },
+	{ "http_passwd",			gen_value_secret,		0 },
+	{ "http_rmenable",			gen_value_bool,			0 },
+	{ "time_zone",				gen_value_word,			0 },
+	{ "ntp_server",				gen_value_host,			0 },
+	{ "upnp_enable",			gen_value_bool,			0 },
+	{ "friendly_name",			gen_value_word,			0 },
+	{ "wla_ssid",				gen_value_word,			0 },
+	{ "wla_wpa_psk",			gen_value_secret,		0 },
+	{ "wla_channel",			gen_value_int,			0 },
+	{ "wlg_ssid",				gen_value_word,			0 },
+	{ "wlg_wpa_psk",			gen_value_secret,		0 },
+	{ "wlg_channel",			gen_value_int,			0 },
+	{ "qos_enable",				gen_value_bool,			0 },
+	{ "pppoe_username",			gen_value_empty,		0 },
+	{ "pppoe_passwd",			gen_value_empty,		0 },
+};
+
+static const struct gen_family gen_families_indexed[] = {
+	{ "wl0_%d_maclist",			gen_value_mac,			6 },
+	{ "wl1_%d_maclist",			gen_value_mac,			4 },
+	{ "fw_rule%d",				gen_value_rule,			8 },
+	{ "forwarding%d",			gen_value_rule,			5 },
+	{ "blk_site%d",				gen_value_host,			6 },
+	{ "dhcp_resrv%d",			gen_value_reservation,	5 },
+	{ "static_route%d",			gen_value_ip,			3 },
+	{ "qos_list%d",				gen_value_word,			4 },
+	{ "qos_rate%d",				gen_value_int,			4 },
+	{ "wps_device%d",			gen_value_secret,		2 },
+	{ "log_enable%d",			gen_value_bool,			3 },
+	{ "usb_share%d",			gen_value_empty,		1 },
+};
+
+static const char * const gen_words[] = {
+	"admin", "dhcp", "pppoe", "static", "NETGEAR", "Office", "Home", "GMT+1", "GMT-5", "auto", "ap", "wds",
+	"printer", "camera", "laptop", "phone", "tv", "nas", "guest", "voip", "gaming", "streaming",
+};
+
+
+/* Funtions definitions */
+int main (int argc, char **argv)
+{
+	static unsigned char buffer_text[GEN_TEXT_MAX];
+	static unsigned char buffer_output[GEN_OUTPUT_MAX];
+	struct main_opts main_opt;
+	struct ntgrbak_ctx *ctx;
+	const char **models;
+	char *model;
+	int i, models_count, ret;
+
+
+	/* Initial setup */
+	memset (&main_opt, 0, sizeof (struct main_opts));
+	main_opt.count = GEN_COUNT;
+	main_opt.seed = GEN_SEED;
+	main_opt.fill_min = GEN_FILL_MIN;
+	main_opt.fill_max = GEN_FILL_MAX;
+	main_opt.models = strdup (GEN_MODELS);
+
+	/* Parse the arguments */
+	for (i = 1; i < argc; i++)
+	{
+		if (argv[i][0] == '-')
+		{
+			switch (argv[i][1])
+			{
+			case 'v':
+				main_opt.main_set_verbose = 1;
+				break;
+			case 'n':
+				main_opt.count = atoi (argv[++i]);
+				break;
+			case 's':
+				main_opt.seed = strtoull (argv[++i], NULL, 0);
+				break;
+			case 'l':
+				if (sscanf (argv[++i], "%d-%d", &main_opt.fill_min, &main_opt.fill_max) == 1)
+					main_opt.fill_max = main_opt.fill_min;
+				break;
+			case 'm':
+				free (main_opt.models);
+				main_opt.models = strdup (argv[++i]);
+				break;
+			case 'o':
+				main_opt.output_dir = argv[++i];
+				break;
+			default:
+				console_output ("Error: Unknown option \"%s\".\n" USAGE, argv[i]);
+				return 1;
+			}
+		}
+		else
+		{
+			console_output ("Error: Unknown option \"%s\".\n" USAGE, argv[i]);
+			return 1;
+		}
+	}
+	if (!main_opt.output_dir)
+	{
+		console_output ("Error: Specify the output directory!\n" USAGE);
+		return 1;
+	}
+	if (main_opt.fill_min < 0 || main_opt.fill_max > 100 || main_opt.fill_min > main_opt.fill_max)
+	{
+		console_output ("Error: The fill level range must be within 0-100!\n" USAGE);
+		return 1;
+	}
+	if (mkdir (main_opt.output_dir, 0755) && access (main_opt.output_dir, W_OK))
+	{
+		console_output ("Error creating the output directory: %s\n", main_opt.output_dir);
+		return 1;
+	}
+
+	/* Split the models list */
+	if (!main_opt.models)
+		return 1;
+	models = malloc (sizeof (char *) * (strlen (main_opt.models) + 1));
+	if (!models)
+		return 1;
+	models_count = 0;
+	for (model = strtok (main_opt.models, ","); model; model = strtok (NULL, ","))
+		models[models_count++] = model;
+	if (!models_count)
+	{
+		console_output ("Error: Specify the models!\n" USAGE);
+		return 1;
+	}
+
+	/* The wrap keys are the same for all the configurations */
+	ctx = ntgrbak_ctx_new (GEN_OUTPUT_MAX, 1, NULL);
+	if (!ctx)
+	{
+		console_output ("Error allocating the codec context\n");
+		return 1;
+	}
+
+	ret = 0;
+	for (i = 0; i < main_opt.count && !ret; i++)
+		ret = gen_config (&main_opt, ctx, models, models_count, i, buffer_text, buffer_output);
+
+	if (!ret)
+		console_output ("Generated %d configurations in %s\n", main_opt.count, main_opt.output_dir);
+
+	ntgrbak_ctx_free (ctx);
+	free (models);
+	free (main_opt.models);
+	return ret;
+}
+
+void console_output(char *format, ...)
+{
+	va_list args;
+
+	va_start(args, format);
+	vfprintf(stderr, format, args);
+	va_end(args);
+}
+
+
+/* Draws the next random number (splitmix64)
+ * state:		The generator state
+ * RETURN:		The random number
+ */
+static uint64_t gen_random (uint64_t *state)
+{
+	uint64_t z;
+
+	z = (*state += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+static unsigned int gen_range (uint64_t *state, unsigned int min, unsigned int max)
+{
+	return min + (unsigned int) (gen_random (state) % (max - min + 1));
+}
+
+
+/* Writes a random string
+ * state:		The generator state
+ * out:			The output
+ * len:			The string length
+ * RETURN:		The string length
+ */
+static int gen_string (uint64_t *state, char *out, int len)
+{
+	static const char charset[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+	int i;
+
+	for (i = 0; i < len; i++)
+		out[i] = charset[gen_random (state) % (sizeof (charset) - 1)];
+	return len;
+}
+
+
+/* Writes a random value of a kind
+ * state:		The generator state
+ * value:		The value kind
+ * out:			The output (at least GEN_RECORD_MAX bytes)
+ * RETURN:		The value length
+ */
+static int gen_value_write (uint64_t *state, gen_value value, char *out)
+{
+	const char *word = gen_words[gen_random (state) % (sizeof (gen_words) / sizeof (gen_words[0]))];
+	int len;
+
+	switch (value)
+	{
+	case gen_value_ip:
+		return sprintf (out, "192.168.%u.%u", gen_range (state, 0, 10), gen_range (state, 1, 254));
+	case gen_value_mac:
+		return sprintf (out, "%02X:%02X:%02X:%02X:%02X:%02X", gen_range (state, 0, 255) & 0xFC, gen_range (state, 0, 255),
+				gen_range (state, 0, 255), gen_range (state, 0, 255), gen_range (state, 0, 255), gen_range (state, 0, 255));
+	case gen_value_int:
+		/* Mostly small numbers */
+		return sprintf (out, "%u", gen_range (state, 0, 3) ? gen_range (state, 0, 165) : gen_range (state, 0, 86400));
+	case gen_value_bool:
+		return sprintf (out, "%u", gen_range (state, 0, 1));
+	case gen_value_word:
+		return sprintf (out, "%s", word);
+	case gen_value_secret:
+		return gen_string (state, out, gen_range (state, 8, 63));
+	case gen_value_host:
+		len = gen_string (state, out, gen_range (state, 3, 20));
+		return len + sprintf (out + len, ".%s", gen_range (state, 0, 2) ? "com" : "net");
+	case gen_value_rule:
+		return sprintf (out, "%s %s 192.168.1.%u %u-%u %s", gen_range (state, 0, 3) ? "ACCEPT" : "DROP", gen_range (state, 0, 1) ? "tcp" : "udp",
+				gen_range (state, 2, 254), gen_range (state, 1, 1024), gen_range (state, 1024, 65535), word);
+	case gen_value_reservation:
+		len = gen_value_write (state, gen_value_mac, out);
+		out[len++] = ' ';
+		len += gen_value_write (state, gen_value_ip, out + len);
+		return len + sprintf (out + len, " %s", word);
+	case gen_value_empty:
+	default:
+		return 0;
+	}
+}
+
+
+/* Generates the text of a configuration
+ * state:		The generator state
+ * target:		The text length to reach (at most GEN_TEXT_MAX)
+ * out:			The text (at least GEN_TEXT_MAX bytes)
+ * RETURN:		The text length
+ */
+int gen_text (uint64_t *state, int target, unsigned char *out)
+{
+	const struct gen_family *family;
+	char record[GEN_RECORD_MAX];
+	int index[sizeof (gen_families_indexed) / sizeof (gen_families_indexed[0])];
+	int i, len, text_len, weights, pick;
+
+	text_len = 0;
+	memset (index, 0, sizeof (index));
+	weights = 0;
+	for (i = 0; i < sizeof (gen_families_indexed) / sizeof (gen_families_indexed[0]); i++)
+		weights += gen_families_indexed[i].weight;
+
+	for (i = 0; ; i++)
+	{
+		/* The base records first, then the indexed ones at random */
+		if (i < sizeof (gen_families_base) / sizeof (gen_families_base[0]))
+		{
+			family = &gen_families_base[i];
+			len = sprintf (record, "%s=", family->key);
+		}
+		else
+		{
+			pick = gen_random (state) % weights;
+			for (family = gen_families_indexed; pick >= family->weight; pick -= family->weight, family++);
+			len = sprintf (record, family->key, index[family - gen_families_indexed]++);
+			record[len++] = '=';
+		}
+		len += gen_value_write (state, family->value, record + len);
+		record[len++] = '\n';
+
+		if (text_len + len > target)
+			break;
+		memcpy (out + text_len, record, len);
+		text_len += len;
+	}
+
+	return text_len;
+}
+
+
+/* Generates and writes a configuration, its randomness depends on the seed and its number only
+ * opt:			The generator options
+ * ctx:			The library context, holding the keys of GEN_OUTPUT_MAX bytes
+ * models:		The router models
+ * models_count:	The number of router models
+ * number:		The configuration number
+ * text:		The text buffer (GEN_TEXT_MAX bytes)
+ * buffer:		The output buffer, when the file cannot be mapped (GEN_OUTPUT_MAX bytes)
+ * RETURN:		0: Success, 1: Failure
+ */
+int gen_config (const struct main_opts *opt, const struct ntgrbak_ctx *ctx, const char **models, int models_count, int number, unsigned char *text, unsigned char *buffer)
+{
+	struct ntgrbak_opts lib_opt;
+	struct io_file output;
+	char file_name[4096];
+	const char *model;
+	uint64_t state;
+	unsigned int version;
+	size_t len;
+	int text_len, fill, ret;
+
+	state = opt->seed ^ ((uint64_t) number * 0xD1B54A32D192ED03ULL);
+	gen_random (&state);
+	model = models[gen_random (&state) % models_count];
+	version = gen_range (&state, 1, 3);
+	fill = gen_range (&state, opt->fill_min * 100, opt->fill_max * 100);
+	text_len = gen_text (&state, (int) ((uint64_t) GEN_TEXT_MAX * fill / 10000), text);
+
+	snprintf (file_name, sizeof (file_name), "%s/%06d.cfg", opt->output_dir, number);
+	if (io_output_open (&output, file_name, buffer, GEN_OUTPUT_MAX, 0))
+	{
+		console_output ("Error writing to file: %s\n", file_name);
+		return 1;
+	}
+
+	/* The same path as NtgrBak C */
+	memset (&lib_opt, 0, sizeof (struct ntgrbak_opts));
+	ret = ntgrbak_text_to_config (ctx, &lib_opt, text, text_len, ntgrbak_model_magic (model), version, output.data, GEN_OUTPUT_MAX, &len);
+	if (ret)
+	{
+		io_output_discard (&output);
+		console_output ("Error generating %s: %s\n", file_name, ntgrbak_strerror (ret));
+		return 1;
+	}
+	if (io_output_close (&output, len))
+	{
+		console_output ("Error writing to file: %s\n", file_name);
+		return 1;
+	}
+
+	if (opt->main_set_verbose)
+		console_output ("%s: model=%s version=%u fill=%d.%02d%% text=%d bytes\n", file_name, model, version, fill / 100, fill % 100, text_len);
+
+	return 0;
+}
@@ -0,0 +1,346 @@
+/*
+ ============================================================================
+ Name        : NtgrLoad.c
+ Author      : Marco Giorgi (multigiorgiplex)
+ Version     :
+ Copyright   : See Apache License 2.0
+ Description : Load test of a NtgrBak server, against running NtgrBak once per request
+ ============================================================================
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+#include <spawn.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/wait.h>
+#include "libntgrbak.h"
+#include "fileio.h"
+#include "metrics.h"
+#include "serve.h"
+
+/* Defines */
+#define BUFFER_SIZE		(0x20000)
+#define LOAD_CONNECTIONS	4
+#define LOAD_SECONDS		5
+
+#define USAGE	\
+"Usage:\n\
+		./NtgrLoad <mode> [options] -U socket -i input_file\n\
+		./NtgrLoad <mode> [options] -x ./NtgrBak -i input_file\n\
+Modes:\n\
+		D, X, W, I, T, C as NtgrBak, the same input is sent by every request\n\
+Options:\n\
+		-U[nix]:	The socket of the NtgrBak server, the requests share a connection per client\n\
+		-x:		Runs this NtgrBak once per request instead (the fork per file baseline)\n\
+		-i[nput]:	The input file\n\
+		-c[lients]:	Number of concurrent clients. (default: 4)\n\
+		-d[uration]:	Seconds to run. (default: 5)\n\
+		-m[odel]:	The router model of the wrap modes. (eg. \"WNDR4500v2\")\n\
+		-V[ersion]:	The configuration version of the wrap modes. (eg. \"1\")\n\
+		-p[arsable]:	Prints a single machine-readable \"key=value\" line\n"
+
+/* Typdefs */
+struct main_opts {
+	char mode[2];
+	char * socket_name;
+	char * exec_name;
+	char * input_file_name;
+	char * model;
+	char * version;
+	int clients;
+	int seconds;
+	union {
+		unsigned int main_sets;
+		struct {
+			unsigned int main_set_parsable	:1;
+			unsigned int 					:31;
+		};
+	};
+};
+
+/* Per-client state and results */
+struct load_client {
+	const struct main_opts * opt;
+	const unsigned char * input;
+	size_t input_len;
+	uint64_t deadline;
+	uint64_t requests;
+	uint64_t errors;
+	struct metrics_histogram latency;
+	pthread_t thread;
+};
+
+
+/* Fuctions signs */
+// Clients
+void *			load_socket_client			(void*);
+void *			load_exec_client			(void*);
+
+// Misc
+uint64_t		load_now					(void);
+void			console_output				(char*, ...);
+
+extern char **environ;
+
+
+/* Funtions definitions */
+int main (int argc, char **argv)
+{
+	unsigned char buffer_input[BUFFER_SIZE];
+	struct main_opts main_opt;
+	struct load_client *client;
+	struct metrics_histogram *latency;
+	struct io_file input;
+	uint64_t requests, errors, start, elapsed;
+	double seconds;
+	int i, started;
+
+
+	/* Initial setup */
+	memset (&main_opt, 0, sizeof (struct main_opts));
+	main_opt.clients = LOAD_CONNECTIONS;
+	main_opt.seconds = LOAD_SECONDS;
+
+	/* Parse the arguments */
+	if (argc < 2 || !strchr ("DXWITC", argv[1][0]) || argv[1][1])
+	{
+		console_output ("Error: Select a mode!\n" USAGE);
+		return 1;
+	}
+	main_opt.mode[0] = argv[1][0];
+	for (i = 2; i < argc; i++)
+	{
+		if (argv[i][0] != '-')
+		{
+			console_output ("Error: Unknown option \"%s\".\n" USAGE, argv[i]);
+			return 1;
+		}
+		switch (argv[i][1])
+		{
+		case 'U':
+			main_opt.socket_name = argv[++i];
+			break;
+		case 'x':
+			main_opt.exec_name = argv[++i];
+			break;
+		case 'i':
+			main_opt.input_file_name = argv[++i];
+			break;
+		case 'c':
+			main_opt.clients = atoi (argv[++i]);
+			break;
+		case 'd':
+			main_opt.seconds = atoi (argv[++i]);
+			break;
+		case 'm':
+			main_opt.model = argv[++i];
+			break;
+		case 'V':
+			main_opt.version = argv[++i];
+			break;
+		case 'p':
+			main_opt.main_set_parsable = 1;
+			break;
+		default:
+			console_output ("Error: Unknown option \"%s\".\n" USAGE, argv[i]);
+			return 1;
+		}
+	}
+	if (!main_opt.socket_name == !main_opt.exec_name || !main_opt.input_file_name)
+	{
+		console_output ("Error: Specify the input and either the socket or the executable!\n" USAGE);
+		return 1;
+	}
+	if ((main_opt.mode[0] == 'W' || main_opt.mode[0] == 'C') && (!main_opt.model || !main_opt.version))
+	{
+		console_output ("Error, provide wrap settings!\n" USAGE);
+		return 1;
+	}
+	if (main_opt.clients < 1)
+		main_opt.clients = 1;
+	if (main_opt.clients > SERVE_CONNECTIONS_MAX)
+		main_opt.clients = SERVE_CONNECTIONS_MAX;
+	if (main_opt.seconds < 1)
+		main_opt.seconds = 1;
+
+	if (io_input_open (&input, main_opt.input_file_name, buffer_input, BUFFER_SIZE))
+	{
+		console_output ("Error reading file: %s\n", main_opt.input_file_name);
+		return 1;
+	}
+	client = calloc (main_opt.clients, sizeof (struct load_client));
+	latency = calloc (1, sizeof (struct metrics_histogram));
+	if (!client || !latency)
+	{
+		free (client);
+		free (latency);
+		io_input_close (&input);
+		return 1;
+	}
+
+	/* Every client keeps its own latency histogram, merged at the end */
+	start = load_now ();
+	for (started = 0; started < main_opt.clients; started++)
+	{
+		client[started].opt = &main_opt;
+		client[started].input = input.data;
+		client[started].input_len = input.len;
+		client[started].deadline = start + (uint64_t) main_opt.seconds * 1000000000;
+		if (pthread_create (&client[started].thread, NULL, main_opt.socket_name ? load_socket_client : load_exec_client, &client[started]))
+			break;
+	}
+	requests = 0;
+	errors = 0;
+	for (i = 0; i < started; i++)
+	{
+		pthread_join (client[i].thread, NULL);
+		requests += client[i].requests;
+		errors += client[i].errors;
+		metrics_histogram_merge (latency, &client[i].latency);
+	}
+	elapsed = load_now () - start;
+	seconds = elapsed / 1e9;
+
+	/* MB/s are 10^6 input bytes per second, the latencies in us */
+	if (main_opt.main_set_parsable)
+		printf ("mode=%s transport=%s clients=%d requests=%llu errors=%llu seconds=%.3f requests_s=%.1f mb_s=%.1f p50_us=%.1f p90_us=%.1f p99_us=%.1f p999_us=%.1f\n",
+				main_opt.mode, main_opt.socket_name ? "socket" : "exec", started, (unsigned long long) requests, (unsigned long long) errors,
+				seconds, requests / seconds, requests * input.len / seconds / 1e6,
+				metrics_histogram_quantile (latency, 0.5) / 1e3, metrics_histogram_quantile (latency, 0.9) / 1e3,
+				metrics_histogram_quantile (latency, 0.99) / 1e3, metrics_histogram_quantile (latency, 0.999) / 1e3);
+	else
+	{
+		printf ("%s %s, %d clients: %llu requests (%llu failed) in %.3f s\n",
+				main_opt.mode, main_opt.socket_name ? "over the socket" : "running NtgrBak", started,
+				(unsigned long long) requests, (unsigned long long) errors, seconds);
+		printf ("%.1f requests/s, %.1f MB/s\n", requests / seconds, requests * input.len / seconds / 1e6);
+		printf ("Latency: p50 %.1f us, p90 %.1f us, p99 %.1f us, p99.9 %.1f us\n",
+				metrics_histogram_quantile (latency, 0.5) / 1e3, metrics_histogram_quantile (latency, 0.9) / 1e3,
+				metrics_histogram_quantile (latency, 0.99) / 1e3, metrics_histogram_quantile (latency, 0.999) / 1e3);
+	}
+
+	free (client);
+	free (latency);
+	io_input_close (&input);
+	return started && !errors ? 0 : 1;
+}
+
+void console_output(char *format, ...)
+{
+	va_list args;
+
+	va_start(args, format);
+	vfprintf(stderr, format, args);
+	va_end(args);
+}
+
+
+/* Monotonic clock in ns */
+uint64_t load_now (void)
+{
+	struct timespec ts;
+
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+
+/* Client thread: sends requests on its connection until the deadline */
+void * load_socket_client (void *arg)
+{
+	struct load_client *client = arg;
+	const struct main_opts *opt = client->opt;
+	struct serve_request request;
+	unsigned char *output;
+	uint64_t start, end;
+	size_t len;
+	int fd, ret;
+
+	request.mode = opt->mode[0];
+	request.flags = 0;
+	request.magic = opt->model ? ntgrbak_model_magic (opt->model) : 0;
+	request.version = opt->version ? (uint32_t) atoi (opt->version) : 0;
+	request.length = client->input_len;
+
+	output = malloc (BUFFER_SIZE);
+	fd = serve_connect (opt->socket_name);
+	if (!output || fd < 0)
+	{
+		console_output ("Error connecting to the server: %s\n", opt->socket_name);
+		client->errors++;
+		free (output);
+		return NULL;
+	}
+
+	for (start = load_now (); start < client->deadline; start = end)
+	{
+		ret = serve_call (fd, &request, client->input, output, BUFFER_SIZE, &len);
+		end = load_now ();
+		client->requests++;
+		metrics_histogram_record (&client->latency, end - start);
+		if (ret)
+		{
+			client->errors++;
+			if (ret < 0)
+				break;
+		}
+	}
+
+	close (fd);
+	free (output);
+	return NULL;
+}
+
+
+/* Client thread: runs NtgrBak on the input until the deadline */
+void * load_exec_client (void *arg)
+{
+	struct load_client *client = arg;
+	const struct main_opts *opt = client->opt;
+	char *args[12];
+	uint64_t start, end;
+	pid_t pid;
+	int n, status;
+
+	n = 0;
+	args[n++] = opt->exec_name;
+	args[n++] = (char *) opt->mode;
+	args[n++] = "-i";
+	args[n++] = opt->input_file_name;
+	args[n++] = "-o";
+	args[n++] = "/dev/null";
+	if (opt->model)
+	{
+		args[n++] = "-m";
+		args[n++] = opt->model;
+	}
+	if (opt->version)
+	{
+		args[n++] = "-V";
+		args[n++] = opt->version;
+	}
+	args[n] = NULL;
+
+	for (start = load_now (); start < client->deadline; start = end)
+	{
+		if (posix_spawn (&pid, opt->exec_name, NULL, NULL, args, environ))
+		{
+			console_output ("Error running: %s\n", opt->exec_name);
+			client->errors++;
+			break;
+		}
+		status = -1;
+		waitpid (pid, &status, 0);
+		end = load_now ();
+		client->requests++;
+		metrics_histogram_record (&client->latency, end - start);
+		if (!WIFEXITED (status) || WEXITSTATUS (status))
+			client->errors++;
+	}
+
+	return NULL;
+}
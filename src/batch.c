@@ -0,0 +1,286 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <glob.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include "batch.h"
+
+
+struct batch_pool {
+	const struct batch_list *list;
+	const char *output_dir;
+	batch_routine routine;
+	void *arg;
+	size_t scratch_size;
+	int next;
+	int *ret;
+};
+
+
+static int batch_list_add (struct batch_list *list, const char *name)
+{
+	char **name_new;
+
+	if (!(list->count % 1024))
+	{
+		name_new = realloc (list->name, sizeof (char *) * (list->count + 1024));
+		if (!name_new)
+			return 1;
+		list->name = name_new;
+	}
+
+	list->name[list->count] = strdup (name);
+	if (!list->name[list->count])
+		return 1;
+	list->count++;
+
+	return 0;
+}
+
+
+static int batch_list_compare (const void *a, const void *b)
+{
+	return strcmp (*(char * const *) a, *(char * const *) b);
+}
+
+
+/* Builds the list of files to process
+ * list:		The output list
+ * source:		A directory (its regular files), "@file" (one path per line, "@-" for stdin) or a glob pattern
+ * RETURN:		0: Success, 1: Failure
+ */
+int batch_list_load (struct batch_list *list, const char *source)
+{
+	char path[4096];
+	struct dirent *entry;
+	struct stat st;
+	glob_t glob_list;
+	FILE *list_file;
+	DIR *dir;
+	size_t len;
+	int i, ret;
+
+	memset (list, 0, sizeof (struct batch_list));
+	ret = 0;
+
+	if (source[0] == '@')
+	{
+		/* List file */
+		list_file = strcmp (source + 1, "-") ? fopen (source + 1, "r") : stdin;
+		if (!list_file)
+		{
+			console_output ("Error opening list file: %s\n", source + 1);
+			return 1;
+		}
+		while (!ret && fgets (path, sizeof (path), list_file))
+		{
+			len = strcspn (path, "\r\n");
+			path[len] = '\0';
+			if (len)
+				ret = batch_list_add (list, path);
+		}
+		if (list_file != stdin)
+			fclose (list_file);
+	}
+	else if (!stat (source, &st) && S_ISDIR (st.st_mode))
+	{
+		/* Directory */
+		dir = opendir (source);
+		if (!dir)
+		{
+			console_output ("Error opening directory: %s\n", source);
+			return 1;
+		}
+		while (!ret && (entry = readdir (dir)))
+		{
+			if (entry->d_name[0] == '.')
+				continue;
+			snprintf (path, sizeof (path), "%s/%s", source, entry->d_name);
+			if (!stat (path, &st) && S_ISREG (st.st_mode))
+				ret = batch_list_add (list, path);
+		}
+		closedir (dir);
+		if (list->count)
+			qsort (list->name, list->count, sizeof (char *), batch_list_compare);
+	}
+	else
+	{
+		/* Glob pattern */
+		if (glob (source, 0, NULL, &glob_list))
+		{
+			console_output ("No file matches: %s\n", source);
+			return 1;
+		}
+		for (i = 0; !ret && i < glob_list.gl_pathc; i++)
+			ret = batch_list_add (list, glob_list.gl_pathv[i]);
+		globfree (&glob_list);
+	}
+
+	if (ret)
+	{
+		console_output ("Error building the file list\n");
+		batch_list_free (list);
+		return 1;
+	}
+
+	return 0;
+}
+
+
+/* Releases a file list
+ * list:		The list
+ */
+void batch_list_free (struct batch_list *list)
+{
+	int i;
+
+	for (i = 0; i < list->count; i++)
+		free (list->name[i]);
+	free (list->name);
+	memset (list, 0, sizeof (struct batch_list));
+}
+
+
+static const char * batch_list_base (const char *name)
+{
+	const char *base;
+
+	base = strrchr (name, '/');
+	return base ? base + 1 : name;
+}
+
+
+static int batch_list_compare_base (const void *a, const void *b)
+{
+	return strcmp (batch_list_base (*(char * const *) a), batch_list_base (*(char * const *) b));
+}
+
+
+/* Checks that no two files of a list share a file name, their outputs would overwrite each other
+ * list:		The list
+ * RETURN:		0: Names are unique, 1: Duplicate found or failure
+ */
+static int batch_list_unique (const struct batch_list *list)
+{
+	char **name;
+	int i, ret;
+
+	if (list->count < 2)
+		return 0;
+
+	name = malloc (sizeof (char *) * list->count);
+	if (!name)
+		return 1;
+	memcpy (name, list->name, sizeof (char *) * list->count);
+	qsort (name, list->count, sizeof (char *), batch_list_compare_base);
+
+	ret = 0;
+	for (i = 1; !ret && i < list->count; i++)
+	{
+		if (!strcmp (batch_list_base (name[i - 1]), batch_list_base (name[i])))
+		{
+			console_output ("Output name collision: %s and %s\n", name[i - 1], name[i]);
+			ret = 1;
+		}
+	}
+
+	free (name);
+	return ret;
+}
+
+
+static void * batch_worker (void *arg)
+{
+	struct batch_pool *pool = arg;
+	char output_file_name[4096];
+	unsigned char *scratch;
+	int i;
+
+	scratch = malloc (pool->scratch_size);
+	if (!scratch)
+		return NULL;
+
+	while ((i = __atomic_fetch_add (&pool->next, 1, __ATOMIC_RELAXED)) < pool->list->count)
+	{
+		if (pool->output_dir)
+			snprintf (output_file_name, sizeof (output_file_name), "%s/%s", pool->output_dir, batch_list_base (pool->list->name[i]));
+
+		pool->ret[i] = pool->routine (pool->arg, pool->list->name[i], pool->output_dir ? output_file_name : NULL, scratch);
+	}
+
+	free (scratch);
+	return NULL;
+}
+
+
+/* Runs a routine on every file of a list using a pool of threads
+ * list:			The files to process
+ * output_dir:		The output directory (created if missing), each output keeps its input file name, which must be unique. NULL for stdout
+ * threads:			The number of worker threads
+ * routine:			The per-file routine
+ * arg:				The routine argument, shared between the workers
+ * scratch_size:	The size of the buffer each worker gives to the routine
+ * RETURN:			The number of failed files, -1 if the batch could not start
+ */
+int batch_run (const struct batch_list *list, const char *output_dir, int threads, batch_routine routine, void *arg, size_t scratch_size)
+{
+	pthread_t thread[BATCH_THREADS_MAX];
+	struct batch_pool pool;
+	int i, started, failed;
+
+	if (output_dir && batch_list_unique (list))
+		return -1;
+
+	if (output_dir && mkdir (output_dir, 0755) && errno != EEXIST)
+	{
+		console_output ("Error creating the output directory: %s\n", output_dir);
+		return -1;
+	}
+
+	pool.list = list;
+	pool.output_dir = output_dir;
+	pool.routine = routine;
+	pool.arg = arg;
+	pool.scratch_size = scratch_size;
+	pool.next = 0;
+	pool.ret = malloc (sizeof (int) * (list->count ? list->count : 1));
+	if (!pool.ret)
+		return -1;
+	for (i = 0; i < list->count; i++)
+		pool.ret[i] = -1;	//Not processed
+
+	if (threads < 1)
+		threads = 1;
+	if (threads > BATCH_THREADS_MAX)
+		threads = BATCH_THREADS_MAX;
+	if (threads > list->count)
+		threads = list->count;
+
+	for (started = 0; started < threads; started++)
+	{
+		if (pthread_create (&thread[started], NULL, batch_worker, &pool))
+			break;
+	}
+	if (!started)
+		batch_worker (&pool);
+	for (i = 0; i < started; i++)
+		pthread_join (thread[i], NULL);
+
+	/* Report */
+	failed = 0;
+	for (i = 0; i < list->count; i++)
+	{
+		if (pool.ret[i])
+		{
+			console_output ("Failed: %s\n", list->name[i]);
+			failed++;
+		}
+	}
+	console_output ("Batch done: %d files, %d failed\n", list->count, failed);
+
+	free (pool.ret);
+	return failed;
+}
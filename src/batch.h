@@ -0,0 +1,25 @@
+#ifndef SRC_BATCH_H_
+#define SRC_BATCH_H_
+
+#include <stddef.h>
+
+#define BATCH_THREADS_MAX	256
+
+/* Per-file routine: (argument, input file name, output file name or NULL for stdout, worker scratch buffer)
+ * RETURN:		0: Success, otherwise failure
+ */
+typedef int (*batch_routine) (void*, const char*, const char*, unsigned char*);
+
+struct batch_list {
+	char ** name;
+	int count;
+};
+
+int				batch_list_load		(struct batch_list*, const char*);
+void			batch_list_free		(struct batch_list*);
+int				batch_run			(const struct batch_list*, const char*, int, batch_routine, void*, size_t);
+
+/* Provided by each tool */
+void			console_output		(char*, ...);
+
+#endif /* SRC_BATCH_H_ */
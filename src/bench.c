@@ -0,0 +1,482 @@
+/*
+ ============================================================================
+ Name        : bench.c
+ Author      : Marco Giorgi (multigiorgiplex)
+ Version     :
+ Copyright   : See Apache License 2.0
+ Description : Micro-benchmarks of the NtgrBak and NVEx hot kernels
+ ============================================================================
+ */
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+#include <sched.h>
+#include "config.h"
+#include "crypt.h"
+#include "nvram.h"
+#include "text.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define bench_cycles()		__rdtsc ()
+#define BENCH_CYCLES		1
+#else
+#define bench_cycles()		0
+#define BENCH_CYCLES		0
+#endif
+
+/* Defines */
+#define BENCH_CONFIG_SIZE	(0x20000)				//A 128 KB configuration
+#define BENCH_IMAGE_SIZE	NVRAM_IMAGE_SIZE_DEFAULT	//A 64 KB NVRAM image
+#define BENCH_SAMPLE_NS		2000000					//Shortest sample, the kernel is repeated within it
+#define BENCH_REPS			21
+#define BENCH_WARMUP		3
+
+#define USAGE	\
+"Usage:\n\
+		./NtgrBench [kernels] [options]\n\
+Kernels (all by default):\n\
+		des_key		generate_des_key() of the 128 KB configuration blocks\n\
+		codec_setup	codec_ctx_new() for a 128 KB configuration\n\
+		decrypt		run_codec() decrypting a 128 KB configuration\n\
+		encrypt		run_codec() encrypting a 128 KB configuration\n\
+		keyed		run_codec_keyed_blocks() decrypting a 128 KB configuration, deriving the keys\n\
+		checksum	calculate_checksum() of a 128 KB configuration\n\
+		crc8		calculate_crc() of a 64 KB NVRAM image\n\
+		text_extract	text_extract() of a 64 KB NVRAM image (NVEx X)\n\
+		text_records	text_extract() of a 64 KB NVRAM image without the checks, the records copy alone (NVEx X -f)\n\
+		text_wrap	text_wrap() of a 64 KB text (NVEx W)\n\
+Options:\n\
+		-r[eps]:	Number of timed samples. (default: 21)\n\
+		-w[armup]:	Number of untimed samples before them. (default: 3)\n\
+		-c[pu]:		Pin to the CPU, -1 not to pin. (default: the CPU it starts on)\n\
+		-p[arsable]:	Prints a machine-readable \"key=value\" line per kernel\n"
+
+/* Typdefs */
+struct bench_data {
+	unsigned char * config;			//BENCH_CONFIG_SIZE bytes of plain configuration
+	unsigned char * config_enc;		//The same, encrypted
+	unsigned char * image;			//A NVRAM image of realistic records
+	unsigned char * text;			//Its text
+	int text_len;
+	unsigned char * out;			//Output of the kernels
+	struct codec_ctx * codec;
+};
+
+struct bench_kernel {
+	const char * name;
+	int size;						//Bytes processed by a run
+	int (*run) (struct bench_data*);
+};
+
+struct main_opts {
+	char ** kernels;				//The kernels to run, all if none
+	int kernels_count;
+	int reps;
+	int warmup;
+	int cpu;
+	union {
+		unsigned int main_sets;
+		struct {
+			unsigned int main_set_parsable	:1;
+			unsigned int 					:31;
+		};
+	};
+};
+
+struct bench_result {
+	double ns_per_byte;				//Median of the samples
+	double ns_per_byte_min;
+	double cycles_per_block;		//Median, in timestamp counter cycles
+	int runs;						//Kernel runs per sample
+};
+
+/* Fuctions signs */
+// Kernels
+int				bench_des_key				(struct bench_data*);
+int				bench_codec_setup			(struct bench_data*);
+int				bench_decrypt				(struct bench_data*);
+int				bench_encrypt				(struct bench_data*);
+int				bench_keyed					(struct bench_data*);
+int				bench_checksum				(struct bench_data*);
+int				bench_crc8					(struct bench_data*);
+int				bench_text_extract			(struct bench_data*);
+int				bench_text_records			(struct bench_data*);
+int				bench_text_wrap				(struct bench_data*);
+
+// Measure
+int				bench_data_init				(struct bench_data*);
+void			bench_data_free				(struct bench_data*);
+int				bench_run					(const struct main_opts*, const struct bench_kernel*, struct bench_data*, struct bench_result*);
+
+// Misc
+void			console_output				(char*, ...);
+
+static const struct bench_kernel bench_kernels[] = {
+	{ "des_key",		BENCH_CONFIG_SIZE,	bench_des_key },
+	{ "codec_setup",	BENCH_CONFIG_SIZE,	bench_codec_setup },
+	{ "decrypt",		BENCH_CONFIG_SIZE,	bench_decrypt },
+	{ "encrypt",		BENCH_CONFIG_SIZE,	bench_encrypt },
+	{ "keyed",			BENCH_CONFIG_SIZE,	bench_keyed },
+	{ "checksum",		BENCH_CONFIG_SIZE,	bench_checksum },
+	{ "crc8",			BENCH_IMAGE_SIZE,	bench_crc8 },
+	{ "text_extract",	BENCH_IMAGE_SIZE,	bench_text_extract },
+	{ "text_records",	BENCH_IMAGE_SIZE,	bench_text_records },
+	{ "text_wrap",		BENCH_IMAGE_SIZE,	bench_text_wrap },
+};
+
+/* Keeps the results of the kernels alive */
+static volatile unsigned int bench_sink;
+
+
+/* Funtions definitions */
+int main (int argc, char **argv)
+{
+	struct main_opts main_opt;
+	struct bench_data data;
+	struct bench_result result;
+	cpu_set_t cpus;
+	int i, k, ret;
+
+
+	/* Initial setup */
+	memset (&main_opt, 0, sizeof (struct main_opts));
+	main_opt.reps = BENCH_REPS;
+	main_opt.warmup = BENCH_WARMUP;
+	main_opt.cpu = sched_getcpu ();
+
+	/* Parse the arguments */
+	main_opt.kernels = malloc (sizeof (char *) * argc);
+	if (!main_opt.kernels)
+		return 1;
+	for (i = 1; i < argc; i++)
+	{
+		if (argv[i][0] == '-')
+		{
+			switch (argv[i][1])
+			{
+			case 'r':
+				main_opt.reps = atoi (argv[++i]);
+				break;
+			case 'w':
+				main_opt.warmup = atoi (argv[++i]);
+				break;
+			case 'c':
+				main_opt.cpu = atoi (argv[++i]);
+				break;
+			case 'p':
+				main_opt.main_set_parsable = 1;
+				break;
+			default:
+				console_output ("Error: Unknown option \"%s\".\n" USAGE, argv[i]);
+				return 1;
+			}
+		}
+		else
+		{
+			for (k = 0; k < sizeof (bench_kernels) / sizeof (bench_kernels[0]); k++)
+				if (!strcmp (argv[i], bench_kernels[k].name))
+					break;
+			if (k == sizeof (bench_kernels) / sizeof (bench_kernels[0]))
+			{
+				console_output ("Error: Unknown kernel \"%s\".\n" USAGE, argv[i]);
+				return 1;
+			}
+			main_opt.kernels[main_opt.kernels_count++] = argv[i];
+		}
+	}
+	if (main_opt.reps < 1)
+		main_opt.reps = 1;
+
+	/* Pinning keeps the caches warm and the samples on a single clock */
+	if (main_opt.cpu >= 0)
+	{
+		CPU_ZERO (&cpus);
+		CPU_SET (main_opt.cpu, &cpus);
+		if (sched_setaffinity (0, sizeof (cpus), &cpus))
+		{
+			console_output ("Error pinning to CPU %d\n", main_opt.cpu);
+			return 1;
+		}
+	}
+
+	if (bench_data_init (&data))
+	{
+		console_output ("Error preparing the benchmark data\n");
+		return 1;
+	}
+
+	if (!main_opt.main_set_parsable)
+		printf ("%-14s %8s %10s %10s %14s\n", "Kernel", "Bytes", "ns/byte", "MB/s", "cycles/block");
+
+	ret = 0;
+	for (k = 0; k < sizeof (bench_kernels) / sizeof (bench_kernels[0]); k++)
+	{
+		if (main_opt.kernels_count)
+		{
+			for (i = 0; i < main_opt.kernels_count; i++)
+				if (!strcmp (main_opt.kernels[i], bench_kernels[k].name))
+					break;
+			if (i == main_opt.kernels_count)
+				continue;
+		}
+
+		if (bench_run (&main_opt, &bench_kernels[k], &data, &result))
+		{
+			console_output ("Error running the %s kernel\n", bench_kernels[k].name);
+			ret = 1;
+			continue;
+		}
+
+		/* MB/s are 10^6 bytes per second */
+		if (main_opt.main_set_parsable)
+			printf ("kernel=%s bytes=%d reps=%d runs=%d cpu=%d ns_per_byte=%.4f ns_per_byte_min=%.4f mb_s=%.1f cycles_per_block=%.1f\n",
+					bench_kernels[k].name, bench_kernels[k].size, main_opt.reps, result.runs, main_opt.cpu,
+					result.ns_per_byte, result.ns_per_byte_min, 1000.0 / result.ns_per_byte, result.cycles_per_block);
+		else if (BENCH_CYCLES)
+			printf ("%-14s %8d %10.4f %10.1f %14.1f\n", bench_kernels[k].name, bench_kernels[k].size,
+					result.ns_per_byte, 1000.0 / result.ns_per_byte, result.cycles_per_block);
+		else
+			printf ("%-14s %8d %10.4f %10.1f %14s\n", bench_kernels[k].name, bench_kernels[k].size,
+					result.ns_per_byte, 1000.0 / result.ns_per_byte, "-");
+		fflush (stdout);
+	}
+
+	bench_data_free (&data);
+	free (main_opt.kernels);
+	return ret;
+}
+
+void console_output(char *format, ...)
+{
+	va_list args;
+
+	va_start(args, format);
+	vfprintf(stderr, format, args);
+	va_end(args);
+}
+
+
+/* Prepares the benchmark inputs: a random configuration and a NVRAM image of "key=value" records
+ * data:		The benchmark data
+ * RETURN:		0: Success, 1: Failure
+ */
+int bench_data_init (struct bench_data *data)
+{
+	unsigned int seed;
+	int i, len, out_len;
+
+	memset (data, 0, sizeof (struct bench_data));
+	data->config = malloc (BENCH_CONFIG_SIZE);
+	data->config_enc = malloc (BENCH_CONFIG_SIZE);
+	data->image = malloc (BENCH_IMAGE_SIZE);
+	data->text = malloc (BENCH_IMAGE_SIZE);
+	data->out = malloc (BENCH_CONFIG_SIZE);
+	data->codec = codec_ctx_new (BENCH_CONFIG_SIZE / CODEC_BLOCK_SIZE);
+	if (!data->config || !data->config_enc || !data->image || !data->text || !data->out || !data->codec)
+	{
+		bench_data_free (data);
+		return 1;
+	}
+
+	seed = 0x4E746772;
+	for (i = 0; i < BENCH_CONFIG_SIZE; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		data->config[i] = seed >> 16;
+	}
+	if (run_codec (data->codec, data->config, BENCH_CONFIG_SIZE, data->config_enc, &out_len, 1))
+	{
+		bench_data_free (data);
+		return 1;
+	}
+
+	/* Records like the ones of a router, filling most of the image */
+	data->text_len = 0;
+	for (i = 0; data->text_len < (BENCH_IMAGE_SIZE - NVRAM_INDEX_DATA) - 0x80; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		len = snprintf ((char *) data->text + data->text_len, (BENCH_IMAGE_SIZE - NVRAM_INDEX_DATA) - data->text_len, "wl%d_key_%04d=%.*s\n",
+				i % 3, i, (int) (seed >> 16) % 40, "0123456789abcdefghijklmnopqrstuvwxyz0123456789");
+		data->text_len += len;
+	}
+	if (text_wrap (NULL, data->text, data->text_len, data->image, BENCH_IMAGE_SIZE, &out_len))
+	{
+		bench_data_free (data);
+		return 1;
+	}
+
+	return 0;
+}
+
+void bench_data_free (struct bench_data *data)
+{
+	free (data->config);
+	free (data->config_enc);
+	free (data->image);
+	free (data->text);
+	free (data->out);
+	codec_ctx_free (data->codec);
+	memset (data, 0, sizeof (struct bench_data));
+}
+
+
+/* Compares two samples, for qsort() */
+static int bench_sample_compare (const void *a, const void *b)
+{
+	double x = *(const double *) a, y = *(const double *) b;
+
+	return (x > y) - (x < y);
+}
+
+
+static double bench_now (void)
+{
+	struct timespec ts;
+
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+
+/* Times a kernel: the runs of a sample are calibrated to last at least BENCH_SAMPLE_NS, the warm-up samples are discarded
+ * opt:			The benchmark options
+ * kernel:		The kernel
+ * data:		The benchmark data
+ * result:		The kernel timings
+ * RETURN:		0: Success, 1: Failure
+ */
+int bench_run (const struct main_opts *opt, const struct bench_kernel *kernel, struct bench_data *data, struct bench_result *result)
+{
+	double *ns, *cycles;
+	double start;
+	unsigned long long tsc;
+	int rep, run, runs;
+
+	/* Calibrate (it warms up as well) */
+	for (runs = 1; ; runs *= 2)
+	{
+		start = bench_now ();
+		for (run = 0; run < runs; run++)
+			if (kernel->run (data))
+				return 1;
+		if (bench_now () - start >= BENCH_SAMPLE_NS)
+			break;
+	}
+
+	ns = malloc (sizeof (double) * opt->reps);
+	cycles = malloc (sizeof (double) * opt->reps);
+	if (!ns || !cycles)
+	{
+		free (ns);
+		free (cycles);
+		return 1;
+	}
+
+	for (rep = -opt->warmup; rep < opt->reps; rep++)
+	{
+		start = bench_now ();
+		tsc = bench_cycles ();
+		for (run = 0; run < runs; run++)
+			kernel->run (data);
+		tsc = bench_cycles () - tsc;
+		if (rep < 0)
+			continue;
+
+		ns[rep] = (bench_now () - start) / runs / kernel->size;
+		cycles[rep] = (double) tsc / runs / (kernel->size / CODEC_BLOCK_SIZE);
+	}
+
+	qsort (ns, opt->reps, sizeof (double), bench_sample_compare);
+	qsort (cycles, opt->reps, sizeof (double), bench_sample_compare);
+	result->ns_per_byte = ns[opt->reps / 2];
+	result->ns_per_byte_min = ns[0];
+	result->cycles_per_block = cycles[opt->reps / 2];
+	result->runs = runs;
+
+	free (ns);
+	free (cycles);
+	return 0;
+}
+
+
+/* Kernels: a run processes the kernel size once */
+int bench_des_key (struct bench_data *data)
+{
+	int blk;
+
+	for (blk = 0; blk < BENCH_CONFIG_SIZE / CODEC_BLOCK_SIZE; blk++)
+		generate_des_key (data->out + blk * CODEC_BLOCK_SIZE, blk);
+	bench_sink += data->out[0];
+	return 0;
+}
+
+int bench_codec_setup (struct bench_data *data)
+{
+	struct codec_ctx *codec;
+
+	codec = codec_ctx_new (BENCH_CONFIG_SIZE / CODEC_BLOCK_SIZE);
+	if (!codec)
+		return 1;
+	codec_ctx_free (codec);
+	return 0;
+}
+
+int bench_decrypt (struct bench_data *data)
+{
+	int out_len;
+
+	return run_codec (data->codec, data->config_enc, BENCH_CONFIG_SIZE, data->out, &out_len, 0);
+}
+
+int bench_encrypt (struct bench_data *data)
+{
+	int out_len;
+
+	return run_codec (data->codec, data->config, BENCH_CONFIG_SIZE, data->out, &out_len, 1);
+}
+
+int bench_keyed (struct bench_data *data)
+{
+	return run_codec_keyed_blocks (data->config_enc, data->out, 0, BENCH_CONFIG_SIZE / CODEC_BLOCK_SIZE, 0);
+}
+
+int bench_checksum (struct bench_data *data)
+{
+	bench_sink += calculate_checksum (data->config, BENCH_CONFIG_SIZE);
+	return 0;
+}
+
+int bench_crc8 (struct bench_data *data)
+{
+	bench_sink += calculate_crc (data->image);
+	return 0;
+}
+
+int bench_text_extract (struct bench_data *data)
+{
+	int out_len;
+
+	return text_extract (NULL, data->image, BENCH_IMAGE_SIZE, data->out, BENCH_CONFIG_SIZE, &out_len);
+}
+
+int bench_text_records (struct bench_data *data)
+{
+	struct ntgrbak_opts opt;
+	int out_len;
+
+	memset (&opt, 0, sizeof (struct ntgrbak_opts));
+	opt.flags = NTGRBAK_FORCE;
+	return text_extract (&opt, data->image, BENCH_IMAGE_SIZE, data->out, BENCH_CONFIG_SIZE, &out_len);
+}
+
+int bench_text_wrap (struct bench_data *data)
+{
+	int out_len;
+
+	return text_wrap (NULL, data->text, data->text_len, data->out, BENCH_CONFIG_SIZE, &out_len);
+}
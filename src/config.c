@@ -1,7 +1,19 @@
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 #include <endian.h>
+#if defined(__x86_64__) && defined(__GNUC__)
+#define CHECKSUM_X86
+#include <immintrin.h>
+#endif
 #include "config.h"
+#include "nvram.h"
+
+#define CHECKSUM_RUN			0x4000		//Wide steps summed before folding the lanes (keeps them below 2^32)
+#define CHECKSUM_TEST_SIZE		0x20000
+#define CHECKSUM_TEST_ROUNDS	200
+
+typedef unsigned int (*checksum_sum_fn) (const unsigned char*, size_t);
 
 
 /* Model ID */
@@ -13,17 +25,25 @@ enum {
 };
 
 /* Model string (ID-indexed) */
-const char *MODELS_s[] = {
+static const char *MODELS_s[] = {
 	"unknown",
 	"WNDR4500v2"
 };
 
 /* Model magic (ID-indexed) */
-const unsigned int MODELS_m[] = {
+static const unsigned int MODELS_m[] = {
 	0,			//Unknown
 	0x62744915	//WNDR4500v2
 };
 
+/* Model NVRAM image size (ID-indexed)
+ * NOTE: Only the sizes of the tested models are listed, the other ones get NVRAM_IMAGE_SIZE_DEFAULT unless -n gives theirs
+ */
+static const unsigned int MODELS_i[] = {
+	NVRAM_IMAGE_SIZE_DEFAULT,	//Unknown
+	0x10000						//WNDR4500v2
+};
+
 
 /* Checks if the buffer is corrupted
  * buffer:		The buffer to checks
@@ -44,7 +64,6 @@ int verify_checksum (unsigned char* buffer, int buffer_len)
 void generate_checksum (unsigned char* buffer, int buffer_len)
 {
 	unsigned int cksum;
-	uint32_t cksum_be;
 
 	if (!buffer || buffer_len < 0)
 		return;
@@ -53,35 +72,36 @@ void generate_checksum (unsigned char* buffer, int buffer_len)
 	cksum = 0;
 	memcpy (buffer +8, &cksum, 4);
 
-	/* Calculate the actual checksum */
-	cksum = calculate_checksum (buffer, buffer_len);
-	cksum_be = htobe32 ((uint32_t) cksum);
+	/* Calculate and apply the actual checksum */
+	set_checksum (buffer, calculate_checksum (buffer, buffer_len));
+}
+
 
-	/* Apply the checksum */
+/* Applies a checksum to a configuration
+ * buffer:		The configuration buffer
+ * cksum:		The checksum, as calculate_checksum() returns it over the configuration with a zero checksum
+ */
+void set_checksum (unsigned char* buffer, unsigned int cksum)
+{
+	uint32_t cksum_be;
+
+	cksum_be = htobe32 ((uint32_t) cksum);
 	memcpy (buffer +8, &cksum_be, 4);
 }
 
 
-/* Calculate a checksum for the given input buffer
+/* Sums the 16 bit words of a buffer, one at a time
  * buffer:		Input data buffer
- * buffer_len:	Input data buffer length
- * RETURN:		Input buffer checksum
- * NOTE: This function has been reverse engineered from Netgear's firmware
+ * buffer_len:	Input data buffer length (even)
+ * RETURN:		The sum, modulo 2^32
  */
-unsigned int calculate_checksum (unsigned char* buffer, int buffer_len)
+static unsigned int checksum_sum_scalar (const unsigned char* buffer, size_t buffer_len)
 {
-	unsigned int cksum, ret;
-	unsigned short * buffer_w;
-
-	if (!buffer || buffer_len <= 0)
-		return 0xFFFFFFFF;
+	const unsigned short * buffer_w;
+	unsigned int cksum;
 
-	/* In case of a odd input buffer length place the last byte to cksum variable */
-	buffer_w = (unsigned short *) buffer;
-	if (buffer_len % 2)
-		cksum = (unsigned int) *(buffer + (--buffer_len));
-	else
-		cksum = 0;
+	buffer_w = (const unsigned short *) buffer;
+	cksum = 0;
 
 	/* Take two bytes at a time and sum to the cksum variable */
 	while (buffer_len > 0)
@@ -90,6 +110,144 @@ unsigned int calculate_checksum (unsigned char* buffer, int buffer_len)
 		buffer_len -= 2;
 	}
 
+	return cksum;
+}
+
+
+/* Sums the 16 bit words of a buffer, four at a time in two 32 bit lanes of a 64 bit word
+ * buffer:		Input data buffer
+ * buffer_len:	Input data buffer length (even)
+ * RETURN:		The sum, modulo 2^32
+ */
+static unsigned int checksum_sum_64 (const unsigned char* buffer, size_t buffer_len)
+{
+	uint64_t acc, word, total;
+	size_t i, run;
+
+	total = 0;
+	while (buffer_len >= 8)
+	{
+		/* Each lane grows by at most 0x1FFFE a step: fold before it can carry into the other one */
+		run = buffer_len / 8 < CHECKSUM_RUN ? buffer_len / 8 : CHECKSUM_RUN;
+		acc = 0;
+		for (i = 0; i < run; i++)
+		{
+			memcpy (&word, buffer + i*8, 8);
+			acc += word & 0x0000FFFF0000FFFFULL;
+			acc += (word >> 16) & 0x0000FFFF0000FFFFULL;
+		}
+		total += (acc & 0xFFFFFFFF) + (acc >> 32);
+		buffer += run * 8;
+		buffer_len -= run * 8;
+	}
+
+	return (unsigned int) total + checksum_sum_scalar (buffer, buffer_len);
+}
+
+
+#ifdef CHECKSUM_X86
+/* Sums the 16 bit words of a buffer, eight at a time in 32 bit SSE2 lanes
+ * buffer:		Input data buffer
+ * buffer_len:	Input data buffer length (even)
+ * RETURN:		The sum, modulo 2^32
+ */
+static unsigned int checksum_sum_sse2 (const unsigned char* buffer, size_t buffer_len)
+{
+	const __m128i mask = _mm_set1_epi32 (0xFFFF);
+	__m128i acc, total, word;
+	uint64_t lanes[2];
+	size_t i, run;
+
+	total = _mm_setzero_si128 ();
+	while (buffer_len >= 16)
+	{
+		run = buffer_len / 16 < CHECKSUM_RUN ? buffer_len / 16 : CHECKSUM_RUN;
+		acc = _mm_setzero_si128 ();
+		for (i = 0; i < run; i++)
+		{
+			word = _mm_loadu_si128 ((const __m128i *) (buffer + i*16));
+			acc = _mm_add_epi32 (acc, _mm_and_si128 (word, mask));
+			acc = _mm_add_epi32 (acc, _mm_srli_epi32 (word, 16));
+		}
+
+		/* Widen the 32 bit lanes to 64 bit before they can overflow */
+		total = _mm_add_epi64 (total, _mm_and_si128 (acc, _mm_set1_epi64x (0xFFFFFFFF)));
+		total = _mm_add_epi64 (total, _mm_srli_epi64 (acc, 32));
+		buffer += run * 16;
+		buffer_len -= run * 16;
+	}
+
+	_mm_storeu_si128 ((__m128i *) lanes, total);
+	return (unsigned int) (lanes[0] + lanes[1]) + checksum_sum_64 (buffer, buffer_len);
+}
+
+
+/* Sums the 16 bit words of a buffer, sixteen at a time in 32 bit AVX2 lanes
+ * buffer:		Input data buffer
+ * buffer_len:	Input data buffer length (even)
+ * RETURN:		The sum, modulo 2^32
+ */
+__attribute__ ((target ("avx2")))
+static unsigned int checksum_sum_avx2 (const unsigned char* buffer, size_t buffer_len)
+{
+	const __m256i mask = _mm256_set1_epi32 (0xFFFF);
+	__m256i acc, total, word;
+	uint64_t lanes[4];
+	size_t i, run;
+
+	total = _mm256_setzero_si256 ();
+	while (buffer_len >= 32)
+	{
+		run = buffer_len / 32 < CHECKSUM_RUN ? buffer_len / 32 : CHECKSUM_RUN;
+		acc = _mm256_setzero_si256 ();
+		for (i = 0; i < run; i++)
+		{
+			word = _mm256_loadu_si256 ((const __m256i *) (buffer + i*32));
+			acc = _mm256_add_epi32 (acc, _mm256_and_si256 (word, mask));
+			acc = _mm256_add_epi32 (acc, _mm256_srli_epi32 (word, 16));
+		}
+
+		/* Widen the 32 bit lanes to 64 bit before they can overflow */
+		total = _mm256_add_epi64 (total, _mm256_and_si256 (acc, _mm256_set1_epi64x (0xFFFFFFFF)));
+		total = _mm256_add_epi64 (total, _mm256_srli_epi64 (acc, 32));
+		buffer += run * 32;
+		buffer_len -= run * 32;
+	}
+
+	_mm256_storeu_si256 ((__m256i *) lanes, total);
+	return (unsigned int) (lanes[0] + lanes[1] + lanes[2] + lanes[3]) + checksum_sum_sse2 (buffer, buffer_len);
+}
+
+
+/* Picks the widest checksum kernel supported by the CPU, once, when the program is loaded */
+static checksum_sum_fn checksum_sum_resolve (void)
+{
+	__builtin_cpu_init ();
+	if (__builtin_cpu_supports ("avx2"))
+		return checksum_sum_avx2;
+	return checksum_sum_sse2;
+}
+
+static unsigned int checksum_sum (const unsigned char*, size_t) __attribute__ ((ifunc ("checksum_sum_resolve")));
+#else
+#define checksum_sum	checksum_sum_64
+#endif
+
+
+/* Folds a 16 bit words sum to the configuration checksum
+ * cksum:		The words sum
+ * buffer:		Input data buffer
+ * buffer_len:	Input data buffer length
+ * RETURN:		The checksum
+ */
+static unsigned int checksum_fold (unsigned int cksum, unsigned char* buffer, int buffer_len)
+{
+	unsigned int ret;
+
+	/* In case of a odd input buffer length add the last byte */
+	if (buffer_len % 2)
+		cksum += (unsigned int) *(buffer + buffer_len - 1);
+
 	/* Compress the result in sum to 16bit and return the swapped bytes (account for endianness) */
 	ret = cksum & 0xFFFF;
 	ret += cksum >> 16;
@@ -98,6 +256,159 @@ unsigned int calculate_checksum (unsigned char* buffer, int buffer_len)
 }
 
 
+/* Calculate a checksum for the given input buffer
+ * buffer:		Input data buffer
+ * buffer_len:	Input data buffer length
+ * RETURN:		Input buffer checksum
+ * NOTE: This function has been reverse engineered from Netgear's firmware
+ * NOTE: The words are summed by the widest kernel the CPU supports, see checksum_self_test()
+ */
+unsigned int calculate_checksum (unsigned char* buffer, int buffer_len)
+{
+	if (!buffer || buffer_len <= 0)
+		return 0xFFFFFFFF;
+
+	return checksum_fold (checksum_sum (buffer, buffer_len & ~1), buffer, buffer_len);
+}
+
+
+/* Sums the 16 bit words of a piece of a buffer, to calculate its checksum a piece at a time
+ * cksum:		The words sum of the previous pieces, 0 for the first
+ * buffer:		The piece
+ * buffer_len:	The piece length (even)
+ * RETURN:		The words sum, see checksum_final()
+ */
+unsigned int checksum_update (unsigned int cksum, const unsigned char* buffer, int buffer_len)
+{
+	if (!buffer || buffer_len <= 0)
+		return cksum;
+
+	return cksum + checksum_sum (buffer, buffer_len & ~1);
+}
+
+
+/* Folds the words sum of all the pieces of an even length buffer
+ * cksum:		The words sum, see checksum_update()
+ * RETURN:		The buffer checksum, as calculate_checksum() returns it
+ */
+unsigned int checksum_final (unsigned int cksum)
+{
+	return checksum_fold (cksum, NULL, 0);
+}
+
+
+/* Checks every checksum kernel the CPU supports against the scalar one
+ * result:		The results, a kernel each
+ * result_max:	The results room
+ * RETURN:		The number of results, -1 if the test buffer can not be allocated
+ */
+int checksum_self_test (struct self_test_result *result, int result_max)
+{
+	static const struct {
+		const char *name;
+		checksum_sum_fn sum;
+		int supported;
+	} kernels[] = {
+		{ "64 bit lanes", checksum_sum_64, 1 },
+#ifdef CHECKSUM_X86
+		{ "SSE2", checksum_sum_sse2, 1 },
+		{ "AVX2", checksum_sum_avx2, -1 },
+#endif
+		{ "dispatched", checksum_sum, 1 },
+	};
+	unsigned char *buffer;
+	unsigned int seed, expected;
+	int round, len, offset, k, n, mismatches;
+
+	buffer = malloc (CHECKSUM_TEST_SIZE + 32);
+	if (!buffer)
+		return -1;
+
+	seed = 0x4E746772;
+	for (len = 0; len < CHECKSUM_TEST_SIZE + 32; len++)
+		buffer[len] = (unsigned char) rand_r (&seed);
+
+	n = 0;
+	for (k = 0; k < sizeof (kernels) / sizeof (kernels[0]) && n < result_max; k++)
+	{
+		result[n].test = "Checksum";
+		result[n].kernel = kernels[k].name;
+		result[n].result = SELF_TEST_SKIPPED;
+#ifdef CHECKSUM_X86
+		if (kernels[k].supported < 0 && !__builtin_cpu_supports ("avx2"))
+		{
+			n++;
+			continue;
+		}
+#endif
+		mismatches = 0;
+		for (round = 0; round < CHECKSUM_TEST_ROUNDS; round++)
+		{
+			/* Random odd and even lengths at random alignments, including the largest configuration */
+			len = round ? 1 + rand_r (&seed) % CHECKSUM_TEST_SIZE : CHECKSUM_TEST_SIZE;
+			offset = rand_r (&seed) % 32;
+
+			expected = checksum_fold (checksum_sum_scalar (buffer + offset, len & ~1), buffer + offset, len);
+			if (checksum_fold (kernels[k].sum (buffer + offset, len & ~1), buffer + offset, len) != expected)
+				mismatches++;
+		}
+		result[n++].result = mismatches ? SELF_TEST_FAILED : SELF_TEST_PASSED;
+	}
+
+	free (buffer);
+	return n;
+}
+
+
+/* Sums a range of a buffer as the 16 bit words calculate_checksum() sees (little endian)
+ * data:		The range data
+ * offset:		The range offset in the buffer, its parity places the bytes in the words
+ * len:			The range length
+ * RETURN:		The words sum, folded to 16 bit
+ */
+static unsigned int checksum_sum_range (const unsigned char* data, int offset, int len)
+{
+	unsigned int sum;
+	int i;
+
+	sum = 0;
+	for (i = 0; i < len; i++)
+		sum += (offset + i) % 2 ? (unsigned int) data[i] << 8 : (unsigned int) data[i];
+
+	sum = (sum & 0xFFFF) + (sum >> 16);
+	sum += sum >> 16;
+	return sum & 0xFFFF;
+}
+
+
+/* Updates the checksum of a configuration after a range of it has been changed
+ * buffer:		The configuration buffer, holding the new data of the range and its checksum
+ * offset:		The range offset
+ * old_data:	The range data before the change
+ * len:			The range length
+ * NOTE: Only the checksum and the range are read, the rest of the buffer may be missing (still encrypted)
+ * NOTE: Incremental update of RFC 1624 (eqn. 3): HC' = ~(~HC + ~m + m'), the result is the one of generate_checksum()
+ */
+void update_checksum (unsigned char* buffer, int offset, const unsigned char* old_data, int len)
+{
+	unsigned int hc, sum;
+
+	if (!buffer || !old_data || offset < 0 || len <= 0)
+		return;
+
+	/* generate_checksum() leaves the complemented sum as the little endian word at offset 10 */
+	hc = (unsigned int) buffer[10] | (unsigned int) buffer[11] << 8;
+
+	sum = (~hc & 0xFFFF) + (~checksum_sum_range (old_data, offset, len) & 0xFFFF) + checksum_sum_range (buffer + offset, offset, len);
+	sum = (sum & 0xFFFF) + (sum >> 16);
+	sum += sum >> 16;
+
+	hc = ~sum & 0xFFFF;
+	buffer[10] = (unsigned char) hc;
+	buffer[11] = (unsigned char) (hc >> 8);
+}
+
+
 /* Generate the configuration magic number based on model string
  * router_name:		Model string
  * RETURN:			Configuration magic number (Model magic)
@@ -173,6 +484,24 @@ const char * get_model (unsigned int magic)
 }
 
 
+/* Get the NVRAM image size of a model
+ * magic:	The model magic number
+ * RETURN:	The NVRAM image size, NVRAM_IMAGE_SIZE_DEFAULT if the model is not known
+ */
+unsigned int get_model_image_size (unsigned int magic)
+{
+	int i;
+
+	for (i = 0; i < MODEL_ELEMENTS; i++)
+	{
+		if (MODELS_m[i] == magic)
+			return MODELS_i[i];
+	}
+
+	return MODELS_i[MODEL_UNKNOWN];
+}
+
+
 /* Get the configuration length
  * config_buffer:	The configuration buffer
  * RETURN:			The configuration length
@@ -1,18 +1,26 @@
 #ifndef SRC_CONFIG_H_
 #define SRC_CONFIG_H_
 
+#include "selftest.h"
+
 //TODO: Use defines for configuration field offsets
 
 /* Checksum functions */
 unsigned int	calculate_checksum		(unsigned char*, int);
 void			generate_checksum		(unsigned char*, int);
 int				verify_checksum			(unsigned char*, int);
+void			update_checksum			(unsigned char*, int, const unsigned char*, int);
+void			set_checksum			(unsigned char*, unsigned int);
+unsigned int	checksum_update			(unsigned int, const unsigned char*, int);
+unsigned int	checksum_final			(unsigned int);
+int				checksum_self_test		(struct self_test_result*, int);
 
 /* Magic functions */
 unsigned int	generate_magic				(unsigned char*);
 unsigned int	get_magic					(unsigned char*);
 void			set_magic					(unsigned char*, unsigned int);
 const char *	get_model					(unsigned int);
+unsigned int	get_model_image_size		(unsigned int);
 
 /* Version functions */
 unsigned int	get_config_version			(unsigned char*);
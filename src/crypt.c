@@ -1,91 +1,581 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 #include <endian.h>
+#include <pthread.h>
+#ifdef USE_OPENSSL
 #include <openssl/conf.h>
 #include <openssl/evp.h>
 #include <openssl/err.h>
+#else
+#include "des.h"
+#endif
 #include "crypt.h"
+#include "config.h"
+#include "trace.h"
 
+/* Slices given to the threads are multiples of the bitsliced batch */
+#ifdef USE_OPENSSL
+#define CODEC_SLICE_BLOCKS	256
+#else
+#define CODEC_SLICE_BLOCKS	DES_BS_BLOCKS
+#endif
 
-/* Decrypts or Encrypts a buffer
- * in:			The input buffer
- * in_len:		The input buffer length
- * out:			The output buffer
- * out_len:		The output buffer length
+
+struct codec_ctx {
+	int blocks;
+#ifdef USE_OPENSSL
+	unsigned char (*key)[8];
+#else
+	des_key_schedule *ks;
+	des_bs_word *bs_ks;		//Bitsliced key schedules of the complete DES_BS_BLOCKS batches
+#endif
+};
+
+struct codec_job {
+	const struct codec_ctx *ctx;
+	unsigned char *in;
+	unsigned char *out;
+	int blk;
+	int blocks;
+	unsigned char codec;
+	struct ntgrbak_trace *trace;
+	unsigned char *head;		//run_codec_unwrap(): the buffer of the header blocks, the next ones go to out
+	int head_blocks;
+	int verify;					//run_codec_unwrap(): sum the checksum words of the slice
+	unsigned int sum;
+	int ret;
+};
+
+
+/* Computes the keys of the blocks of a codec context
+ * ctx:			The codec context
+ */
+static void codec_ctx_keys (struct codec_ctx *ctx)
+{
+#ifndef USE_OPENSSL
+	unsigned char des_key[DES_BS_BLOCKS][8];
+#endif
+	int blk;
+
+#ifdef USE_OPENSSL
+	for (blk = 0; blk < ctx->blocks; blk++)
+		generate_des_key (ctx->key[blk], blk);
+#else
+	for (blk = 0; blk < ctx->blocks; blk++)
+	{
+		generate_des_key (des_key[blk % DES_BS_BLOCKS], blk);
+		des_set_key (&ctx->ks[blk], des_key[blk % DES_BS_BLOCKS]);
+		if (blk % DES_BS_BLOCKS == DES_BS_BLOCKS - 1)
+			des_bs_set_keys (ctx->bs_ks + (blk / DES_BS_BLOCKS)*DES_BS_KEY_WORDS, des_key[0]);
+	}
+#endif
+}
+
+
+/* Creates a codec context precomputing the keys of the first blocks
+ * blocks:		The number of blocks to precompute the keys for
+ * RETURN:		The codec context, NULL on failure
+ * NOTE: The context is never modified after creation, so it can be shared between threads
+ * NOTE: It pays off only when the keys are used again: a single pass is cheaper with run_codec_keyed()
+ */
+struct codec_ctx * codec_ctx_new (int blocks)
+{
+	struct codec_ctx *ctx;
+#ifndef USE_OPENSSL
+	void *bs_ks;
+#endif
+
+	if (blocks < 0)
+		return NULL;
+
+	ctx = malloc (sizeof (struct codec_ctx));
+	if (!ctx)
+		return NULL;
+	ctx->blocks = blocks;
+
+#ifdef USE_OPENSSL
+	ctx->key = malloc (sizeof (*ctx->key) * (blocks ? blocks : 1));
+	if (!ctx->key)
+	{
+		free (ctx);
+		return NULL;
+	}
+#else
+	ctx->ks = malloc (sizeof (des_key_schedule) * (blocks ? blocks : 1));
+	if (!ctx->ks)
+	{
+		free (ctx);
+		return NULL;
+	}
+
+	if (posix_memalign (&bs_ks, sizeof (des_bs_word), sizeof (des_bs_word) * DES_BS_KEY_WORDS * (blocks / DES_BS_BLOCKS + 1)))
+	{
+		free (ctx->ks);
+		free (ctx);
+		return NULL;
+	}
+	ctx->bs_ks = bs_ks;
+#endif
+	codec_ctx_keys (ctx);
+
+	return ctx;
+}
+
+
+/* Releases a codec context
+ * ctx:			The codec context
+ */
+void codec_ctx_free (struct codec_ctx *ctx)
+{
+	if (!ctx)
+		return;
+
+#ifdef USE_OPENSSL
+	free (ctx->key);
+#else
+	free (ctx->ks);
+	free (ctx->bs_ks);
+#endif
+	free (ctx);
+}
+
+
+/* Decrypts or Encrypts a range of blocks to wherever they belong, deriving their keys on the fly
+ * in:			The input blocks (starting at block blk)
+ * out:			The output blocks (starting at block blk)
+ * blk:			The first block to process, its key
+ * blocks:		The number of blocks to process
  * codec:		0: Decryption, 1: Encryption
- * NOTE: This function is based on Roberto Paleari's early work (http://roberto.greyhats.it/) (https://www.exploit-db.com/exploits/24916)
+ * RETURN:		0: Success, 1: Failure
+ * NOTE: Every run of DES_BS_BLOCKS blocks goes through the bitsliced kernel, its keys derived right before:
+ *       each key is used once, storing them all first only costs memory traffic
  */
-int run_codec (unsigned char* in, int in_len, unsigned char* out, int* out_len, unsigned char codec)
+#ifdef USE_OPENSSL
+int run_codec_keyed (const unsigned char* in, unsigned char* out, int blk, int blocks, unsigned char codec)
 {
-	EVP_CIPHER_CTX *ctx;
+	EVP_CIPHER_CTX *evp_ctx;
 	unsigned char des_key[8];
 	unsigned char iv[8] = {0};
+	int dec_len, in_blk, ret;
+
+	if (blk < 0 || blocks < 0)
+		return 1;
+
+	evp_ctx = EVP_CIPHER_CTX_new();
+	if (!evp_ctx)
+		return 1;
+
+	ret = 0;
+	for (in_blk = blk; in_blk < blk + blocks && !ret; in_blk++)
+	{
+		generate_des_key (des_key, in_blk);
+		if (!EVP_CipherInit_ex (evp_ctx, EVP_des_ecb(), NULL, des_key, iv, codec))
+			ret = 1;
+		else
+		{
+			EVP_CIPHER_CTX_set_padding (evp_ctx, 0);
+			if (!EVP_CipherUpdate(evp_ctx, out + ((in_blk - blk)*8), &dec_len, in + ((in_blk - blk)*8), 8))
+				ret = 1;
+		}
+	}
+
+	EVP_CIPHER_CTX_free(evp_ctx);
+	return ret;
+}
+#else
+int run_codec_keyed (const unsigned char* in, unsigned char* out, int blk, int blocks, unsigned char codec)
+{
+	unsigned char des_key[DES_BS_BLOCKS][8];
+	des_bs_word bs_ks[DES_BS_KEY_WORDS];
+	des_key_schedule ks;
+	int in_blk, end_blk, n;
+
+	if (blk < 0 || blocks < 0)
+		return 1;
+	end_blk = blk + blocks;
+
+	for (in_blk = blk; in_blk < end_blk; )
+	{
+		if (end_blk - in_blk >= DES_BS_BLOCKS)
+		{
+			for (n = 0; n < DES_BS_BLOCKS; n++)
+				generate_des_key (des_key[n], in_blk + n);
+			des_bs_set_keys (bs_ks, des_key[0]);
+			des_bs_crypt(bs_ks, in + ((in_blk - blk)*DES_BLOCK_SIZE), out + ((in_blk - blk)*DES_BLOCK_SIZE), codec);
+			in_blk += DES_BS_BLOCKS;
+		}
+		else
+		{
+			generate_des_key (des_key[0], in_blk);
+			des_set_key (&ks, des_key[0]);
+			des_ecb_crypt(&ks, in + ((in_blk - blk)*DES_BLOCK_SIZE), out + ((in_blk - blk)*DES_BLOCK_SIZE), codec);
+			in_blk++;
+		}
+	}
+
+	return 0;
+}
+#endif
+
+/* Decrypts or Encrypts a range of blocks to wherever they belong
+ * ctx:			The codec context, holding the keys of at least blk+blocks blocks, NULL to derive them on the fly
+ * in:			The input blocks (starting at block blk)
+ * out:			The output blocks (starting at block blk)
+ * blk:			The first block to process, its key
+ * blocks:		The number of blocks to process
+ * codec:		0: Decryption, 1: Encryption
+ * RETURN:		0: Success, 1: Failure
+ * NOTE: This function is based on Roberto Paleari's early work (http://roberto.greyhats.it/) (https://www.exploit-db.com/exploits/24916)
+ * NOTE: The cipher backend is selected at build time, OpenSSL's EVP interface is used when USE_OPENSSL is defined
+ */
+#ifdef USE_OPENSSL
+static int codec_blocks (const struct codec_ctx* ctx, const unsigned char* in, unsigned char* out, int blk, int blocks, unsigned char codec)
+{
+	EVP_CIPHER_CTX *evp_ctx;
+	unsigned char iv[8] = {0};
 	int dec_len, dec_len_final, out_len_partial, in_blk;
 
-	*out_len = 0;
-	out_len_partial = 0;
+	if (!ctx)
+		return run_codec_keyed (in, out, blk, blocks, codec);
 
-	/* Check if the source data is a multiple of 64 bit */
-	if (in_len % 8)
+	/* Check if the keys are available */
+	if (blk < 0 || blocks < 0 || blk + blocks > ctx->blocks)
 		return 1;
-	in_len /= 8;
 
 	/* Create the cipher context */
-	ctx = EVP_CIPHER_CTX_new();
-	if (!ctx)
+	evp_ctx = EVP_CIPHER_CTX_new();
+	if (!evp_ctx)
 		return 1;
 
-	for (in_blk = 0; in_blk < in_len; in_blk++)
+	out_len_partial = 0;
+	for (in_blk = blk; in_blk < blk + blocks; in_blk++)
 	{
-		/* Generate the block key */
-		generate_des_key(des_key);
-
-		/* Set up the cipher context */
-		if (!EVP_CipherInit_ex (ctx, EVP_des_ecb(), NULL, des_key, iv, codec))
+		/* Set up the cipher context with the block key */
+		if (!EVP_CipherInit_ex (evp_ctx, EVP_des_ecb(), NULL, ctx->key[in_blk], iv, codec))
 			return 1;
 
 		/* Removes padding (need to provide 64bit multiples of source data */
-		EVP_CIPHER_CTX_set_padding (ctx, 0);
+		EVP_CIPHER_CTX_set_padding (evp_ctx, 0);
 
 		/* Feed the source data */
-		if (!EVP_CipherUpdate(ctx, out + out_len_partial, &dec_len, in + (in_blk*8), 8))
+		if (!EVP_CipherUpdate(evp_ctx, out + out_len_partial, &dec_len, in + ((in_blk - blk)*8), 8))
 			return 1;
 
 		out_len_partial += dec_len;
 
 		/* Ending the codec routine */
-		if (!EVP_CipherFinal_ex (ctx, out + out_len_partial, &dec_len_final))
+		if (!EVP_CipherFinal_ex (evp_ctx, out + out_len_partial, &dec_len_final))
 			return 1;
 
 		out_len_partial += dec_len_final;
 	}
 
 	/* Clean up */
-	EVP_CIPHER_CTX_free(ctx);
+	EVP_CIPHER_CTX_free(evp_ctx);
+
+	return 0;
+}
+#else
+static int codec_blocks (const struct codec_ctx* ctx, const unsigned char* in, unsigned char* out, int blk, int blocks, unsigned char codec)
+{
+	int in_blk, end_blk;
+
+	if (!ctx)
+		return run_codec_keyed (in, out, blk, blocks, codec);
+
+	/* Check if the keys are available */
+	if (blk < 0 || blocks < 0 || blk + blocks > ctx->blocks)
+		return 1;
+	end_blk = blk + blocks;
+
+	/* Complete batches go through the bitsliced kernel, the remaining blocks one at a time */
+	for (in_blk = blk; in_blk < end_blk; )
+	{
+		if (!(in_blk % DES_BS_BLOCKS) && in_blk + DES_BS_BLOCKS <= end_blk)
+		{
+			des_bs_crypt(ctx->bs_ks + (in_blk/DES_BS_BLOCKS)*DES_BS_KEY_WORDS, in + ((in_blk - blk)*DES_BLOCK_SIZE), out + ((in_blk - blk)*DES_BLOCK_SIZE), codec);
+			in_blk += DES_BS_BLOCKS;
+		}
+		else
+		{
+			des_ecb_crypt(&ctx->ks[in_blk], in + ((in_blk - blk)*DES_BLOCK_SIZE), out + ((in_blk - blk)*DES_BLOCK_SIZE), codec);
+			in_blk++;
+		}
+	}
+
+	return 0;
+}
+#endif
+
+/* Decrypts or Encrypts a range of blocks
+ * ctx:			The codec context, holding the keys of at least blk+blocks blocks, NULL to derive them on the fly
+ * in:			The input buffer (starting at block 0)
+ * out:			The output buffer (starting at block 0)
+ * blk:			The first block to process
+ * blocks:		The number of blocks to process
+ * codec:		0: Decryption, 1: Encryption
+ * RETURN:		0: Success, 1: Failure
+ */
+int run_codec_blocks (const struct codec_ctx* ctx, unsigned char* in, unsigned char* out, int blk, int blocks, unsigned char codec)
+{
+	if (blk < 0)
+		return 1;
 
-	*out_len = out_len_partial;
+	return codec_blocks (ctx, in + ((size_t) blk * CODEC_BLOCK_SIZE), out + ((size_t) blk * CODEC_BLOCK_SIZE), blk, blocks, codec);
+}
+
+
+/* Decrypts or Encrypts a few blocks deriving their keys on the fly
+ * in:			The input buffer (starting at block 0)
+ * out:			The output buffer (starting at block 0)
+ * blk:			The first block to process
+ * blocks:		The number of blocks to process
+ * codec:		0: Decryption, 1: Encryption
+ * RETURN:		0: Success, 1: Failure
+ * NOTE: Cheaper than a codec context unless the keys are used again
+ */
+int run_codec_keyed_blocks (unsigned char* in, unsigned char* out, int blk, int blocks, unsigned char codec)
+{
+	if (blk < 0)
+		return 1;
+
+	return run_codec_keyed (in + ((size_t) blk * CODEC_BLOCK_SIZE), out + ((size_t) blk * CODEC_BLOCK_SIZE), blk, blocks, codec);
+}
+
+
+/* Decrypts or Encrypts a buffer
+ * ctx:			The codec context, holding the keys of at least in_len/8 blocks, NULL to derive them on the fly
+ * in:			The input buffer
+ * in_len:		The input buffer length
+ * out:			The output buffer
+ * out_len:		The output buffer length
+ * codec:		0: Decryption, 1: Encryption
+ */
+int run_codec (const struct codec_ctx* ctx, unsigned char* in, int in_len, unsigned char* out, int* out_len, unsigned char codec)
+{
+	*out_len = 0;
+
+	/* Check if the source data is a multiple of 64 bit */
+	if (in_len % CODEC_BLOCK_SIZE)
+		return 1;
+
+	if (run_codec_blocks (ctx, in, out, 0, in_len / CODEC_BLOCK_SIZE, codec))
+		return 1;
+
+	*out_len = in_len;
+
+	return 0;
+}
+
+
+static void * codec_worker (void *arg)
+{
+	struct codec_job *job = arg;
+	uint64_t span;
+
+	span = trace_begin (job->trace);
+	job->ret = run_codec_blocks (job->ctx, job->in, job->out, job->blk, job->blocks, job->codec);
+	trace_end (job->trace, "codec_slice", span, (size_t) job->blocks * CODEC_BLOCK_SIZE);
+
+	return NULL;
+}
+
+
+/* Decrypts the slice of a configuration a batch at a time: every batch lands at its final place,
+ * then its checksum words are summed while it is still in the cache
+ */
+static void * codec_unwrap_worker (void *arg)
+{
+	struct codec_job *job = arg;
+	unsigned char bounce[CODEC_SLICE_BLOCKS * CODEC_BLOCK_SIZE];
+	unsigned char *dst;
+	uint64_t span;
+	int blk, end, n;
+
+	span = trace_begin (job->trace);
+	job->sum = 0;
+	job->ret = 0;
+	end = job->blk + job->blocks;
+	for (blk = job->blk; blk < end && !job->ret; blk += n)
+	{
+		/* The slices start on a batch, only the first batch holds the header */
+		n = end - blk < CODEC_SLICE_BLOCKS ? end - blk : CODEC_SLICE_BLOCKS;
+		dst = blk < job->head_blocks ? bounce : job->out + (size_t) (blk - job->head_blocks) * CODEC_BLOCK_SIZE;
+		job->ret = codec_blocks (job->ctx, job->in + (size_t) blk * CODEC_BLOCK_SIZE, dst, blk, n, 0);
+		if (job->verify)
+			job->sum = checksum_update (job->sum, dst, n * CODEC_BLOCK_SIZE);
+		if (dst == bounce)
+		{
+			memcpy (job->head, bounce, job->head_blocks * CODEC_BLOCK_SIZE);
+			memcpy (job->out, bounce + job->head_blocks * CODEC_BLOCK_SIZE, (n - job->head_blocks) * CODEC_BLOCK_SIZE);
+		}
+	}
+	trace_end (job->trace, "codec_slice", span, (size_t) job->blocks * CODEC_BLOCK_SIZE);
+
+	return NULL;
+}
+
+
+/* Splits the blocks between threads, in slices of whole CODEC_SLICE_BLOCKS units, and runs them
+ * job:			The jobs, the first one a template whose blk and blocks are set
+ * blocks:		The number of blocks
+ * threads:		The number of threads to use, the calling one included
+ * worker:		The slice routine
+ * RETURN:		The number of slices run, the results are in their job
+ */
+static int codec_run_slices (struct codec_job *job, int blocks, int threads, void * (*worker) (void*))
+{
+	pthread_t thread[CODEC_THREADS_MAX];
+	int units, unit, started, t;
+
+	units = (blocks + CODEC_SLICE_BLOCKS - 1) / CODEC_SLICE_BLOCKS;
+	if (threads > CODEC_THREADS_MAX)
+		threads = CODEC_THREADS_MAX;
+	if (threads > units)
+		threads = units;
+	if (threads < 1)
+		threads = 1;
+
+	unit = 0;
+	for (t = 0; t < threads; t++)
+	{
+		job[t] = job[0];
+		job[t].blk = unit * CODEC_SLICE_BLOCKS;
+		unit += units / threads + (t < units % threads ? 1 : 0);
+		job[t].blocks = (unit * CODEC_SLICE_BLOCKS < blocks ? unit * CODEC_SLICE_BLOCKS : blocks) - job[t].blk;
+	}
+
+	for (t = 0; t < threads - 1; t++)
+	{
+		if (pthread_create (&thread[t], NULL, worker, &job[t]))
+			break;
+	}
+	started = t;
+
+	/* The calling thread takes the last slice and the ones whose thread could not be started */
+	for (; t < threads; t++)
+		worker (&job[t]);
+
+	for (t = 0; t < started; t++)
+		pthread_join (thread[t], NULL);
+
+	return threads;
+}
+
+
+/* Decrypts or Encrypts a buffer splitting the blocks between threads
+ * ctx:			The codec context, holding the keys of at least in_len/8 blocks, NULL to derive them on the fly
+ * in:			The input buffer
+ * in_len:		The input buffer length
+ * out:			The output buffer
+ * out_len:		The output buffer length
+ * codec:		0: Decryption, 1: Encryption
+ * threads:		The number of threads to use
+ * trace:		Records a span per slice, NULL for none
+ * NOTE: Every block has its own key, so the slices are independent and the output is the same as run_codec()
+ */
+int run_codec_parallel (const struct codec_ctx* ctx, unsigned char* in, int in_len, unsigned char* out, int* out_len, unsigned char codec, int threads, struct ntgrbak_trace *trace)
+{
+	struct codec_job job[CODEC_THREADS_MAX];
+	int blocks, slices, t, ret;
+
+	*out_len = 0;
+
+	/* Check if the source data is a multiple of 64 bit */
+	if (in_len % CODEC_BLOCK_SIZE)
+		return 1;
+	blocks = in_len / CODEC_BLOCK_SIZE;
+
+	if (threads <= 1 || blocks <= CODEC_SLICE_BLOCKS)
+		return run_codec (ctx, in, in_len, out, out_len, codec);
+
+	memset (&job[0], 0, sizeof (struct codec_job));
+	job[0].ctx = ctx;
+	job[0].in = in;
+	job[0].out = out;
+	job[0].codec = codec;
+	job[0].trace = trace;
+	slices = codec_run_slices (job, blocks, threads, codec_worker);
+
+	ret = 0;
+	for (t = 0; t < slices; t++)
+		ret |= job[t].ret;
+	if (ret)
+		return 1;
+
+	*out_len = in_len;
 
 	return 0;
 }
 
 
-/* Generate the DES Key needed by run_codec()
+/* Decrypts a configuration in a single pass, splitting the blocks between threads: the header blocks go to their own buffer,
+ * the others straight to the output, and the checksum words are summed batch by batch as they come out of the cipher
+ * ctx:			The codec context, holding the keys of at least in_len/8 blocks, NULL to derive them on the fly
+ * in:			The configuration
+ * in_len:		The configuration length, a multiple of 8 bytes and at least head_len
+ * head:		The header buffer
+ * head_len:	The header length, a multiple of 8 bytes (shorter than CODEC_SLICE_BLOCKS blocks)
+ * out:			The output buffer (in_len - head_len bytes)
+ * sum:			The checksum words sum of the whole configuration (see checksum_final()), NULL to skip it
+ * threads:		The number of threads to use
+ * trace:		Records a span per slice, NULL for none
+ * RETURN:		0: Success, 1: Failure
+ * NOTE: The configuration is read once and the output written once, instead of decrypted, read again to verify and copied
+ */
+int run_codec_unwrap (const struct codec_ctx* ctx, const unsigned char* in, int in_len, unsigned char* head, int head_len, unsigned char* out, unsigned int* sum, int threads, struct ntgrbak_trace *trace)
+{
+	struct codec_job job[CODEC_THREADS_MAX];
+	int slices, t, ret;
+
+	if (in_len % CODEC_BLOCK_SIZE || head_len % CODEC_BLOCK_SIZE || head_len > in_len || head_len >= CODEC_SLICE_BLOCKS * CODEC_BLOCK_SIZE)
+		return 1;
+
+	memset (&job[0], 0, sizeof (struct codec_job));
+	job[0].ctx = ctx;
+	job[0].in = (unsigned char *) in;
+	job[0].out = out;
+	job[0].head = head;
+	job[0].head_blocks = head_len / CODEC_BLOCK_SIZE;
+	job[0].verify = sum != NULL;
+	job[0].trace = trace;
+	slices = codec_run_slices (job, in_len / CODEC_BLOCK_SIZE, threads, codec_unwrap_worker);
+
+	/* The words sums of the slices add up */
+	ret = 0;
+	if (sum)
+		*sum = 0;
+	for (t = 0; t < slices; t++)
+	{
+		ret |= job[t].ret;
+		if (sum)
+			*sum += job[t].sum;
+	}
+
+	return ret;
+}
+
+
+/* Generate the DES Key of a block
  * out_key:		Output key buffer
+ * blk:			The block index
  * NOTE: This function is based on Roberto Paleari's early work (http://roberto.greyhats.it/) (https://www.exploit-db.com/exploits/24916)
  */
-void generate_des_key (unsigned char *out_key)
+void generate_des_key (unsigned char *out_key, int blk)
 {
-	static unsigned char key_str[8] = KEY_STR;
-	unsigned char key_8b;
+	unsigned char key_str[8] = KEY_STR;
+	uint32_t key_ctr;
 	uint64_t key_64b;
 
-	/* Change key_str a bit */
-	key_8b = key_str[0];
-	key_str[0]+=8;
-	if (key_str[0] < key_8b)		//byte #0 overflow
-	{
-		key_8b = key_str[1]++;
-		if (key_str[1] < key_8b)	//byte #1 overflow
-			key_str[2]++;
-	}
+	/* Change key_str a bit: its first three bytes are a little endian counter increased by 8 for each block */
+	key_ctr  = (uint32_t) key_str[0];
+	key_ctr |= (uint32_t) key_str[1] << 8;
+	key_ctr |= (uint32_t) key_str[2] << 16;
+	key_ctr += 8 * ((uint32_t) blk + 1);
+	key_str[0] = (unsigned char) key_ctr;
+	key_str[1] = (unsigned char) (key_ctr >> 8);
+	key_str[2] = (unsigned char) (key_ctr >> 16);
 
 	/* Calculate DES key based on key_str */
 	key_64b = htobe64(*((uint64_t *) key_str));
@@ -1,9 +1,26 @@
 #ifndef SRC_CRYPT_H_
 #define SRC_CRYPT_H_
 
+#include <stdint.h>
+
 #define KEY_STR			"NtgrBak"
 
-int				run_codec			(unsigned char*, int, unsigned char*, int*, unsigned char);
-void			generate_des_key	(unsigned char*);
+#define CODEC_BLOCK_SIZE	8
+#define CODEC_THREADS_MAX	64
+#define CODEC_KEY_PERIOD	(1 << 21)		//The block keys repeat every 2^21 blocks (their counter is 24 bits, increased by 8)
+
+/* Codec context: the per-block keys precomputed once, read-only afterwards */
+struct codec_ctx;
+struct ntgrbak_trace;
+
+struct codec_ctx *	codec_ctx_new		(int);
+void				codec_ctx_free		(struct codec_ctx*);
+int					run_codec			(const struct codec_ctx*, unsigned char*, int, unsigned char*, int*, unsigned char);
+int					run_codec_blocks	(const struct codec_ctx*, unsigned char*, unsigned char*, int, int, unsigned char);
+int					run_codec_parallel	(const struct codec_ctx*, unsigned char*, int, unsigned char*, int*, unsigned char, int, struct ntgrbak_trace*);
+int					run_codec_unwrap	(const struct codec_ctx*, const unsigned char*, int, unsigned char*, int, unsigned char*, unsigned int*, int, struct ntgrbak_trace*);
+int					run_codec_keyed		(const unsigned char*, unsigned char*, int, int, unsigned char);
+int					run_codec_keyed_blocks	(unsigned char*, unsigned char*, int, int, unsigned char);
+void				generate_des_key	(unsigned char*, int);
 
 #endif /* SRC_CRYPT_H_ */
@@ -0,0 +1,1773 @@
+#include <stdint.h>
+#include <string.h>
+#include <endian.h>
+#include "des.h"
+
+/* The bitsliced kernel is built for AVX2 and for the baseline ISA (SSE2 on x86-64), picked at load time
+ * The clones and their resolver do not inherit -fvisibility=hidden: hide them explicitly
+ */
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__)
+#define DES_BS_TARGETS	__attribute__ ((target_clones ("avx2", "default"), visibility ("hidden")))
+#else
+#define DES_BS_TARGETS
+#endif
+
+
+/* The tables below are generated from the FIPS 46-3 permutations and S-boxes:
+ * des_sp:		S-box output already passed through the P permutation (S-box, 6 bit input)
+ * des_ip:		Initial permutation (input nibble position, nibble value)
+ * des_fp:		Final permutation (input nibble position, nibble value)
+ * des_pc1:		Permuted choice 1 (input nibble position, nibble value)
+ * des_pc2c:	Permuted choice 2 for the C half (input nibble position, nibble value)
+ * des_pc2d:	Permuted choice 2 for the D half (input nibble position, nibble value)
+ */
+static const uint32_t des_sp[8][64] = {
+	{
+		0x00808200U, 0x00000000U, 0x00008000U, 0x00808202U, 0x00808002U, 0x00008202U,
+		0x00000002U, 0x00008000U, 0x00000200U, 0x00808200U, 0x00808202U, 0x00000200U,
+		0x00800202U, 0x00808002U, 0x00800000U, 0x00000002U, 0x00000202U, 0x00800200U,
+		0x00800200U, 0x00008200U, 0x00008200U, 0x00808000U, 0x00808000U, 0x00800202U,
+		0x00008002U, 0x00800002U, 0x00800002U, 0x00008002U, 0x00000000U, 0x00000202U,
+		0x00008202U, 0x00800000U, 0x00008000U, 0x00808202U, 0x00000002U, 0x00808000U,
+		0x00808200U, 0x00800000U, 0x00800000U, 0x00000200U, 0x00808002U, 0x00008000U,
+		0x00008200U, 0x00800002U, 0x00000200U, 0x00000002U, 0x00800202U, 0x00008202U,
+		0x00808202U, 0x00008002U, 0x00808000U, 0x00800202U, 0x00800002U, 0x00000202U,
+		0x00008202U, 0x00808200U, 0x00000202U, 0x00800200U, 0x00800200U, 0x00000000U,
+		0x00008002U, 0x00008200U, 0x00000000U, 0x00808002U
+	},
+	{
+		0x40084010U, 0x40004000U, 0x00004000U, 0x00084010U, 0x00080000U, 0x00000010U,
+		0x40080010U, 0x40004010U, 0x40000010U, 0x40084010U, 0x40084000U, 0x40000000U,
+		0x40004000U, 0x00080000U, 0x00000010U, 0x40080010U, 0x00084000U, 0x00080010U,
+		0x40004010U, 0x00000000U, 0x40000000U, 0x00004000U, 0x00084010U, 0x40080000U,
+		0x00080010U, 0x40000010U, 0x00000000U, 0x00084000U, 0x00004010U, 0x40084000U,
+		0x40080000U, 0x00004010U, 0x00000000U, 0x00084010U, 0x40080010U, 0x00080000U,
+		0x40004010U, 0x40080000U, 0x40084000U, 0x00004000U, 0x40080000U, 0x40004000U,
+		0x00000010U, 0x40084010U, 0x00084010U, 0x00000010U, 0x00004000U, 0x40000000U,
+		0x00004010U, 0x40084000U, 0x00080000U, 0x40000010U, 0x00080010U, 0x40004010U,
+		0x40000010U, 0x00080010U, 0x00084000U, 0x00000000U, 0x40004000U, 0x00004010U,
+		0x40000000U, 0x40080010U, 0x40084010U, 0x00084000U
+	},
+	{
+		0x00000104U, 0x04010100U, 0x00000000U, 0x04010004U, 0x04000100U, 0x00000000U,
+		0x00010104U, 0x04000100U, 0x00010004U, 0x04000004U, 0x04000004U, 0x00010000U,
+		0x04010104U, 0x00010004U, 0x04010000U, 0x00000104U, 0x04000000U, 0x00000004U,
+		0x04010100U, 0x00000100U, 0x00010100U, 0x04010000U, 0x04010004U, 0x00010104U,
+		0x04000104U, 0x00010100U, 0x00010000U, 0x04000104U, 0x00000004U, 0x04010104U,
+		0x00000100U, 0x04000000U, 0x04010100U, 0x04000000U, 0x00010004U, 0x00000104U,
+		0x00010000U, 0x04010100U, 0x04000100U, 0x00000000U, 0x00000100U, 0x00010004U,
+		0x04010104U, 0x04000100U, 0x04000004U, 0x00000100U, 0x00000000U, 0x04010004U,
+		0x04000104U, 0x00010000U, 0x04000000U, 0x04010104U, 0x00000004U, 0x00010104U,
+		0x00010100U, 0x04000004U, 0x04010000U, 0x04000104U, 0x00000104U, 0x04010000U,
+		0x00010104U, 0x00000004U, 0x04010004U, 0x00010100U
+	},
+	{
+		0x80401000U, 0x80001040U, 0x80001040U, 0x00000040U, 0x00401040U, 0x80400040U,
+		0x80400000U, 0x80001000U, 0x00000000U, 0x00401000U, 0x00401000U, 0x80401040U,
+		0x80000040U, 0x00000000U, 0x00400040U, 0x80400000U, 0x80000000U, 0x00001000U,
+		0x00400000U, 0x80401000U, 0x00000040U, 0x00400000U, 0x80001000U, 0x00001040U,
+		0x80400040U, 0x80000000U, 0x00001040U, 0x00400040U, 0x00001000U, 0x00401040U,
+		0x80401040U, 0x80000040U, 0x00400040U, 0x80400000U, 0x00401000U, 0x80401040U,
+		0x80000040U, 0x00000000U, 0x00000000U, 0x00401000U, 0x00001040U, 0x00400040U,
+		0x80400040U, 0x80000000U, 0x80401000U, 0x80001040U, 0x80001040U, 0x00000040U,
+		0x80401040U, 0x80000040U, 0x80000000U, 0x00001000U, 0x80400000U, 0x80001000U,
+		0x00401040U, 0x80400040U, 0x80001000U, 0x00001040U, 0x00400000U, 0x80401000U,
+		0x00000040U, 0x00400000U, 0x00001000U, 0x00401040U
+	},
+	{
+		0x00000080U, 0x01040080U, 0x01040000U, 0x21000080U, 0x00040000U, 0x00000080U,
+		0x20000000U, 0x01040000U, 0x20040080U, 0x00040000U, 0x01000080U, 0x20040080U,
+		0x21000080U, 0x21040000U, 0x00040080U, 0x20000000U, 0x01000000U, 0x20040000U,
+		0x20040000U, 0x00000000U, 0x20000080U, 0x21040080U, 0x21040080U, 0x01000080U,
+		0x21040000U, 0x20000080U, 0x00000000U, 0x21000000U, 0x01040080U, 0x01000000U,
+		0x21000000U, 0x00040080U, 0x00040000U, 0x21000080U, 0x00000080U, 0x01000000U,
+		0x20000000U, 0x01040000U, 0x21000080U, 0x20040080U, 0x01000080U, 0x20000000U,
+		0x21040000U, 0x01040080U, 0x20040080U, 0x00000080U, 0x01000000U, 0x21040000U,
+		0x21040080U, 0x00040080U, 0x21000000U, 0x21040080U, 0x01040000U, 0x00000000U,
+		0x20040000U, 0x21000000U, 0x00040080U, 0x01000080U, 0x20000080U, 0x00040000U,
+		0x00000000U, 0x20040000U, 0x01040080U, 0x20000080U
+	},
+	{
+		0x10000008U, 0x10200000U, 0x00002000U, 0x10202008U, 0x10200000U, 0x00000008U,
+		0x10202008U, 0x00200000U, 0x10002000U, 0x00202008U, 0x00200000U, 0x10000008U,
+		0x00200008U, 0x10002000U, 0x10000000U, 0x00002008U, 0x00000000U, 0x00200008U,
+		0x10002008U, 0x00002000U, 0x00202000U, 0x10002008U, 0x00000008U, 0x10200008U,
+		0x10200008U, 0x00000000U, 0x00202008U, 0x10202000U, 0x00002008U, 0x00202000U,
+		0x10202000U, 0x10000000U, 0x10002000U, 0x00000008U, 0x10200008U, 0x00202000U,
+		0x10202008U, 0x00200000U, 0x00002008U, 0x10000008U, 0x00200000U, 0x10002000U,
+		0x10000000U, 0x00002008U, 0x10000008U, 0x10202008U, 0x00202000U, 0x10200000U,
+		0x00202008U, 0x10202000U, 0x00000000U, 0x10200008U, 0x00000008U, 0x00002000U,
+		0x10200000U, 0x00202008U, 0x00002000U, 0x00200008U, 0x10002008U, 0x00000000U,
+		0x10202000U, 0x10000000U, 0x00200008U, 0x10002008U
+	},
+	{
+		0x00100000U, 0x02100001U, 0x02000401U, 0x00000000U, 0x00000400U, 0x02000401U,
+		0x00100401U, 0x02100400U, 0x02100401U, 0x00100000U, 0x00000000U, 0x02000001U,
+		0x00000001U, 0x02000000U, 0x02100001U, 0x00000401U, 0x02000400U, 0x00100401U,
+		0x00100001U, 0x02000400U, 0x02000001U, 0x02100000U, 0x02100400U, 0x00100001U,
+		0x02100000U, 0x00000400U, 0x00000401U, 0x02100401U, 0x00100400U, 0x00000001U,
+		0x02000000U, 0x00100400U, 0x02000000U, 0x00100400U, 0x00100000U, 0x02000401U,
+		0x02000401U, 0x02100001U, 0x02100001U, 0x00000001U, 0x00100001U, 0x02000000U,
+		0x02000400U, 0x00100000U, 0x02100400U, 0x00000401U, 0x00100401U, 0x02100400U,
+		0x00000401U, 0x02000001U, 0x02100401U, 0x02100000U, 0x00100400U, 0x00000000U,
+		0x00000001U, 0x02100401U, 0x00000000U, 0x00100401U, 0x02100000U, 0x00000400U,
+		0x02000001U, 0x02000400U, 0x00000400U, 0x00100001U
+	},
+	{
+		0x08000820U, 0x00000800U, 0x00020000U, 0x08020820U, 0x08000000U, 0x08000820U,
+		0x00000020U, 0x08000000U, 0x00020020U, 0x08020000U, 0x08020820U, 0x00020800U,
+		0x08020800U, 0x00020820U, 0x00000800U, 0x00000020U, 0x08020000U, 0x08000020U,
+		0x08000800U, 0x00000820U, 0x00020800U, 0x00020020U, 0x08020020U, 0x08020800U,
+		0x00000820U, 0x00000000U, 0x00000000U, 0x08020020U, 0x08000020U, 0x08000800U,
+		0x00020820U, 0x00020000U, 0x00020820U, 0x00020000U, 0x08020800U, 0x00000800U,
+		0x00000020U, 0x08020020U, 0x00000800U, 0x00020820U, 0x08000800U, 0x00000020U,
+		0x08000020U, 0x08020000U, 0x08020020U, 0x08000000U, 0x00020000U, 0x08000820U,
+		0x00000000U, 0x08020820U, 0x00020020U, 0x08000020U, 0x08020000U, 0x08000800U,
+		0x08000820U, 0x00000000U, 0x08020820U, 0x00020800U, 0x00020800U, 0x00000820U,
+		0x00000820U, 0x00020020U, 0x08000000U, 0x08020800U
+	}
+};
+
+static const uint64_t des_ip[16][16] = {
+	{
+		0x0000000000000000ULL, 0x0001000000000000ULL, 0x0000000000010000ULL,
+		0x0001000000010000ULL, 0x0100000000000000ULL, 0x0101000000000000ULL,
+		0x0100000000010000ULL, 0x0101000000010000ULL, 0x0000000001000000ULL,
+		0x0001000001000000ULL, 0x0000000001010000ULL, 0x0001000001010000ULL,
+		0x0100000001000000ULL, 0x0101000001000000ULL, 0x0100000001010000ULL,
+		0x0101000001010000ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0000000100000000ULL, 0x0000000000000001ULL,
+		0x0000000100000001ULL, 0x0000010000000000ULL, 0x0000010100000000ULL,
+		0x0000010000000001ULL, 0x0000010100000001ULL, 0x0000000000000100ULL,
+		0x0000000100000100ULL, 0x0000000000000101ULL, 0x0000000100000101ULL,
+		0x0000010000000100ULL, 0x0000010100000100ULL, 0x0000010000000101ULL,
+		0x0000010100000101ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0002000000000000ULL, 0x0000000000020000ULL,
+		0x0002000000020000ULL, 0x0200000000000000ULL, 0x0202000000000000ULL,
+		0x0200000000020000ULL, 0x0202000000020000ULL, 0x0000000002000000ULL,
+		0x0002000002000000ULL, 0x0000000002020000ULL, 0x0002000002020000ULL,
+		0x0200000002000000ULL, 0x0202000002000000ULL, 0x0200000002020000ULL,
+		0x0202000002020000ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0000000200000000ULL, 0x0000000000000002ULL,
+		0x0000000200000002ULL, 0x0000020000000000ULL, 0x0000020200000000ULL,
+		0x0000020000000002ULL, 0x0000020200000002ULL, 0x0000000000000200ULL,
+		0x0000000200000200ULL, 0x0000000000000202ULL, 0x0000000200000202ULL,
+		0x0000020000000200ULL, 0x0000020200000200ULL, 0x0000020000000202ULL,
+		0x0000020200000202ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0004000000000000ULL, 0x0000000000040000ULL,
+		0x0004000000040000ULL, 0x0400000000000000ULL, 0x0404000000000000ULL,
+		0x0400000000040000ULL, 0x0404000000040000ULL, 0x0000000004000000ULL,
+		0x0004000004000000ULL, 0x0000000004040000ULL, 0x0004000004040000ULL,
+		0x0400000004000000ULL, 0x0404000004000000ULL, 0x0400000004040000ULL,
+		0x0404000004040000ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0000000400000000ULL, 0x0000000000000004ULL,
+		0x0000000400000004ULL, 0x0000040000000000ULL, 0x0000040400000000ULL,
+		0x0000040000000004ULL, 0x0000040400000004ULL, 0x0000000000000400ULL,
+		0x0000000400000400ULL, 0x0000000000000404ULL, 0x0000000400000404ULL,
+		0x0000040000000400ULL, 0x0000040400000400ULL, 0x0000040000000404ULL,
+		0x0000040400000404ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0008000000000000ULL, 0x0000000000080000ULL,
+		0x0008000000080000ULL, 0x0800000000000000ULL, 0x0808000000000000ULL,
+		0x0800000000080000ULL, 0x0808000000080000ULL, 0x0000000008000000ULL,
+		0x0008000008000000ULL, 0x0000000008080000ULL, 0x0008000008080000ULL,
+		0x0800000008000000ULL, 0x0808000008000000ULL, 0x0800000008080000ULL,
+		0x0808000008080000ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0000000800000000ULL, 0x0000000000000008ULL,
+		0x0000000800000008ULL, 0x0000080000000000ULL, 0x0000080800000000ULL,
+		0x0000080000000008ULL, 0x0000080800000008ULL, 0x0000000000000800ULL,
+		0x0000000800000800ULL, 0x0000000000000808ULL, 0x0000000800000808ULL,
+		0x0000080000000800ULL, 0x0000080800000800ULL, 0x0000080000000808ULL,
+		0x0000080800000808ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0010000000000000ULL, 0x0000000000100000ULL,
+		0x0010000000100000ULL, 0x1000000000000000ULL, 0x1010000000000000ULL,
+		0x1000000000100000ULL, 0x1010000000100000ULL, 0x0000000010000000ULL,
+		0x0010000010000000ULL, 0x0000000010100000ULL, 0x0010000010100000ULL,
+		0x1000000010000000ULL, 0x1010000010000000ULL, 0x1000000010100000ULL,
+		0x1010000010100000ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0000001000000000ULL, 0x0000000000000010ULL,
+		0x0000001000000010ULL, 0x0000100000000000ULL, 0x0000101000000000ULL,
+		0x0000100000000010ULL, 0x0000101000000010ULL, 0x0000000000001000ULL,
+		0x0000001000001000ULL, 0x0000000000001010ULL, 0x0000001000001010ULL,
+		0x0000100000001000ULL, 0x0000101000001000ULL, 0x0000100000001010ULL,
+		0x0000101000001010ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0020000000000000ULL, 0x0000000000200000ULL,
+		0x0020000000200000ULL, 0x2000000000000000ULL, 0x2020000000000000ULL,
+		0x2000000000200000ULL, 0x2020000000200000ULL, 0x0000000020000000ULL,
+		0x0020000020000000ULL, 0x0000000020200000ULL, 0x0020000020200000ULL,
+		0x2000000020000000ULL, 0x2020000020000000ULL, 0x2000000020200000ULL,
+		0x2020000020200000ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0000002000000000ULL, 0x0000000000000020ULL,
+		0x0000002000000020ULL, 0x0000200000000000ULL, 0x0000202000000000ULL,
+		0x0000200000000020ULL, 0x0000202000000020ULL, 0x0000000000002000ULL,
+		0x0000002000002000ULL, 0x0000000000002020ULL, 0x0000002000002020ULL,
+		0x0000200000002000ULL, 0x0000202000002000ULL, 0x0000200000002020ULL,
+		0x0000202000002020ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0040000000000000ULL, 0x0000000000400000ULL,
+		0x0040000000400000ULL, 0x4000000000000000ULL, 0x4040000000000000ULL,
+		0x4000000000400000ULL, 0x4040000000400000ULL, 0x0000000040000000ULL,
+		0x0040000040000000ULL, 0x0000000040400000ULL, 0x0040000040400000ULL,
+		0x4000000040000000ULL, 0x4040000040000000ULL, 0x4000000040400000ULL,
+		0x4040000040400000ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0000004000000000ULL, 0x0000000000000040ULL,
+		0x0000004000000040ULL, 0x0000400000000000ULL, 0x0000404000000000ULL,
+		0x0000400000000040ULL, 0x0000404000000040ULL, 0x0000000000004000ULL,
+		0x0000004000004000ULL, 0x0000000000004040ULL, 0x0000004000004040ULL,
+		0x0000400000004000ULL, 0x0000404000004000ULL, 0x0000400000004040ULL,
+		0x0000404000004040ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0080000000000000ULL, 0x0000000000800000ULL,
+		0x0080000000800000ULL, 0x8000000000000000ULL, 0x8080000000000000ULL,
+		0x8000000000800000ULL, 0x8080000000800000ULL, 0x0000000080000000ULL,
+		0x0080000080000000ULL, 0x0000000080800000ULL, 0x0080000080800000ULL,
+		0x8000000080000000ULL, 0x8080000080000000ULL, 0x8000000080800000ULL,
+		0x8080000080800000ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0000008000000000ULL, 0x0000000000000080ULL,
+		0x0000008000000080ULL, 0x0000800000000000ULL, 0x0000808000000000ULL,
+		0x0000800000000080ULL, 0x0000808000000080ULL, 0x0000000000008000ULL,
+		0x0000008000008000ULL, 0x0000000000008080ULL, 0x0000008000008080ULL,
+		0x0000800000008000ULL, 0x0000808000008000ULL, 0x0000800000008080ULL,
+		0x0000808000008080ULL
+	}
+};
+
+static const uint64_t des_fp[16][16] = {
+	{
+		0x0000000000000000ULL, 0x0000000040000000ULL, 0x0000000000400000ULL,
+		0x0000000040400000ULL, 0x0000000000004000ULL, 0x0000000040004000ULL,
+		0x0000000000404000ULL, 0x0000000040404000ULL, 0x0000000000000040ULL,
+		0x0000000040000040ULL, 0x0000000000400040ULL, 0x0000000040400040ULL,
+		0x0000000000004040ULL, 0x0000000040004040ULL, 0x0000000000404040ULL,
+		0x0000000040404040ULL
+	},
+	{
+		0x0000000000000000ULL, 0x4000000000000000ULL, 0x0040000000000000ULL,
+		0x4040000000000000ULL, 0x0000400000000000ULL, 0x4000400000000000ULL,
+		0x0040400000000000ULL, 0x4040400000000000ULL, 0x0000004000000000ULL,
+		0x4000004000000000ULL, 0x0040004000000000ULL, 0x4040004000000000ULL,
+		0x0000404000000000ULL, 0x4000404000000000ULL, 0x0040404000000000ULL,
+		0x4040404000000000ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0000000010000000ULL, 0x0000000000100000ULL,
+		0x0000000010100000ULL, 0x0000000000001000ULL, 0x0000000010001000ULL,
+		0x0000000000101000ULL, 0x0000000010101000ULL, 0x0000000000000010ULL,
+		0x0000000010000010ULL, 0x0000000000100010ULL, 0x0000000010100010ULL,
+		0x0000000000001010ULL, 0x0000000010001010ULL, 0x0000000000101010ULL,
+		0x0000000010101010ULL
+	},
+	{
+		0x0000000000000000ULL, 0x1000000000000000ULL, 0x0010000000000000ULL,
+		0x1010000000000000ULL, 0x0000100000000000ULL, 0x1000100000000000ULL,
+		0x0010100000000000ULL, 0x1010100000000000ULL, 0x0000001000000000ULL,
+		0x1000001000000000ULL, 0x0010001000000000ULL, 0x1010001000000000ULL,
+		0x0000101000000000ULL, 0x1000101000000000ULL, 0x0010101000000000ULL,
+		0x1010101000000000ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0000000004000000ULL, 0x0000000000040000ULL,
+		0x0000000004040000ULL, 0x0000000000000400ULL, 0x0000000004000400ULL,
+		0x0000000000040400ULL, 0x0000000004040400ULL, 0x0000000000000004ULL,
+		0x0000000004000004ULL, 0x0000000000040004ULL, 0x0000000004040004ULL,
+		0x0000000000000404ULL, 0x0000000004000404ULL, 0x0000000000040404ULL,
+		0x0000000004040404ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0400000000000000ULL, 0x0004000000000000ULL,
+		0x0404000000000000ULL, 0x0000040000000000ULL, 0x0400040000000000ULL,
+		0x0004040000000000ULL, 0x0404040000000000ULL, 0x0000000400000000ULL,
+		0x0400000400000000ULL, 0x0004000400000000ULL, 0x0404000400000000ULL,
+		0x0000040400000000ULL, 0x0400040400000000ULL, 0x0004040400000000ULL,
+		0x0404040400000000ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0000000001000000ULL, 0x0000000000010000ULL,
+		0x0000000001010000ULL, 0x0000000000000100ULL, 0x0000000001000100ULL,
+		0x0000000000010100ULL, 0x0000000001010100ULL, 0x0000000000000001ULL,
+		0x0000000001000001ULL, 0x0000000000010001ULL, 0x0000000001010001ULL,
+		0x0000000000000101ULL, 0x0000000001000101ULL, 0x0000000000010101ULL,
+		0x0000000001010101ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0100000000000000ULL, 0x0001000000000000ULL,
+		0x0101000000000000ULL, 0x0000010000000000ULL, 0x0100010000000000ULL,
+		0x0001010000000000ULL, 0x0101010000000000ULL, 0x0000000100000000ULL,
+		0x0100000100000000ULL, 0x0001000100000000ULL, 0x0101000100000000ULL,
+		0x0000010100000000ULL, 0x0100010100000000ULL, 0x0001010100000000ULL,
+		0x0101010100000000ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0000000080000000ULL, 0x0000000000800000ULL,
+		0x0000000080800000ULL, 0x0000000000008000ULL, 0x0000000080008000ULL,
+		0x0000000000808000ULL, 0x0000000080808000ULL, 0x0000000000000080ULL,
+		0x0000000080000080ULL, 0x0000000000800080ULL, 0x0000000080800080ULL,
+		0x0000000000008080ULL, 0x0000000080008080ULL, 0x0000000000808080ULL,
+		0x0000000080808080ULL
+	},
+	{
+		0x0000000000000000ULL, 0x8000000000000000ULL, 0x0080000000000000ULL,
+		0x8080000000000000ULL, 0x0000800000000000ULL, 0x8000800000000000ULL,
+		0x0080800000000000ULL, 0x8080800000000000ULL, 0x0000008000000000ULL,
+		0x8000008000000000ULL, 0x0080008000000000ULL, 0x8080008000000000ULL,
+		0x0000808000000000ULL, 0x8000808000000000ULL, 0x0080808000000000ULL,
+		0x8080808000000000ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0000000020000000ULL, 0x0000000000200000ULL,
+		0x0000000020200000ULL, 0x0000000000002000ULL, 0x0000000020002000ULL,
+		0x0000000000202000ULL, 0x0000000020202000ULL, 0x0000000000000020ULL,
+		0x0000000020000020ULL, 0x0000000000200020ULL, 0x0000000020200020ULL,
+		0x0000000000002020ULL, 0x0000000020002020ULL, 0x0000000000202020ULL,
+		0x0000000020202020ULL
+	},
+	{
+		0x0000000000000000ULL, 0x2000000000000000ULL, 0x0020000000000000ULL,
+		0x2020000000000000ULL, 0x0000200000000000ULL, 0x2000200000000000ULL,
+		0x0020200000000000ULL, 0x2020200000000000ULL, 0x0000002000000000ULL,
+		0x2000002000000000ULL, 0x0020002000000000ULL, 0x2020002000000000ULL,
+		0x0000202000000000ULL, 0x2000202000000000ULL, 0x0020202000000000ULL,
+		0x2020202000000000ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0000000008000000ULL, 0x0000000000080000ULL,
+		0x0000000008080000ULL, 0x0000000000000800ULL, 0x0000000008000800ULL,
+		0x0000000000080800ULL, 0x0000000008080800ULL, 0x0000000000000008ULL,
+		0x0000000008000008ULL, 0x0000000000080008ULL, 0x0000000008080008ULL,
+		0x0000000000000808ULL, 0x0000000008000808ULL, 0x0000000000080808ULL,
+		0x0000000008080808ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0800000000000000ULL, 0x0008000000000000ULL,
+		0x0808000000000000ULL, 0x0000080000000000ULL, 0x0800080000000000ULL,
+		0x0008080000000000ULL, 0x0808080000000000ULL, 0x0000000800000000ULL,
+		0x0800000800000000ULL, 0x0008000800000000ULL, 0x0808000800000000ULL,
+		0x0000080800000000ULL, 0x0800080800000000ULL, 0x0008080800000000ULL,
+		0x0808080800000000ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0000000002000000ULL, 0x0000000000020000ULL,
+		0x0000000002020000ULL, 0x0000000000000200ULL, 0x0000000002000200ULL,
+		0x0000000000020200ULL, 0x0000000002020200ULL, 0x0000000000000002ULL,
+		0x0000000002000002ULL, 0x0000000000020002ULL, 0x0000000002020002ULL,
+		0x0000000000000202ULL, 0x0000000002000202ULL, 0x0000000000020202ULL,
+		0x0000000002020202ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0200000000000000ULL, 0x0002000000000000ULL,
+		0x0202000000000000ULL, 0x0000020000000000ULL, 0x0200020000000000ULL,
+		0x0002020000000000ULL, 0x0202020000000000ULL, 0x0000000200000000ULL,
+		0x0200000200000000ULL, 0x0002000200000000ULL, 0x0202000200000000ULL,
+		0x0000020200000000ULL, 0x0200020200000000ULL, 0x0002020200000000ULL,
+		0x0202020200000000ULL
+	}
+};
+
+static const uint64_t des_pc1[16][16] = {
+	{
+		0x0000000000000000ULL, 0x0000000000000001ULL, 0x0000000100000000ULL,
+		0x0000000100000001ULL, 0x0000010000000000ULL, 0x0000010000000001ULL,
+		0x0000010100000000ULL, 0x0000010100000001ULL, 0x0001000000000000ULL,
+		0x0001000000000001ULL, 0x0001000100000000ULL, 0x0001000100000001ULL,
+		0x0001010000000000ULL, 0x0001010000000001ULL, 0x0001010100000000ULL,
+		0x0001010100000001ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000100000ULL,
+		0x0000000000100000ULL, 0x0000000000001000ULL, 0x0000000000001000ULL,
+		0x0000000000101000ULL, 0x0000000000101000ULL, 0x0000000000000010ULL,
+		0x0000000000000010ULL, 0x0000000000100010ULL, 0x0000000000100010ULL,
+		0x0000000000001010ULL, 0x0000000000001010ULL, 0x0000000000101010ULL,
+		0x0000000000101010ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0000000000000002ULL, 0x0000000200000000ULL,
+		0x0000000200000002ULL, 0x0000020000000000ULL, 0x0000020000000002ULL,
+		0x0000020200000000ULL, 0x0000020200000002ULL, 0x0002000000000000ULL,
+		0x0002000000000002ULL, 0x0002000200000000ULL, 0x0002000200000002ULL,
+		0x0002020000000000ULL, 0x0002020000000002ULL, 0x0002020200000000ULL,
+		0x0002020200000002ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000200000ULL,
+		0x0000000000200000ULL, 0x0000000000002000ULL, 0x0000000000002000ULL,
+		0x0000000000202000ULL, 0x0000000000202000ULL, 0x0000000000000020ULL,
+		0x0000000000000020ULL, 0x0000000000200020ULL, 0x0000000000200020ULL,
+		0x0000000000002020ULL, 0x0000000000002020ULL, 0x0000000000202020ULL,
+		0x0000000000202020ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0000000000000004ULL, 0x0000000400000000ULL,
+		0x0000000400000004ULL, 0x0000040000000000ULL, 0x0000040000000004ULL,
+		0x0000040400000000ULL, 0x0000040400000004ULL, 0x0004000000000000ULL,
+		0x0004000000000004ULL, 0x0004000400000000ULL, 0x0004000400000004ULL,
+		0x0004040000000000ULL, 0x0004040000000004ULL, 0x0004040400000000ULL,
+		0x0004040400000004ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000400000ULL,
+		0x0000000000400000ULL, 0x0000000000004000ULL, 0x0000000000004000ULL,
+		0x0000000000404000ULL, 0x0000000000404000ULL, 0x0000000000000040ULL,
+		0x0000000000000040ULL, 0x0000000000400040ULL, 0x0000000000400040ULL,
+		0x0000000000004040ULL, 0x0000000000004040ULL, 0x0000000000404040ULL,
+		0x0000000000404040ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0000000000000008ULL, 0x0000000800000000ULL,
+		0x0000000800000008ULL, 0x0000080000000000ULL, 0x0000080000000008ULL,
+		0x0000080800000000ULL, 0x0000080800000008ULL, 0x0008000000000000ULL,
+		0x0008000000000008ULL, 0x0008000800000000ULL, 0x0008000800000008ULL,
+		0x0008080000000000ULL, 0x0008080000000008ULL, 0x0008080800000000ULL,
+		0x0008080800000008ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000800000ULL,
+		0x0000000000800000ULL, 0x0000000000008000ULL, 0x0000000000008000ULL,
+		0x0000000000808000ULL, 0x0000000000808000ULL, 0x0000000000000080ULL,
+		0x0000000000000080ULL, 0x0000000000800080ULL, 0x0000000000800080ULL,
+		0x0000000000008080ULL, 0x0000000000008080ULL, 0x0000000000808080ULL,
+		0x0000000000808080ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0000000010000000ULL, 0x0000001000000000ULL,
+		0x0000001010000000ULL, 0x0000100000000000ULL, 0x0000100010000000ULL,
+		0x0000101000000000ULL, 0x0000101010000000ULL, 0x0010000000000000ULL,
+		0x0010000010000000ULL, 0x0010001000000000ULL, 0x0010001010000000ULL,
+		0x0010100000000000ULL, 0x0010100010000000ULL, 0x0010101000000000ULL,
+		0x0010101010000000ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000001000000ULL,
+		0x0000000001000000ULL, 0x0000000000010000ULL, 0x0000000000010000ULL,
+		0x0000000001010000ULL, 0x0000000001010000ULL, 0x0000000000000100ULL,
+		0x0000000000000100ULL, 0x0000000001000100ULL, 0x0000000001000100ULL,
+		0x0000000000010100ULL, 0x0000000000010100ULL, 0x0000000001010100ULL,
+		0x0000000001010100ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0000000020000000ULL, 0x0000002000000000ULL,
+		0x0000002020000000ULL, 0x0000200000000000ULL, 0x0000200020000000ULL,
+		0x0000202000000000ULL, 0x0000202020000000ULL, 0x0020000000000000ULL,
+		0x0020000020000000ULL, 0x0020002000000000ULL, 0x0020002020000000ULL,
+		0x0020200000000000ULL, 0x0020200020000000ULL, 0x0020202000000000ULL,
+		0x0020202020000000ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000002000000ULL,
+		0x0000000002000000ULL, 0x0000000000020000ULL, 0x0000000000020000ULL,
+		0x0000000002020000ULL, 0x0000000002020000ULL, 0x0000000000000200ULL,
+		0x0000000000000200ULL, 0x0000000002000200ULL, 0x0000000002000200ULL,
+		0x0000000000020200ULL, 0x0000000000020200ULL, 0x0000000002020200ULL,
+		0x0000000002020200ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0000000040000000ULL, 0x0000004000000000ULL,
+		0x0000004040000000ULL, 0x0000400000000000ULL, 0x0000400040000000ULL,
+		0x0000404000000000ULL, 0x0000404040000000ULL, 0x0040000000000000ULL,
+		0x0040000040000000ULL, 0x0040004000000000ULL, 0x0040004040000000ULL,
+		0x0040400000000000ULL, 0x0040400040000000ULL, 0x0040404000000000ULL,
+		0x0040404040000000ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000004000000ULL,
+		0x0000000004000000ULL, 0x0000000000040000ULL, 0x0000000000040000ULL,
+		0x0000000004040000ULL, 0x0000000004040000ULL, 0x0000000000000400ULL,
+		0x0000000000000400ULL, 0x0000000004000400ULL, 0x0000000004000400ULL,
+		0x0000000000040400ULL, 0x0000000000040400ULL, 0x0000000004040400ULL,
+		0x0000000004040400ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0000000080000000ULL, 0x0000008000000000ULL,
+		0x0000008080000000ULL, 0x0000800000000000ULL, 0x0000800080000000ULL,
+		0x0000808000000000ULL, 0x0000808080000000ULL, 0x0080000000000000ULL,
+		0x0080000080000000ULL, 0x0080008000000000ULL, 0x0080008080000000ULL,
+		0x0080800000000000ULL, 0x0080800080000000ULL, 0x0080808000000000ULL,
+		0x0080808080000000ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000008000000ULL,
+		0x0000000008000000ULL, 0x0000000000080000ULL, 0x0000000000080000ULL,
+		0x0000000008080000ULL, 0x0000000008080000ULL, 0x0000000000000800ULL,
+		0x0000000000000800ULL, 0x0000000008000800ULL, 0x0000000008000800ULL,
+		0x0000000000080800ULL, 0x0000000000080800ULL, 0x0000000008080800ULL,
+		0x0000000008080800ULL
+	}
+};
+
+static const uint32_t des_pc2c[7][16] = {
+	{
+		0x000000U, 0x000100U, 0x020000U, 0x020100U, 0x000001U, 0x000101U, 0x020001U, 0x020101U,
+		0x080000U, 0x080100U, 0x0A0000U, 0x0A0100U, 0x080001U, 0x080101U, 0x0A0001U, 0x0A0101U
+	},
+	{
+		0x000000U, 0x000040U, 0x000010U, 0x000050U, 0x004000U, 0x004040U, 0x004010U, 0x004050U,
+		0x040000U, 0x040040U, 0x040010U, 0x040050U, 0x044000U, 0x044040U, 0x044010U, 0x044050U
+	},
+	{
+		0x000000U, 0x000200U, 0x200000U, 0x200200U, 0x001000U, 0x001200U, 0x201000U, 0x201200U,
+		0x000000U, 0x000200U, 0x200000U, 0x200200U, 0x001000U, 0x001200U, 0x201000U, 0x201200U
+	},
+	{
+		0x000000U, 0x000020U, 0x008000U, 0x008020U, 0x800000U, 0x800020U, 0x808000U, 0x808020U,
+		0x000002U, 0x000022U, 0x008002U, 0x008022U, 0x800002U, 0x800022U, 0x808002U, 0x808022U
+	},
+	{
+		0x000000U, 0x000004U, 0x000400U, 0x000404U, 0x000000U, 0x000004U, 0x000400U, 0x000404U,
+		0x400000U, 0x400004U, 0x400400U, 0x400404U, 0x400000U, 0x400004U, 0x400400U, 0x400404U
+	},
+	{
+		0x000000U, 0x100000U, 0x000800U, 0x100800U, 0x000000U, 0x100000U, 0x000800U, 0x100800U,
+		0x002000U, 0x102000U, 0x002800U, 0x102800U, 0x002000U, 0x102000U, 0x002800U, 0x102800U
+	},
+	{
+		0x000000U, 0x010000U, 0x000008U, 0x010008U, 0x000080U, 0x010080U, 0x000088U, 0x010088U,
+		0x000000U, 0x010000U, 0x000008U, 0x010008U, 0x000080U, 0x010080U, 0x000088U, 0x010088U
+	}
+};
+
+static const uint32_t des_pc2d[7][16] = {
+	{
+		0x000000U, 0x000001U, 0x200000U, 0x200001U, 0x020000U, 0x020001U, 0x220000U, 0x220001U,
+		0x000002U, 0x000003U, 0x200002U, 0x200003U, 0x020002U, 0x020003U, 0x220002U, 0x220003U
+	},
+	{
+		0x000000U, 0x000004U, 0x000000U, 0x000004U, 0x000080U, 0x000084U, 0x000080U, 0x000084U,
+		0x002000U, 0x002004U, 0x002000U, 0x002004U, 0x002080U, 0x002084U, 0x002080U, 0x002084U
+	},
+	{
+		0x000000U, 0x010000U, 0x000200U, 0x010200U, 0x000000U, 0x010000U, 0x000200U, 0x010200U,
+		0x100000U, 0x110000U, 0x100200U, 0x110200U, 0x100000U, 0x110000U, 0x100200U, 0x110200U
+	},
+	{
+		0x000000U, 0x000800U, 0x000000U, 0x000800U, 0x000010U, 0x000810U, 0x000010U, 0x000810U,
+		0x800000U, 0x800800U, 0x800000U, 0x800800U, 0x800010U, 0x800810U, 0x800010U, 0x800810U
+	},
+	{
+		0x000000U, 0x001000U, 0x080000U, 0x081000U, 0x000020U, 0x001020U, 0x080020U, 0x081020U,
+		0x004000U, 0x005000U, 0x084000U, 0x085000U, 0x004020U, 0x005020U, 0x084020U, 0x085020U
+	},
+	{
+		0x000000U, 0x400000U, 0x008000U, 0x408000U, 0x000008U, 0x400008U, 0x008008U, 0x408008U,
+		0x000400U, 0x400400U, 0x008400U, 0x408400U, 0x000408U, 0x400408U, 0x008408U, 0x408408U
+	},
+	{
+		0x000000U, 0x000100U, 0x040000U, 0x040100U, 0x000000U, 0x000100U, 0x040000U, 0x040100U,
+		0x000040U, 0x000140U, 0x040040U, 0x040140U, 0x000040U, 0x000140U, 0x040040U, 0x040140U
+	}
+};
+
+/* Bitsliced kernel tables (0 based bit indexes):
+ * des_bs_ip:		Initial permutation
+ * des_bs_e:		Expansion
+ * des_bs_p_inv:	Inverse of the P permutation
+ * The S-boxes themselves are boolean circuits (see des_bs_s1 to des_bs_s8)
+ */
+static const uint8_t des_bs_ip[64] = {
+	57, 49, 41, 33, 25, 17,  9,  1, 59, 51, 43, 35, 27, 19, 11,  3,
+	61, 53, 45, 37, 29, 21, 13,  5, 63, 55, 47, 39, 31, 23, 15,  7,
+	56, 48, 40, 32, 24, 16,  8,  0, 58, 50, 42, 34, 26, 18, 10,  2,
+	60, 52, 44, 36, 28, 20, 12,  4, 62, 54, 46, 38, 30, 22, 14,  6
+};
+static const uint8_t des_bs_e[48] = {
+	31,  0,  1,  2,  3,  4,  3,  4,  5,  6,  7,  8,  7,  8,  9, 10,
+	11, 12, 11, 12, 13, 14, 15, 16, 15, 16, 17, 18, 19, 20, 19, 20,
+	21, 22, 23, 24, 23, 24, 25, 26, 27, 28, 27, 28, 29, 30, 31,  0
+};
+static const uint8_t des_bs_p_inv[32] = {
+	 8, 16, 22, 30, 12, 27,  1, 17, 23, 15, 29,  5, 25, 19,  9,  0,
+	 7, 13, 24,  2,  3, 28, 10, 18, 31, 11, 21,  6,  4, 26, 14, 20
+};
+
+/* Key schedule left shifts */
+static const uint8_t des_shifts[DES_ROUNDS] = {
+	1, 1, 2, 2, 2, 2, 2, 2, 1, 2, 2, 2, 2, 2, 2, 1
+};
+
+/* PC1, the shifts and PC2 only select key bits: the key bit (most significant first) of each round subkey bit */
+static const uint8_t des_bs_key_bit[DES_ROUNDS][48] = {
+	{  9, 50, 33, 59, 48, 16, 32, 56,  1,  8, 18, 41,  2, 34, 25, 24, 43, 57, 58,  0, 35, 26, 17, 40, 21, 27, 38, 53, 36,  3, 46, 29,  4, 52, 22, 28, 60, 20, 37, 62, 14, 19, 44, 13, 12, 61, 54, 30 },
+	{  1, 42, 25, 51, 40,  8, 24, 48, 58,  0, 10, 33, 59, 26, 17, 16, 35, 49, 50, 57, 56, 18,  9, 32, 13, 19, 30, 45, 28, 62, 38, 21, 27, 44, 14, 20, 52, 12, 29, 54,  6, 11, 36,  5,  4, 53, 46, 22 },
+	{ 50, 26,  9, 35, 24, 57,  8, 32, 42, 49, 59, 17, 43, 10,  1,  0, 48, 33, 34, 41, 40,  2, 58, 16, 60,  3, 14, 29, 12, 46, 22,  5, 11, 28, 61,  4, 36, 27, 13, 38, 53, 62, 20, 52, 19, 37, 30,  6 },
+	{ 34, 10, 58, 48,  8, 41, 57, 16, 26, 33, 43,  1, 56, 59, 50, 49, 32, 17, 18, 25, 24, 51, 42,  0, 44, 54, 61, 13, 27, 30,  6, 52, 62, 12, 45, 19, 20, 11, 60, 22, 37, 46,  4, 36,  3, 21, 14, 53 },
+	{ 18, 59, 42, 32, 57, 25, 41,  0, 10, 17, 56, 50, 40, 43, 34, 33, 16,  1,  2,  9,  8, 35, 26, 49, 28, 38, 45, 60, 11, 14, 53, 36, 46, 27, 29,  3,  4, 62, 44,  6, 21, 30, 19, 20, 54,  5, 61, 37 },
+	{  2, 43, 26, 16, 41,  9, 25, 49, 59,  1, 40, 34, 24, 56, 18, 17,  0, 50, 51, 58, 57, 48, 10, 33, 12, 22, 29, 44, 62, 61, 37, 20, 30, 11, 13, 54, 19, 46, 28, 53,  5, 14,  3,  4, 38, 52, 45, 21 },
+	{ 51, 56, 10,  0, 25, 58,  9, 33, 43, 50, 24, 18,  8, 40,  2,  1, 49, 34, 35, 42, 41, 32, 59, 17, 27,  6, 13, 28, 46, 45, 21,  4, 14, 62, 60, 38,  3, 30, 12, 37, 52, 61, 54, 19, 22, 36, 29,  5 },
+	{ 35, 40, 59, 49,  9, 42, 58, 17, 56, 34,  8,  2, 57, 24, 51, 50, 33, 18, 48, 26, 25, 16, 43,  1, 11, 53, 60, 12, 30, 29,  5, 19, 61, 46, 44, 22, 54, 14, 27, 21, 36, 45, 38,  3,  6, 20, 13, 52 },
+	{ 56, 32, 51, 41,  1, 34, 50,  9, 48, 26,  0, 59, 49, 16, 43, 42, 25, 10, 40, 18, 17,  8, 35, 58,  3, 45, 52,  4, 22, 21, 60, 11, 53, 38, 36, 14, 46,  6, 19, 13, 28, 37, 30, 62, 61, 12,  5, 44 },
+	{ 40, 16, 35, 25, 50, 18, 34, 58, 32, 10, 49, 43, 33,  0, 56, 26,  9, 59, 24,  2,  1, 57, 48, 42, 54, 29, 36, 19,  6,  5, 44, 62, 37, 22, 20, 61, 30, 53,  3, 60, 12, 21, 14, 46, 45, 27, 52, 28 },
+	{ 24,  0, 48,  9, 34,  2, 18, 42, 16, 59, 33, 56, 17, 49, 40, 10, 58, 43,  8, 51, 50, 41, 32, 26, 38, 13, 20,  3, 53, 52, 28, 46, 21,  6,  4, 45, 14, 37, 54, 44, 27,  5, 61, 30, 29, 11, 36, 12 },
+	{  8, 49, 32, 58, 18, 51,  2, 26,  0, 43, 17, 40,  1, 33, 24, 59, 42, 56, 57, 35, 34, 25, 16, 10, 22, 60,  4, 54, 37, 36, 12, 30,  5, 53, 19, 29, 61, 21, 38, 28, 11, 52, 45, 14, 13, 62, 20, 27 },
+	{ 57, 33, 16, 42,  2, 35, 51, 10, 49, 56,  1, 24, 50, 17,  8, 43, 26, 40, 41, 48, 18,  9,  0, 59,  6, 44, 19, 38, 21, 20, 27, 14, 52, 37,  3, 13, 45,  5, 22, 12, 62, 36, 29, 61, 60, 46,  4, 11 },
+	{ 41, 17,  0, 26, 51, 48, 35, 59, 33, 40, 50,  8, 34,  1, 57, 56, 10, 24, 25, 32,  2, 58, 49, 43, 53, 28,  3, 22,  5,  4, 11, 61, 36, 21, 54, 60, 29, 52,  6, 27, 46, 20, 13, 45, 44, 30, 19, 62 },
+	{ 25,  1, 49, 10, 35, 32, 48, 43, 17, 24, 34, 57, 18, 50, 41, 40, 59,  8,  9, 16, 51, 42, 33, 56, 37, 12, 54,  6, 52, 19, 62, 45, 20,  5, 38, 44, 13, 36, 53, 11, 30,  4, 60, 29, 28, 14,  3, 46 },
+	{ 17, 58, 41,  2, 56, 24, 40, 35,  9, 16, 26, 49, 10, 42, 33, 32, 51,  0,  1,  8, 43, 34, 25, 48, 29,  4, 46, 61, 44, 11, 54, 37, 12, 60, 30, 36,  5, 28, 45,  3, 22, 27, 52, 21, 20,  6, 62, 38 }
+};
+
+
+#define ROR32(x, n)		(((x) >> (n)) | ((x) << (32 - (n))))
+#define ROL28(x, n)		((((x) << (n)) | ((x) >> (28 - (n)))) & 0x0FFFFFFF)
+
+
+/* Apply a nibble-indexed permutation table to a 64 bit value
+ * table:		The permutation table
+ * in:			The input value
+ * RETURN:		The permuted value
+ */
+static inline uint64_t des_permute (const uint64_t table[16][16], uint64_t in)
+{
+	uint64_t out;
+	int n;
+
+	out = 0;
+	for (n = 0; n < 16; n++)
+		out |= table[n][(in >> (60 - 4*n)) & 0xF];
+
+	return out;
+}
+
+
+/* The DES round function: expansion, subkey mixing, S-boxes and P permutation
+ * r:			The right half of the block
+ * k:			The round subkey
+ * RETURN:		The value to be XORed to the left half
+ */
+static inline uint32_t des_f (uint32_t r, const uint8_t *k)
+{
+	return	des_sp[0][(ROR32(r, 27) & 0x3F) ^ k[0]] |
+			des_sp[1][(ROR32(r, 23) & 0x3F) ^ k[1]] |
+			des_sp[2][(ROR32(r, 19) & 0x3F) ^ k[2]] |
+			des_sp[3][(ROR32(r, 15) & 0x3F) ^ k[3]] |
+			des_sp[4][(ROR32(r, 11) & 0x3F) ^ k[4]] |
+			des_sp[5][(ROR32(r,  7) & 0x3F) ^ k[5]] |
+			des_sp[6][(ROR32(r,  3) & 0x3F) ^ k[6]] |
+			des_sp[7][(((r << 1) | (r >> 31)) & 0x3F) ^ k[7]];
+}
+
+
+/* Expand a DES key into the 16 round subkeys
+ * ks:			The output key schedule
+ * key:			The 8 bytes DES key (parity bits are ignored)
+ */
+void des_set_key (des_key_schedule *ks, const unsigned char *key)
+{
+	uint64_t key_64b, cd;
+	uint32_t c, d, k_c, k_d;
+	int round, n;
+
+	key_64b = 0;
+	for (n = 0; n < 8; n++)
+		key_64b = (key_64b << 8) | key[n];
+
+	/* Permuted choice 1, splitting the 56 bits result in the C and D halves */
+	cd = des_permute (des_pc1, key_64b);
+	c = (uint32_t) (cd >> 28) & 0x0FFFFFFF;
+	d = (uint32_t) cd & 0x0FFFFFFF;
+
+	for (round = 0; round < DES_ROUNDS; round++)
+	{
+		c = ROL28(c, des_shifts[round]);
+		d = ROL28(d, des_shifts[round]);
+
+		/* Permuted choice 2 */
+		k_c = 0;
+		k_d = 0;
+		for (n = 0; n < 7; n++)
+		{
+			k_c |= des_pc2c[n][(c >> (24 - 4*n)) & 0xF];
+			k_d |= des_pc2d[n][(d >> (24 - 4*n)) & 0xF];
+		}
+
+		ks->subkey[round][0] = (k_c >> 18) & 0x3F;
+		ks->subkey[round][1] = (k_c >> 12) & 0x3F;
+		ks->subkey[round][2] = (k_c >>  6) & 0x3F;
+		ks->subkey[round][3] = (k_c      ) & 0x3F;
+		ks->subkey[round][4] = (k_d >> 18) & 0x3F;
+		ks->subkey[round][5] = (k_d >> 12) & 0x3F;
+		ks->subkey[round][6] = (k_d >>  6) & 0x3F;
+		ks->subkey[round][7] = (k_d      ) & 0x3F;
+	}
+}
+
+
+/* Decrypts or Encrypts a single 8 bytes block
+ * ks:			The key schedule generated by des_set_key()
+ * in:			The input block
+ * out:			The output block (may be the same as in)
+ * codec:		0: Decryption, 1: Encryption
+ */
+void des_ecb_crypt (const des_key_schedule *ks, const unsigned char *in, unsigned char *out, unsigned char codec)
+{
+	uint64_t block;
+	uint32_t l, r, t;
+	int round, n;
+
+	block = 0;
+	for (n = 0; n < 8; n++)
+		block = (block << 8) | in[n];
+
+	block = des_permute (des_ip, block);
+	l = (uint32_t) (block >> 32);
+	r = (uint32_t) block;
+
+	for (round = 0; round < DES_ROUNDS; round++)
+	{
+		t = r;
+		r = l ^ des_f (r, ks->subkey[codec ? round : DES_ROUNDS - 1 - round]);
+		l = t;
+	}
+
+	/* Undo the last swap and apply the final permutation */
+	block = des_permute (des_fp, ((uint64_t) r << 32) | l);
+
+	for (n = 7; n >= 0; n--)
+	{
+		out[n] = (unsigned char) block;
+		block >>= 8;
+	}
+}
+
+
+/* Transposes a 64x64 bits matrix for each element of the bitsliced words
+ * x:			The 64 words matrix
+ * NOTE: Row i bit (63-j) is swapped with row j bit (63-i)
+ */
+static inline void des_bs_transpose (des_bs_word *x)
+{
+	des_bs_word t;
+	uint64_t m;
+	int j, k;
+
+	m = 0x00000000FFFFFFFFULL;
+	for (j = 32; j; j >>= 1, m ^= m << j)
+	{
+		for (k = 0; k < 64; k = (k + j + 1) & ~j)
+		{
+			t = (x[k] ^ (x[k + j] >> j)) & m;
+			x[k] ^= t;
+			x[k + j] ^= t << j;
+		}
+	}
+}
+
+
+/* The S-boxes as gate-level circuits of NOT, AND, OR, XOR and AND NOT gates
+ * a:			The 6 input words, first S-box input bit first
+ * out:			The 4 output words, first S-box output bit first
+ * NOTE: Synthesized from the S-box tables and checked against them on all the 64 inputs
+ */
+
+/* S1: 109 gates */
+static inline __attribute__ ((always_inline)) void des_bs_s1 (const des_bs_word *a, des_bs_word *out)
+{
+	des_bs_word x6, x7, x8, x9, x10, x11, x12, x13, x14, x15, x16, x17, x18, x19, x20, x21, x22, x23, x24, x25, x26, x27,
+		x28, x29, x30, x31, x32, x33, x34, x36, x37, x38, x39, x40, x41, x42, x43, x44, x45, x46, x47, x48, x49, x50, x51,
+		x52, x53, x54, x55, x56, x57, x58, x59, x60, x61, x62, x63, x64, x65, x66, x68, x69, x70, x71, x72, x73, x74, x75,
+		x76, x77, x78, x79, x80, x81, x82, x83, x84, x85, x86, x87, x88, x89, x90, x91, x92, x93, x95, x96, x97, x98, x99,
+		x100, x101, x102, x103, x104, x105, x106, x107, x108, x109, x110, x111, x112, x113;
+
+	x6 = a[0] ^ a[2];
+	x7 = ~(a[0] ^ a[0]);
+	x8 = x6 ^ a[3];
+	x9 = a[0] & x6;
+	x10 = ~x9;
+	x11 = a[3] & x10;
+	x12 = x9 ^ x11;
+	x13 = ~a[5] & x12;
+	x14 = x8 ^ x13;
+	x15 = a[0] ^ x10;
+	x16 = ~a[3] & x15;
+	x17 = a[0] ^ x16;
+	x18 = a[5] & x17;
+	x19 = x12 ^ x18;
+	x20 = ~a[1] & x19;
+	x21 = x14 ^ x20;
+	x22 = a[2] ^ x16;
+	x23 = a[3] ^ x22;
+	x24 = a[5] & x23;
+	x25 = x22 ^ x24;
+	x26 = a[2] & a[5];
+	x27 = x7 ^ x26;
+	x28 = x27 ^ a[3];
+	x29 = ~a[0] & x28;
+	x30 = a[0] & a[5];
+	x31 = x29 | x30;
+	x32 = ~a[1] & x31;
+	x33 = x25 ^ x32;
+	x34 = ~a[4] & x33;
+	out[3] = x21 ^ x34;
+	x36 = a[2] & x16;
+	x37 = a[5] & x36;
+	x38 = x8 ^ x37;
+	x39 = a[0] | a[5];
+	x40 = a[0] ^ x30;
+	x41 = ~a[3] & x40;
+	x42 = x39 ^ x41;
+	x43 = ~a[5];
+	x44 = a[3] & a[5];
+	x45 = x43 ^ x44;
+	x46 = ~x44;
+	x47 = a[0] & x46;
+	x48 = x45 ^ x47;
+	x49 = a[2] & x48;
+	x50 = x42 ^ x49;
+	x51 = a[4] & x50;
+	x52 = x38 ^ x51;
+	x53 = a[5] ^ x27;
+	x54 = a[3] & x43;
+	x55 = x53 ^ x54;
+	x56 = a[4] & a[3];
+	x57 = x55 ^ x56;
+	x58 = a[2] | a[5];
+	x59 = a[3] & x58;
+	x60 = a[5] ^ x59;
+	x61 = x45 ^ x58;
+	x62 = ~a[4] & x61;
+	x63 = x60 ^ x62;
+	x64 = a[0] & x63;
+	x65 = x57 ^ x64;
+	x66 = ~a[1] & x65;
+	out[1] = x52 ^ x66;
+	x68 = a[1] ^ x43;
+	x69 = ~a[3] & x68;
+	x70 = a[5] ^ x69;
+	x71 = a[2] & x70;
+	x72 = x68 ^ x71;
+	x73 = ~a[2];
+	x74 = ~a[1] & x53;
+	x75 = x73 ^ x74;
+	x76 = x73 & x74;
+	x77 = ~a[3] & x76;
+	x78 = x75 ^ x77;
+	x79 = a[0] & x78;
+	x80 = x72 ^ x79;
+	x81 = ~x15;
+	x82 = a[1] & x81;
+	x83 = x6 ^ x82;
+	x84 = a[2] ^ x10;
+	x85 = ~a[1] & a[0];
+	x86 = x84 ^ x85;
+	x87 = ~a[3] & x86;
+	x88 = x83 ^ x87;
+	x89 = a[1] & x9;
+	x90 = a[3] ^ x89;
+	x91 = ~a[5] & x90;
+	x92 = x88 ^ x91;
+	x93 = a[4] & x92;
+	out[0] = x80 ^ x93;
+	x95 = x55 ^ x59;
+	x96 = x54 ^ x73;
+	x97 = a[4] & x96;
+	x98 = x95 ^ x97;
+	x99 = a[2] ^ x46;
+	x100 = ~a[4] & x99;
+	x101 = x95 ^ x100;
+	x102 = a[1] & x101;
+	x103 = x98 ^ x102;
+	x104 = x45 ^ x60;
+	x105 = ~a[1] & x104;
+	x106 = x43 ^ x105;
+	x107 = x45 & x53;
+	x108 = x53 ^ x96;
+	x109 = a[1] & x108;
+	x110 = x107 ^ x109;
+	x111 = ~a[4] & x110;
+	x112 = x106 ^ x111;
+	x113 = a[0] & x112;
+	out[2] = x103 ^ x113;
+}
+
+
+/* S2: 93 gates */
+static inline __attribute__ ((always_inline)) void des_bs_s2 (const des_bs_word *a, des_bs_word *out)
+{
+	des_bs_word x6, x7, x8, x9, x10, x11, x12, x13, x14, x15, x16, x17, x18, x19, x20, x21, x22, x23, x24, x25, x26, x27,
+		x28, x29, x30, x31, x32, x33, x34, x35, x36, x37, x39, x40, x41, x42, x43, x44, x45, x46, x47, x48, x49, x50, x51,
+		x52, x53, x54, x55, x56, x57, x58, x59, x60, x61, x62, x63, x64, x65, x66, x67, x68, x70, x71, x72, x73, x74, x75,
+		x76, x77, x78, x79, x80, x81, x82, x84, x85, x86, x87, x88, x89, x90, x91, x92, x93, x94, x95, x96, x97;
+
+	x6 = ~(a[0] ^ a[0]);
+	x7 = ~a[4] & x6;
+	x8 = a[3] ^ x7;
+	x9 = a[5] ^ x7;
+	x10 = a[3] & x9;
+	x11 = a[4] ^ x10;
+	x12 = a[2] & x11;
+	x13 = x8 ^ x12;
+	x14 = ~a[5] & a[4];
+	x15 = x7 ^ x14;
+	x16 = a[3] & a[4];
+	x17 = x15 ^ x16;
+	x18 = ~x11;
+	x19 = a[2] & x18;
+	x20 = x17 ^ x19;
+	x21 = a[0] & x20;
+	x22 = x13 ^ x21;
+	x23 = a[3] ^ a[5];
+	x24 = ~a[5];
+	x25 = x23 ^ x14;
+	x26 = ~x25;
+	x27 = a[2] & x26;
+	x28 = x25 ^ x27;
+	x29 = ~a[2] & x23;
+	x30 = ~a[2] & x24;
+	x31 = ~a[3] & a[5];
+	x32 = x30 ^ x31;
+	x33 = ~a[4] & x32;
+	x34 = x29 ^ x33;
+	x35 = ~a[0] & x34;
+	x36 = x28 ^ x35;
+	x37 = a[1] & x36;
+	out[2] = x22 ^ x37;
+	x39 = ~a[0] & a[4];
+	x40 = x7 ^ x39;
+	x41 = ~x39;
+	x42 = a[3] & x41;
+	x43 = x40 ^ x42;
+	x44 = a[2] & a[4];
+	x45 = x43 ^ x44;
+	x46 = a[0] ^ a[4];
+	x47 = a[0] ^ x40;
+	x48 = a[2] & x47;
+	x49 = x46 ^ x48;
+	x50 = ~a[3] & x39;
+	x51 = x49 ^ x50;
+	x52 = ~a[5] & x51;
+	x53 = x45 ^ x52;
+	x54 = ~a[2];
+	x55 = x54 ^ a[3];
+	x56 = ~a[0] & x6;
+	x57 = x55 ^ x56;
+	x58 = a[4] & x57;
+	x59 = a[0] ^ x58;
+	x60 = ~x46;
+	x61 = a[0] ^ x39;
+	x62 = ~a[2] & x61;
+	x63 = x60 ^ x62;
+	x64 = a[3] & x46;
+	x65 = x63 ^ x64;
+	x66 = a[5] & x65;
+	x67 = x59 ^ x66;
+	x68 = a[1] & x67;
+	out[3] = x53 ^ x68;
+	x70 = ~x10 & a[5];
+	x71 = ~a[2] & x70;
+	x72 = x8 ^ x71;
+	x73 = ~x72;
+	x74 = ~a[0] & x72;
+	x75 = a[0] & x73;
+	x76 = x74 | x75;
+	x77 = ~x55 & a[0];
+	x78 = a[4] & x77;
+	x79 = a[3] ^ x78;
+	x80 = ~a[5] & x79;
+	x81 = x54 ^ x80;
+	x82 = a[1] & x81;
+	out[1] = x76 ^ x82;
+	x84 = a[0] ^ x8;
+	x85 = a[2] & a[0];
+	x86 = x84 ^ x85;
+	x87 = a[0] ^ x48;
+	x88 = a[5] & x87;
+	x89 = x86 ^ x88;
+	x90 = a[2] ^ x85;
+	x91 = x47 ^ x90;
+	x92 = a[5] & x91;
+	x93 = x90 ^ x92;
+	x94 = x15 & x41;
+	x95 = a[3] & x94;
+	x96 = x93 ^ x95;
+	x97 = ~a[1] & x96;
+	out[0] = x89 ^ x97;
+}
+
+
+/* S3: 92 gates */
+static inline __attribute__ ((always_inline)) void des_bs_s3 (const des_bs_word *a, des_bs_word *out)
+{
+	des_bs_word x6, x7, x8, x9, x10, x11, x12, x13, x14, x15, x16, x17, x18, x19, x20, x21, x22, x23, x24, x25, x26, x27,
+		x28, x29, x30, x31, x32, x33, x34, x36, x37, x38, x39, x40, x41, x42, x43, x44, x45, x46, x47, x48, x49, x50, x51,
+		x52, x53, x54, x55, x56, x57, x59, x60, x61, x62, x63, x64, x65, x66, x67, x68, x69, x70, x71, x72, x73, x74, x75,
+		x76, x77, x78, x79, x81, x82, x83, x84, x85, x86, x87, x88, x89, x90, x91, x92, x93, x94, x95, x96;
+
+	x6 = ~a[3];
+	x7 = ~a[0] & x6;
+	x8 = a[3] ^ x7;
+	x9 = ~a[1] & x8;
+	x10 = x7 ^ x9;
+	x11 = a[3] ^ x6;
+	x12 = ~a[2] & x11;
+	x13 = x10 ^ x12;
+	x14 = a[1] ^ a[2];
+	x15 = ~a[0] & x14;
+	x16 = x12 ^ x15;
+	x17 = a[3] & x16;
+	x18 = x11 ^ x17;
+	x19 = ~a[4] & x18;
+	x20 = x13 ^ x19;
+	x21 = a[2] ^ x6;
+	x22 = a[2] | x6;
+	x23 = ~a[0] & x22;
+	x24 = x21 ^ x23;
+	x25 = ~a[1] & x24;
+	x26 = x6 ^ x25;
+	x27 = ~a[0];
+	x28 = ~a[2] & x7;
+	x29 = x27 ^ x28;
+	x30 = a[1] & x8;
+	x31 = x29 ^ x30;
+	x32 = a[4] & x31;
+	x33 = x26 ^ x32;
+	x34 = ~a[5] & x33;
+	out[2] = x20 ^ x34;
+	x36 = ~a[5];
+	x37 = x36 ^ a[4];
+	x38 = a[5] | x37;
+	x39 = ~a[1] & x38;
+	x40 = x37 ^ x39;
+	x41 = ~x39;
+	x42 = ~a[2] & x41;
+	x43 = x40 ^ x42;
+	x44 = a[1] ^ x39;
+	x45 = ~a[0] & x44;
+	x46 = x43 ^ x45;
+	x47 = a[2] & x14;
+	x48 = a[5] & x14;
+	x49 = x47 ^ x48;
+	x50 = a[2] & a[5];
+	x51 = ~a[1] & x36;
+	x52 = x50 ^ x51;
+	x53 = ~a[4] & x52;
+	x54 = x49 ^ x53;
+	x55 = ~a[0] & x54;
+	x56 = x11 ^ x55;
+	x57 = ~a[3] & x56;
+	out[0] = x46 ^ x57;
+	x59 = a[0] ^ x51;
+	x60 = ~a[4] & a[5];
+	x61 = x59 ^ x60;
+	x62 = x36 | x39;
+	x63 = a[1] ^ x62;
+	x64 = a[4] & x63;
+	x65 = x62 ^ x64;
+	x66 = ~a[0] & x65;
+	x67 = a[0] & x38;
+	x68 = x66 | x67;
+	x69 = ~a[2] & x68;
+	x70 = x61 ^ x69;
+	x71 = x37 ^ x62;
+	x72 = x41 ^ x64;
+	x73 = ~a[0] & x72;
+	x74 = x71 ^ x73;
+	x75 = a[1] ^ x72;
+	x76 = x75 ^ x73;
+	x77 = a[2] & x76;
+	x78 = x74 ^ x77;
+	x79 = ~a[3] & x78;
+	out[1] = x70 ^ x79;
+	x81 = a[4] ^ x12;
+	x82 = ~a[4] & x21;
+	x83 = x11 ^ x82;
+	x84 = ~a[0] & x83;
+	x85 = x81 ^ x84;
+	x86 = ~a[5] & x8;
+	x87 = x85 ^ x86;
+	x88 = a[2] | a[4];
+	x89 = a[0] & x88;
+	x90 = x27 | x89;
+	x91 = ~x8 & a[2];
+	x92 = ~a[4] & a[0];
+	x93 = x91 ^ x92;
+	x94 = a[5] & x93;
+	x95 = x90 ^ x94;
+	x96 = a[1] & x95;
+	out[3] = x87 ^ x96;
+}
+
+
+/* S4: 92 gates */
+static inline __attribute__ ((always_inline)) void des_bs_s4 (const des_bs_word *a, des_bs_word *out)
+{
+	des_bs_word x6, x7, x8, x9, x10, x11, x12, x13, x14, x15, x16, x17, x18, x19, x20, x21, x22, x23, x24, x25, x26, x27,
+		x28, x29, x30, x31, x32, x33, x34, x35, x36, x37, x38, x39, x41, x42, x43, x44, x45, x46, x47, x48, x49, x50, x51,
+		x52, x53, x54, x55, x57, x58, x59, x60, x61, x62, x63, x64, x65, x66, x67, x68, x69, x70, x71, x72, x73, x74, x75,
+		x76, x77, x78, x79, x80, x82, x83, x84, x85, x86, x87, x88, x89, x90, x91, x92, x93, x94, x95, x96;
+
+	x6 = ~a[1];
+	x7 = ~a[3] & a[4];
+	x8 = x6 ^ x7;
+	x9 = a[1] ^ x6;
+	x10 = ~a[4];
+	x11 = a[3] & x10;
+	x12 = x9 ^ x11;
+	x13 = ~a[1] & a[3];
+	x14 = x12 ^ x13;
+	x15 = a[2] & x14;
+	x16 = x8 ^ x15;
+	x17 = a[4] & x6;
+	x18 = ~a[2] & x17;
+	x19 = a[1] ^ x18;
+	x20 = a[2] & x10;
+	x21 = a[2] ^ x10;
+	x22 = ~a[1] & x21;
+	x23 = x20 ^ x22;
+	x24 = a[3] & x23;
+	x25 = x19 ^ x24;
+	x26 = a[0] & x25;
+	x27 = x16 ^ x26;
+	x28 = a[2] | x11;
+	x29 = ~a[3];
+	x30 = ~a[2] & x7;
+	x31 = x29 ^ x30;
+	x32 = a[0] & x31;
+	x33 = x28 ^ x32;
+	x34 = a[3] | x21;
+	x35 = a[0] & x20;
+	x36 = x34 ^ x35;
+	x37 = ~a[1] & x36;
+	x38 = x33 ^ x37;
+	x39 = a[5] & x38;
+	out[2] = x27 ^ x39;
+	x41 = ~a[0] & a[4];
+	x42 = x6 ^ x41;
+	x43 = x10 ^ x41;
+	x44 = ~a[1] & x41;
+	x45 = x43 ^ x44;
+	x46 = ~a[3] & x45;
+	x47 = x42 ^ x46;
+	x48 = a[1] & x29;
+	x49 = x10 ^ x48;
+	x50 = a[0] & x49;
+	x51 = x6 ^ x50;
+	x52 = ~a[2] & x51;
+	x53 = x47 ^ x52;
+	x54 = ~x38;
+	x55 = a[5] & x54;
+	out[3] = x53 ^ x55;
+	x57 = a[1] ^ x29;
+	x58 = a[2] & x6;
+	x59 = x57 ^ x58;
+	x60 = ~x13;
+	x61 = ~a[4] & x60;
+	x62 = x59 ^ x61;
+	x63 = x24 ^ x31;
+	x64 = ~a[0] & x63;
+	x65 = x62 ^ x64;
+	x66 = x7 | x41;
+	x67 = ~a[1] & x12;
+	x68 = x66 ^ x67;
+	x69 = a[4] | x6;
+	x70 = a[1] ^ x69;
+	x71 = a[0] & x70;
+	x72 = x69 ^ x71;
+	x73 = a[1] ^ x10;
+	x74 = ~a[0] & x10;
+	x75 = x73 ^ x74;
+	x76 = ~a[3] & x75;
+	x77 = x72 ^ x76;
+	x78 = ~a[2] & x77;
+	x79 = x68 ^ x78;
+	x80 = a[5] & x79;
+	out[1] = x65 ^ x80;
+	x82 = a[3] ^ a[4];
+	x83 = a[2] & a[4];
+	x84 = x82 ^ x83;
+	x85 = x20 | x29;
+	x86 = a[0] & x85;
+	x87 = x84 ^ x86;
+	x88 = a[0] | x20;
+	x89 = ~a[2] & a[0];
+	x90 = x41 ^ x89;
+	x91 = ~a[3] & x90;
+	x92 = x88 ^ x91;
+	x93 = a[1] & x92;
+	x94 = x87 ^ x93;
+	x95 = ~x79;
+	x96 = a[5] & x95;
+	out[0] = x94 ^ x96;
+}
+
+
+/* S5: 101 gates */
+static inline __attribute__ ((always_inline)) void des_bs_s5 (const des_bs_word *a, des_bs_word *out)
+{
+	des_bs_word x6, x7, x8, x9, x10, x11, x12, x13, x14, x15, x16, x17, x18, x19, x20, x21, x22, x23, x24, x25, x26, x27,
+		x28, x29, x30, x31, x32, x33, x34, x35, x36, x37, x39, x40, x41, x42, x43, x44, x45, x46, x47, x48, x49, x50, x51,
+		x52, x53, x54, x55, x56, x57, x59, x60, x61, x62, x63, x64, x65, x66, x67, x68, x69, x70, x71, x72, x73, x74, x75,
+		x76, x77, x78, x79, x80, x81, x82, x83, x84, x85, x86, x87, x89, x90, x91, x92, x93, x94, x95, x96, x97, x98, x99,
+		x100, x101, x102, x103, x104, x105;
+
+	x6 = a[2] ^ a[4];
+	x7 = ~(a[0] ^ a[0]);
+	x8 = ~a[2];
+	x9 = a[4] & x8;
+	x10 = x7 ^ x9;
+	x11 = a[1] & x10;
+	x12 = x6 ^ x11;
+	x13 = a[2] ^ x11;
+	x14 = ~a[5] & x12;
+	x15 = a[5] & x13;
+	x16 = x14 | x15;
+	x17 = a[1] ^ x9;
+	x18 = x12 & x13;
+	x19 = a[5] & x18;
+	x20 = x17 ^ x19;
+	x21 = ~a[3] & x20;
+	x22 = x16 ^ x21;
+	x23 = a[2] ^ x10;
+	x24 = ~a[3] & x10;
+	x25 = x23 ^ x24;
+	x26 = x6 | x24;
+	x27 = ~a[5] & x25;
+	x28 = a[5] & x26;
+	x29 = x27 | x28;
+	x30 = ~x6;
+	x31 = a[3] & x30;
+	x32 = x23 ^ x31;
+	x33 = a[5] & x23;
+	x34 = x32 ^ x33;
+	x35 = a[1] & x34;
+	x36 = x29 ^ x35;
+	x37 = a[0] & x36;
+	out[3] = x22 ^ x37;
+	x39 = a[2] ^ a[5];
+	x40 = ~a[4] & x39;
+	x41 = a[4] & a[5];
+	x42 = x40 | x41;
+	x43 = ~a[0] & x10;
+	x44 = x42 ^ x43;
+	x45 = x23 | x39;
+	x46 = x9 ^ x41;
+	x47 = ~a[0] & x46;
+	x48 = x45 ^ x47;
+	x49 = ~a[3] & x48;
+	x50 = x44 ^ x49;
+	x51 = x8 | x39;
+	x52 = a[2] | a[5];
+	x53 = a[0] & x52;
+	x54 = x51 ^ x53;
+	x55 = ~a[3] & x54;
+	x56 = x7 ^ x55;
+	x57 = a[1] & x56;
+	out[1] = x50 ^ x57;
+	x59 = a[1] & x41;
+	x60 = a[4] ^ x59;
+	x61 = ~x41;
+	x62 = a[1] & x61;
+	x63 = a[5] ^ x62;
+	x64 = ~a[2] & x63;
+	x65 = x60 ^ x64;
+	x66 = ~a[1];
+	x67 = ~a[4] & a[5];
+	x68 = x66 ^ x67;
+	x69 = a[2] & x68;
+	x70 = x60 ^ x69;
+	x71 = ~a[3] & x70;
+	x72 = x65 ^ x71;
+	x73 = x6 | x13;
+	x74 = x6 ^ x73;
+	x75 = ~a[3] & x74;
+	x76 = x73 ^ x75;
+	x77 = a[2] ^ a[3];
+	x78 = ~a[1] & x8;
+	x79 = x77 ^ x78;
+	x80 = a[1] ^ x8;
+	x81 = a[3] & a[1];
+	x82 = x80 ^ x81;
+	x83 = ~a[4] & x82;
+	x84 = x79 ^ x83;
+	x85 = a[5] & x84;
+	x86 = x76 ^ x85;
+	x87 = ~a[0] & x86;
+	out[0] = x72 ^ x87;
+	x89 = x12 ^ x79;
+	x90 = a[4] | x66;
+	x91 = ~a[3] & x90;
+	x92 = ~a[5] & x91;
+	x93 = x89 ^ x92;
+	x94 = a[2] ^ x51;
+	x95 = a[3] & x94;
+	x96 = x39 ^ x95;
+	x97 = ~a[4] & x96;
+	x98 = x51 ^ x97;
+	x99 = ~x29 & x55;
+	x100 = x96 ^ x99;
+	x101 = ~a[4] & x100;
+	x102 = x99 ^ x101;
+	x103 = a[1] & x102;
+	x104 = x98 ^ x103;
+	x105 = ~a[0] & x104;
+	out[2] = x93 ^ x105;
+}
+
+
+/* S6: 101 gates */
+static inline __attribute__ ((always_inline)) void des_bs_s6 (const des_bs_word *a, des_bs_word *out)
+{
+	des_bs_word x6, x7, x8, x9, x10, x11, x12, x13, x14, x15, x16, x17, x18, x19, x20, x21, x22, x23, x24, x25, x26, x27,
+		x28, x29, x30, x31, x32, x33, x34, x36, x37, x38, x39, x40, x41, x42, x43, x44, x45, x46, x47, x48, x49, x50, x51,
+		x52, x53, x54, x55, x56, x57, x58, x59, x60, x61, x62, x63, x64, x66, x67, x68, x69, x70, x71, x72, x73, x74, x75,
+		x76, x77, x78, x79, x80, x81, x82, x84, x85, x86, x87, x88, x89, x90, x91, x92, x93, x94, x95, x96, x97, x98, x99,
+		x100, x101, x102, x103, x104, x105;
+
+	x6 = ~(a[0] ^ a[0]);
+	x7 = a[2] & a[3];
+	x8 = x6 ^ x7;
+	x9 = ~a[5] & x8;
+	x10 = a[2] ^ x9;
+	x11 = ~a[5] & x6;
+	x12 = a[3] ^ x11;
+	x13 = ~a[4] & x10;
+	x14 = a[4] & x12;
+	x15 = x13 | x14;
+	x16 = a[2] & x11;
+	x17 = ~a[3] & a[5];
+	x18 = x16 ^ x17;
+	x19 = ~x18;
+	x20 = a[4] & x19;
+	x21 = x18 ^ x20;
+	x22 = ~a[0] & x21;
+	x23 = x15 ^ x22;
+	x24 = a[2] ^ x8;
+	x25 = ~a[5] & x7;
+	x26 = x24 ^ x25;
+	x27 = a[4] & x17;
+	x28 = a[5] ^ x27;
+	x29 = x21 & x28;
+	x30 = ~a[2] & x29;
+	x31 = x28 ^ x30;
+	x32 = a[0] & x31;
+	x33 = x26 ^ x32;
+	x34 = a[1] & x33;
+	out[0] = x23 ^ x34;
+	x36 = x11 ^ x17;
+	x37 = ~a[1] & x36;
+	x38 = a[5] ^ x37;
+	x39 = ~x36;
+	x40 = ~a[1] & x39;
+	x41 = x36 ^ x40;
+	x42 = a[2] & x41;
+	x43 = x38 ^ x42;
+	x44 = x12 ^ x19;
+	x45 = ~a[1] & x44;
+	x46 = x6 ^ x45;
+	x47 = ~a[4] & x46;
+	x48 = x43 ^ x47;
+	x49 = ~x37 & a[3];
+	x50 = a[3] ^ x41;
+	x51 = ~a[2] & x50;
+	x52 = x49 ^ x51;
+	x53 = a[3] ^ x39;
+	x54 = ~a[1] & x53;
+	x55 = a[1] & x39;
+	x56 = x54 | x55;
+	x57 = ~a[3];
+	x58 = ~a[1] & x11;
+	x59 = x57 ^ x58;
+	x60 = a[2] & x59;
+	x61 = x56 ^ x60;
+	x62 = ~a[4] & x61;
+	x63 = x52 ^ x62;
+	x64 = ~a[0] & x63;
+	out[1] = x48 ^ x64;
+	x66 = a[2] ^ x25;
+	x67 = a[0] & x9;
+	x68 = x66 ^ x67;
+	x69 = x24 ^ x57;
+	x70 = ~x69;
+	x71 = a[2] ^ x57;
+	x72 = ~a[0] & x71;
+	x73 = x70 ^ x72;
+	x74 = a[5] & x73;
+	x75 = x69 ^ x74;
+	x76 = a[1] & x75;
+	x77 = x68 ^ x76;
+	x78 = x9 | x50;
+	x79 = x71 ^ x78;
+	x80 = a[0] & x79;
+	x81 = x78 ^ x80;
+	x82 = a[4] & x81;
+	out[3] = x77 ^ x82;
+	x84 = a[1] ^ x12;
+	x85 = ~x50;
+	x86 = ~a[4] & x84;
+	x87 = a[4] & x85;
+	x88 = x86 | x87;
+	x89 = a[5] ^ x58;
+	x90 = ~x58;
+	x91 = ~a[4] & x90;
+	x92 = x89 ^ x91;
+	x93 = ~a[2] & x92;
+	x94 = x88 ^ x93;
+	x95 = ~x17;
+	x96 = ~x44;
+	x97 = a[1] & x96;
+	x98 = x95 ^ x97;
+	x99 = a[3] ^ x96;
+	x100 = a[2] ^ x44;
+	x101 = a[1] & x100;
+	x102 = x99 ^ x101;
+	x103 = ~a[4] & x102;
+	x104 = x98 ^ x103;
+	x105 = ~a[0] & x104;
+	out[2] = x94 ^ x105;
+}
+
+
+/* S7: 100 gates */
+static inline __attribute__ ((always_inline)) void des_bs_s7 (const des_bs_word *a, des_bs_word *out)
+{
+	des_bs_word x6, x7, x8, x9, x10, x11, x12, x13, x14, x15, x16, x17, x18, x19, x20, x21, x22, x23, x24, x25, x26, x27,
+		x28, x29, x30, x31, x32, x33, x35, x36, x37, x38, x39, x40, x41, x42, x43, x44, x45, x46, x47, x48, x49, x50, x51,
+		x52, x53, x54, x55, x56, x57, x58, x60, x61, x62, x63, x64, x65, x66, x67, x68, x69, x70, x71, x72, x73, x74, x75,
+		x76, x77, x78, x80, x81, x82, x83, x84, x85, x86, x87, x88, x89, x90, x91, x92, x93, x94, x95, x96, x97, x98, x99,
+		x100, x101, x102, x103, x104;
+
+	x6 = a[1] ^ a[5];
+	x7 = a[4] | a[5];
+	x8 = ~a[0] & x7;
+	x9 = x6 ^ x8;
+	x10 = ~(a[0] ^ a[0]);
+	x11 = a[0] & a[4];
+	x12 = x10 ^ x11;
+	x13 = ~a[0];
+	x14 = ~a[1] & x12;
+	x15 = a[1] & x13;
+	x16 = x14 | x15;
+	x17 = ~a[5] & x16;
+	x18 = a[0] ^ x17;
+	x19 = a[2] & x18;
+	x20 = x9 ^ x19;
+	x21 = a[0] | x17;
+	x22 = ~x21;
+	x23 = ~a[2] & x22;
+	x24 = x21 ^ x23;
+	x25 = a[5] ^ x24;
+	x26 = a[4] & x25;
+	x27 = x24 ^ x26;
+	x28 = a[5] ^ x13;
+	x29 = ~a[4] & x28;
+	x30 = x25 ^ x29;
+	x31 = a[1] & x30;
+	x32 = x27 ^ x31;
+	x33 = a[3] & x32;
+	out[2] = x20 ^ x33;
+	x35 = a[4] ^ x13;
+	x36 = ~a[3] & x35;
+	x37 = a[3] & x13;
+	x38 = x36 | x37;
+	x39 = a[4] ^ x12;
+	x40 = a[3] & x39;
+	x41 = x12 ^ x40;
+	x42 = a[5] & x41;
+	x43 = x38 ^ x42;
+	x44 = x12 ^ x35;
+	x45 = x44 ^ x36;
+	x46 = ~x45;
+	x47 = ~a[5] & x46;
+	x48 = x45 ^ x47;
+	x49 = ~a[1] & x48;
+	x50 = x43 ^ x49;
+	x51 = a[5] ^ x21;
+	x52 = a[3] & x51;
+	x53 = x10 ^ x52;
+	x54 = ~a[4] & x53;
+	x55 = x54 | a[4];
+	x56 = a[1] & x51;
+	x57 = x55 ^ x56;
+	x58 = a[2] & x57;
+	out[3] = x50 ^ x58;
+	x60 = x36 ^ x40;
+	x61 = x8 | x38;
+	x62 = ~a[5] & x61;
+	x63 = x60 ^ x62;
+	x64 = a[0] ^ x12;
+	x65 = ~a[3] & x64;
+	x66 = x12 ^ x65;
+	x67 = a[1] & x66;
+	x68 = x63 ^ x67;
+	x69 = a[1] & x11;
+	x70 = x64 ^ x69;
+	x71 = x13 ^ x15;
+	x72 = ~a[4] & x13;
+	x73 = x71 ^ x72;
+	x74 = ~a[3] & x73;
+	x75 = x44 ^ x74;
+	x76 = ~a[5] & x75;
+	x77 = x70 ^ x76;
+	x78 = a[2] & x77;
+	out[0] = x68 ^ x78;
+	x80 = x13 ^ x37;
+	x81 = ~a[2] & a[0];
+	x82 = x80 ^ x81;
+	x83 = ~a[5] & a[0];
+	x84 = x82 ^ x83;
+	x85 = a[2] ^ a[3];
+	x86 = ~x85 & x82;
+	x87 = a[0] & x86;
+	x88 = x85 ^ x87;
+	x89 = a[3] ^ x82;
+	x90 = ~a[5] & x89;
+	x91 = x88 ^ x90;
+	x92 = a[1] & x91;
+	x93 = x84 ^ x92;
+	x94 = ~x28;
+	x95 = a[2] & x94;
+	x96 = x10 ^ x95;
+	x97 = x21 ^ x95;
+	x98 = ~a[1] & x96;
+	x99 = a[1] & x97;
+	x100 = x98 | x99;
+	x101 = ~x100;
+	x102 = ~a[3] & x101;
+	x103 = x100 ^ x102;
+	x104 = a[4] & x103;
+	out[1] = x93 ^ x104;
+}
+
+
+/* S8: 92 gates */
+static inline __attribute__ ((always_inline)) void des_bs_s8 (const des_bs_word *a, des_bs_word *out)
+{
+	des_bs_word x6, x7, x8, x9, x10, x11, x12, x13, x14, x15, x16, x17, x18, x19, x20, x21, x22, x23, x24, x25, x26, x27,
+		x28, x30, x31, x32, x33, x34, x35, x36, x37, x38, x39, x40, x41, x42, x43, x44, x45, x46, x47, x48, x49, x50, x51,
+		x52, x53, x54, x55, x56, x57, x58, x59, x60, x61, x62, x63, x65, x66, x67, x68, x69, x70, x71, x72, x73, x74, x75,
+		x76, x77, x78, x79, x80, x82, x83, x84, x85, x86, x87, x88, x89, x90, x91, x92, x93, x94, x95, x96;
+
+	x6 = a[0] ^ a[2];
+	x7 = a[1] & x6;
+	x8 = a[0] ^ x7;
+	x9 = ~(a[0] ^ a[0]);
+	x10 = a[0] & a[1];
+	x11 = x9 ^ x10;
+	x12 = a[0] ^ x10;
+	x13 = ~a[2] & x12;
+	x14 = x11 ^ x13;
+	x15 = a[5] & x14;
+	x16 = x8 ^ x15;
+	x17 = ~a[0];
+	x18 = ~a[5] & x17;
+	x19 = x18 | a[5];
+	x20 = ~a[2] & x19;
+	x21 = a[0] ^ x20;
+	x22 = a[4] & x21;
+	x23 = x16 ^ x22;
+	x24 = a[5] | x14;
+	x25 = a[1] ^ x10;
+	x26 = ~a[4] & x25;
+	x27 = x24 ^ x26;
+	x28 = ~a[3] & x27;
+	out[1] = x23 ^ x28;
+	x30 = a[1] ^ a[3];
+	x31 = ~a[1];
+	x32 = ~a[3] & x31;
+	x33 = a[1] ^ x32;
+	x34 = a[4] & x33;
+	x35 = x30 ^ x34;
+	x36 = x35 ^ a[2];
+	x37 = a[2] ^ a[3];
+	x38 = a[1] & x37;
+	x39 = a[2] ^ x38;
+	x40 = ~x39;
+	x41 = a[4] & x40;
+	x42 = x39 ^ x41;
+	x43 = a[0] & x42;
+	x44 = x36 ^ x43;
+	x45 = a[0] ^ a[1];
+	x46 = ~a[4] & x45;
+	x47 = x9 ^ x46;
+	x48 = ~a[4] & x10;
+	x49 = a[0] ^ x48;
+	x50 = a[2] & x49;
+	x51 = x47 ^ x50;
+	x52 = ~a[4] & x17;
+	x53 = a[0] ^ x52;
+	x54 = a[2] & x17;
+	x55 = x53 ^ x54;
+	x56 = x17 ^ x54;
+	x57 = a[4] & a[0];
+	x58 = x56 ^ x57;
+	x59 = a[1] & x58;
+	x60 = x55 ^ x59;
+	x61 = a[3] & x60;
+	x62 = x51 ^ x61;
+	x63 = ~a[5] & x62;
+	out[0] = x44 ^ x63;
+	x65 = a[1] ^ x52;
+	x66 = ~a[2] & x53;
+	x67 = x65 ^ x66;
+	x68 = ~a[2] & x57;
+	x69 = a[0] ^ x68;
+	x70 = ~a[1] & x68;
+	x71 = x69 ^ x70;
+	x72 = ~a[5] & x71;
+	x73 = x67 ^ x72;
+	x74 = ~x52;
+	x75 = a[0] ^ x25;
+	x76 = ~a[4] & x75;
+	x77 = x7 ^ x76;
+	x78 = a[5] & x77;
+	x79 = x74 ^ x78;
+	x80 = ~a[3] & x79;
+	out[2] = x73 ^ x80;
+	x82 = ~x44;
+	x83 = ~a[3] & x6;
+	x84 = ~a[4] & x83;
+	x85 = a[3] ^ x84;
+	x86 = a[2] ^ a[4];
+	x87 = ~a[3];
+	x88 = x87 ^ a[4];
+	x89 = a[2] & x88;
+	x90 = a[3] ^ x89;
+	x91 = ~a[0] & x86;
+	x92 = a[0] & x90;
+	x93 = x91 | x92;
+	x94 = ~a[1] & x93;
+	x95 = x85 ^ x94;
+	x96 = a[5] & x95;
+	out[3] = x82 ^ x96;
+}
+
+/* Evaluates a S-box on bitsliced inputs
+ * n:			The S-box, 0 based: a constant once the rounds are unrolled, so the switch goes away
+ * a:			The 6 input words, first S-box input bit first
+ * out:			The 4 output words, first S-box output bit first
+ */
+static inline __attribute__ ((always_inline)) void des_bs_sbox (int n, const des_bs_word *a, des_bs_word *out)
+{
+	switch (n)
+	{
+		case 0: des_bs_s1 (a, out); break;
+		case 1: des_bs_s2 (a, out); break;
+		case 2: des_bs_s3 (a, out); break;
+		case 3: des_bs_s4 (a, out); break;
+		case 4: des_bs_s5 (a, out); break;
+		case 5: des_bs_s6 (a, out); break;
+		case 6: des_bs_s7 (a, out); break;
+		case 7: des_bs_s8 (a, out); break;
+	}
+}
+
+
+/* Generates the bitsliced key schedule of a batch of blocks
+ * bs_ks:		The output bitsliced key schedule (DES_BS_KEY_WORDS words)
+ * key:			The 8 bytes DES keys of the DES_BS_BLOCKS blocks of the batch, one after the other
+ * NOTE: The schedule is just the transposed keys, every subkey word is one of their bits (see des_bs_key_bit)
+ */
+DES_BS_TARGETS
+void des_bs_set_keys (des_bs_word *bs_ks, const unsigned char *key)
+{
+	uint64_t key_64b;
+	int blk, g;
+
+	/* Place each key as a block would be */
+	for (blk = 0; blk < 64; blk++)
+	{
+		for (g = 0; g < 4; g++)
+		{
+			memcpy (&key_64b, key + (g*64 + blk)*DES_BLOCK_SIZE, DES_BLOCK_SIZE);
+			bs_ks[blk][g] = be64toh (key_64b);
+		}
+	}
+
+	des_bs_transpose (bs_ks);
+}
+
+
+/* Decrypts or Encrypts a batch of DES_BS_BLOCKS blocks, each one with its own key
+ * bs_ks:		The bitsliced key schedule generated by des_bs_set_keys()
+ * in:			The input blocks
+ * out:			The output blocks (may be the same as in)
+ * codec:		0: Decryption, 1: Encryption
+ */
+DES_BS_TARGETS
+void des_bs_crypt (const des_bs_word *bs_ks, const unsigned char *in, unsigned char *out, unsigned char codec)
+{
+	des_bs_word x[64], lr[64], a[6], s[4];
+	des_bs_word *l, *r, *t;
+	const uint8_t *k;
+	uint64_t block;
+	int round, blk, g, n, q;
+
+	/* Load and transpose: x[n] holds the bit n of all the blocks */
+	for (blk = 0; blk < 64; blk++)
+	{
+		for (g = 0; g < 4; g++)
+		{
+			memcpy (&block, in + (g*64 + blk)*DES_BLOCK_SIZE, DES_BLOCK_SIZE);
+			x[blk][g] = be64toh (block);
+		}
+	}
+	des_bs_transpose (x);
+
+	/* The initial permutation is just a renaming */
+	for (n = 0; n < 64; n++)
+		lr[n] = x[des_bs_ip[n]];
+	l = lr;
+	r = lr + 32;
+
+	for (round = 0; round < DES_ROUNDS; round++)
+	{
+		k = des_bs_key_bit[codec ? round : DES_ROUNDS - 1 - round];
+
+		/* Unrolled, every S-box circuit is inlined in place */
+#pragma GCC unroll 8
+		for (n = 0; n < 8; n++)
+		{
+			for (q = 0; q < 6; q++)
+				a[q] = r[des_bs_e[n*6 + q]] ^ bs_ks[k[n*6 + q]];
+
+			des_bs_sbox (n, a, s);
+
+			for (q = 0; q < 4; q++)
+				l[des_bs_p_inv[n*4 + q]] ^= s[q];
+		}
+
+		t = l;
+		l = r;
+		r = t;
+	}
+
+	/* Undo the last swap and apply the final permutation */
+	for (n = 0; n < 32; n++)
+	{
+		x[des_bs_ip[n]] = r[n];
+		x[des_bs_ip[n + 32]] = l[n];
+	}
+
+	des_bs_transpose (x);
+	for (blk = 0; blk < 64; blk++)
+	{
+		for (g = 0; g < 4; g++)
+		{
+			block = htobe64 (x[blk][g]);
+			memcpy (out + (g*64 + blk)*DES_BLOCK_SIZE, &block, DES_BLOCK_SIZE);
+		}
+	}
+}
@@ -0,0 +1,24 @@
+#ifndef SRC_DES_H_
+#define SRC_DES_H_
+
+#include <stdint.h>
+
+#define DES_BLOCK_SIZE		8
+#define DES_ROUNDS			16
+#define DES_BS_BLOCKS		256		//Blocks processed at once by the bitsliced kernel
+#define DES_BS_KEY_WORDS	64		//The transposed keys, the round subkeys are picked from them
+
+/* Expanded DES key: for each round the 48 bit subkey split in eight 6 bit S-box inputs */
+typedef struct {
+	uint8_t subkey[DES_ROUNDS][8];
+} des_key_schedule;
+
+/* Bitsliced word: bit b of element g belongs to block (g*64 + 63-b) of the batch */
+typedef uint64_t des_bs_word __attribute__ ((vector_size (32)));
+
+void			des_set_key			(des_key_schedule*, const unsigned char*);
+void			des_ecb_crypt		(const des_key_schedule*, const unsigned char*, unsigned char*, unsigned char);
+void			des_bs_set_keys		(des_bs_word*, const unsigned char*);
+void			des_bs_crypt		(const des_bs_word*, const unsigned char*, unsigned char*, unsigned char);
+
+#endif /* SRC_DES_H_ */
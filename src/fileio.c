@@ -0,0 +1,376 @@
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include "fileio.h"
+
+
+/* Opens an input: regular files are memory mapped, anything else (stdin, pipes, devices) is read to the buffer
+ * file:		The input file
+ * name:		The file path, NULL for stdin
+ * buffer:		The fallback buffer
+ * max_len:		The maximum length to map or read, file->more is set if the input goes on
+ * RETURN:		0: Success, IO_OPEN_ERROR: The file cannot be opened, IO_READ_ERROR: Nothing can be read
+ */
+int io_input_open (struct io_file *file, const char *name, unsigned char *buffer, size_t max_len)
+{
+	unsigned char probe;
+	struct stat st;
+	ssize_t len;
+	void *map;
+
+	memset (file, 0, sizeof (struct io_file));
+	file->fd = name ? open (name, O_RDONLY) : STDIN_FILENO;
+	if (file->fd < 0)
+		return IO_OPEN_ERROR;
+
+	/* Map the regular files (stdin only if nothing has been read from it yet) */
+	if (!fstat (file->fd, &st) && S_ISREG (st.st_mode) && st.st_size > 0 && lseek (file->fd, 0, SEEK_CUR) == 0)
+	{
+		file->len = (size_t) st.st_size < max_len ? (size_t) st.st_size : max_len;
+		file->more = (size_t) st.st_size > max_len;
+		map = mmap (NULL, file->len, PROT_READ, MAP_PRIVATE, file->fd, 0);
+		if (map != MAP_FAILED)
+		{
+			file->data = map;
+			file->map_len = file->len;
+			return 0;
+		}
+	}
+
+	/* Read anything else straight to the buffer */
+	file->data = buffer;
+	file->len = 0;
+	while (file->len < max_len)
+	{
+		len = read (file->fd, buffer + file->len, max_len - file->len);
+		if (len < 0 && errno == EINTR)
+			continue;
+		if (len <= 0)
+			break;
+		file->len += len;
+	}
+
+	/* A full buffer can be all of the input, or just its start: a byte more tells (it is lost, the input is too big anyway) */
+	while (file->len && file->len == max_len)
+	{
+		len = read (file->fd, &probe, 1);
+		if (len < 0 && errno == EINTR)
+			continue;
+		file->more = len > 0;
+		break;
+	}
+
+	return file->len ? 0 : IO_READ_ERROR;
+}
+
+
+/* Closes an input
+ * file:		The input file
+ */
+void io_input_close (struct io_file *file)
+{
+	if (file->map_len)
+		munmap (file->data, file->map_len);
+	if (file->fd > STDERR_FILENO)
+		close (file->fd);
+	file->fd = -1;
+}
+
+
+/* Creates the file an output is written to. A named regular file, or a new one, is written to a temporary file next to it,
+ * renamed over it once complete: a failed run leaves it untouched, and it can be the input still being read
+ * name:		The output path
+ * final_name:	The path the temporary file is renamed to, allocated, NULL when the output is written directly
+ * temp_name:	The temporary file path, allocated, NULL when the output is written directly
+ * RETURN:		The file descriptor, -1 on failure
+ */
+static int io_output_create (const char *name, char **final_name, char **temp_name)
+{
+	static unsigned int temp_ids;
+	struct stat st;
+	char *path;
+	size_t len;
+	int fd, exists, i;
+
+	*final_name = NULL;
+	*temp_name = NULL;
+	exists = !stat (name, &st);
+	if (exists && !S_ISREG (st.st_mode))
+		return open (name, O_WRONLY | O_TRUNC);
+
+	/* The file a symbolic link points to is replaced, not the link */
+	*final_name = exists ? realpath (name, NULL) : strdup (name);
+	len = *final_name ? strlen (*final_name) + 32 : 0;
+	path = len ? malloc (len) : NULL;
+	fd = -1;
+	for (i = 0; path && i < 100; i++)
+	{
+		snprintf (path, len, "%s.%d.%u.tmp", *final_name, (int) getpid (), __atomic_fetch_add (&temp_ids, 1, __ATOMIC_RELAXED));
+		fd = open (path, O_RDWR | O_CREAT | O_EXCL, 0666);
+		if (fd >= 0 || errno != EEXIST)
+			break;
+	}
+	if (fd < 0)
+	{
+		free (*final_name);
+		free (path);
+		*final_name = NULL;
+		return -1;
+	}
+
+	if (exists)
+		fchmod (fd, st.st_mode & 07777);
+	*temp_name = path;
+	return fd;
+}
+
+
+/* Puts the temporary file of an output in place, or removes it
+ * final_name:	The output path
+ * temp_name:	The temporary file path, NULL if there is none
+ * commit:		1: Put it in place, 0: Remove it
+ * RETURN:		0: Success, 1: Failure (the temporary file is removed)
+ */
+static int io_output_commit (char *final_name, char *temp_name, int commit)
+{
+	int ret;
+
+	if (!temp_name)
+		return 0;
+
+	ret = 0;
+	if (!commit || rename (temp_name, final_name))
+	{
+		unlink (temp_name);
+		ret = commit;
+	}
+	free (final_name);
+	free (temp_name);
+
+	return ret;
+}
+
+
+/* Opens an output: named regular files are sized and memory mapped, so the routine writes straight to them (a temporary file,
+ * see io_output_create()). Anything else (stdout, pipes, devices) gets the buffer, written out by io_output_close()
+ * file:		The output file
+ * name:		The file path, NULL for stdout
+ * buffer:		The fallback buffer
+ * max_len:		The maximum output length
+ * flags:		IO_OUTPUT_* flags
+ * RETURN:		0: Success, IO_OPEN_ERROR: The file cannot be opened
+ */
+int io_output_open (struct io_file *file, const char *name, unsigned char *buffer, size_t max_len, int flags)
+{
+	void *map;
+
+	memset (file, 0, sizeof (struct io_file));
+	file->flags = flags;
+	file->fd = name ? io_output_create (name, &file->final_name, &file->temp_name) : STDOUT_FILENO;
+	if (file->fd < 0)
+		return IO_OPEN_ERROR;
+
+	if (file->temp_name && !ftruncate (file->fd, max_len))
+	{
+		map = mmap (NULL, max_len, PROT_READ | PROT_WRITE, MAP_SHARED, file->fd, 0);
+		if (map != MAP_FAILED)
+		{
+			file->data = map;
+			file->map_len = max_len;
+			return 0;
+		}
+	}
+
+	file->data = buffer;
+	return 0;
+}
+
+
+/* Completes and closes an output
+ * file:		The output file
+ * len:			The output length
+ * RETURN:		0: Success, 1: The output can be incomplete (a named regular file is left as it was)
+ */
+int io_output_close (struct io_file *file, size_t len)
+{
+	struct stat st;
+	struct iovec iov;
+	ssize_t done;
+	int splice, ret;
+
+	ret = 0;
+	if (file->map_len)
+	{
+		/* Drop the unused part of the mapped file */
+		munmap (file->data, file->map_len);
+		if (ftruncate (file->fd, len))
+			ret = 1;
+	}
+	else
+	{
+		/* Pipes get the pages handed over instead of copied, when allowed */
+		splice = (file->flags & IO_OUTPUT_SPLICE) && !fstat (file->fd, &st) && S_ISFIFO (st.st_mode);
+		if (file->temp_name && ftruncate (file->fd, 0))
+			ret = 1;
+
+		iov.iov_base = file->data;
+		iov.iov_len = len;
+		while (iov.iov_len && !ret)
+		{
+			done = splice ? vmsplice (file->fd, &iov, 1, 0) : write (file->fd, iov.iov_base, iov.iov_len);
+			if (done < 0 && errno == EINTR)
+				continue;
+			if (done <= 0)
+				break;
+			iov.iov_base = (unsigned char *) iov.iov_base + done;
+			iov.iov_len -= done;
+		}
+		ret |= iov.iov_len != 0;
+	}
+
+	if (file->fd > STDERR_FILENO && close (file->fd))
+		ret = 1;
+	file->fd = -1;
+	if (io_output_commit (file->final_name, file->temp_name, !ret))
+		ret = 1;
+	file->final_name = NULL;
+	file->temp_name = NULL;
+
+	return ret;
+}
+
+
+/* Closes an output without writing anything: a named regular file is left as it was
+ * file:		The output file
+ */
+void io_output_discard (struct io_file *file)
+{
+	if (file->map_len)
+		munmap (file->data, file->map_len);
+	if (file->fd > STDERR_FILENO)
+		close (file->fd);
+	file->fd = -1;
+	io_output_commit (file->final_name, file->temp_name, 0);
+	file->final_name = NULL;
+	file->temp_name = NULL;
+}
+
+
+/* Opens a stream, read or written a piece at a time. A named output is written to a temporary file, see io_output_create()
+ * file:		The stream, its descriptor in file->fd
+ * name:		The file path, NULL for stdin or stdout
+ * output:		0: Input, 1: Output
+ * RETURN:		0: Success, IO_OPEN_ERROR: The file cannot be opened
+ */
+int io_stream_open (struct io_file *file, const char *name, int output)
+{
+	memset (file, 0, sizeof (struct io_file));
+	if (!name)
+		file->fd = output ? STDOUT_FILENO : STDIN_FILENO;
+	else
+		file->fd = output ? io_output_create (name, &file->final_name, &file->temp_name) : open (name, O_RDONLY);
+
+	return file->fd < 0 ? IO_OPEN_ERROR : 0;
+}
+
+
+/* Reads the next piece of a stream, filling the buffer unless the stream ends
+ * fd:			The stream
+ * buffer:		The buffer
+ * len:			The buffer length
+ * RETURN:		The piece length, 0 at the end of the stream, -1 on failure
+ */
+ssize_t io_stream_read (int fd, unsigned char *buffer, size_t len)
+{
+	ssize_t ret;
+	size_t done;
+
+	done = 0;
+	while (done < len)
+	{
+		ret = read (fd, buffer + done, len - done);
+		if (ret < 0 && errno == EINTR)
+			continue;
+		if (ret < 0)
+			return -1;
+		if (!ret)
+			break;
+		done += ret;
+	}
+
+	return (ssize_t) done;
+}
+
+
+/* Writes a piece of a stream
+ * fd:			The stream
+ * buffer:		The piece
+ * len:			The piece length
+ * offset:		Where to write it, -1 at the current position (the other offsets need a seekable stream)
+ * RETURN:		0: Success, 1: Failure
+ */
+int io_stream_write (int fd, const unsigned char *buffer, size_t len, long long offset)
+{
+	ssize_t ret;
+
+	while (len)
+	{
+		ret = offset < 0 ? write (fd, buffer, len) : pwrite (fd, buffer, len, (off_t) offset);
+		if (ret < 0 && errno == EINTR)
+			continue;
+		if (ret <= 0)
+			return 1;
+		buffer += ret;
+		len -= ret;
+		if (offset >= 0)
+			offset += ret;
+	}
+
+	return 0;
+}
+
+
+/* Closes a stream
+ * file:		The stream
+ * commit:		Outputs, 1: Put the file in place, 0: Leave the named file as it was
+ * RETURN:		0: Success, 1: The output can be incomplete
+ */
+int io_stream_close (struct io_file *file, int commit)
+{
+	int ret;
+
+	ret = 0;
+	if (file->fd > STDERR_FILENO && close (file->fd))
+		ret = 1;
+	file->fd = -1;
+	if (io_output_commit (file->final_name, file->temp_name, commit && !ret))
+		ret = 1;
+	file->final_name = NULL;
+	file->temp_name = NULL;
+
+	return ret;
+}
+
+
+/* Gets the size of a regular file
+ * name:		The file path, NULL for stdin
+ * RETURN:		The size, -1 if not a regular file
+ */
+long long io_file_size (const char *name)
+{
+	struct stat st;
+
+	if (name ? stat (name, &st) : fstat (STDIN_FILENO, &st))
+		return -1;
+	if (!S_ISREG (st.st_mode))
+		return -1;
+
+	return (long long) st.st_size;
+}
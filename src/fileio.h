@@ -0,0 +1,37 @@
+#ifndef SRC_FILEIO_H_
+#define SRC_FILEIO_H_
+
+#include <stddef.h>
+#include <sys/types.h>
+
+#define IO_OPEN_ERROR		1
+#define IO_READ_ERROR		2
+
+#define IO_OUTPUT_SPLICE	0x1		//The output buffer is not modified after io_output_close(): pipes may reference it
+
+/* An input or output file: mapped when possible, otherwise backed by a caller buffer */
+struct io_file {
+	unsigned char * data;
+	size_t len;
+	size_t map_len;		//0 when data is the caller buffer
+	char * final_name;	//Outputs written to a temporary file: the path it is renamed to
+	char * temp_name;
+	int fd;
+	int flags;
+	int more;			//Inputs: it goes on past the length read
+};
+
+int				io_input_open		(struct io_file*, const char*, unsigned char*, size_t);
+void			io_input_close		(struct io_file*);
+int				io_output_open		(struct io_file*, const char*, unsigned char*, size_t, int);
+int				io_output_close		(struct io_file*, size_t);
+void			io_output_discard	(struct io_file*);
+
+/* Streams: plain descriptors, a piece at a time */
+int				io_stream_open		(struct io_file*, const char*, int);
+ssize_t			io_stream_read		(int, unsigned char*, size_t);
+int				io_stream_write		(int, const unsigned char*, size_t, long long);
+int				io_stream_close		(struct io_file*, int);
+long long		io_file_size		(const char*);
+
+#endif /* SRC_FILEIO_H_ */
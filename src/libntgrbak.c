@@ -0,0 +1,948 @@
+#include <stdlib.h>
+#include <limits.h>
+#include <string.h>
+#include "libntgrbak.h"
+#include "config.h"
+#include "crypt.h"
+#include "nvram.h"
+#include "text.h"
+#include "trace.h"
+
+#define LIB_CONFIG_SIZE_MAX		(NVRAM_IMAGE_SIZE_MAX + NTGRBAK_HEADER_SIZE)		//Largest configuration checked (without NTGRBAK_FORCE)
+#define LIB_ARENA_ALIGN			16
+#define lib_output				text_output
+#define lib_verbose				text_verbose
+#define lib_force				text_force
+#define lib_trace				text_trace
+
+
+struct ntgrbak_ctx {
+	struct codec_ctx * codec;		//NULL when created for no blocks: the calls derive the keys on the fly
+	int threads;
+	struct ntgrbak_allocator alloc;
+};
+
+static const char * const lib_errors[NTGRBAK_ERR_ELEMENTS] = {
+	"Success",
+	"Invalid arguments",
+	"Out of memory",
+	"Output buffer too small",
+	"Input size is not a multiple of 8 bytes",
+	"Cipher failure",
+	"Checksum verify failed",
+	"Configuration length mismatch",
+	"Data size is too big",
+	"Magic check failed",
+	"CRC8 check failed",
+	"Patch out of the NVRAM data",
+	"Malformed record",
+};
+
+
+static void * lib_malloc (void *opaque, size_t size)
+{
+	return malloc (size);
+}
+
+static void lib_free (void *opaque, void *ptr)
+{
+	free (ptr);
+}
+
+static const struct ntgrbak_allocator lib_allocator_default = { lib_malloc, lib_free, NULL };
+
+
+/* Passes the description of an error to the caller log
+ * opt:			The call options
+ * err:			The error code
+ * RETURN:		The error code
+ */
+static int lib_error (const struct ntgrbak_opts *opt, int err)
+{
+	lib_output (opt, "%s!\n", ntgrbak_strerror (err));
+	return err;
+}
+
+
+/* Picks the allocator of a call: the options one, then the context one, then malloc() */
+static const struct ntgrbak_allocator * lib_allocator (const struct ntgrbak_ctx *ctx, const struct ntgrbak_opts *opt)
+{
+	if (opt && opt->alloc)
+		return opt->alloc;
+
+	return ctx ? &ctx->alloc : &lib_allocator_default;
+}
+
+/* Allocates a working buffer of a call */
+static void * lib_alloc (const struct ntgrbak_ctx *ctx, const struct ntgrbak_opts *opt, size_t size)
+{
+	const struct ntgrbak_allocator *alloc = lib_allocator (ctx, opt);
+
+	return alloc->alloc (alloc->opaque, size);
+}
+
+static void lib_release (const struct ntgrbak_ctx *ctx, const struct ntgrbak_opts *opt, void *ptr)
+{
+	const struct ntgrbak_allocator *alloc = lib_allocator (ctx, opt);
+
+	if (ptr)
+		alloc->free (alloc->opaque, ptr);
+}
+
+
+static void * lib_arena_alloc (void *opaque, size_t size)
+{
+	return ntgrbak_arena_alloc ((struct ntgrbak_arena *) opaque, size);
+}
+
+/* Gives back a buffer and the ones carved after it */
+static void lib_arena_free (void *opaque, void *ptr)
+{
+	struct ntgrbak_arena *arena = opaque;
+
+	if ((unsigned char *) ptr >= arena->base && (unsigned char *) ptr < arena->base + arena->used)
+		arena->used = (unsigned char *) ptr - arena->base;
+}
+
+
+/* Sets up an arena on a block
+ * arena:		The arena
+ * buffer:		The block, kept by the caller
+ * size:		The block size
+ */
+void ntgrbak_arena_init (struct ntgrbak_arena *arena, void *buffer, size_t size)
+{
+	arena->base = buffer;
+	arena->size = buffer ? size : 0;
+	arena->used = 0;
+	arena->peak = 0;
+	arena->allocator.alloc = lib_arena_alloc;
+	arena->allocator.free = lib_arena_free;
+	arena->allocator.opaque = arena;
+}
+
+
+/* Takes back all the buffers of an arena
+ * arena:		The arena
+ */
+void ntgrbak_arena_reset (struct ntgrbak_arena *arena)
+{
+	arena->used = 0;
+}
+
+
+/* Carves a buffer from an arena
+ * arena:		The arena
+ * size:		The buffer size
+ * RETURN:		The buffer (aligned to 16 bytes), NULL if the arena is full
+ */
+void * ntgrbak_arena_alloc (struct ntgrbak_arena *arena, size_t size)
+{
+	size_t offset;
+
+	offset = (arena->used + LIB_ARENA_ALIGN - 1) & ~(size_t) (LIB_ARENA_ALIGN - 1);
+	if (offset > arena->size || size > arena->size - offset)
+		return NULL;
+
+	arena->used = offset + size;
+	if (arena->used > arena->peak)
+		arena->peak = arena->used;
+
+	return arena->base + offset;
+}
+
+
+/* Creates a context
+ * config_size_max:		The largest configuration to process (its blocks keys are precomputed), 0 to derive the keys on the fly
+ *						Precomputing pays off only when the context serves many configurations
+ * threads:				The threads the codec of a configuration is split between
+ * alloc:				The working buffers allocator, NULL for malloc()
+ * RETURN:				The context, NULL on failure
+ */
+struct ntgrbak_ctx * ntgrbak_ctx_new (size_t config_size_max, int threads, const struct ntgrbak_allocator *alloc)
+{
+	struct ntgrbak_ctx *ctx;
+
+	if (!alloc)
+		alloc = &lib_allocator_default;
+
+	ctx = alloc->alloc (alloc->opaque, sizeof (struct ntgrbak_ctx));
+	if (!ctx)
+		return NULL;
+	ctx->alloc = *alloc;
+	ctx->threads = threads;
+	ctx->codec = NULL;
+
+	if (config_size_max)
+	{
+		ctx->codec = codec_ctx_new (config_size_max / CODEC_BLOCK_SIZE);
+		if (!ctx->codec)
+		{
+			alloc->free (alloc->opaque, ctx);
+			return NULL;
+		}
+	}
+
+	return ctx;
+}
+
+
+/* Releases a context
+ * ctx:			The context
+ */
+void ntgrbak_ctx_free (struct ntgrbak_ctx *ctx)
+{
+	if (!ctx)
+		return;
+
+	codec_ctx_free (ctx->codec);
+	ctx->alloc.free (ctx->alloc.opaque, ctx);
+}
+
+
+/* Describes a return code
+ * err:			The return code
+ * RETURN:		The description
+ */
+const char * ntgrbak_strerror (int err)
+{
+	if (err < 0 || err >= NTGRBAK_ERR_ELEMENTS)
+		return "Unknown error";
+
+	return lib_errors[err];
+}
+
+
+/* Generates the configuration magic of a router model
+ * model:		The model string (eg. "WNDR4500v2")
+ * RETURN:		The magic
+ */
+unsigned int ntgrbak_model_magic (const char *model)
+{
+	return generate_magic ((unsigned char *) model);
+}
+
+
+/* Names the router model of a configuration magic
+ * magic:		The magic
+ * RETURN:		The model, "unknown" if not known
+ */
+const char * ntgrbak_model_name (unsigned int magic)
+{
+	return get_model (magic);
+}
+
+
+/* Gets the NVRAM image size of a router model
+ * magic:		The configuration magic
+ * RETURN:		The NVRAM image size, NTGRBAK_IMAGE_SIZE if the model is not known
+ */
+size_t ntgrbak_model_image_size (unsigned int magic)
+{
+	return get_model_image_size (magic);
+}
+
+
+/* Fills the info of a decrypted configuration header, counting the unknown models */
+static void lib_info (const struct ntgrbak_opts *opt, const unsigned char *header, struct ntgrbak_info *info)
+{
+	if (!strcmp (get_model (get_magic ((unsigned char *) header)), "unknown"))
+		trace_count (lib_trace (opt), TRACE_UNKNOWN_MODELS, 1);
+	if (!info)
+		return;
+
+	info->magic = get_magic ((unsigned char *) header);
+	info->version = get_config_version ((unsigned char *) header);
+	info->length = get_config_length ((unsigned char *) header);
+	info->model = get_model (info->magic);
+}
+
+
+/* Decrypts a configuration, header included
+ * ctx:			The context, holding the keys of the in_len bytes or none
+ * opt:			The call options
+ * in:			The encrypted configuration
+ * in_len:		The encrypted configuration length
+ * out:			The output buffer (at least in_len bytes)
+ * out_max:		The output buffer size
+ * out_len:		The output length
+ * RETURN:		NTGRBAK_OK or the error code
+ */
+int ntgrbak_decrypt (const struct ntgrbak_ctx *ctx, const struct ntgrbak_opts *opt, const unsigned char *in, size_t in_len, unsigned char *out, size_t out_max, size_t *out_len)
+{
+	uint64_t span;
+	int dec_len;
+
+	if (!ctx || !in || !out || !out_len)
+		return lib_error (opt, NTGRBAK_ERR_ARGS);
+	if (out_max < in_len)
+		return lib_error (opt, NTGRBAK_ERR_BUFFER);
+
+	if (in_len % CODEC_BLOCK_SIZE)
+	{
+		lib_output (opt, "Error processing the input!\nMake sure the input data size is a multiple of 8 bytes.\n");
+		return NTGRBAK_ERR_BLOCK;
+	}
+
+	span = trace_begin (lib_trace (opt));
+	if (run_codec_parallel (ctx->codec, (unsigned char *) in, (int) in_len, out, &dec_len, 0, ctx->threads, lib_trace (opt)))
+	{
+		lib_output (opt, "Error processing the input!\n");
+		return NTGRBAK_ERR_CODEC;
+	}
+	trace_end (lib_trace (opt), "decrypt", span, in_len);
+
+	*out_len = dec_len;
+	return NTGRBAK_OK;
+}
+
+
+/* Decrypts a configuration and checks it, in a single pass summing the checksum words as the blocks are decrypted
+ * ctx:				The context
+ * opt:				The call options
+ * in:				The encrypted configuration
+ * in_len:			The encrypted configuration length
+ * payload:			The NVRAM image buffer (in_len - 0x18 bytes), its content is undefined on failure
+ * payload_size:	The NVRAM image length
+ * info:			The configuration info, NULL if not needed
+ * RETURN:			NTGRBAK_OK or the error code
+ */
+static int lib_unwrap (const struct ntgrbak_ctx *ctx, const struct ntgrbak_opts *opt, const unsigned char *in, size_t in_len, unsigned char *payload, size_t *payload_size, struct ntgrbak_info *info)
+{
+	unsigned char header[NTGRBAK_HEADER_SIZE];
+	unsigned int sum;
+	size_t dec_len;
+	uint64_t span;
+
+	if (in_len % CODEC_BLOCK_SIZE)
+	{
+		lib_output (opt, "Error processing the input!\nMake sure the input data size is a multiple of 8 bytes.\n");
+		return NTGRBAK_ERR_BLOCK;
+	}
+	if (in_len < NTGRBAK_HEADER_SIZE)
+	{
+		lib_output (opt, "Input is too short to hold a configuration header.\n");
+		return NTGRBAK_ERR_LENGTH;
+	}
+	dec_len = in_len;
+
+	/* Decrypt the header and the NVRAM image to their buffers, summing the words unless forced */
+	span = trace_begin (lib_trace (opt));
+	if (run_codec_unwrap (ctx->codec, in, (int) in_len, header, NTGRBAK_HEADER_SIZE, payload, lib_force (opt) ? NULL : &sum, ctx->threads, lib_trace (opt)))
+	{
+		lib_output (opt, "Error processing the input!\n");
+		return NTGRBAK_ERR_CODEC;
+	}
+	trace_end (lib_trace (opt), "decrypt", span, in_len);
+
+	/* Check for consistency */
+	if (lib_force (opt))
+	{
+		if (lib_verbose (opt)) lib_output (opt, "Skipping checksum verify.\n");
+	}
+	else
+	{
+		span = trace_begin (lib_trace (opt));
+		if (checksum_final (sum))
+		{
+			trace_count (lib_trace (opt), TRACE_CHECKSUM_FAILURES, 1);
+			lib_output (opt, "Checksum verify failed.\n");
+			return NTGRBAK_ERR_CHECKSUM;
+		}
+		trace_end (lib_trace (opt), "checksum_verify", span, dec_len);
+
+		if (lib_verbose (opt)) lib_output (opt, "Checksum verify passed.\n");
+	}
+
+	/* Print info */
+	lib_info (opt, header, info);
+	if (lib_verbose (opt))
+	{
+		lib_output (opt, "Router Model: %s\n", get_model (get_magic (header)));
+		lib_output (opt, "Configuration version: %u\n", get_config_version (header));
+		lib_output (opt, "Configuration magic: 0x%08x\n", get_magic (header));
+	}
+
+	/* Check lengths */
+	span = trace_begin (lib_trace (opt));
+	*payload_size = get_config_length (header) - NTGRBAK_HEADER_SIZE;
+	if (lib_force (opt))
+	{
+		if (lib_verbose (opt)) lib_output (opt, "Skipping length check.\n");
+		if (*payload_size > dec_len - NTGRBAK_HEADER_SIZE)
+			*payload_size = dec_len - NTGRBAK_HEADER_SIZE;
+	}
+	else
+	{
+		if (*payload_size > LIB_CONFIG_SIZE_MAX)
+		{
+			lib_output (opt, "Configuration NVRAM image is too big. (%u bytes, max: %u bytes)\n", (unsigned int) *payload_size, LIB_CONFIG_SIZE_MAX);
+			return NTGRBAK_ERR_TOO_BIG;
+		}
+
+		if (*payload_size != dec_len - NTGRBAK_HEADER_SIZE)
+		{
+			lib_output (opt, "Configuration NVRAM image size is not what expected. Expecting %u bytes instead of %u bytes\n", (unsigned int) *payload_size, (unsigned int) (dec_len - NTGRBAK_HEADER_SIZE));
+			return NTGRBAK_ERR_LENGTH;
+		}
+	}
+	trace_end (lib_trace (opt), "length_check", span, 0);
+	if (lib_verbose (opt)) lib_output (opt, "Configuration NVRAM image size: %u bytes\n", (unsigned int) *payload_size);
+
+	/* Check padding */
+	//TODO: Check if bytes from 0x10 to 0x18 are 0s
+
+	return NTGRBAK_OK;
+}
+
+
+/* Builds the header of a configuration and encrypts it
+ * ctx:				The context
+ * opt:				The call options
+ * wrap:			The configuration (payload_size + 0x18 bytes), the NVRAM image starts at offset 0x18
+ * payload_size:	The NVRAM image length
+ * magic:			The configuration magic
+ * version:			The configuration version
+ * out:				The encrypted configuration
+ * out_len:			The encrypted configuration length
+ * RETURN:			NTGRBAK_OK or the error code
+ */
+static int lib_wrap (const struct ntgrbak_ctx *ctx, const struct ntgrbak_opts *opt, unsigned char *wrap, size_t payload_size, unsigned int magic, unsigned int version, unsigned char *out, size_t *out_len)
+{
+	uint64_t span;
+	int wrap_len, enc_len;
+
+	/* Clean the header */
+	memset (wrap, 0x00, NTGRBAK_HEADER_SIZE);
+
+	/* Build the header */
+	wrap_len = (int) payload_size + NTGRBAK_HEADER_SIZE;
+	set_magic (wrap, magic);
+	set_config_length (wrap, wrap_len);
+	set_config_version (wrap, (int) version);
+	span = trace_begin (lib_trace (opt));
+	generate_checksum (wrap, wrap_len);
+	trace_end (lib_trace (opt), "checksum", span, wrap_len);
+
+	if (lib_verbose (opt))
+	{
+		lib_output (opt, "Generated configuration:\n");
+		lib_output (opt, "Router Model: %s\n", get_model (get_magic (wrap)));
+		lib_output (opt, "Configuration version: %u\n", get_config_version (wrap));
+	}
+
+	/* Encrypting the result */
+	if (wrap_len % CODEC_BLOCK_SIZE)
+	{
+		lib_output (opt, "Error processing the input!\nMake sure the input data size is a multiple of 8 bytes.\n");
+		return NTGRBAK_ERR_BLOCK;
+	}
+	span = trace_begin (lib_trace (opt));
+	if (run_codec_parallel (ctx->codec, wrap, wrap_len, out, &enc_len, 1, ctx->threads, lib_trace (opt)))
+	{
+		lib_output (opt, "Error processing the input!\n");
+		return NTGRBAK_ERR_CODEC;
+	}
+	trace_end (lib_trace (opt), "encrypt", span, wrap_len);
+
+	if (lib_verbose (opt)) lib_output (opt, "Successfully encoded configuration.\n");
+
+	*out_len = enc_len;
+	return NTGRBAK_OK;
+}
+
+
+/* Extracts the NVRAM image of a configuration
+ * ctx:			The context, holding the keys of the in_len bytes or none
+ * opt:			The call options
+ * in:			The encrypted configuration
+ * in_len:		The encrypted configuration length
+ * out:			The NVRAM image buffer
+ * out_max:		The NVRAM image buffer size (in_len - 0x18 bytes is enough)
+ * out_len:		The NVRAM image length
+ * info:		The configuration info, NULL if not needed
+ * RETURN:		NTGRBAK_OK or the error code
+ * NOTE: With in_len - 0x18 bytes or more the image is decrypted straight to out, whose content is then undefined on failure
+ */
+int ntgrbak_extract (const struct ntgrbak_ctx *ctx, const struct ntgrbak_opts *opt, const unsigned char *in, size_t in_len, unsigned char *out, size_t out_max, size_t *out_len, struct ntgrbak_info *info)
+{
+	unsigned char *dec;
+	size_t payload_size;
+	uint64_t span;
+	int ret;
+
+	if (!ctx || !in || !out || !out_len)
+		return lib_error (opt, NTGRBAK_ERR_ARGS);
+
+	/* Decrypt straight to out when it can hold everything after the header */
+	if (in_len < NTGRBAK_HEADER_SIZE || out_max >= in_len - NTGRBAK_HEADER_SIZE)
+	{
+		ret = lib_unwrap (ctx, opt, in, in_len, out, &payload_size, info);
+		if (!ret)
+			*out_len = payload_size;
+		return ret;
+	}
+
+	/* A smaller buffer can still hold the image a forced extraction clamps to */
+	dec = lib_alloc (ctx, opt, in_len - NTGRBAK_HEADER_SIZE);
+	if (!dec)
+		return lib_error (opt, NTGRBAK_ERR_NOMEM);
+
+	ret = lib_unwrap (ctx, opt, in, in_len, dec, &payload_size, info);
+	if (!ret && payload_size > out_max)
+		ret = lib_error (opt, NTGRBAK_ERR_BUFFER);
+	if (!ret)
+	{
+		/* Copy the payload */
+		span = trace_begin (lib_trace (opt));
+		memcpy (out, dec, payload_size);
+		trace_end (lib_trace (opt), "copy", span, payload_size);
+		*out_len = payload_size;
+	}
+
+	lib_release (ctx, opt, dec);
+	return ret;
+}
+
+
+/* Wraps a NVRAM image to a configuration
+ * ctx:			The context, holding the keys of payload_len + 0x18 bytes or none
+ * opt:			The call options
+ * payload:		The NVRAM image
+ * payload_len:	The NVRAM image length (a multiple of 8 bytes)
+ * magic:		The configuration magic (see ntgrbak_model_magic())
+ * version:		The configuration version
+ * out:			The configuration buffer
+ * out_max:		The configuration buffer size (payload_len + 0x18 bytes)
+ * out_len:		The configuration length
+ * RETURN:		NTGRBAK_OK or the error code
+ */
+int ntgrbak_wrap (const struct ntgrbak_ctx *ctx, const struct ntgrbak_opts *opt, const unsigned char *payload, size_t payload_len, unsigned int magic, unsigned int version, unsigned char *out, size_t out_max, size_t *out_len)
+{
+	unsigned char *wrap;
+	uint64_t span;
+	int ret;
+
+	if (!ctx || !payload || !out || !out_len)
+		return lib_error (opt, NTGRBAK_ERR_ARGS);
+	if (out_max < payload_len + NTGRBAK_HEADER_SIZE)
+		return lib_error (opt, NTGRBAK_ERR_BUFFER);
+
+	wrap = lib_alloc (ctx, opt, payload_len + NTGRBAK_HEADER_SIZE);
+	if (!wrap)
+		return lib_error (opt, NTGRBAK_ERR_NOMEM);
+
+	/* Dump the payload after the header */
+	span = trace_begin (lib_trace (opt));
+	memcpy (wrap + NTGRBAK_HEADER_SIZE, payload, payload_len);
+	trace_end (lib_trace (opt), "copy", span, payload_len);
+	ret = lib_wrap (ctx, opt, wrap, payload_len, magic, version, out, out_len);
+
+	lib_release (ctx, opt, wrap);
+	return ret;
+}
+
+
+/* Reads the header of a configuration, decrypting only its first two blocks
+ * ctx:			The context, can be NULL
+ * opt:			The call options
+ * in:			The encrypted configuration (at least 16 bytes of it)
+ * in_len:		The encrypted configuration length
+ * info:		The configuration info
+ * RETURN:		NTGRBAK_OK or the error code
+ */
+int ntgrbak_info (const struct ntgrbak_ctx *ctx, const struct ntgrbak_opts *opt, const unsigned char *in, size_t in_len, struct ntgrbak_info *info)
+{
+	unsigned char header[2 * CODEC_BLOCK_SIZE];
+	uint64_t span;
+
+	if (!in || !info)
+		return lib_error (opt, NTGRBAK_ERR_ARGS);
+
+	if (in_len < sizeof (header))
+	{
+		lib_output (opt, "Input is too short to hold a configuration header.\n");
+		return NTGRBAK_ERR_LENGTH;
+	}
+
+	span = trace_begin (lib_trace (opt));
+	if (run_codec_keyed_blocks ((unsigned char *) in, header, 0, 2, 0))
+	{
+		lib_output (opt, "Error processing the input!\n");
+		return NTGRBAK_ERR_CODEC;
+	}
+	trace_end (lib_trace (opt), "decrypt_header", span, sizeof (header));
+
+	lib_info (opt, header, info);
+	return NTGRBAK_OK;
+}
+
+
+/* Decrypts in place the blocks covering a range, the ones not decrypted yet
+ * conf:		The configuration, sparse: the touched blocks are decrypted
+ * touched:		The decrypted blocks map
+ * offset:		The range offset in the configuration
+ * len:			The range length
+ * RETURN:		0: Success, 1: Failure
+ */
+static int lib_patch_decrypt (unsigned char *conf, unsigned char *touched, size_t offset, size_t len)
+{
+	size_t blk;
+
+	for (blk = offset / CODEC_BLOCK_SIZE; blk <= (offset + len - 1) / CODEC_BLOCK_SIZE; blk++)
+	{
+		if (touched[blk])
+			continue;
+		if (run_codec_keyed_blocks (conf, conf, (int) blk, 1, 0))
+			return 1;
+		touched[blk] = 1;
+	}
+
+	return 0;
+}
+
+
+/* Patches the NVRAM image of a configuration without decrypting all of it
+ * ctx:			The context, can be NULL
+ * opt:			The call options
+ * in:			The encrypted configuration
+ * in_len:		The encrypted configuration length
+ * patch:		The patches, applied in order
+ * patches:		The number of patches
+ * out:			The patched configuration buffer, not the input one
+ * out_max:		The patched configuration buffer size (at least in_len bytes)
+ * out_len:		The patched configuration length
+ * blocks:		The number of blocks encrypted again, NULL if not needed
+ * RETURN:		NTGRBAK_OK or the error code
+ * NOTE: The ECB blocks are independent: only the header blocks and the ones holding the patches are decrypted,
+ *       the checksum and the CRC8 are updated by delta and only those blocks are encrypted again
+ * NOTE: The untouched part of the configuration is not verified
+ */
+int ntgrbak_patch (const struct ntgrbak_ctx *ctx, const struct ntgrbak_opts *opt, const unsigned char *in, size_t in_len, const struct ntgrbak_patch *patch, int patches, unsigned char *out, size_t out_max, size_t *out_len, int *blocks)
+{
+	unsigned char *touched, *nvram, *old_data, old_crc;
+	unsigned int nvram_len;
+	size_t blk, run;
+	uint64_t span;
+	int i, ret, encrypted;
+
+	if (!in || !out || out == in || !out_len || (patches && !patch) || patches < 0)
+		return lib_error (opt, NTGRBAK_ERR_ARGS);
+	if (out_max < in_len)
+		return lib_error (opt, NTGRBAK_ERR_BUFFER);
+	if (in_len % CODEC_BLOCK_SIZE || in_len < NTGRBAK_HEADER_SIZE + NVRAM_INDEX_DATA)
+	{
+		lib_output (opt, "Input is not a configuration!\n");
+		return NTGRBAK_ERR_BLOCK;
+	}
+
+	/* The untouched blocks are copied as they are, the touched ones decrypted where they are */
+	touched = lib_alloc (ctx, opt, in_len / CODEC_BLOCK_SIZE);
+	if (!touched)
+		return lib_error (opt, NTGRBAK_ERR_NOMEM);
+	memset (touched, 0, in_len / CODEC_BLOCK_SIZE);
+	span = trace_begin (lib_trace (opt));
+	memcpy (out, in, in_len);
+	trace_end (lib_trace (opt), "copy", span, in_len);
+	span = trace_begin (lib_trace (opt));
+	nvram = out + NTGRBAK_HEADER_SIZE;
+	ret = NTGRBAK_OK;
+
+	/* Configuration and NVRAM headers */
+	if (lib_patch_decrypt (out, touched, 0, NTGRBAK_HEADER_SIZE + NVRAM_INDEX_DATA))
+		ret = NTGRBAK_ERR_CODEC;
+
+	nvram_len = get_length (nvram);
+	if (!ret && !lib_force (opt))
+	{
+		if (get_config_length (out) != in_len)
+		{
+			lib_output (opt, "Configuration length is not what expected. Expecting %u bytes instead of %u bytes\n", get_config_length (out), (unsigned int) in_len);
+			ret = NTGRBAK_ERR_LENGTH;
+		}
+		else if (get_nvram_magic (nvram) != NVRAM_CONTENT_MAGIC)
+		{
+			trace_count (lib_trace (opt), TRACE_MAGIC_MISMATCHES, 1);
+			lib_output (opt, "NVRAM magic check failed!\n");
+			ret = NTGRBAK_ERR_MAGIC;
+		}
+	}
+	if (!ret && (nvram_len < NVRAM_INDEX_DATA || nvram_len > in_len - NTGRBAK_HEADER_SIZE))
+	{
+		lib_output (opt, "Invalid NVRAM data size! (%u bytes)\n", nvram_len);
+		ret = NTGRBAK_ERR_LENGTH;
+	}
+
+	for (i = 0; i < patches && !ret; i++)
+	{
+		if (!patch[i].data || patch[i].offset < NVRAM_INDEX_DATA || patch[i].offset > nvram_len || patch[i].len > nvram_len - patch[i].offset)
+		{
+			lib_output (opt, "Patch out of the NVRAM data (%u to %u bytes): %u+%u\n", NVRAM_INDEX_DATA, nvram_len, patch[i].offset, (unsigned int) patch[i].len);
+			ret = NTGRBAK_ERR_PATCH;
+			break;
+		}
+		if (!patch[i].len)
+			continue;
+		if (lib_patch_decrypt (out, touched, NTGRBAK_HEADER_SIZE + patch[i].offset, patch[i].len))
+		{
+			ret = NTGRBAK_ERR_CODEC;
+			break;
+		}
+
+		old_data = lib_alloc (ctx, opt, patch[i].len);
+		if (!old_data)
+		{
+			ret = lib_error (opt, NTGRBAK_ERR_NOMEM);
+			break;
+		}
+
+		/* Apply, then move the checksum and the CRC8 (part of the configuration too) by the change */
+		memcpy (old_data, nvram + patch[i].offset, patch[i].len);
+		memcpy (nvram + patch[i].offset, patch[i].data, patch[i].len);
+		old_crc = get_crc (nvram);
+		update_crc (nvram, patch[i].offset, old_data, patch[i].len);
+		update_checksum (out, NTGRBAK_HEADER_SIZE + patch[i].offset, old_data, patch[i].len);
+		update_checksum (out, NTGRBAK_HEADER_SIZE + NVRAM_INDEX_CRC, &old_crc, NVRAM_SIZE_CRC);
+
+		lib_release (ctx, opt, old_data);
+	}
+
+	/* Encrypt the touched blocks again, in runs (the output is left as the input on failure) */
+	encrypted = 0;
+	for (blk = 0; blk < in_len / CODEC_BLOCK_SIZE; blk += run ? run : 1)
+	{
+		for (run = 0; blk + run < in_len / CODEC_BLOCK_SIZE && touched[blk + run]; run++);
+		if (!run)
+			continue;
+
+		if (ret)
+			memcpy (out + blk * CODEC_BLOCK_SIZE, in + blk * CODEC_BLOCK_SIZE, run * CODEC_BLOCK_SIZE);
+		else if (run_codec_keyed_blocks (out, out, (int) blk, (int) run, 1))
+			ret = NTGRBAK_ERR_CODEC;
+		encrypted += run;
+	}
+	lib_release (ctx, opt, touched);
+
+	if (ret)
+		return ret;
+	trace_end (lib_trace (opt), "patch", span, (size_t) encrypted * CODEC_BLOCK_SIZE);
+
+	if (lib_verbose (opt))
+		lib_output (opt, "Patched %d ranges, %d of %u blocks encrypted again\n", patches, encrypted, (unsigned int) (in_len / CODEC_BLOCK_SIZE));
+	if (blocks)
+		*blocks = encrypted;
+
+	*out_len = in_len;
+	return NTGRBAK_OK;
+}
+
+
+/* Extracts the editable text from a NVRAM image
+ * opt:			The call options
+ * in:			The NVRAM image
+ * in_len:		The NVRAM image length
+ * out:			The text buffer
+ * out_max:		The text buffer size (the image data size is enough)
+ * out_len:		The text length
+ * RETURN:		NTGRBAK_OK or the error code
+ */
+int ntgrbak_text_extract (const struct ntgrbak_opts *opt, const unsigned char *in, size_t in_len, unsigned char *out, size_t out_max, size_t *out_len)
+{
+	int len, ret;
+
+	if (!in || !out || !out_len || in_len > LIB_CONFIG_SIZE_MAX)
+		return lib_error (opt, NTGRBAK_ERR_ARGS);
+
+	ret = text_extract (opt, in, (int) in_len, out, out_max > LIB_CONFIG_SIZE_MAX ? LIB_CONFIG_SIZE_MAX : (int) out_max, &len);
+	if (!ret)
+		*out_len = len;
+
+	return ret;
+}
+
+
+/* Checks the NVRAM image size of a call */
+static int lib_image_size_check (const struct ntgrbak_opts *opt, size_t image_size)
+{
+	if (image_size < NVRAM_INDEX_DATA || image_size > NVRAM_IMAGE_SIZE_MAX || image_size % CODEC_BLOCK_SIZE)
+	{
+		lib_output (opt, "Invalid NVRAM image size! (%u bytes, a multiple of 8 bytes up to %u bytes)\n", (unsigned int) image_size, NVRAM_IMAGE_SIZE_MAX);
+		return NTGRBAK_ERR_ARGS;
+	}
+
+	return NTGRBAK_OK;
+}
+
+
+/* Builds a NVRAM image of the call size, see ntgrbak_text_wrap() */
+static int lib_text_wrap (const struct ntgrbak_opts *opt, const unsigned char *in, size_t in_len, size_t image_size, unsigned char *out, size_t out_max, size_t *out_len)
+{
+	int len, ret;
+
+	ret = lib_image_size_check (opt, image_size);
+	if (ret)
+		return ret;
+	if (in_len > image_size - NVRAM_INDEX_DATA)
+	{
+		lib_output (opt, "Data size is too big! (%u bytes, max: %u bytes)\n", (unsigned int) in_len, (unsigned int) (image_size - NVRAM_INDEX_DATA));
+		return NTGRBAK_ERR_TOO_BIG;
+	}
+	if (out_max < image_size)
+		return lib_error (opt, NTGRBAK_ERR_BUFFER);
+
+	ret = text_wrap (opt, in, (int) in_len, out, (int) image_size, &len);
+	if (!ret)
+		*out_len = len;
+
+	return ret;
+}
+
+
+/* Wraps an editable text to a NVRAM image
+ * opt:			The call options, the image size is NTGRBAK_IMAGE_SIZE unless they set one
+ * in:			The text
+ * in_len:		The text length
+ * out:			The NVRAM image buffer
+ * out_max:		The NVRAM image buffer size (at least the image size)
+ * out_len:		The NVRAM image length
+ * RETURN:		NTGRBAK_OK or the error code
+ */
+int ntgrbak_text_wrap (const struct ntgrbak_opts *opt, const unsigned char *in, size_t in_len, unsigned char *out, size_t out_max, size_t *out_len)
+{
+	if (!in || !out || !out_len)
+		return lib_error (opt, NTGRBAK_ERR_ARGS);
+
+	return lib_text_wrap (opt, in, in_len, opt && opt->image_size ? opt->image_size : NTGRBAK_IMAGE_SIZE, out, out_max, out_len);
+}
+
+
+/* Extracts the records of a NVRAM image as a stream
+ * opt:			The call options
+ * in:			The NVRAM image
+ * in_len:		The NVRAM image length
+ * format:		NTGRBAK_FORMAT_* (the text is ntgrbak_text_extract())
+ * out:			The stream buffer
+ * out_max:		The stream buffer size (NTGRBAK_RECORDS_SIZE() is enough)
+ * out_len:		The stream length
+ * RETURN:		NTGRBAK_OK or the error code
+ */
+int ntgrbak_records_extract (const struct ntgrbak_opts *opt, const unsigned char *in, size_t in_len, int format, unsigned char *out, size_t out_max, size_t *out_len)
+{
+	int len, ret;
+
+	if (format == NTGRBAK_FORMAT_TEXT)
+		return ntgrbak_text_extract (opt, in, in_len, out, out_max, out_len);
+	if (!in || !out || !out_len || in_len > LIB_CONFIG_SIZE_MAX || (format != NTGRBAK_FORMAT_BINARY && format != NTGRBAK_FORMAT_JSONL))
+		return lib_error (opt, NTGRBAK_ERR_ARGS);
+
+	ret = text_records_extract (opt, in, (int) in_len, format, out, out_max > INT_MAX ? INT_MAX : (int) out_max, &len);
+	if (!ret)
+		*out_len = len;
+
+	return ret;
+}
+
+
+/* Wraps a records stream to a NVRAM image
+ * opt:			The call options, the image size is NTGRBAK_IMAGE_SIZE unless they set one
+ * in:			The stream
+ * in_len:		The stream length
+ * format:		NTGRBAK_FORMAT_* (the text is ntgrbak_text_wrap())
+ * out:			The NVRAM image buffer
+ * out_max:		The NVRAM image buffer size (at least the image size)
+ * out_len:		The NVRAM image length
+ * RETURN:		NTGRBAK_OK or the error code
+ */
+int ntgrbak_records_wrap (const struct ntgrbak_opts *opt, const unsigned char *in, size_t in_len, int format, unsigned char *out, size_t out_max, size_t *out_len)
+{
+	size_t image_size;
+	int len, ret;
+
+	if (format == NTGRBAK_FORMAT_TEXT)
+		return ntgrbak_text_wrap (opt, in, in_len, out, out_max, out_len);
+	if (!in || !out || !out_len || in_len > INT_MAX || (format != NTGRBAK_FORMAT_BINARY && format != NTGRBAK_FORMAT_JSONL))
+		return lib_error (opt, NTGRBAK_ERR_ARGS);
+
+	image_size = opt && opt->image_size ? opt->image_size : NTGRBAK_IMAGE_SIZE;
+	ret = lib_image_size_check (opt, image_size);
+	if (ret)
+		return ret;
+	if (out_max < image_size)
+		return lib_error (opt, NTGRBAK_ERR_BUFFER);
+
+	ret = text_records_wrap (opt, in, (int) in_len, format, out, (int) image_size, &len);
+	if (!ret)
+		*out_len = len;
+
+	return ret;
+}
+
+
+/* Extracts the editable text of a configuration, converting the NVRAM image where it has been decrypted
+ * ctx:			The context, holding the keys of the in_len bytes or none
+ * opt:			The call options
+ * in:			The encrypted configuration
+ * in_len:		The encrypted configuration length
+ * out:			The text buffer
+ * out_max:		The text buffer size (in_len bytes is enough)
+ * out_len:		The text length
+ * info:		The configuration info, NULL if not needed
+ * RETURN:		NTGRBAK_OK or the error code
+ */
+int ntgrbak_config_to_text (const struct ntgrbak_ctx *ctx, const struct ntgrbak_opts *opt, const unsigned char *in, size_t in_len, unsigned char *out, size_t out_max, size_t *out_len, struct ntgrbak_info *info)
+{
+	unsigned char *dec;
+	size_t payload_size;
+	int ret;
+
+	if (!ctx || !in || !out || !out_len)
+		return lib_error (opt, NTGRBAK_ERR_ARGS);
+
+	dec = lib_alloc (ctx, opt, in_len > NTGRBAK_HEADER_SIZE ? in_len - NTGRBAK_HEADER_SIZE : 1);
+	if (!dec)
+		return lib_error (opt, NTGRBAK_ERR_NOMEM);
+
+	ret = lib_unwrap (ctx, opt, in, in_len, dec, &payload_size, info);
+	if (!ret)
+		ret = ntgrbak_text_extract (opt, dec, payload_size, out, out_max, out_len);
+
+	lib_release (ctx, opt, dec);
+	return ret;
+}
+
+
+/* Wraps an editable text straight to a configuration, building the NVRAM image where it will be encrypted from
+ * ctx:			The context, holding the keys of the image size + 0x18 bytes or none
+ * opt:			The call options, the image size is the model one unless they set one
+ * in:			The text
+ * in_len:		The text length
+ * magic:		The configuration magic (see ntgrbak_model_magic())
+ * version:		The configuration version
+ * out:			The configuration buffer
+ * out_max:		The configuration buffer size (the image size + 0x18 bytes)
+ * out_len:		The configuration length
+ * RETURN:		NTGRBAK_OK or the error code
+ */
+int ntgrbak_text_to_config (const struct ntgrbak_ctx *ctx, const struct ntgrbak_opts *opt, const unsigned char *in, size_t in_len, unsigned int magic, unsigned int version, unsigned char *out, size_t out_max, size_t *out_len)
+{
+	unsigned char *wrap;
+	size_t image_size, payload_size;
+	int ret;
+
+	if (!ctx || !in || !out || !out_len)
+		return lib_error (opt, NTGRBAK_ERR_ARGS);
+	image_size = opt && opt->image_size ? opt->image_size : ntgrbak_model_image_size (magic);
+	if (image_size > NVRAM_IMAGE_SIZE_MAX || out_max < image_size + NTGRBAK_HEADER_SIZE)
+		return lib_error (opt, NTGRBAK_ERR_BUFFER);
+
+	wrap = lib_alloc (ctx, opt, image_size + NTGRBAK_HEADER_SIZE);
+	if (!wrap)
+		return lib_error (opt, NTGRBAK_ERR_NOMEM);
+
+	ret = lib_text_wrap (opt, in, in_len, image_size, wrap + NTGRBAK_HEADER_SIZE, image_size, &payload_size);
+	if (!ret)
+		ret = lib_wrap (ctx, opt, wrap, payload_size, magic, version, out, out_len);
+
+	lib_release (ctx, opt, wrap);
+	return ret;
+}
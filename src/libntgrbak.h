@@ -0,0 +1,170 @@
+#ifndef SRC_LIBNTGRBAK_H_
+#define SRC_LIBNTGRBAK_H_
+
+/*
+ ============================================================================
+ libntgrbak: Netgear configuration backups, buffer to buffer
+ Every function works on caller buffers (out_max bytes available, *out_len used), returns a NTGRBAK_* code
+ and keeps no state besides the context it is given: contexts can be shared between threads.
+ ============================================================================
+ */
+
+#include <stddef.h>
+
+#if defined(__GNUC__)
+#define NTGRBAK_API	__attribute__ ((visibility ("default")))
+#else
+#define NTGRBAK_API
+#endif
+
+#define NTGRBAK_HEADER_SIZE		0x18		//Configuration header: magic, length, checksum, version and padding
+#define NTGRBAK_IMAGE_SIZE		0x10000		//NVRAM image built by the text wrap, unless the model or the call options have another size
+#define NTGRBAK_IMAGE_SIZE_MAX	0x1000000	//Largest NVRAM image handled
+
+/* Return codes */
+enum {
+	NTGRBAK_OK = 0,
+	NTGRBAK_ERR_ARGS,			//Invalid arguments
+	NTGRBAK_ERR_NOMEM,			//The allocator failed
+	NTGRBAK_ERR_BUFFER,			//The output buffer is too small
+	NTGRBAK_ERR_BLOCK,			//The input is not made of 8 bytes blocks
+	NTGRBAK_ERR_CODEC,			//The cipher failed
+	NTGRBAK_ERR_CHECKSUM,		//Configuration checksum mismatch
+	NTGRBAK_ERR_LENGTH,			//Configuration length mismatch
+	NTGRBAK_ERR_TOO_BIG,		//The data does not fit its container
+	NTGRBAK_ERR_MAGIC,			//NVRAM magic mismatch
+	NTGRBAK_ERR_CRC,			//NVRAM CRC8 mismatch
+	NTGRBAK_ERR_PATCH,			//A patch is out of the NVRAM data
+	NTGRBAK_ERR_FORMAT,			//A malformed record, or records stream
+
+	NTGRBAK_ERR_ELEMENTS
+};
+
+/* Per call flags */
+#define NTGRBAK_VERBOSE		0x1		//Pass the diagnostics to the log, not only the errors
+#define NTGRBAK_FORCE		0x2		//Skip the checks
+
+/* Memory for the working buffers, malloc() and free() when not given */
+struct ntgrbak_allocator {
+	void * (*alloc) (void *opaque, size_t size);
+	void (*free) (void *opaque, void *ptr);
+	void * opaque;
+};
+
+/* Arena: working buffers carved in turn from one caller block, none of them released but the last one.
+ * Give &arena->allocator to a context or to the call options, ntgrbak_arena_reset() takes all the buffers back at once:
+ * a block sized to the job, reset between the jobs, makes no allocation at all.
+ */
+struct ntgrbak_arena {
+	unsigned char * base;
+	size_t size;
+	size_t used;
+	size_t peak;							//Largest use since ntgrbak_arena_init()
+	struct ntgrbak_allocator allocator;		//Carves from the arena, its free() gives back a buffer and the ones carved after it
+};
+
+/* Stage timings: the spans of the calls sharing it, from any thread */
+struct ntgrbak_trace;
+
+#define NTGRBAK_TRACE_EVENTS	0x1		//Keep every span, see ntgrbak_trace_write()
+#define NTGRBAK_TRACE_METRICS	0x2		//Per thread stage latency histograms and counters, see ntgrbak_trace_write_metrics()
+
+/* Per call options */
+struct ntgrbak_opts {
+	unsigned int flags;
+	void (*log) (void *opaque, const char *message);		//Error details and diagnostics, NULL for none
+	void * log_opaque;
+	struct ntgrbak_trace * trace;							//Records the stages spans, NULL for none
+	const struct ntgrbak_allocator * alloc;					//The working buffers of the call, NULL for the context allocator
+	size_t image_size;										//The NVRAM image built by the text wraps, 0 for the model one (see ntgrbak_model_image_size())
+};
+
+/* Configuration header */
+struct ntgrbak_info {
+	unsigned int magic;
+	unsigned int version;
+	unsigned int length;		//Of the whole configuration, header included
+	const char * model;			//"unknown" when the magic is not a known one
+};
+
+/* A same length change of a NVRAM image */
+struct ntgrbak_patch {
+	unsigned int offset;		//Within the NVRAM image
+	const unsigned char * data;
+	size_t len;
+};
+
+/* Context: the block keys and the allocator, read only once created
+ * NOTE: A context created for a 0 bytes configuration holds no keys, every call derives the ones it needs as it goes
+ * NOTE: ntgrbak_info() and ntgrbak_patch() derive the few keys they need, they take a NULL context as well
+ */
+struct ntgrbak_ctx;
+
+NTGRBAK_API struct ntgrbak_ctx *	ntgrbak_ctx_new			(size_t, int, const struct ntgrbak_allocator*);
+NTGRBAK_API void					ntgrbak_ctx_free		(struct ntgrbak_ctx*);
+NTGRBAK_API const char *			ntgrbak_strerror		(int);
+NTGRBAK_API unsigned int			ntgrbak_model_magic		(const char*);
+NTGRBAK_API const char *			ntgrbak_model_name		(unsigned int);
+NTGRBAK_API size_t					ntgrbak_model_image_size	(unsigned int);
+NTGRBAK_API void					ntgrbak_arena_init		(struct ntgrbak_arena*, void*, size_t);
+NTGRBAK_API void					ntgrbak_arena_reset		(struct ntgrbak_arena*);
+NTGRBAK_API void *					ntgrbak_arena_alloc		(struct ntgrbak_arena*, size_t);
+NTGRBAK_API struct ntgrbak_trace *	ntgrbak_trace_new		(unsigned int);
+NTGRBAK_API void					ntgrbak_trace_free		(struct ntgrbak_trace*);
+NTGRBAK_API int						ntgrbak_trace_write		(const struct ntgrbak_trace*, const char*);
+NTGRBAK_API int						ntgrbak_trace_write_metrics	(const struct ntgrbak_trace*, const char*, const char*);
+
+/* Configuration <-> NVRAM image */
+NTGRBAK_API int		ntgrbak_decrypt			(const struct ntgrbak_ctx*, const struct ntgrbak_opts*, const unsigned char*, size_t, unsigned char*, size_t, size_t*);
+NTGRBAK_API int		ntgrbak_extract			(const struct ntgrbak_ctx*, const struct ntgrbak_opts*, const unsigned char*, size_t, unsigned char*, size_t, size_t*, struct ntgrbak_info*);
+NTGRBAK_API int		ntgrbak_wrap			(const struct ntgrbak_ctx*, const struct ntgrbak_opts*, const unsigned char*, size_t, unsigned int, unsigned int, unsigned char*, size_t, size_t*);
+NTGRBAK_API int		ntgrbak_info			(const struct ntgrbak_ctx*, const struct ntgrbak_opts*, const unsigned char*, size_t, struct ntgrbak_info*);
+NTGRBAK_API int		ntgrbak_patch			(const struct ntgrbak_ctx*, const struct ntgrbak_opts*, const unsigned char*, size_t, const struct ntgrbak_patch*, int, unsigned char*, size_t, size_t*, int*);
+
+/* NVRAM image <-> editable text */
+NTGRBAK_API int		ntgrbak_text_extract	(const struct ntgrbak_opts*, const unsigned char*, size_t, unsigned char*, size_t, size_t*);
+NTGRBAK_API int		ntgrbak_text_wrap		(const struct ntgrbak_opts*, const unsigned char*, size_t, unsigned char*, size_t, size_t*);
+
+/* NVRAM image <-> records stream, for the machines: keys and values of any bytes (but null), no line splitting
+ * NTGRBAK_FORMAT_BINARY:	NTGRBAK_RECORDS_MAGIC, then every record as its varint key length, varint value length, key and value.
+ *							The varints are LEB128: 7 bits a byte, the lowest first, the high bit set on all but the last byte
+ * NTGRBAK_FORMAT_JSONL:	A {"key":"...","value":"..."} line per record. The bytes out of UTF-8 are the lone surrogates \uDC80 to \uDCFF
+ */
+enum {
+	NTGRBAK_FORMAT_TEXT = 0,		//The editable text, see ntgrbak_text_extract()
+	NTGRBAK_FORMAT_BINARY,
+	NTGRBAK_FORMAT_JSONL
+};
+
+#define NTGRBAK_RECORDS_MAGIC		"NVKV"
+#define NTGRBAK_RECORDS_MAGIC_SIZE	4
+#define NTGRBAK_RECORDS_SIZE(format, image_len)	((format) == NTGRBAK_FORMAT_JSONL ? 11 * (size_t) (image_len) + 16 : (size_t) (image_len) + (image_len) / 64 + 16)	//Output buffer enough for an image
+
+NTGRBAK_API int		ntgrbak_records_extract	(const struct ntgrbak_opts*, const unsigned char*, size_t, int, unsigned char*, size_t, size_t*);
+NTGRBAK_API int		ntgrbak_records_wrap	(const struct ntgrbak_opts*, const unsigned char*, size_t, int, unsigned char*, size_t, size_t*);
+
+/* Configuration <-> editable text, without the intermediate image */
+NTGRBAK_API int		ntgrbak_config_to_text	(const struct ntgrbak_ctx*, const struct ntgrbak_opts*, const unsigned char*, size_t, unsigned char*, size_t, size_t*, struct ntgrbak_info*);
+NTGRBAK_API int		ntgrbak_text_to_config	(const struct ntgrbak_ctx*, const struct ntgrbak_opts*, const unsigned char*, size_t, unsigned int, unsigned int, unsigned char*, size_t, size_t*);
+
+/* Streams: a configuration processed a piece at a time in constant memory, whatever its size
+ * Extracting checks the header length against the input length (when given) before any output, the checksum once all the input is in:
+ * the output of a stream failing in ntgrbak_stream_final() must be discarded.
+ * Wrapping outputs a header with no checksum first, ntgrbak_stream_final() gives the complete header to write over it.
+ */
+struct ntgrbak_stream;
+
+enum {
+	NTGRBAK_STREAM_DECRYPT = 0,		//Configuration -> decrypted configuration, header included
+	NTGRBAK_STREAM_EXTRACT,			//Configuration -> NVRAM image
+	NTGRBAK_STREAM_WRAP				//NVRAM image -> configuration
+};
+
+#define NTGRBAK_STREAM_SLACK	0x20		//Output bytes a piece may add to its length
+
+NTGRBAK_API struct ntgrbak_stream *	ntgrbak_stream_new		(const struct ntgrbak_opts*, int, size_t, unsigned int, unsigned int, const struct ntgrbak_allocator*);
+NTGRBAK_API void					ntgrbak_stream_free		(struct ntgrbak_stream*);
+NTGRBAK_API int						ntgrbak_stream_update	(struct ntgrbak_stream*, const unsigned char*, size_t, unsigned char*, size_t, size_t*);
+NTGRBAK_API int						ntgrbak_stream_final	(struct ntgrbak_stream*, unsigned char*, size_t, size_t*, struct ntgrbak_info*);
+
+#endif /* SRC_LIBNTGRBAK_H_ */
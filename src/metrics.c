@@ -0,0 +1,120 @@
+#include <stdint.h>
+#include <stdio.h>
+#include "metrics.h"
+
+#define METRICS_SUB_COUNT		(1 << METRICS_SUB_BITS)
+#define METRICS_EXPORT_MIN		10		//The exported buckets are the powers of two from 2^10 ns (about 1 us)
+#define METRICS_EXPORT_MAX		36		//to 2^36 ns (about 69 s)
+
+
+/* Gets the bucket of a value
+ * value:		The value
+ * RETURN:		The bucket index
+ */
+static int metrics_bucket (uint64_t value)
+{
+	int exp;
+
+	if (value < METRICS_SUB_COUNT)
+		return (int) value;
+	if (value >> METRICS_EXP_MAX)
+		return METRICS_BUCKETS - 1;
+
+	exp = 63 - __builtin_clzll (value);
+	return ((exp - METRICS_SUB_BITS + 1) << METRICS_SUB_BITS) + (int) ((value >> (exp - METRICS_SUB_BITS)) & (METRICS_SUB_COUNT - 1));
+}
+
+
+/* Gets the smallest value past a bucket
+ * bucket:		The bucket index
+ * RETURN:		The bucket upper bound, exclusive
+ */
+static uint64_t metrics_bucket_end (int bucket)
+{
+	int exp;
+
+	if (bucket < METRICS_SUB_COUNT)
+		return (uint64_t) bucket + 1;
+
+	exp = (bucket >> METRICS_SUB_BITS) + METRICS_SUB_BITS - 1;
+	return (uint64_t) (METRICS_SUB_COUNT + (bucket & (METRICS_SUB_COUNT - 1)) + 1) << (exp - METRICS_SUB_BITS);
+}
+
+
+/* Records a value: a few instructions, the histogram is not shared between threads */
+void metrics_histogram_record (struct metrics_histogram *histogram, uint64_t value)
+{
+	histogram->count++;
+	histogram->sum += value;
+	histogram->bucket[metrics_bucket (value)]++;
+}
+
+
+/* Adds a histogram to another one
+ * histogram:	The histogram summed to
+ * other:		The histogram to sum
+ */
+void metrics_histogram_merge (struct metrics_histogram *histogram, const struct metrics_histogram *other)
+{
+	int i;
+
+	histogram->count += other->count;
+	histogram->sum += other->sum;
+	for (i = 0; i < METRICS_BUCKETS; i++)
+		histogram->bucket[i] += other->bucket[i];
+}
+
+
+/* Estimates a quantile
+ * histogram:	The histogram
+ * quantile:	The quantile, 0 to 1
+ * RETURN:		The upper bound of the bucket holding the quantile, 0 when empty
+ */
+uint64_t metrics_histogram_quantile (const struct metrics_histogram *histogram, double quantile)
+{
+	uint64_t rank, seen;
+	int i;
+
+	if (!histogram->count)
+		return 0;
+
+	rank = (uint64_t) (quantile * histogram->count);
+	if (rank >= histogram->count)
+		rank = histogram->count - 1;
+
+	seen = 0;
+	for (i = 0; i < METRICS_BUCKETS; i++)
+	{
+		seen += histogram->bucket[i];
+		if (seen > rank)
+			break;
+	}
+
+	return metrics_bucket_end (i < METRICS_BUCKETS ? i : METRICS_BUCKETS - 1) - 1;
+}
+
+
+/* Writes a histogram in Prometheus text format, in seconds
+ * file:		The output
+ * name:		The metric name (its HELP and TYPE lines are written by the caller)
+ * labels:		The labels of the series, without braces
+ * histogram:	The histogram
+ * NOTE: The exported buckets are powers of two ns, which are bucket bounds: the counts are exact
+ */
+void metrics_histogram_write (FILE *file, const char *name, const char *labels, const struct metrics_histogram *histogram)
+{
+	uint64_t cumulative;
+	int i, exp;
+
+	cumulative = 0;
+	i = 0;
+	for (exp = METRICS_EXPORT_MIN; exp <= METRICS_EXPORT_MAX; exp++)
+	{
+		for (; i < METRICS_BUCKETS && metrics_bucket_end (i) <= (1ULL << exp); i++)
+			cumulative += histogram->bucket[i];
+		fprintf (file, "%s_bucket{%s,le=\"%.9g\"} %llu\n", name, labels, (double) (1ULL << exp) / 1e9, (unsigned long long) cumulative);
+	}
+	fprintf (file, "%s_bucket{%s,le=\"+Inf\"} %llu\n", name, labels, (unsigned long long) histogram->count);
+	fprintf (file, "%s_sum{%s} %.9f\n", name, labels, histogram->sum / 1e9);
+	fprintf (file, "%s_count{%s} %llu\n", name, labels, (unsigned long long) histogram->count);
+}
@@ -0,0 +1,25 @@
+#ifndef SRC_METRICS_H_
+#define SRC_METRICS_H_
+
+#include <stdio.h>
+#include <stdint.h>
+
+/* Log-linear (HDR style) latency histogram in ns: every power of two is split in 2^METRICS_SUB_BITS buckets,
+ * the values are kept within 12.5% up to 2^METRICS_EXP_MAX ns (about 73 minutes)
+ */
+#define METRICS_SUB_BITS	3
+#define METRICS_EXP_MAX		42
+#define METRICS_BUCKETS		((METRICS_EXP_MAX - METRICS_SUB_BITS + 2) << METRICS_SUB_BITS)
+
+struct metrics_histogram {
+	uint64_t count;
+	uint64_t sum;
+	uint64_t bucket[METRICS_BUCKETS];
+};
+
+void			metrics_histogram_record		(struct metrics_histogram*, uint64_t);
+void			metrics_histogram_merge			(struct metrics_histogram*, const struct metrics_histogram*);
+uint64_t		metrics_histogram_quantile		(const struct metrics_histogram*, double);
+void			metrics_histogram_write			(FILE*, const char*, const char*, const struct metrics_histogram*);
+
+#endif /* SRC_METRICS_H_ */
@@ -1,9 +1,13 @@
 #include <stdint.h>
 #include <stddef.h>
+#include <stdlib.h>
 #include <string.h>
 #include <endian.h>
 #include "nvram.h"
 
+#define CRC8_SLICE			16		//Bytes taken at once by crc8()
+#define CRC8_TEST_ROUNDS	200
+
 
 /* CRC table in Netgear Firmware */
 static const uint8_t crc8_table[256] = {
@@ -42,13 +46,306 @@ static const uint8_t crc8_table[256] = {
 };
 
 
-/* Calculate the CRC8 of the provided buffer
+/* Slicing tables: crc8_slice_table[k][x] is the CRC of byte x followed by k zero bytes, starting from 0 */
+static const uint8_t crc8_slice_table[CRC8_SLICE][256] = {
+	{
+		0x00, 0xF7, 0xB9, 0x4E, 0x25, 0xD2, 0x9C, 0x6B, 0x4A, 0xBD, 0xF3, 0x04, 0x6F, 0x98, 0xD6, 0x21,
+		0x94, 0x63, 0x2D, 0xDA, 0xB1, 0x46, 0x08, 0xFF, 0xDE, 0x29, 0x67, 0x90, 0xFB, 0x0C, 0x42, 0xB5,
+		0x7F, 0x88, 0xC6, 0x31, 0x5A, 0xAD, 0xE3, 0x14, 0x35, 0xC2, 0x8C, 0x7B, 0x10, 0xE7, 0xA9, 0x5E,
+		0xEB, 0x1C, 0x52, 0xA5, 0xCE, 0x39, 0x77, 0x80, 0xA1, 0x56, 0x18, 0xEF, 0x84, 0x73, 0x3D, 0xCA,
+		0xFE, 0x09, 0x47, 0xB0, 0xDB, 0x2C, 0x62, 0x95, 0xB4, 0x43, 0x0D, 0xFA, 0x91, 0x66, 0x28, 0xDF,
+		0x6A, 0x9D, 0xD3, 0x24, 0x4F, 0xB8, 0xF6, 0x01, 0x20, 0xD7, 0x99, 0x6E, 0x05, 0xF2, 0xBC, 0x4B,
+		0x81, 0x76, 0x38, 0xCF, 0xA4, 0x53, 0x1D, 0xEA, 0xCB, 0x3C, 0x72, 0x85, 0xEE, 0x19, 0x57, 0xA0,
+		0x15, 0xE2, 0xAC, 0x5B, 0x30, 0xC7, 0x89, 0x7E, 0x5F, 0xA8, 0xE6, 0x11, 0x7A, 0x8D, 0xC3, 0x34,
+		0xAB, 0x5C, 0x12, 0xE5, 0x8E, 0x79, 0x37, 0xC0, 0xE1, 0x16, 0x58, 0xAF, 0xC4, 0x33, 0x7D, 0x8A,
+		0x3F, 0xC8, 0x86, 0x71, 0x1A, 0xED, 0xA3, 0x54, 0x75, 0x82, 0xCC, 0x3B, 0x50, 0xA7, 0xE9, 0x1E,
+		0xD4, 0x23, 0x6D, 0x9A, 0xF1, 0x06, 0x48, 0xBF, 0x9E, 0x69, 0x27, 0xD0, 0xBB, 0x4C, 0x02, 0xF5,
+		0x40, 0xB7, 0xF9, 0x0E, 0x65, 0x92, 0xDC, 0x2B, 0x0A, 0xFD, 0xB3, 0x44, 0x2F, 0xD8, 0x96, 0x61,
+		0x55, 0xA2, 0xEC, 0x1B, 0x70, 0x87, 0xC9, 0x3E, 0x1F, 0xE8, 0xA6, 0x51, 0x3A, 0xCD, 0x83, 0x74,
+		0xC1, 0x36, 0x78, 0x8F, 0xE4, 0x13, 0x5D, 0xAA, 0x8B, 0x7C, 0x32, 0xC5, 0xAE, 0x59, 0x17, 0xE0,
+		0x2A, 0xDD, 0x93, 0x64, 0x0F, 0xF8, 0xB6, 0x41, 0x60, 0x97, 0xD9, 0x2E, 0x45, 0xB2, 0xFC, 0x0B,
+		0xBE, 0x49, 0x07, 0xF0, 0x9B, 0x6C, 0x22, 0xD5, 0xF4, 0x03, 0x4D, 0xBA, 0xD1, 0x26, 0x68, 0x9F
+	},
+	{
+		0x00, 0xD5, 0xFD, 0x28, 0xAD, 0x78, 0x50, 0x85, 0x0D, 0xD8, 0xF0, 0x25, 0xA0, 0x75, 0x5D, 0x88,
+		0x1A, 0xCF, 0xE7, 0x32, 0xB7, 0x62, 0x4A, 0x9F, 0x17, 0xC2, 0xEA, 0x3F, 0xBA, 0x6F, 0x47, 0x92,
+		0x34, 0xE1, 0xC9, 0x1C, 0x99, 0x4C, 0x64, 0xB1, 0x39, 0xEC, 0xC4, 0x11, 0x94, 0x41, 0x69, 0xBC,
+		0x2E, 0xFB, 0xD3, 0x06, 0x83, 0x56, 0x7E, 0xAB, 0x23, 0xF6, 0xDE, 0x0B, 0x8E, 0x5B, 0x73, 0xA6,
+		0x68, 0xBD, 0x95, 0x40, 0xC5, 0x10, 0x38, 0xED, 0x65, 0xB0, 0x98, 0x4D, 0xC8, 0x1D, 0x35, 0xE0,
+		0x72, 0xA7, 0x8F, 0x5A, 0xDF, 0x0A, 0x22, 0xF7, 0x7F, 0xAA, 0x82, 0x57, 0xD2, 0x07, 0x2F, 0xFA,
+		0x5C, 0x89, 0xA1, 0x74, 0xF1, 0x24, 0x0C, 0xD9, 0x51, 0x84, 0xAC, 0x79, 0xFC, 0x29, 0x01, 0xD4,
+		0x46, 0x93, 0xBB, 0x6E, 0xEB, 0x3E, 0x16, 0xC3, 0x4B, 0x9E, 0xB6, 0x63, 0xE6, 0x33, 0x1B, 0xCE,
+		0xD0, 0x05, 0x2D, 0xF8, 0x7D, 0xA8, 0x80, 0x55, 0xDD, 0x08, 0x20, 0xF5, 0x70, 0xA5, 0x8D, 0x58,
+		0xCA, 0x1F, 0x37, 0xE2, 0x67, 0xB2, 0x9A, 0x4F, 0xC7, 0x12, 0x3A, 0xEF, 0x6A, 0xBF, 0x97, 0x42,
+		0xE4, 0x31, 0x19, 0xCC, 0x49, 0x9C, 0xB4, 0x61, 0xE9, 0x3C, 0x14, 0xC1, 0x44, 0x91, 0xB9, 0x6C,
+		0xFE, 0x2B, 0x03, 0xD6, 0x53, 0x86, 0xAE, 0x7B, 0xF3, 0x26, 0x0E, 0xDB, 0x5E, 0x8B, 0xA3, 0x76,
+		0xB8, 0x6D, 0x45, 0x90, 0x15, 0xC0, 0xE8, 0x3D, 0xB5, 0x60, 0x48, 0x9D, 0x18, 0xCD, 0xE5, 0x30,
+		0xA2, 0x77, 0x5F, 0x8A, 0x0F, 0xDA, 0xF2, 0x27, 0xAF, 0x7A, 0x52, 0x87, 0x02, 0xD7, 0xFF, 0x2A,
+		0x8C, 0x59, 0x71, 0xA4, 0x21, 0xF4, 0xDC, 0x09, 0x81, 0x54, 0x7C, 0xA9, 0x2C, 0xF9, 0xD1, 0x04,
+		0x96, 0x43, 0x6B, 0xBE, 0x3B, 0xEE, 0xC6, 0x13, 0x9B, 0x4E, 0x66, 0xB3, 0x36, 0xE3, 0xCB, 0x1E
+	},
+	{
+		0x00, 0x13, 0x26, 0x35, 0x4C, 0x5F, 0x6A, 0x79, 0x98, 0x8B, 0xBE, 0xAD, 0xD4, 0xC7, 0xF2, 0xE1,
+		0x67, 0x74, 0x41, 0x52, 0x2B, 0x38, 0x0D, 0x1E, 0xFF, 0xEC, 0xD9, 0xCA, 0xB3, 0xA0, 0x95, 0x86,
+		0xCE, 0xDD, 0xE8, 0xFB, 0x82, 0x91, 0xA4, 0xB7, 0x56, 0x45, 0x70, 0x63, 0x1A, 0x09, 0x3C, 0x2F,
+		0xA9, 0xBA, 0x8F, 0x9C, 0xE5, 0xF6, 0xC3, 0xD0, 0x31, 0x22, 0x17, 0x04, 0x7D, 0x6E, 0x5B, 0x48,
+		0xCB, 0xD8, 0xED, 0xFE, 0x87, 0x94, 0xA1, 0xB2, 0x53, 0x40, 0x75, 0x66, 0x1F, 0x0C, 0x39, 0x2A,
+		0xAC, 0xBF, 0x8A, 0x99, 0xE0, 0xF3, 0xC6, 0xD5, 0x34, 0x27, 0x12, 0x01, 0x78, 0x6B, 0x5E, 0x4D,
+		0x05, 0x16, 0x23, 0x30, 0x49, 0x5A, 0x6F, 0x7C, 0x9D, 0x8E, 0xBB, 0xA8, 0xD1, 0xC2, 0xF7, 0xE4,
+		0x62, 0x71, 0x44, 0x57, 0x2E, 0x3D, 0x08, 0x1B, 0xFA, 0xE9, 0xDC, 0xCF, 0xB6, 0xA5, 0x90, 0x83,
+		0xC1, 0xD2, 0xE7, 0xF4, 0x8D, 0x9E, 0xAB, 0xB8, 0x59, 0x4A, 0x7F, 0x6C, 0x15, 0x06, 0x33, 0x20,
+		0xA6, 0xB5, 0x80, 0x93, 0xEA, 0xF9, 0xCC, 0xDF, 0x3E, 0x2D, 0x18, 0x0B, 0x72, 0x61, 0x54, 0x47,
+		0x0F, 0x1C, 0x29, 0x3A, 0x43, 0x50, 0x65, 0x76, 0x97, 0x84, 0xB1, 0xA2, 0xDB, 0xC8, 0xFD, 0xEE,
+		0x68, 0x7B, 0x4E, 0x5D, 0x24, 0x37, 0x02, 0x11, 0xF0, 0xE3, 0xD6, 0xC5, 0xBC, 0xAF, 0x9A, 0x89,
+		0x0A, 0x19, 0x2C, 0x3F, 0x46, 0x55, 0x60, 0x73, 0x92, 0x81, 0xB4, 0xA7, 0xDE, 0xCD, 0xF8, 0xEB,
+		0x6D, 0x7E, 0x4B, 0x58, 0x21, 0x32, 0x07, 0x14, 0xF5, 0xE6, 0xD3, 0xC0, 0xB9, 0xAA, 0x9F, 0x8C,
+		0xC4, 0xD7, 0xE2, 0xF1, 0x88, 0x9B, 0xAE, 0xBD, 0x5C, 0x4F, 0x7A, 0x69, 0x10, 0x03, 0x36, 0x25,
+		0xA3, 0xB0, 0x85, 0x96, 0xEF, 0xFC, 0xC9, 0xDA, 0x3B, 0x28, 0x1D, 0x0E, 0x77, 0x64, 0x51, 0x42
+	},
+	{
+		0x00, 0xDA, 0xE3, 0x39, 0x91, 0x4B, 0x72, 0xA8, 0x75, 0xAF, 0x96, 0x4C, 0xE4, 0x3E, 0x07, 0xDD,
+		0xEA, 0x30, 0x09, 0xD3, 0x7B, 0xA1, 0x98, 0x42, 0x9F, 0x45, 0x7C, 0xA6, 0x0E, 0xD4, 0xED, 0x37,
+		0x83, 0x59, 0x60, 0xBA, 0x12, 0xC8, 0xF1, 0x2B, 0xF6, 0x2C, 0x15, 0xCF, 0x67, 0xBD, 0x84, 0x5E,
+		0x69, 0xB3, 0x8A, 0x50, 0xF8, 0x22, 0x1B, 0xC1, 0x1C, 0xC6, 0xFF, 0x25, 0x8D, 0x57, 0x6E, 0xB4,
+		0x51, 0x8B, 0xB2, 0x68, 0xC0, 0x1A, 0x23, 0xF9, 0x24, 0xFE, 0xC7, 0x1D, 0xB5, 0x6F, 0x56, 0x8C,
+		0xBB, 0x61, 0x58, 0x82, 0x2A, 0xF0, 0xC9, 0x13, 0xCE, 0x14, 0x2D, 0xF7, 0x5F, 0x85, 0xBC, 0x66,
+		0xD2, 0x08, 0x31, 0xEB, 0x43, 0x99, 0xA0, 0x7A, 0xA7, 0x7D, 0x44, 0x9E, 0x36, 0xEC, 0xD5, 0x0F,
+		0x38, 0xE2, 0xDB, 0x01, 0xA9, 0x73, 0x4A, 0x90, 0x4D, 0x97, 0xAE, 0x74, 0xDC, 0x06, 0x3F, 0xE5,
+		0xA2, 0x78, 0x41, 0x9B, 0x33, 0xE9, 0xD0, 0x0A, 0xD7, 0x0D, 0x34, 0xEE, 0x46, 0x9C, 0xA5, 0x7F,
+		0x48, 0x92, 0xAB, 0x71, 0xD9, 0x03, 0x3A, 0xE0, 0x3D, 0xE7, 0xDE, 0x04, 0xAC, 0x76, 0x4F, 0x95,
+		0x21, 0xFB, 0xC2, 0x18, 0xB0, 0x6A, 0x53, 0x89, 0x54, 0x8E, 0xB7, 0x6D, 0xC5, 0x1F, 0x26, 0xFC,
+		0xCB, 0x11, 0x28, 0xF2, 0x5A, 0x80, 0xB9, 0x63, 0xBE, 0x64, 0x5D, 0x87, 0x2F, 0xF5, 0xCC, 0x16,
+		0xF3, 0x29, 0x10, 0xCA, 0x62, 0xB8, 0x81, 0x5B, 0x86, 0x5C, 0x65, 0xBF, 0x17, 0xCD, 0xF4, 0x2E,
+		0x19, 0xC3, 0xFA, 0x20, 0x88, 0x52, 0x6B, 0xB1, 0x6C, 0xB6, 0x8F, 0x55, 0xFD, 0x27, 0x1E, 0xC4,
+		0x70, 0xAA, 0x93, 0x49, 0xE1, 0x3B, 0x02, 0xD8, 0x05, 0xDF, 0xE6, 0x3C, 0x94, 0x4E, 0x77, 0xAD,
+		0x9A, 0x40, 0x79, 0xA3, 0x0B, 0xD1, 0xE8, 0x32, 0xEF, 0x35, 0x0C, 0xD6, 0x7E, 0xA4, 0x9D, 0x47
+	},
+	{
+		0x00, 0x32, 0x64, 0x56, 0xC8, 0xFA, 0xAC, 0x9E, 0xC7, 0xF5, 0xA3, 0x91, 0x0F, 0x3D, 0x6B, 0x59,
+		0xD9, 0xEB, 0xBD, 0x8F, 0x11, 0x23, 0x75, 0x47, 0x1E, 0x2C, 0x7A, 0x48, 0xD6, 0xE4, 0xB2, 0x80,
+		0xE5, 0xD7, 0x81, 0xB3, 0x2D, 0x1F, 0x49, 0x7B, 0x22, 0x10, 0x46, 0x74, 0xEA, 0xD8, 0x8E, 0xBC,
+		0x3C, 0x0E, 0x58, 0x6A, 0xF4, 0xC6, 0x90, 0xA2, 0xFB, 0xC9, 0x9F, 0xAD, 0x33, 0x01, 0x57, 0x65,
+		0x9D, 0xAF, 0xF9, 0xCB, 0x55, 0x67, 0x31, 0x03, 0x5A, 0x68, 0x3E, 0x0C, 0x92, 0xA0, 0xF6, 0xC4,
+		0x44, 0x76, 0x20, 0x12, 0x8C, 0xBE, 0xE8, 0xDA, 0x83, 0xB1, 0xE7, 0xD5, 0x4B, 0x79, 0x2F, 0x1D,
+		0x78, 0x4A, 0x1C, 0x2E, 0xB0, 0x82, 0xD4, 0xE6, 0xBF, 0x8D, 0xDB, 0xE9, 0x77, 0x45, 0x13, 0x21,
+		0xA1, 0x93, 0xC5, 0xF7, 0x69, 0x5B, 0x0D, 0x3F, 0x66, 0x54, 0x02, 0x30, 0xAE, 0x9C, 0xCA, 0xF8,
+		0x6D, 0x5F, 0x09, 0x3B, 0xA5, 0x97, 0xC1, 0xF3, 0xAA, 0x98, 0xCE, 0xFC, 0x62, 0x50, 0x06, 0x34,
+		0xB4, 0x86, 0xD0, 0xE2, 0x7C, 0x4E, 0x18, 0x2A, 0x73, 0x41, 0x17, 0x25, 0xBB, 0x89, 0xDF, 0xED,
+		0x88, 0xBA, 0xEC, 0xDE, 0x40, 0x72, 0x24, 0x16, 0x4F, 0x7D, 0x2B, 0x19, 0x87, 0xB5, 0xE3, 0xD1,
+		0x51, 0x63, 0x35, 0x07, 0x99, 0xAB, 0xFD, 0xCF, 0x96, 0xA4, 0xF2, 0xC0, 0x5E, 0x6C, 0x3A, 0x08,
+		0xF0, 0xC2, 0x94, 0xA6, 0x38, 0x0A, 0x5C, 0x6E, 0x37, 0x05, 0x53, 0x61, 0xFF, 0xCD, 0x9B, 0xA9,
+		0x29, 0x1B, 0x4D, 0x7F, 0xE1, 0xD3, 0x85, 0xB7, 0xEE, 0xDC, 0x8A, 0xB8, 0x26, 0x14, 0x42, 0x70,
+		0x15, 0x27, 0x71, 0x43, 0xDD, 0xEF, 0xB9, 0x8B, 0xD2, 0xE0, 0xB6, 0x84, 0x1A, 0x28, 0x7E, 0x4C,
+		0xCC, 0xFE, 0xA8, 0x9A, 0x04, 0x36, 0x60, 0x52, 0x0B, 0x39, 0x6F, 0x5D, 0xC3, 0xF1, 0xA7, 0x95
+	},
+	{
+		0x00, 0x52, 0xA4, 0xF6, 0x1F, 0x4D, 0xBB, 0xE9, 0x3E, 0x6C, 0x9A, 0xC8, 0x21, 0x73, 0x85, 0xD7,
+		0x7C, 0x2E, 0xD8, 0x8A, 0x63, 0x31, 0xC7, 0x95, 0x42, 0x10, 0xE6, 0xB4, 0x5D, 0x0F, 0xF9, 0xAB,
+		0xF8, 0xAA, 0x5C, 0x0E, 0xE7, 0xB5, 0x43, 0x11, 0xC6, 0x94, 0x62, 0x30, 0xD9, 0x8B, 0x7D, 0x2F,
+		0x84, 0xD6, 0x20, 0x72, 0x9B, 0xC9, 0x3F, 0x6D, 0xBA, 0xE8, 0x1E, 0x4C, 0xA5, 0xF7, 0x01, 0x53,
+		0xA7, 0xF5, 0x03, 0x51, 0xB8, 0xEA, 0x1C, 0x4E, 0x99, 0xCB, 0x3D, 0x6F, 0x86, 0xD4, 0x22, 0x70,
+		0xDB, 0x89, 0x7F, 0x2D, 0xC4, 0x96, 0x60, 0x32, 0xE5, 0xB7, 0x41, 0x13, 0xFA, 0xA8, 0x5E, 0x0C,
+		0x5F, 0x0D, 0xFB, 0xA9, 0x40, 0x12, 0xE4, 0xB6, 0x61, 0x33, 0xC5, 0x97, 0x7E, 0x2C, 0xDA, 0x88,
+		0x23, 0x71, 0x87, 0xD5, 0x3C, 0x6E, 0x98, 0xCA, 0x1D, 0x4F, 0xB9, 0xEB, 0x02, 0x50, 0xA6, 0xF4,
+		0x19, 0x4B, 0xBD, 0xEF, 0x06, 0x54, 0xA2, 0xF0, 0x27, 0x75, 0x83, 0xD1, 0x38, 0x6A, 0x9C, 0xCE,
+		0x65, 0x37, 0xC1, 0x93, 0x7A, 0x28, 0xDE, 0x8C, 0x5B, 0x09, 0xFF, 0xAD, 0x44, 0x16, 0xE0, 0xB2,
+		0xE1, 0xB3, 0x45, 0x17, 0xFE, 0xAC, 0x5A, 0x08, 0xDF, 0x8D, 0x7B, 0x29, 0xC0, 0x92, 0x64, 0x36,
+		0x9D, 0xCF, 0x39, 0x6B, 0x82, 0xD0, 0x26, 0x74, 0xA3, 0xF1, 0x07, 0x55, 0xBC, 0xEE, 0x18, 0x4A,
+		0xBE, 0xEC, 0x1A, 0x48, 0xA1, 0xF3, 0x05, 0x57, 0x80, 0xD2, 0x24, 0x76, 0x9F, 0xCD, 0x3B, 0x69,
+		0xC2, 0x90, 0x66, 0x34, 0xDD, 0x8F, 0x79, 0x2B, 0xFC, 0xAE, 0x58, 0x0A, 0xE3, 0xB1, 0x47, 0x15,
+		0x46, 0x14, 0xE2, 0xB0, 0x59, 0x0B, 0xFD, 0xAF, 0x78, 0x2A, 0xDC, 0x8E, 0x67, 0x35, 0xC3, 0x91,
+		0x3A, 0x68, 0x9E, 0xCC, 0x25, 0x77, 0x81, 0xD3, 0x04, 0x56, 0xA0, 0xF2, 0x1B, 0x49, 0xBF, 0xED
+	},
+	{
+		0x00, 0xD3, 0xF1, 0x22, 0xB5, 0x66, 0x44, 0x97, 0x3D, 0xEE, 0xCC, 0x1F, 0x88, 0x5B, 0x79, 0xAA,
+		0x7A, 0xA9, 0x8B, 0x58, 0xCF, 0x1C, 0x3E, 0xED, 0x47, 0x94, 0xB6, 0x65, 0xF2, 0x21, 0x03, 0xD0,
+		0xF4, 0x27, 0x05, 0xD6, 0x41, 0x92, 0xB0, 0x63, 0xC9, 0x1A, 0x38, 0xEB, 0x7C, 0xAF, 0x8D, 0x5E,
+		0x8E, 0x5D, 0x7F, 0xAC, 0x3B, 0xE8, 0xCA, 0x19, 0xB3, 0x60, 0x42, 0x91, 0x06, 0xD5, 0xF7, 0x24,
+		0xBF, 0x6C, 0x4E, 0x9D, 0x0A, 0xD9, 0xFB, 0x28, 0x82, 0x51, 0x73, 0xA0, 0x37, 0xE4, 0xC6, 0x15,
+		0xC5, 0x16, 0x34, 0xE7, 0x70, 0xA3, 0x81, 0x52, 0xF8, 0x2B, 0x09, 0xDA, 0x4D, 0x9E, 0xBC, 0x6F,
+		0x4B, 0x98, 0xBA, 0x69, 0xFE, 0x2D, 0x0F, 0xDC, 0x76, 0xA5, 0x87, 0x54, 0xC3, 0x10, 0x32, 0xE1,
+		0x31, 0xE2, 0xC0, 0x13, 0x84, 0x57, 0x75, 0xA6, 0x0C, 0xDF, 0xFD, 0x2E, 0xB9, 0x6A, 0x48, 0x9B,
+		0x29, 0xFA, 0xD8, 0x0B, 0x9C, 0x4F, 0x6D, 0xBE, 0x14, 0xC7, 0xE5, 0x36, 0xA1, 0x72, 0x50, 0x83,
+		0x53, 0x80, 0xA2, 0x71, 0xE6, 0x35, 0x17, 0xC4, 0x6E, 0xBD, 0x9F, 0x4C, 0xDB, 0x08, 0x2A, 0xF9,
+		0xDD, 0x0E, 0x2C, 0xFF, 0x68, 0xBB, 0x99, 0x4A, 0xE0, 0x33, 0x11, 0xC2, 0x55, 0x86, 0xA4, 0x77,
+		0xA7, 0x74, 0x56, 0x85, 0x12, 0xC1, 0xE3, 0x30, 0x9A, 0x49, 0x6B, 0xB8, 0x2F, 0xFC, 0xDE, 0x0D,
+		0x96, 0x45, 0x67, 0xB4, 0x23, 0xF0, 0xD2, 0x01, 0xAB, 0x78, 0x5A, 0x89, 0x1E, 0xCD, 0xEF, 0x3C,
+		0xEC, 0x3F, 0x1D, 0xCE, 0x59, 0x8A, 0xA8, 0x7B, 0xD1, 0x02, 0x20, 0xF3, 0x64, 0xB7, 0x95, 0x46,
+		0x62, 0xB1, 0x93, 0x40, 0xD7, 0x04, 0x26, 0xF5, 0x5F, 0x8C, 0xAE, 0x7D, 0xEA, 0x39, 0x1B, 0xC8,
+		0x18, 0xCB, 0xE9, 0x3A, 0xAD, 0x7E, 0x5C, 0x8F, 0x25, 0xF6, 0xD4, 0x07, 0x90, 0x43, 0x61, 0xB2
+	},
+	{
+		0x00, 0x8F, 0x49, 0xC6, 0x92, 0x1D, 0xDB, 0x54, 0x73, 0xFC, 0x3A, 0xB5, 0xE1, 0x6E, 0xA8, 0x27,
+		0xE6, 0x69, 0xAF, 0x20, 0x74, 0xFB, 0x3D, 0xB2, 0x95, 0x1A, 0xDC, 0x53, 0x07, 0x88, 0x4E, 0xC1,
+		0x9B, 0x14, 0xD2, 0x5D, 0x09, 0x86, 0x40, 0xCF, 0xE8, 0x67, 0xA1, 0x2E, 0x7A, 0xF5, 0x33, 0xBC,
+		0x7D, 0xF2, 0x34, 0xBB, 0xEF, 0x60, 0xA6, 0x29, 0x0E, 0x81, 0x47, 0xC8, 0x9C, 0x13, 0xD5, 0x5A,
+		0x61, 0xEE, 0x28, 0xA7, 0xF3, 0x7C, 0xBA, 0x35, 0x12, 0x9D, 0x5B, 0xD4, 0x80, 0x0F, 0xC9, 0x46,
+		0x87, 0x08, 0xCE, 0x41, 0x15, 0x9A, 0x5C, 0xD3, 0xF4, 0x7B, 0xBD, 0x32, 0x66, 0xE9, 0x2F, 0xA0,
+		0xFA, 0x75, 0xB3, 0x3C, 0x68, 0xE7, 0x21, 0xAE, 0x89, 0x06, 0xC0, 0x4F, 0x1B, 0x94, 0x52, 0xDD,
+		0x1C, 0x93, 0x55, 0xDA, 0x8E, 0x01, 0xC7, 0x48, 0x6F, 0xE0, 0x26, 0xA9, 0xFD, 0x72, 0xB4, 0x3B,
+		0xC2, 0x4D, 0x8B, 0x04, 0x50, 0xDF, 0x19, 0x96, 0xB1, 0x3E, 0xF8, 0x77, 0x23, 0xAC, 0x6A, 0xE5,
+		0x24, 0xAB, 0x6D, 0xE2, 0xB6, 0x39, 0xFF, 0x70, 0x57, 0xD8, 0x1E, 0x91, 0xC5, 0x4A, 0x8C, 0x03,
+		0x59, 0xD6, 0x10, 0x9F, 0xCB, 0x44, 0x82, 0x0D, 0x2A, 0xA5, 0x63, 0xEC, 0xB8, 0x37, 0xF1, 0x7E,
+		0xBF, 0x30, 0xF6, 0x79, 0x2D, 0xA2, 0x64, 0xEB, 0xCC, 0x43, 0x85, 0x0A, 0x5E, 0xD1, 0x17, 0x98,
+		0xA3, 0x2C, 0xEA, 0x65, 0x31, 0xBE, 0x78, 0xF7, 0xD0, 0x5F, 0x99, 0x16, 0x42, 0xCD, 0x0B, 0x84,
+		0x45, 0xCA, 0x0C, 0x83, 0xD7, 0x58, 0x9E, 0x11, 0x36, 0xB9, 0x7F, 0xF0, 0xA4, 0x2B, 0xED, 0x62,
+		0x38, 0xB7, 0x71, 0xFE, 0xAA, 0x25, 0xE3, 0x6C, 0x4B, 0xC4, 0x02, 0x8D, 0xD9, 0x56, 0x90, 0x1F,
+		0xDE, 0x51, 0x97, 0x18, 0x4C, 0xC3, 0x05, 0x8A, 0xAD, 0x22, 0xE4, 0x6B, 0x3F, 0xB0, 0x76, 0xF9
+	},
+	{
+		0x00, 0x8A, 0x43, 0xC9, 0x86, 0x0C, 0xC5, 0x4F, 0x5B, 0xD1, 0x18, 0x92, 0xDD, 0x57, 0x9E, 0x14,
+		0xB6, 0x3C, 0xF5, 0x7F, 0x30, 0xBA, 0x73, 0xF9, 0xED, 0x67, 0xAE, 0x24, 0x6B, 0xE1, 0x28, 0xA2,
+		0x3B, 0xB1, 0x78, 0xF2, 0xBD, 0x37, 0xFE, 0x74, 0x60, 0xEA, 0x23, 0xA9, 0xE6, 0x6C, 0xA5, 0x2F,
+		0x8D, 0x07, 0xCE, 0x44, 0x0B, 0x81, 0x48, 0xC2, 0xD6, 0x5C, 0x95, 0x1F, 0x50, 0xDA, 0x13, 0x99,
+		0x76, 0xFC, 0x35, 0xBF, 0xF0, 0x7A, 0xB3, 0x39, 0x2D, 0xA7, 0x6E, 0xE4, 0xAB, 0x21, 0xE8, 0x62,
+		0xC0, 0x4A, 0x83, 0x09, 0x46, 0xCC, 0x05, 0x8F, 0x9B, 0x11, 0xD8, 0x52, 0x1D, 0x97, 0x5E, 0xD4,
+		0x4D, 0xC7, 0x0E, 0x84, 0xCB, 0x41, 0x88, 0x02, 0x16, 0x9C, 0x55, 0xDF, 0x90, 0x1A, 0xD3, 0x59,
+		0xFB, 0x71, 0xB8, 0x32, 0x7D, 0xF7, 0x3E, 0xB4, 0xA0, 0x2A, 0xE3, 0x69, 0x26, 0xAC, 0x65, 0xEF,
+		0xEC, 0x66, 0xAF, 0x25, 0x6A, 0xE0, 0x29, 0xA3, 0xB7, 0x3D, 0xF4, 0x7E, 0x31, 0xBB, 0x72, 0xF8,
+		0x5A, 0xD0, 0x19, 0x93, 0xDC, 0x56, 0x9F, 0x15, 0x01, 0x8B, 0x42, 0xC8, 0x87, 0x0D, 0xC4, 0x4E,
+		0xD7, 0x5D, 0x94, 0x1E, 0x51, 0xDB, 0x12, 0x98, 0x8C, 0x06, 0xCF, 0x45, 0x0A, 0x80, 0x49, 0xC3,
+		0x61, 0xEB, 0x22, 0xA8, 0xE7, 0x6D, 0xA4, 0x2E, 0x3A, 0xB0, 0x79, 0xF3, 0xBC, 0x36, 0xFF, 0x75,
+		0x9A, 0x10, 0xD9, 0x53, 0x1C, 0x96, 0x5F, 0xD5, 0xC1, 0x4B, 0x82, 0x08, 0x47, 0xCD, 0x04, 0x8E,
+		0x2C, 0xA6, 0x6F, 0xE5, 0xAA, 0x20, 0xE9, 0x63, 0x77, 0xFD, 0x34, 0xBE, 0xF1, 0x7B, 0xB2, 0x38,
+		0xA1, 0x2B, 0xE2, 0x68, 0x27, 0xAD, 0x64, 0xEE, 0xFA, 0x70, 0xB9, 0x33, 0x7C, 0xF6, 0x3F, 0xB5,
+		0x17, 0x9D, 0x54, 0xDE, 0x91, 0x1B, 0xD2, 0x58, 0x4C, 0xC6, 0x0F, 0x85, 0xCA, 0x40, 0x89, 0x03
+	},
+	{
+		0x00, 0x58, 0xB0, 0xE8, 0x37, 0x6F, 0x87, 0xDF, 0x6E, 0x36, 0xDE, 0x86, 0x59, 0x01, 0xE9, 0xB1,
+		0xDC, 0x84, 0x6C, 0x34, 0xEB, 0xB3, 0x5B, 0x03, 0xB2, 0xEA, 0x02, 0x5A, 0x85, 0xDD, 0x35, 0x6D,
+		0xEF, 0xB7, 0x5F, 0x07, 0xD8, 0x80, 0x68, 0x30, 0x81, 0xD9, 0x31, 0x69, 0xB6, 0xEE, 0x06, 0x5E,
+		0x33, 0x6B, 0x83, 0xDB, 0x04, 0x5C, 0xB4, 0xEC, 0x5D, 0x05, 0xED, 0xB5, 0x6A, 0x32, 0xDA, 0x82,
+		0x89, 0xD1, 0x39, 0x61, 0xBE, 0xE6, 0x0E, 0x56, 0xE7, 0xBF, 0x57, 0x0F, 0xD0, 0x88, 0x60, 0x38,
+		0x55, 0x0D, 0xE5, 0xBD, 0x62, 0x3A, 0xD2, 0x8A, 0x3B, 0x63, 0x8B, 0xD3, 0x0C, 0x54, 0xBC, 0xE4,
+		0x66, 0x3E, 0xD6, 0x8E, 0x51, 0x09, 0xE1, 0xB9, 0x08, 0x50, 0xB8, 0xE0, 0x3F, 0x67, 0x8F, 0xD7,
+		0xBA, 0xE2, 0x0A, 0x52, 0x8D, 0xD5, 0x3D, 0x65, 0xD4, 0x8C, 0x64, 0x3C, 0xE3, 0xBB, 0x53, 0x0B,
+		0x45, 0x1D, 0xF5, 0xAD, 0x72, 0x2A, 0xC2, 0x9A, 0x2B, 0x73, 0x9B, 0xC3, 0x1C, 0x44, 0xAC, 0xF4,
+		0x99, 0xC1, 0x29, 0x71, 0xAE, 0xF6, 0x1E, 0x46, 0xF7, 0xAF, 0x47, 0x1F, 0xC0, 0x98, 0x70, 0x28,
+		0xAA, 0xF2, 0x1A, 0x42, 0x9D, 0xC5, 0x2D, 0x75, 0xC4, 0x9C, 0x74, 0x2C, 0xF3, 0xAB, 0x43, 0x1B,
+		0x76, 0x2E, 0xC6, 0x9E, 0x41, 0x19, 0xF1, 0xA9, 0x18, 0x40, 0xA8, 0xF0, 0x2F, 0x77, 0x9F, 0xC7,
+		0xCC, 0x94, 0x7C, 0x24, 0xFB, 0xA3, 0x4B, 0x13, 0xA2, 0xFA, 0x12, 0x4A, 0x95, 0xCD, 0x25, 0x7D,
+		0x10, 0x48, 0xA0, 0xF8, 0x27, 0x7F, 0x97, 0xCF, 0x7E, 0x26, 0xCE, 0x96, 0x49, 0x11, 0xF9, 0xA1,
+		0x23, 0x7B, 0x93, 0xCB, 0x14, 0x4C, 0xA4, 0xFC, 0x4D, 0x15, 0xFD, 0xA5, 0x7A, 0x22, 0xCA, 0x92,
+		0xFF, 0xA7, 0x4F, 0x17, 0xC8, 0x90, 0x78, 0x20, 0x91, 0xC9, 0x21, 0x79, 0xA6, 0xFE, 0x16, 0x4E
+	},
+	{
+		0x00, 0x20, 0x40, 0x60, 0x80, 0xA0, 0xC0, 0xE0, 0x57, 0x77, 0x17, 0x37, 0xD7, 0xF7, 0x97, 0xB7,
+		0xAE, 0x8E, 0xEE, 0xCE, 0x2E, 0x0E, 0x6E, 0x4E, 0xF9, 0xD9, 0xB9, 0x99, 0x79, 0x59, 0x39, 0x19,
+		0x0B, 0x2B, 0x4B, 0x6B, 0x8B, 0xAB, 0xCB, 0xEB, 0x5C, 0x7C, 0x1C, 0x3C, 0xDC, 0xFC, 0x9C, 0xBC,
+		0xA5, 0x85, 0xE5, 0xC5, 0x25, 0x05, 0x65, 0x45, 0xF2, 0xD2, 0xB2, 0x92, 0x72, 0x52, 0x32, 0x12,
+		0x16, 0x36, 0x56, 0x76, 0x96, 0xB6, 0xD6, 0xF6, 0x41, 0x61, 0x01, 0x21, 0xC1, 0xE1, 0x81, 0xA1,
+		0xB8, 0x98, 0xF8, 0xD8, 0x38, 0x18, 0x78, 0x58, 0xEF, 0xCF, 0xAF, 0x8F, 0x6F, 0x4F, 0x2F, 0x0F,
+		0x1D, 0x3D, 0x5D, 0x7D, 0x9D, 0xBD, 0xDD, 0xFD, 0x4A, 0x6A, 0x0A, 0x2A, 0xCA, 0xEA, 0x8A, 0xAA,
+		0xB3, 0x93, 0xF3, 0xD3, 0x33, 0x13, 0x73, 0x53, 0xE4, 0xC4, 0xA4, 0x84, 0x64, 0x44, 0x24, 0x04,
+		0x2C, 0x0C, 0x6C, 0x4C, 0xAC, 0x8C, 0xEC, 0xCC, 0x7B, 0x5B, 0x3B, 0x1B, 0xFB, 0xDB, 0xBB, 0x9B,
+		0x82, 0xA2, 0xC2, 0xE2, 0x02, 0x22, 0x42, 0x62, 0xD5, 0xF5, 0x95, 0xB5, 0x55, 0x75, 0x15, 0x35,
+		0x27, 0x07, 0x67, 0x47, 0xA7, 0x87, 0xE7, 0xC7, 0x70, 0x50, 0x30, 0x10, 0xF0, 0xD0, 0xB0, 0x90,
+		0x89, 0xA9, 0xC9, 0xE9, 0x09, 0x29, 0x49, 0x69, 0xDE, 0xFE, 0x9E, 0xBE, 0x5E, 0x7E, 0x1E, 0x3E,
+		0x3A, 0x1A, 0x7A, 0x5A, 0xBA, 0x9A, 0xFA, 0xDA, 0x6D, 0x4D, 0x2D, 0x0D, 0xED, 0xCD, 0xAD, 0x8D,
+		0x94, 0xB4, 0xD4, 0xF4, 0x14, 0x34, 0x54, 0x74, 0xC3, 0xE3, 0x83, 0xA3, 0x43, 0x63, 0x03, 0x23,
+		0x31, 0x11, 0x71, 0x51, 0xB1, 0x91, 0xF1, 0xD1, 0x66, 0x46, 0x26, 0x06, 0xE6, 0xC6, 0xA6, 0x86,
+		0x9F, 0xBF, 0xDF, 0xFF, 0x1F, 0x3F, 0x5F, 0x7F, 0xC8, 0xE8, 0x88, 0xA8, 0x48, 0x68, 0x08, 0x28
+	},
+	{
+		0x00, 0x7F, 0xFE, 0x81, 0xAB, 0xD4, 0x55, 0x2A, 0x01, 0x7E, 0xFF, 0x80, 0xAA, 0xD5, 0x54, 0x2B,
+		0x02, 0x7D, 0xFC, 0x83, 0xA9, 0xD6, 0x57, 0x28, 0x03, 0x7C, 0xFD, 0x82, 0xA8, 0xD7, 0x56, 0x29,
+		0x04, 0x7B, 0xFA, 0x85, 0xAF, 0xD0, 0x51, 0x2E, 0x05, 0x7A, 0xFB, 0x84, 0xAE, 0xD1, 0x50, 0x2F,
+		0x06, 0x79, 0xF8, 0x87, 0xAD, 0xD2, 0x53, 0x2C, 0x07, 0x78, 0xF9, 0x86, 0xAC, 0xD3, 0x52, 0x2D,
+		0x08, 0x77, 0xF6, 0x89, 0xA3, 0xDC, 0x5D, 0x22, 0x09, 0x76, 0xF7, 0x88, 0xA2, 0xDD, 0x5C, 0x23,
+		0x0A, 0x75, 0xF4, 0x8B, 0xA1, 0xDE, 0x5F, 0x20, 0x0B, 0x74, 0xF5, 0x8A, 0xA0, 0xDF, 0x5E, 0x21,
+		0x0C, 0x73, 0xF2, 0x8D, 0xA7, 0xD8, 0x59, 0x26, 0x0D, 0x72, 0xF3, 0x8C, 0xA6, 0xD9, 0x58, 0x27,
+		0x0E, 0x71, 0xF0, 0x8F, 0xA5, 0xDA, 0x5B, 0x24, 0x0F, 0x70, 0xF1, 0x8E, 0xA4, 0xDB, 0x5A, 0x25,
+		0x10, 0x6F, 0xEE, 0x91, 0xBB, 0xC4, 0x45, 0x3A, 0x11, 0x6E, 0xEF, 0x90, 0xBA, 0xC5, 0x44, 0x3B,
+		0x12, 0x6D, 0xEC, 0x93, 0xB9, 0xC6, 0x47, 0x38, 0x13, 0x6C, 0xED, 0x92, 0xB8, 0xC7, 0x46, 0x39,
+		0x14, 0x6B, 0xEA, 0x95, 0xBF, 0xC0, 0x41, 0x3E, 0x15, 0x6A, 0xEB, 0x94, 0xBE, 0xC1, 0x40, 0x3F,
+		0x16, 0x69, 0xE8, 0x97, 0xBD, 0xC2, 0x43, 0x3C, 0x17, 0x68, 0xE9, 0x96, 0xBC, 0xC3, 0x42, 0x3D,
+		0x18, 0x67, 0xE6, 0x99, 0xB3, 0xCC, 0x4D, 0x32, 0x19, 0x66, 0xE7, 0x98, 0xB2, 0xCD, 0x4C, 0x33,
+		0x1A, 0x65, 0xE4, 0x9B, 0xB1, 0xCE, 0x4F, 0x30, 0x1B, 0x64, 0xE5, 0x9A, 0xB0, 0xCF, 0x4E, 0x31,
+		0x1C, 0x63, 0xE2, 0x9D, 0xB7, 0xC8, 0x49, 0x36, 0x1D, 0x62, 0xE3, 0x9C, 0xB6, 0xC9, 0x48, 0x37,
+		0x1E, 0x61, 0xE0, 0x9F, 0xB5, 0xCA, 0x4B, 0x34, 0x1F, 0x60, 0xE1, 0x9E, 0xB4, 0xCB, 0x4A, 0x35
+	},
+	{
+		0x00, 0x34, 0x68, 0x5C, 0xD0, 0xE4, 0xB8, 0x8C, 0xF7, 0xC3, 0x9F, 0xAB, 0x27, 0x13, 0x4F, 0x7B,
+		0xB9, 0x8D, 0xD1, 0xE5, 0x69, 0x5D, 0x01, 0x35, 0x4E, 0x7A, 0x26, 0x12, 0x9E, 0xAA, 0xF6, 0xC2,
+		0x25, 0x11, 0x4D, 0x79, 0xF5, 0xC1, 0x9D, 0xA9, 0xD2, 0xE6, 0xBA, 0x8E, 0x02, 0x36, 0x6A, 0x5E,
+		0x9C, 0xA8, 0xF4, 0xC0, 0x4C, 0x78, 0x24, 0x10, 0x6B, 0x5F, 0x03, 0x37, 0xBB, 0x8F, 0xD3, 0xE7,
+		0x4A, 0x7E, 0x22, 0x16, 0x9A, 0xAE, 0xF2, 0xC6, 0xBD, 0x89, 0xD5, 0xE1, 0x6D, 0x59, 0x05, 0x31,
+		0xF3, 0xC7, 0x9B, 0xAF, 0x23, 0x17, 0x4B, 0x7F, 0x04, 0x30, 0x6C, 0x58, 0xD4, 0xE0, 0xBC, 0x88,
+		0x6F, 0x5B, 0x07, 0x33, 0xBF, 0x8B, 0xD7, 0xE3, 0x98, 0xAC, 0xF0, 0xC4, 0x48, 0x7C, 0x20, 0x14,
+		0xD6, 0xE2, 0xBE, 0x8A, 0x06, 0x32, 0x6E, 0x5A, 0x21, 0x15, 0x49, 0x7D, 0xF1, 0xC5, 0x99, 0xAD,
+		0x94, 0xA0, 0xFC, 0xC8, 0x44, 0x70, 0x2C, 0x18, 0x63, 0x57, 0x0B, 0x3F, 0xB3, 0x87, 0xDB, 0xEF,
+		0x2D, 0x19, 0x45, 0x71, 0xFD, 0xC9, 0x95, 0xA1, 0xDA, 0xEE, 0xB2, 0x86, 0x0A, 0x3E, 0x62, 0x56,
+		0xB1, 0x85, 0xD9, 0xED, 0x61, 0x55, 0x09, 0x3D, 0x46, 0x72, 0x2E, 0x1A, 0x96, 0xA2, 0xFE, 0xCA,
+		0x08, 0x3C, 0x60, 0x54, 0xD8, 0xEC, 0xB0, 0x84, 0xFF, 0xCB, 0x97, 0xA3, 0x2F, 0x1B, 0x47, 0x73,
+		0xDE, 0xEA, 0xB6, 0x82, 0x0E, 0x3A, 0x66, 0x52, 0x29, 0x1D, 0x41, 0x75, 0xF9, 0xCD, 0x91, 0xA5,
+		0x67, 0x53, 0x0F, 0x3B, 0xB7, 0x83, 0xDF, 0xEB, 0x90, 0xA4, 0xF8, 0xCC, 0x40, 0x74, 0x28, 0x1C,
+		0xFB, 0xCF, 0x93, 0xA7, 0x2B, 0x1F, 0x43, 0x77, 0x0C, 0x38, 0x64, 0x50, 0xDC, 0xE8, 0xB4, 0x80,
+		0x42, 0x76, 0x2A, 0x1E, 0x92, 0xA6, 0xFA, 0xCE, 0xB5, 0x81, 0xDD, 0xE9, 0x65, 0x51, 0x0D, 0x39
+	},
+	{
+		0x00, 0xCE, 0xCB, 0x05, 0xC1, 0x0F, 0x0A, 0xC4, 0xD5, 0x1B, 0x1E, 0xD0, 0x14, 0xDA, 0xDF, 0x11,
+		0xFD, 0x33, 0x36, 0xF8, 0x3C, 0xF2, 0xF7, 0x39, 0x28, 0xE6, 0xE3, 0x2D, 0xE9, 0x27, 0x22, 0xEC,
+		0xAD, 0x63, 0x66, 0xA8, 0x6C, 0xA2, 0xA7, 0x69, 0x78, 0xB6, 0xB3, 0x7D, 0xB9, 0x77, 0x72, 0xBC,
+		0x50, 0x9E, 0x9B, 0x55, 0x91, 0x5F, 0x5A, 0x94, 0x85, 0x4B, 0x4E, 0x80, 0x44, 0x8A, 0x8F, 0x41,
+		0x0D, 0xC3, 0xC6, 0x08, 0xCC, 0x02, 0x07, 0xC9, 0xD8, 0x16, 0x13, 0xDD, 0x19, 0xD7, 0xD2, 0x1C,
+		0xF0, 0x3E, 0x3B, 0xF5, 0x31, 0xFF, 0xFA, 0x34, 0x25, 0xEB, 0xEE, 0x20, 0xE4, 0x2A, 0x2F, 0xE1,
+		0xA0, 0x6E, 0x6B, 0xA5, 0x61, 0xAF, 0xAA, 0x64, 0x75, 0xBB, 0xBE, 0x70, 0xB4, 0x7A, 0x7F, 0xB1,
+		0x5D, 0x93, 0x96, 0x58, 0x9C, 0x52, 0x57, 0x99, 0x88, 0x46, 0x43, 0x8D, 0x49, 0x87, 0x82, 0x4C,
+		0x1A, 0xD4, 0xD1, 0x1F, 0xDB, 0x15, 0x10, 0xDE, 0xCF, 0x01, 0x04, 0xCA, 0x0E, 0xC0, 0xC5, 0x0B,
+		0xE7, 0x29, 0x2C, 0xE2, 0x26, 0xE8, 0xED, 0x23, 0x32, 0xFC, 0xF9, 0x37, 0xF3, 0x3D, 0x38, 0xF6,
+		0xB7, 0x79, 0x7C, 0xB2, 0x76, 0xB8, 0xBD, 0x73, 0x62, 0xAC, 0xA9, 0x67, 0xA3, 0x6D, 0x68, 0xA6,
+		0x4A, 0x84, 0x81, 0x4F, 0x8B, 0x45, 0x40, 0x8E, 0x9F, 0x51, 0x54, 0x9A, 0x5E, 0x90, 0x95, 0x5B,
+		0x17, 0xD9, 0xDC, 0x12, 0xD6, 0x18, 0x1D, 0xD3, 0xC2, 0x0C, 0x09, 0xC7, 0x03, 0xCD, 0xC8, 0x06,
+		0xEA, 0x24, 0x21, 0xEF, 0x2B, 0xE5, 0xE0, 0x2E, 0x3F, 0xF1, 0xF4, 0x3A, 0xFE, 0x30, 0x35, 0xFB,
+		0xBA, 0x74, 0x71, 0xBF, 0x7B, 0xB5, 0xB0, 0x7E, 0x6F, 0xA1, 0xA4, 0x6A, 0xAE, 0x60, 0x65, 0xAB,
+		0x47, 0x89, 0x8C, 0x42, 0x86, 0x48, 0x4D, 0x83, 0x92, 0x5C, 0x59, 0x97, 0x53, 0x9D, 0x98, 0x56
+	},
+	{
+		0x00, 0x83, 0x51, 0xD2, 0xA2, 0x21, 0xF3, 0x70, 0x13, 0x90, 0x42, 0xC1, 0xB1, 0x32, 0xE0, 0x63,
+		0x26, 0xA5, 0x77, 0xF4, 0x84, 0x07, 0xD5, 0x56, 0x35, 0xB6, 0x64, 0xE7, 0x97, 0x14, 0xC6, 0x45,
+		0x4C, 0xCF, 0x1D, 0x9E, 0xEE, 0x6D, 0xBF, 0x3C, 0x5F, 0xDC, 0x0E, 0x8D, 0xFD, 0x7E, 0xAC, 0x2F,
+		0x6A, 0xE9, 0x3B, 0xB8, 0xC8, 0x4B, 0x99, 0x1A, 0x79, 0xFA, 0x28, 0xAB, 0xDB, 0x58, 0x8A, 0x09,
+		0x98, 0x1B, 0xC9, 0x4A, 0x3A, 0xB9, 0x6B, 0xE8, 0x8B, 0x08, 0xDA, 0x59, 0x29, 0xAA, 0x78, 0xFB,
+		0xBE, 0x3D, 0xEF, 0x6C, 0x1C, 0x9F, 0x4D, 0xCE, 0xAD, 0x2E, 0xFC, 0x7F, 0x0F, 0x8C, 0x5E, 0xDD,
+		0xD4, 0x57, 0x85, 0x06, 0x76, 0xF5, 0x27, 0xA4, 0xC7, 0x44, 0x96, 0x15, 0x65, 0xE6, 0x34, 0xB7,
+		0xF2, 0x71, 0xA3, 0x20, 0x50, 0xD3, 0x01, 0x82, 0xE1, 0x62, 0xB0, 0x33, 0x43, 0xC0, 0x12, 0x91,
+		0x67, 0xE4, 0x36, 0xB5, 0xC5, 0x46, 0x94, 0x17, 0x74, 0xF7, 0x25, 0xA6, 0xD6, 0x55, 0x87, 0x04,
+		0x41, 0xC2, 0x10, 0x93, 0xE3, 0x60, 0xB2, 0x31, 0x52, 0xD1, 0x03, 0x80, 0xF0, 0x73, 0xA1, 0x22,
+		0x2B, 0xA8, 0x7A, 0xF9, 0x89, 0x0A, 0xD8, 0x5B, 0x38, 0xBB, 0x69, 0xEA, 0x9A, 0x19, 0xCB, 0x48,
+		0x0D, 0x8E, 0x5C, 0xDF, 0xAF, 0x2C, 0xFE, 0x7D, 0x1E, 0x9D, 0x4F, 0xCC, 0xBC, 0x3F, 0xED, 0x6E,
+		0xFF, 0x7C, 0xAE, 0x2D, 0x5D, 0xDE, 0x0C, 0x8F, 0xEC, 0x6F, 0xBD, 0x3E, 0x4E, 0xCD, 0x1F, 0x9C,
+		0xD9, 0x5A, 0x88, 0x0B, 0x7B, 0xF8, 0x2A, 0xA9, 0xCA, 0x49, 0x9B, 0x18, 0x68, 0xEB, 0x39, 0xBA,
+		0xB3, 0x30, 0xE2, 0x61, 0x11, 0x92, 0x40, 0xC3, 0xA0, 0x23, 0xF1, 0x72, 0x02, 0x81, 0x53, 0xD0,
+		0x95, 0x16, 0xC4, 0x47, 0x37, 0xB4, 0x66, 0xE5, 0x86, 0x05, 0xD7, 0x54, 0x24, 0xA7, 0x75, 0xF6
+	},
+	{
+		0x00, 0xE5, 0x9D, 0x78, 0x6D, 0x88, 0xF0, 0x15, 0xDA, 0x3F, 0x47, 0xA2, 0xB7, 0x52, 0x2A, 0xCF,
+		0xE3, 0x06, 0x7E, 0x9B, 0x8E, 0x6B, 0x13, 0xF6, 0x39, 0xDC, 0xA4, 0x41, 0x54, 0xB1, 0xC9, 0x2C,
+		0x91, 0x74, 0x0C, 0xE9, 0xFC, 0x19, 0x61, 0x84, 0x4B, 0xAE, 0xD6, 0x33, 0x26, 0xC3, 0xBB, 0x5E,
+		0x72, 0x97, 0xEF, 0x0A, 0x1F, 0xFA, 0x82, 0x67, 0xA8, 0x4D, 0x35, 0xD0, 0xC5, 0x20, 0x58, 0xBD,
+		0x75, 0x90, 0xE8, 0x0D, 0x18, 0xFD, 0x85, 0x60, 0xAF, 0x4A, 0x32, 0xD7, 0xC2, 0x27, 0x5F, 0xBA,
+		0x96, 0x73, 0x0B, 0xEE, 0xFB, 0x1E, 0x66, 0x83, 0x4C, 0xA9, 0xD1, 0x34, 0x21, 0xC4, 0xBC, 0x59,
+		0xE4, 0x01, 0x79, 0x9C, 0x89, 0x6C, 0x14, 0xF1, 0x3E, 0xDB, 0xA3, 0x46, 0x53, 0xB6, 0xCE, 0x2B,
+		0x07, 0xE2, 0x9A, 0x7F, 0x6A, 0x8F, 0xF7, 0x12, 0xDD, 0x38, 0x40, 0xA5, 0xB0, 0x55, 0x2D, 0xC8,
+		0xEA, 0x0F, 0x77, 0x92, 0x87, 0x62, 0x1A, 0xFF, 0x30, 0xD5, 0xAD, 0x48, 0x5D, 0xB8, 0xC0, 0x25,
+		0x09, 0xEC, 0x94, 0x71, 0x64, 0x81, 0xF9, 0x1C, 0xD3, 0x36, 0x4E, 0xAB, 0xBE, 0x5B, 0x23, 0xC6,
+		0x7B, 0x9E, 0xE6, 0x03, 0x16, 0xF3, 0x8B, 0x6E, 0xA1, 0x44, 0x3C, 0xD9, 0xCC, 0x29, 0x51, 0xB4,
+		0x98, 0x7D, 0x05, 0xE0, 0xF5, 0x10, 0x68, 0x8D, 0x42, 0xA7, 0xDF, 0x3A, 0x2F, 0xCA, 0xB2, 0x57,
+		0x9F, 0x7A, 0x02, 0xE7, 0xF2, 0x17, 0x6F, 0x8A, 0x45, 0xA0, 0xD8, 0x3D, 0x28, 0xCD, 0xB5, 0x50,
+		0x7C, 0x99, 0xE1, 0x04, 0x11, 0xF4, 0x8C, 0x69, 0xA6, 0x43, 0x3B, 0xDE, 0xCB, 0x2E, 0x56, 0xB3,
+		0x0E, 0xEB, 0x93, 0x76, 0x63, 0x86, 0xFE, 0x1B, 0xD4, 0x31, 0x49, 0xAC, 0xB9, 0x5C, 0x24, 0xC1,
+		0xED, 0x08, 0x70, 0x95, 0x80, 0x65, 0x1D, 0xF8, 0x37, 0xD2, 0xAA, 0x4F, 0x5A, 0xBF, 0xC7, 0x22
+	}
+};
+
+
+/* Calculate the CRC8 of the provided buffer, one byte at a time
  * buffer:		The input buffer
  * buffer_len:	The input buffer length
  * crc:			CRC starting value (for small chunks of buffer data)
  * NOTE: This function has been reverse engineered from Netgear's firmware
  */
-static uint8_t hndcrc8 (uint8_t* buffer, size_t buffer_len, uint8_t crc)
+static uint8_t hndcrc8 (const uint8_t* buffer, size_t buffer_len, uint8_t crc)
 {
 	uint8_t buffer_b;
 	uint8_t crc_i;
@@ -65,11 +362,171 @@ static uint8_t hndcrc8 (uint8_t* buffer, size_t buffer_len, uint8_t crc)
 }
 
 
+/* Calculate the CRC8 of the provided buffer, CRC8_SLICE bytes at a time
+ * buffer:		The input buffer
+ * buffer_len:	The input buffer length
+ * crc:			CRC starting value (NVRAM_CRC_START, or the CRC of the previous chunk)
+ * RETURN:		The CRC8, the same as hndcrc8()
+ * NOTE: The CRC is linear and its state is a single byte, so every input byte only needs to be
+ *       carried through the table once per zero byte following it within the slice
+ */
+uint8_t crc8 (const uint8_t* buffer, size_t buffer_len, uint8_t crc)
+{
+	uint64_t lo, hi;
+
+	while (buffer_len >= CRC8_SLICE)
+	{
+		memcpy (&lo, buffer, 8);
+		memcpy (&hi, buffer + 8, 8);
+		lo = le64toh (lo) ^ crc;
+		hi = le64toh (hi);
+
+		crc = crc8_slice_table[15][lo & 0xFF] ^ crc8_slice_table[14][(lo >> 8) & 0xFF]
+			^ crc8_slice_table[13][(lo >> 16) & 0xFF] ^ crc8_slice_table[12][(lo >> 24) & 0xFF]
+			^ crc8_slice_table[11][(lo >> 32) & 0xFF] ^ crc8_slice_table[10][(lo >> 40) & 0xFF]
+			^ crc8_slice_table[9][(lo >> 48) & 0xFF] ^ crc8_slice_table[8][lo >> 56]
+			^ crc8_slice_table[7][hi & 0xFF] ^ crc8_slice_table[6][(hi >> 8) & 0xFF]
+			^ crc8_slice_table[5][(hi >> 16) & 0xFF] ^ crc8_slice_table[4][(hi >> 24) & 0xFF]
+			^ crc8_slice_table[3][(hi >> 32) & 0xFF] ^ crc8_slice_table[2][(hi >> 40) & 0xFF]
+			^ crc8_slice_table[1][(hi >> 48) & 0xFF] ^ crc8_slice_table[0][hi >> 56];
+
+		buffer += CRC8_SLICE;
+		buffer_len -= CRC8_SLICE;
+	}
+
+	return hndcrc8 (buffer, buffer_len, crc);
+}
+
+
+/* Applies a linear operator on the CRC8 state
+ * op:			The operator, as the images of the 8 state bits
+ * crc:			The CRC8 state
+ * RETURN:		The transformed state
+ */
+static uint8_t crc8_apply (const uint8_t* op, uint8_t crc)
+{
+	uint8_t ret;
+	int i;
+
+	ret = 0;
+	for (i = 0; i < 8; i++)
+		if (crc & (1 << i))
+			ret ^= op[i];
+
+	return ret;
+}
+
+
+/* Advances a CRC8 over a run of zero bytes
+ * crc:			The CRC8 state
+ * len:			The number of zero bytes
+ * RETURN:		The CRC8 after the zero bytes, the same as crc8() over len zero bytes
+ * NOTE: Runs in O(log len) by squaring the one byte operator
+ */
+uint8_t crc8_shift (uint8_t crc, size_t len)
+{
+	uint8_t op[8], op_sq[8];
+	int i;
+
+	/* Feeding a zero byte is a table lookup, a linear operator itself */
+	for (i = 0; i < 8; i++)
+		op[i] = crc8_table[1 << i];
+
+	while (len)
+	{
+		if (len & 1)
+			crc = crc8_apply (op, crc);
+		len >>= 1;
+
+		if (len)
+		{
+			for (i = 0; i < 8; i++)
+				op_sq[i] = crc8_apply (op, op[i]);
+			memcpy (op, op_sq, sizeof (op));
+		}
+	}
+
+	return crc;
+}
+
+
+/* Merges the CRC8 of two adjacent chunks
+ * crc_a:		The CRC8 of the first chunk
+ * crc_b:		The CRC8 of the second chunk, calculated from NVRAM_CRC_START as well
+ * len_b:		The second chunk length
+ * RETURN:		The CRC8 of the two chunks as a whole
+ * NOTE: Lets the chunks of a buffer be calculated independently (eg. by different threads)
+ */
+uint8_t crc8_combine (uint8_t crc_a, uint8_t crc_b, size_t len_b)
+{
+	/* crc_b has NVRAM_CRC_START carried through its chunk, crc_a has to replace it */
+	return crc8_shift (crc_a ^ NVRAM_CRC_START, len_b) ^ crc_b;
+}
+
+
+/* Checks the sliced CRC8, its shift and its combination against the byte at a time one
+ * result:		The results, a kernel each
+ * result_max:	The results room (3 at least)
+ * RETURN:		The number of results, -1 if the test buffer can not be allocated
+ */
+int crc8_self_test (struct self_test_result *result, int result_max)
+{
+	static const char * const kernels[] = { "sliced", "combine", "shift" };
+	uint8_t *buffer;
+	unsigned int seed;
+	size_t len, offset, split;
+	int round, failed[3], i;
+	uint8_t expected;
+
+	buffer = malloc (NVRAM_IMAGE_SIZE_DEFAULT + CRC8_SLICE);
+	if (!buffer)
+		return -1;
+
+	seed = 0x464C5348;
+	for (len = 0; len < NVRAM_IMAGE_SIZE_DEFAULT + CRC8_SLICE; len++)
+		buffer[len] = (uint8_t) rand_r (&seed);
+
+	memset (failed, 0, sizeof (failed));
+	for (round = 0; round < CRC8_TEST_ROUNDS; round++)
+	{
+		/* Random lengths at random alignments, including a whole default image */
+		len = round ? rand_r (&seed) % (NVRAM_IMAGE_SIZE_DEFAULT + 1) : NVRAM_IMAGE_SIZE_DEFAULT;
+		offset = rand_r (&seed) % CRC8_SLICE;
+		split = len ? rand_r (&seed) % (len + 1) : 0;
+
+		expected = hndcrc8 (buffer + offset, len, NVRAM_CRC_START);
+		if (crc8 (buffer + offset, len, NVRAM_CRC_START) != expected)
+			failed[0]++;
+		if (crc8_combine (crc8 (buffer + offset, split, NVRAM_CRC_START), crc8 (buffer + offset + split, len - split, NVRAM_CRC_START), len - split) != expected)
+			failed[1]++;
+	}
+
+	/* Shifting is checked against real zero bytes */
+	for (len = 0; len < 4096; len += 1 + len / 4)
+	{
+		memset (buffer, 0, len);
+		for (i = 0; i < 256; i += 37)
+			if (crc8_shift ((uint8_t) i, len) != hndcrc8 (buffer, len, (uint8_t) i))
+				failed[2]++;
+	}
+
+	for (i = 0; i < 3 && i < result_max; i++)
+	{
+		result[i].test = "CRC8";
+		result[i].kernel = kernels[i];
+		result[i].result = failed[i] ? SELF_TEST_FAILED : SELF_TEST_PASSED;
+	}
+
+	free (buffer);
+	return i;
+}
+
+
 /* Get the NVRAM magic
  * buffer:		The NVRAM buffer
  * RETURN:		The NVRAM magic number
  */
-uint32_t get_magic (uint8_t* buffer)
+uint32_t get_nvram_magic (uint8_t* buffer)
 {
 	if (!buffer)
 		return 0;
@@ -82,7 +539,7 @@ uint32_t get_magic (uint8_t* buffer)
  * buffer:		The NVRAM buffer
  * magic:		The magic number calculated before
  */
-void set_magic (uint8_t* buffer, uint32_t magic)
+void set_nvram_magic (uint8_t* buffer, uint32_t magic)
 {
 	uint32_t magic_be;
 
@@ -157,15 +614,33 @@ uint8_t calculate_crc (uint8_t* buffer)
 	uint8_t crc;
 
 	/* Calculate the fields first */
-	crc = hndcrc8(buffer + NVRAM_INDEX_FIELD1, NVRAM_SIZE_FIELD1, NVRAM_CRC_START);
-	crc = hndcrc8(buffer + NVRAM_INDEX_FIELD2, NVRAM_SIZE_FIELD2, crc);
+	crc = crc8(buffer + NVRAM_INDEX_FIELD1, NVRAM_SIZE_FIELD1, NVRAM_CRC_START);
+	crc = crc8(buffer + NVRAM_INDEX_FIELD2, NVRAM_SIZE_FIELD2, crc);
 
 	/* Calculate for the data */
-	crc = hndcrc8(buffer + NVRAM_INDEX_DATA, get_length(buffer) - NVRAM_INDEX_DATA, crc);
+	crc = crc8(buffer + NVRAM_INDEX_DATA, get_length(buffer) - NVRAM_INDEX_DATA, crc);
 
 	return crc;
 }
 
+/* Updates the NVRAM CRC8 after a range of the image has been changed
+ * buffer:		The NVRAM buffer, holding the header and the new data of the range
+ * offset:		The range offset, within the CRC8 covered bytes (NVRAM_INDEX_FIELD1 to the length)
+ * old_data:	The range data before the change
+ * len:			The range length
+ * NOTE: The CRC8 is linear: the change is carried through the bytes following the range by crc8_shift()
+ */
+void update_crc (uint8_t* buffer, uint32_t offset, const uint8_t* old_data, uint32_t len)
+{
+	uint8_t delta;
+
+	if (!buffer || !old_data || offset < NVRAM_INDEX_FIELD1 || offset + len > get_length(buffer))
+		return;
+
+	delta = crc8 (old_data, len, 0) ^ crc8 (buffer + offset, len, 0);
+	set_crc (buffer, get_crc (buffer) ^ crc8_shift (delta, get_length(buffer) - offset - len));
+}
+
 /* Applies to a NVRAM image the FIELD1 content
  * buffer:		The NVRAM buffer
  */
@@ -3,8 +3,10 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include "selftest.h"
 
-#define NVRAM_IMAGE_SIZE_MAX	0x10000
+#define NVRAM_IMAGE_SIZE_DEFAULT	0x10000		//NVRAM partition of the models not known to have a bigger one
+#define NVRAM_IMAGE_SIZE_MAX		0x1000000	//Largest NVRAM image handled (NTGRBAK_IMAGE_SIZE_MAX)
 
 #define NVRAM_INDEX_MAGIC	0	//Bytes 0-3
 #define NVRAM_INDEX_LENGTH	4	//Bytes 4-7
@@ -27,15 +29,20 @@
 
 #define NVRAM_CRC_START		0xFF
 
-uint32_t	get_magic		(uint8_t*);
-void		set_magic		(uint8_t*, uint32_t);
+uint32_t	get_nvram_magic	(uint8_t*);
+void		set_nvram_magic	(uint8_t*, uint32_t);
 uint32_t	get_length		(uint8_t*);
 void		set_length		(uint8_t*, uint32_t);
 uint8_t		get_crc			(uint8_t*);
 void		set_crc			(uint8_t*, uint8_t);
 uint8_t		calculate_crc	(uint8_t*);
+void		update_crc		(uint8_t*, uint32_t, const uint8_t*, uint32_t);
 void		set_field1		(uint8_t*);
 void		set_field2		(uint8_t*);
+uint8_t		crc8			(const uint8_t*, size_t, uint8_t);
+uint8_t		crc8_shift		(uint8_t, size_t);
+uint8_t		crc8_combine	(uint8_t, uint8_t, size_t);
+int			crc8_self_test	(struct self_test_result*, int);
 
 
 #endif /* SRC_NVRAM_H_ */
@@ -0,0 +1,17 @@
+#ifndef SRC_SELFTEST_H_
+#define SRC_SELFTEST_H_
+
+/* Results of the kernel self-tests, printed by the S modes */
+#define SELF_TEST_PASSED	0
+#define SELF_TEST_FAILED	1
+#define SELF_TEST_SKIPPED	2		//Not supported by the CPU
+
+#define SELF_TEST_RESULTS_MAX	16	//Enough for every self-test of a source
+
+struct self_test_result {
+	const char * test;
+	const char * kernel;
+	int result;				//SELF_TEST_*
+};
+
+#endif /* SRC_SELFTEST_H_ */
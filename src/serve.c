@@ -0,0 +1,505 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include "libntgrbak.h"
+#include "serve.h"
+
+#define SERVE_TEST_BUFFER_SIZE		4096
+#define SERVE_TEST_PAYLOAD_SIZE		(1024 * 1024)
+
+#define SERVE_MESSAGE_TOO_BIG		"Request payload too big!\n"
+
+
+struct serve_server;
+
+struct serve_connection {
+	struct serve_server *server;
+	int fd;						//-1 when the slot is free
+};
+
+struct serve_server {
+	serve_routine routine;
+	void *arg;
+	size_t buffer_size;
+	int listen_fd;
+	int stop;
+	int connections;
+	pthread_mutex_t lock;
+	pthread_cond_t idle;		//Signaled when a connection ends
+	struct serve_connection connection[SERVE_CONNECTIONS_MAX];
+};
+
+
+static void serve_put32 (unsigned char *p, uint32_t value)
+{
+	p[0] = value;
+	p[1] = value >> 8;
+	p[2] = value >> 16;
+	p[3] = value >> 24;
+}
+
+static uint32_t serve_get32 (const unsigned char *p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+
+/* Reads exactly len bytes
+ * RETURN:		0: Success, 1: Failure or end of the stream
+ */
+static int serve_read (int fd, void *data, size_t len)
+{
+	ssize_t ret;
+
+	while (len)
+	{
+		ret = read (fd, data, len);
+		if (ret < 0 && errno == EINTR)
+			continue;
+		if (ret <= 0)
+			return 1;
+		data = (unsigned char *) data + ret;
+		len -= ret;
+	}
+
+	return 0;
+}
+
+
+/* Reads and drops len bytes, keeping the stream in step past a refused request
+ * buffer:		A scratch buffer
+ * buffer_size:	The scratch buffer size
+ * RETURN:		0: Success, 1: Failure or end of the stream
+ */
+static int serve_discard (int fd, unsigned char *buffer, size_t buffer_size, size_t len)
+{
+	size_t n;
+
+	while (len)
+	{
+		n = len < buffer_size ? len : buffer_size;
+		if (serve_read (fd, buffer, n))
+			return 1;
+		len -= n;
+	}
+
+	return 0;
+}
+
+
+/* Writes a header and its payload in as few system calls as possible
+ * RETURN:		0: Success, 1: Failure
+ */
+static int serve_write (int fd, const unsigned char *header, size_t header_len, const unsigned char *payload, size_t payload_len)
+{
+	struct iovec iov[2];
+	struct msghdr msg;
+	ssize_t ret;
+	size_t done;
+
+	iov[0].iov_base = (void *) header;
+	iov[0].iov_len = header_len;
+	iov[1].iov_base = (void *) payload;
+	iov[1].iov_len = payload_len;
+	memset (&msg, 0, sizeof (msg));
+	msg.msg_iov = iov;
+	msg.msg_iovlen = payload_len ? 2 : 1;
+
+	while (msg.msg_iovlen)
+	{
+		ret = sendmsg (fd, &msg, MSG_NOSIGNAL);
+		if (ret < 0 && errno == EINTR)
+			continue;
+		if (ret <= 0)
+			return 1;
+		for (done = ret; msg.msg_iovlen && done >= msg.msg_iov->iov_len; msg.msg_iovlen--, msg.msg_iov++)
+			done -= msg.msg_iov->iov_len;
+		if (msg.msg_iovlen)
+		{
+			msg.msg_iov->iov_base = (unsigned char *) msg.msg_iov->iov_base + done;
+			msg.msg_iov->iov_len -= done;
+		}
+	}
+
+	return 0;
+}
+
+
+static int serve_respond (int fd, int status, const unsigned char *payload, size_t len)
+{
+	unsigned char header[SERVE_RESPONSE_SIZE];
+
+	serve_put32 (header, status);
+	serve_put32 (header + 4, len);
+	return serve_write (fd, header, sizeof (header), payload, len);
+}
+
+
+/* Connection thread: answers its requests until the peer closes it
+ * The buffers are allocated once per connection and kept for all its requests
+ */
+static void * serve_worker (void *arg)
+{
+	struct serve_connection *connection = arg;
+	struct serve_server *server = connection->server;
+	struct serve_request request;
+	unsigned char header[SERVE_REQUEST_SIZE];
+	unsigned char *input, *output;
+	const char *message;
+	size_t output_len;
+	int status;
+
+	input = malloc (2 * server->buffer_size);
+	output = input + server->buffer_size;
+
+	while (input && !serve_read (connection->fd, header, sizeof (header)))
+	{
+		request.mode = header[4];
+		request.flags = header[5];
+		request.magic = serve_get32 (header + 8);
+		request.version = serve_get32 (header + 12);
+		request.length = serve_get32 (header + 16);
+
+		/* The stream can not be resynchronized after a bad request */
+		if (serve_get32 (header) != SERVE_MAGIC)
+		{
+			message = "Bad request magic!\n";
+			serve_respond (connection->fd, NTGRBAK_ERR_ARGS, (const unsigned char *) message, strlen (message));
+			break;
+		}
+		/* The client writes the whole payload before reading the response: drain it, then go on */
+		if (request.length > server->buffer_size)
+		{
+			message = SERVE_MESSAGE_TOO_BIG;
+			if (serve_discard (connection->fd, input, server->buffer_size, request.length) ||
+				serve_respond (connection->fd, NTGRBAK_ERR_TOO_BIG, (const unsigned char *) message, strlen (message)))
+				break;
+			continue;
+		}
+		if (serve_read (connection->fd, input, request.length))
+			break;
+
+		output_len = 0;
+		status = server->routine (server->arg, &request, input, output, server->buffer_size, &output_len);
+		if (serve_respond (connection->fd, status, output, output_len))
+			break;
+	}
+	free (input);
+
+	pthread_mutex_lock (&server->lock);
+	close (connection->fd);
+	connection->fd = -1;
+	server->connections--;
+	pthread_cond_signal (&server->idle);
+	pthread_mutex_unlock (&server->lock);
+
+	return NULL;
+}
+
+
+/* Waits for SIGINT or SIGTERM, then stops accepting */
+static void * serve_signal_thread (void *arg)
+{
+	struct serve_server *server = arg;
+	sigset_t signals;
+	int sig;
+
+	sigemptyset (&signals);
+	sigaddset (&signals, SIGINT);
+	sigaddset (&signals, SIGTERM);
+	sigwait (&signals, &sig);
+
+	pthread_mutex_lock (&server->lock);
+	server->stop = 1;
+	shutdown (server->listen_fd, SHUT_RDWR);
+	pthread_mutex_unlock (&server->lock);
+
+	return NULL;
+}
+
+
+/* Serves requests on a Unix socket until SIGINT or SIGTERM, a thread per connection
+ * path:			The socket path, a stale socket there is replaced, anything else refused
+ * routine:			The request routine, called by many threads at once
+ * arg:				The routine argument
+ * buffer_size:		The largest request payload and response
+ * RETURN:			0: Success, 1: Failure
+ */
+int serve_run (const char *path, serve_routine routine, void *arg, size_t buffer_size)
+{
+	struct serve_server server;
+	struct sockaddr_un address;
+	struct stat st;
+	pthread_attr_t attr;
+	pthread_t signal_thread, thread;
+	sigset_t signals, signals_old;
+	int fd, i, ret;
+
+	memset (&address, 0, sizeof (address));
+	address.sun_family = AF_UNIX;
+	if (strlen (path) >= sizeof (address.sun_path))
+	{
+		console_output ("Error: Socket path too long: %s\n", path);
+		return 1;
+	}
+	strcpy (address.sun_path, path);
+	if (!lstat (path, &st) && !S_ISSOCK (st.st_mode))
+	{
+		console_output ("Error: Not a socket, refusing to replace it: %s\n", path);
+		return 1;
+	}
+
+	memset (&server, 0, sizeof (server));
+	server.routine = routine;
+	server.arg = arg;
+	server.buffer_size = buffer_size;
+	for (i = 0; i < SERVE_CONNECTIONS_MAX; i++)
+	{
+		server.connection[i].server = &server;
+		server.connection[i].fd = -1;
+	}
+
+	server.listen_fd = socket (AF_UNIX, SOCK_STREAM, 0);
+	if (server.listen_fd < 0)
+	{
+		console_output ("Error creating the socket\n");
+		return 1;
+	}
+	if (!lstat (path, &st) && S_ISSOCK (st.st_mode))
+		unlink (path);
+	if (bind (server.listen_fd, (struct sockaddr *) &address, sizeof (address)) || listen (server.listen_fd, SERVE_CONNECTIONS_MAX))
+	{
+		console_output ("Error listening on socket: %s\n", path);
+		close (server.listen_fd);
+		return 1;
+	}
+
+	/* Only the signal thread gets the stop signals */
+	pthread_mutex_init (&server.lock, NULL);
+	pthread_cond_init (&server.idle, NULL);
+	sigemptyset (&signals);
+	sigaddset (&signals, SIGINT);
+	sigaddset (&signals, SIGTERM);
+	pthread_sigmask (SIG_BLOCK, &signals, &signals_old);
+	if (pthread_create (&signal_thread, NULL, serve_signal_thread, &server))
+	{
+		console_output ("Error starting the signal thread\n");
+		pthread_sigmask (SIG_SETMASK, &signals_old, NULL);
+		close (server.listen_fd);
+		return 1;
+	}
+	pthread_attr_init (&attr);
+	pthread_attr_setdetachstate (&attr, PTHREAD_CREATE_DETACHED);
+
+	ret = 0;
+	while (!ret)
+	{
+		fd = accept (server.listen_fd, NULL, NULL);
+		if (fd < 0)
+		{
+			if (errno == EINTR || errno == ECONNABORTED)
+				continue;
+			pthread_mutex_lock (&server.lock);
+			if (!server.stop)
+			{
+				console_output ("Error accepting a connection\n");
+				ret = 1;
+			}
+			pthread_mutex_unlock (&server.lock);
+			break;
+		}
+
+		pthread_mutex_lock (&server.lock);
+		for (i = 0; i < SERVE_CONNECTIONS_MAX && server.connection[i].fd >= 0; i++)
+			;
+		if (i == SERVE_CONNECTIONS_MAX)
+		{
+			pthread_mutex_unlock (&server.lock);
+			console_output ("Too many connections, refused\n");
+			close (fd);
+			continue;
+		}
+		server.connection[i].fd = fd;
+		server.connections++;
+		if (pthread_create (&thread, &attr, serve_worker, &server.connection[i]))
+		{
+			server.connection[i].fd = -1;
+			server.connections--;
+			close (fd);
+			console_output ("Error starting a connection thread\n");
+		}
+		pthread_mutex_unlock (&server.lock);
+	}
+
+	/* Close the open connections and wait for their threads */
+	pthread_mutex_lock (&server.lock);
+	for (i = 0; i < SERVE_CONNECTIONS_MAX; i++)
+		if (server.connection[i].fd >= 0)
+			shutdown (server.connection[i].fd, SHUT_RDWR);
+	while (server.connections)
+		pthread_cond_wait (&server.idle, &server.lock);
+	if (!server.stop)
+		pthread_kill (signal_thread, SIGTERM);
+	pthread_mutex_unlock (&server.lock);
+	pthread_join (signal_thread, NULL);
+
+	pthread_attr_destroy (&attr);
+	pthread_sigmask (SIG_SETMASK, &signals_old, NULL);
+	pthread_cond_destroy (&server.idle);
+	pthread_mutex_destroy (&server.lock);
+	close (server.listen_fd);
+	unlink (path);
+
+	return ret;
+}
+
+
+/* Connects to a server
+ * path:		The socket path
+ * RETURN:		The connection, -1 on failure
+ */
+int serve_connect (const char *path)
+{
+	struct sockaddr_un address;
+	int fd;
+
+	memset (&address, 0, sizeof (address));
+	address.sun_family = AF_UNIX;
+	if (strlen (path) >= sizeof (address.sun_path))
+		return -1;
+	strcpy (address.sun_path, path);
+
+	fd = socket (AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0)
+		return -1;
+	if (connect (fd, (struct sockaddr *) &address, sizeof (address)))
+	{
+		close (fd);
+		return -1;
+	}
+
+	return fd;
+}
+
+
+/* Sends a request and waits for its response
+ * fd:			The connection
+ * request:		The request
+ * payload:		The request payload (request->length bytes)
+ * out:			The response payload buffer
+ * out_max:		The response payload buffer size
+ * out_len:		The response payload length
+ * RETURN:		The response status, -1 if the connection failed
+ * NOTE: If the payload can not be written, the response is read anyway: it tells why the server refused it
+ */
+int serve_call (int fd, const struct serve_request *request, const unsigned char *payload, unsigned char *out, size_t out_max, size_t *out_len)
+{
+	unsigned char header[SERVE_REQUEST_SIZE];
+	unsigned char response[SERVE_RESPONSE_SIZE];
+
+	memset (header, 0, sizeof (header));
+	serve_put32 (header, SERVE_MAGIC);
+	header[4] = request->mode;
+	header[5] = request->flags;
+	serve_put32 (header + 8, request->magic);
+	serve_put32 (header + 12, request->version);
+	serve_put32 (header + 16, request->length);
+	/* A server closing the connection early may still have answered why */
+	if (serve_write (fd, header, sizeof (header), payload, request->length) && errno != EPIPE && errno != ECONNRESET)
+		return -1;
+
+	if (serve_read (fd, response, sizeof (response)))
+		return -1;
+	*out_len = serve_get32 (response + 4);
+	if (*out_len > out_max || serve_read (fd, out, *out_len))
+		return -1;
+
+	return (int) serve_get32 (response);
+}
+
+
+static int serve_self_test_echo (void *arg, const struct serve_request *request, const unsigned char *in, unsigned char *out, size_t out_max, size_t *out_len)
+{
+	memcpy (out, in, request->length);
+	*out_len = request->length;
+	return NTGRBAK_OK;
+}
+
+
+/* Self-tests the refusal of a request too big for the server buffers, on a connection pair
+ * result:		The results
+ * results:		The number of results the array holds
+ * RETURN:		The number of results, -1 on failure
+ * NOTE: The connection must answer the error, then serve the next request
+ */
+int serve_self_test (struct self_test_result *result, int results)
+{
+	struct serve_server server;
+	struct serve_request request;
+	unsigned char out[SERVE_TEST_BUFFER_SIZE];
+	unsigned char *payload;
+	pthread_t thread;
+	size_t len;
+	int fd[2], n, ret;
+
+	if (results < 2)
+		return -1;
+	payload = malloc (SERVE_TEST_PAYLOAD_SIZE);
+	if (!payload)
+		return -1;
+	if (socketpair (AF_UNIX, SOCK_STREAM, 0, fd))
+	{
+		free (payload);
+		return -1;
+	}
+
+	memset (&server, 0, sizeof (server));
+	server.routine = serve_self_test_echo;
+	server.buffer_size = SERVE_TEST_BUFFER_SIZE;
+	server.connection[0].server = &server;
+	server.connection[0].fd = fd[0];
+	server.connections = 1;
+	pthread_mutex_init (&server.lock, NULL);
+	pthread_cond_init (&server.idle, NULL);
+	if (pthread_create (&thread, NULL, serve_worker, &server.connection[0]))
+	{
+		close (fd[0]);
+		close (fd[1]);
+		free (payload);
+		return -1;
+	}
+
+	memset (&request, 0, sizeof (request));
+	request.mode = 'D';
+	memset (payload, 0x5A, SERVE_TEST_PAYLOAD_SIZE);
+
+	/* Bigger than the socket buffers: the server must read it to let the write end */
+	n = 0;
+	request.length = SERVE_TEST_PAYLOAD_SIZE;
+	ret = serve_call (fd[1], &request, payload, out, sizeof (out), &len);
+	result[n].test = "Serve";
+	result[n].kernel = "too big";
+	result[n++].result = ret == NTGRBAK_ERR_TOO_BIG && len == strlen (SERVE_MESSAGE_TOO_BIG) && !memcmp (out, SERVE_MESSAGE_TOO_BIG, len) ? SELF_TEST_PASSED : SELF_TEST_FAILED;
+
+	request.length = SERVE_TEST_BUFFER_SIZE;
+	ret = serve_call (fd[1], &request, payload, out, sizeof (out), &len);
+	result[n].test = "Serve";
+	result[n].kernel = "next request";
+	result[n++].result = ret == NTGRBAK_OK && len == SERVE_TEST_BUFFER_SIZE && !memcmp (out, payload, len) ? SELF_TEST_PASSED : SELF_TEST_FAILED;
+
+	close (fd[1]);
+	pthread_join (thread, NULL);
+	pthread_cond_destroy (&server.idle);
+	pthread_mutex_destroy (&server.lock);
+	free (payload);
+
+	return n;
+}
@@ -0,0 +1,42 @@
+#ifndef SRC_SERVE_H_
+#define SRC_SERVE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "selftest.h"
+
+/* Request/response protocol over a Unix stream socket, many requests per connection
+ * Request:		magic "NBRQ", mode, flags, 2 reserved bytes, model magic, version, payload length, payload
+ * Response:	status (NTGRBAK_* code), payload length, payload (the output, or the error message)
+ * Integers are 32 bits little endian
+ */
+#define SERVE_MAGIC				0x5152424e		//"NBRQ"
+#define SERVE_REQUEST_SIZE		20
+#define SERVE_RESPONSE_SIZE		8
+#define SERVE_CONNECTIONS_MAX	256
+
+#define SERVE_VERBOSE			0x1		//Request flags, as the -v and -f options
+#define SERVE_FORCE				0x2
+
+struct serve_request {
+	unsigned char mode;			//The NtgrBak mode letter
+	unsigned char flags;
+	uint32_t magic;				//Model magic, for the wrap modes
+	uint32_t version;
+	uint32_t length;
+};
+
+/* Request routine: (argument, request, payload, output buffer, output buffer size, output length)
+ * RETURN:		The response status, on failure the output holds the error message
+ */
+typedef int (*serve_routine) (void*, const struct serve_request*, const unsigned char*, unsigned char*, size_t, size_t*);
+
+int				serve_run			(const char*, serve_routine, void*, size_t);
+int				serve_connect		(const char*);
+int				serve_call			(int, const struct serve_request*, const unsigned char*, unsigned char*, size_t, size_t*);
+int				serve_self_test		(struct self_test_result*, int);
+
+/* Provided by each tool */
+void			console_output		(char*, ...);
+
+#endif /* SRC_SERVE_H_ */
@@ -0,0 +1,403 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "nvram.h"
+#include "store.h"
+
+#define STORE_RECORDS_MIN	256
+#define STORE_HEAP_MIN		4096
+
+
+/* Hashes a key (FNV-1a)
+ * key:			The key
+ * key_len:		The key length
+ * RETURN:		The key hash
+ */
+static uint32_t store_hash (const char* key, size_t key_len)
+{
+	uint32_t hash;
+	size_t i;
+
+	hash = 0x811C9DC5;
+	for (i = 0; i < key_len; i++)
+	{
+		hash ^= (uint8_t) key[i];
+		hash *= 0x01000193;
+	}
+
+	return hash;
+}
+
+
+/* Finds the index slot of a key
+ * store:		The store
+ * key:			The key
+ * key_len:		The key length
+ * RETURN:		The slot holding the key record, or the empty slot where it belongs
+ */
+static int store_slot (const struct nvram_store* store, const char* key, size_t key_len)
+{
+	const struct nvram_record *record;
+	int slot, rec;
+
+	slot = store_hash (key, key_len) & (store->index_size - 1);
+	while ((rec = store->index[slot]) >= 0)
+	{
+		record = &store->record[rec];
+		if (record->key_len == key_len && !memcmp (nvram_store_string (store, rec), key, key_len))
+			break;
+		slot = (slot + 1) & (store->index_size - 1);
+	}
+
+	return slot;
+}
+
+
+/* Builds the hash index of the records, keeping it at most half full
+ * store:		The store
+ * RETURN:		0: Success, 1: Failure
+ * NOTE: When a key is duplicated the first record is the indexed one
+ */
+static int store_index (struct nvram_store* store)
+{
+	int size, slot, rec;
+	int *index;
+
+	for (size = 16; size < 2 * store->records_max; size *= 2);
+	index = malloc (sizeof (int) * size);
+	if (!index)
+		return 1;
+	memset (index, 0xFF, sizeof (int) * size);
+
+	free (store->index);
+	store->index = index;
+	store->index_size = size;
+
+	for (rec = 0; rec < store->records; rec++)
+	{
+		slot = store_slot (store, nvram_store_string (store, rec), store->record[rec].key_len);
+		if (store->index[slot] < 0)
+			store->index[slot] = rec;
+	}
+
+	return 0;
+}
+
+
+/* Appends a record
+ * store:		The store
+ * RETURN:		The new record number, -1 on failure
+ */
+static int store_append (struct nvram_store* store)
+{
+	struct nvram_record *record;
+
+	if (store->records == store->records_max)
+	{
+		record = realloc (store->record, sizeof (struct nvram_record) * store->records_max * 2);
+		if (!record)
+			return -1;
+		store->record = record;
+		store->records_max *= 2;
+
+		/* The index grows with the records */
+		if (store_index (store))
+			return -1;
+	}
+
+	memset (&store->record[store->records], 0, sizeof (struct nvram_record));
+	return store->records++;
+}
+
+
+/* Copies a "key=value" string to the heap
+ * store:		The store
+ * key:			The key
+ * key_len:		The key length
+ * value:		The value
+ * value_len:	The value length
+ * RETURN:		The string offset in the heap, -1 on failure
+ */
+static int64_t store_heap_put (struct nvram_store* store, const char* key, size_t key_len, const char* value, size_t value_len)
+{
+	uint32_t offset, max;
+	char *heap;
+
+	for (max = store->heap_max; store->heap_len + key_len + 1 + value_len > max; max *= 2);
+	if (max != store->heap_max)
+	{
+		heap = realloc (store->heap, max);
+		if (!heap)
+			return -1;
+		store->heap = heap;
+		store->heap_max = max;
+	}
+
+	offset = store->heap_len;
+	memcpy (store->heap + offset, key, key_len);
+	store->heap[offset + key_len] = '=';
+	memcpy (store->heap + offset + key_len + 1, value, value_len);
+	store->heap_len += key_len + 1 + value_len;
+
+	return offset;
+}
+
+
+/* Parses a NVRAM image into a store
+ * store:		The store
+ * image:		The NVRAM image, its header already checked
+ * image_size:	The NVRAM image size, the edits are kept within it
+ * RETURN:		0: Success, 1: Failure
+ * NOTE: The image is only written by nvram_store_commit(), a read only image can be looked up
+ */
+int nvram_store_open (struct nvram_store* store, uint8_t* image, uint32_t image_size)
+{
+	uint8_t *data, *end, *nul, *eq;
+	int rec;
+
+	memset (store, 0, sizeof (struct nvram_store));
+	store->image = image;
+	store->image_size = image_size;
+
+	if (get_length (image) < NVRAM_INDEX_DATA || get_length (image) > image_size || image_size > NVRAM_IMAGE_SIZE_MAX)
+		return 1;
+
+	store->records_max = STORE_RECORDS_MIN;
+	store->record = malloc (sizeof (struct nvram_record) * store->records_max);
+	store->heap_max = STORE_HEAP_MIN;
+	store->heap = malloc (store->heap_max);
+	if (!store->record || !store->heap)
+	{
+		nvram_store_close (store);
+		return 1;
+	}
+
+	/* The records are NUL terminated strings, the empty ones are the trailing padding */
+	data = image + NVRAM_INDEX_DATA;
+	end = image + get_length (image);
+	for (; data < end; data = nul + 1)
+	{
+		nul = memchr (data, '\0', end - data);
+		if (!nul)
+			nul = end;
+		if (nul == data)
+			continue;
+
+		rec = store_append (store);
+		if (rec < 0)
+		{
+			nvram_store_close (store);
+			return 1;
+		}
+		eq = memchr (data, '=', nul - data);
+		store->record[rec].offset = data - image;
+		store->record[rec].len = nul - data;
+		store->record[rec].key_len = (eq ? eq : nul) - data;
+		store->data_len += store->record[rec].len + 1;
+	}
+
+	if (store_index (store))
+	{
+		nvram_store_close (store);
+		return 1;
+	}
+
+	return 0;
+}
+
+
+/* Releases a store, the image is left as it is
+ * store:		The store
+ */
+void nvram_store_close (struct nvram_store* store)
+{
+	free (store->record);
+	free (store->index);
+	free (store->heap);
+	store->record = NULL;
+	store->index = NULL;
+	store->heap = NULL;
+	store->records = 0;
+}
+
+
+/* Gets the "key=value" string of a record
+ * store:		The store
+ * rec:			The record number
+ * RETURN:		The string, not NUL terminated: its length is in the record
+ */
+const char * nvram_store_string (const struct nvram_store* store, int rec)
+{
+	const struct nvram_record *record = &store->record[rec];
+
+	if (record->heap)
+		return store->heap + record->offset;
+	return (const char *) store->image + record->offset;
+}
+
+
+/* Looks up a key
+ * store:		The store
+ * key:			The key
+ * key_len:		The key length
+ * RETURN:		The record number, -1 if the key is not set
+ */
+int nvram_store_get (const struct nvram_store* store, const char* key, size_t key_len)
+{
+	int rec;
+
+	rec = store->index[store_slot (store, key, key_len)];
+	if (rec < 0 || store->record[rec].removed)
+		return -1;
+
+	return rec;
+}
+
+
+/* Sets a key, editing the record in place when the value length does not change
+ * store:		The store
+ * key:			The key
+ * key_len:		The key length
+ * value:		The value
+ * value_len:	The value length
+ * RETURN:		0: Success, 1: Failure (the image would overflow, or out of memory)
+ */
+int nvram_store_set (struct nvram_store* store, const char* key, size_t key_len, const char* value, size_t value_len)
+{
+	struct nvram_record *record;
+	uint32_t data_len;
+	int64_t offset;
+	int slot, rec;
+
+	if (!key_len || memchr (key, '\0', key_len) || memchr (key, '=', key_len) || memchr (value, '\0', value_len))
+		return 1;
+
+	slot = store_slot (store, key, key_len);
+	rec = store->index[slot];
+
+	/* Same length: overwrite the value where it is */
+	if (rec >= 0 && !store->record[rec].removed && store->record[rec].len == key_len + 1 + value_len)
+	{
+		record = &store->record[rec];
+		if (record->heap)
+			memcpy (store->heap + record->offset + key_len + 1, value, value_len);
+		else
+			memcpy (store->image + record->offset + key_len + 1, value, value_len);
+		store->store_set_changed = 1;
+		return 0;
+	}
+
+	/* Check the rebuilt image still fits */
+	data_len = store->data_len + key_len + 1 + value_len + 1;
+	if (rec >= 0 && !store->record[rec].removed)
+		data_len -= store->record[rec].len + 1;
+	if (NVRAM_INDEX_DATA + ((data_len + 3) & ~3) > store->image_size)
+		return 1;
+
+	offset = store_heap_put (store, key, key_len, value, value_len);
+	if (offset < 0)
+		return 1;
+
+	/* A new key is appended, an existing (or unset) one keeps its place */
+	if (rec < 0)
+	{
+		rec = store_append (store);
+		if (rec < 0)
+			return 1;
+		store->record[rec].heap = 1;
+		store->record[rec].offset = offset;
+		store->record[rec].key_len = key_len;
+		store->index[store_slot (store, key, key_len)] = rec;
+	}
+	record = &store->record[rec];
+	record->heap = 1;
+	record->offset = offset;
+	record->len = key_len + 1 + value_len;
+	record->removed = 0;
+
+	store->data_len = data_len;
+	store->store_set_changed = 1;
+	store->store_set_resized = 1;
+	return 0;
+}
+
+
+/* Unsets a key
+ * store:		The store
+ * key:			The key
+ * key_len:		The key length
+ * RETURN:		0: Success, 1: The key is not set
+ */
+int nvram_store_unset (struct nvram_store* store, const char* key, size_t key_len)
+{
+	int rec;
+
+	rec = nvram_store_get (store, key, key_len);
+	if (rec < 0)
+		return 1;
+
+	/* The record stays indexed as a tombstone, setting the key again revives it */
+	store->record[rec].removed = 1;
+	store->data_len -= store->record[rec].len + 1;
+	store->store_set_changed = 1;
+	store->store_set_resized = 1;
+	return 0;
+}
+
+
+/* Writes the edits back to the image, rebuilding the data only if needed, and calculates its CRC8
+ * store:		The store
+ * RETURN:		0: Success, 1: Failure
+ * NOTE: The layout is the one of text_wrap(): NUL terminated records, NUL padded to 4 bytes, 0xFF padded image
+ */
+int nvram_store_commit (struct nvram_store* store)
+{
+	struct nvram_record *record;
+	uint8_t *data;
+	uint32_t j;
+	int rec, live;
+
+	if (store->store_set_resized)
+	{
+		data = malloc (store->image_size - NVRAM_INDEX_DATA);
+		if (!data)
+			return 1;
+
+		/* Serialize the live records, in order, dropping the unset ones */
+		j = 0;
+		live = 0;
+		for (rec = 0; rec < store->records; rec++)
+		{
+			record = &store->record[rec];
+			if (record->removed)
+				continue;
+
+			memcpy (data + j, nvram_store_string (store, rec), record->len);
+			data[j + record->len] = '\0';
+			store->record[live] = *record;
+			store->record[live].offset = NVRAM_INDEX_DATA + j;
+			store->record[live].heap = 0;
+			j += record->len + 1;
+			live++;
+		}
+		while (j % 4)
+			data[j++] = '\0';
+
+		memcpy (store->image + NVRAM_INDEX_DATA, data, j);
+		free (data);
+		j += NVRAM_INDEX_DATA;
+		set_length (store->image, j);
+		memset (store->image + j, NVRAM_CONTENT_PADDING, store->image_size - j);
+
+		store->records = live;
+		store->heap_len = 0;
+		if (store_index (store))
+			return 1;
+	}
+
+	if (store->store_set_changed)
+		set_crc (store->image, calculate_crc (store->image));
+
+	store->store_sets = 0;
+	return 0;
+}
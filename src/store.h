@@ -0,0 +1,47 @@
+#ifndef SRC_STORE_H_
+#define SRC_STORE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* A "key=value" string of the NVRAM data */
+struct nvram_record {
+	uint32_t offset;		//In the image, or in the heap
+	uint32_t len;			//Of the whole "key=value" string
+	uint32_t key_len;
+	uint8_t heap;			//The string has been set after opening and lives in the heap
+	uint8_t removed;
+};
+
+/* Indexed key/value view of a NVRAM image */
+struct nvram_store {
+	uint8_t * image;
+	uint32_t image_size;	//The rebuilt image is padded to it
+	struct nvram_record * record;
+	int records;
+	int records_max;
+	int * index;			//Open addressing hash table of record numbers, -1 when empty
+	int index_size;			//Power of 2
+	char * heap;
+	uint32_t heap_len;
+	uint32_t heap_max;
+	uint32_t data_len;		//Of the serialized records, NUL separators included
+	union {
+		unsigned int store_sets;
+		struct {
+			unsigned int store_set_changed	:1;		//Records were edited: the CRC must be calculated again
+			unsigned int store_set_resized	:1;		//Records were added, removed or resized: the data must be rebuilt
+			unsigned int 					:30;
+		};
+	};
+};
+
+int				nvram_store_open		(struct nvram_store*, uint8_t*, uint32_t);
+void			nvram_store_close		(struct nvram_store*);
+int				nvram_store_get			(const struct nvram_store*, const char*, size_t);
+const char *	nvram_store_string		(const struct nvram_store*, int);
+int				nvram_store_set			(struct nvram_store*, const char*, size_t, const char*, size_t);
+int				nvram_store_unset		(struct nvram_store*, const char*, size_t);
+int				nvram_store_commit		(struct nvram_store*);
+
+#endif /* SRC_STORE_H_ */
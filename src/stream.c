@@ -0,0 +1,451 @@
+#include <stdlib.h>
+#include <string.h>
+#include "libntgrbak.h"
+#include "config.h"
+#include "crypt.h"
+#include "stream.h"
+#include "text.h"
+#include "trace.h"
+
+#define stream_output			text_output
+#define stream_verbose			text_verbose
+#define stream_force			text_force
+#define stream_trace			text_trace
+
+
+struct ntgrbak_stream {
+	const struct ntgrbak_opts * opt;
+	struct ntgrbak_allocator alloc;
+	int mode;
+	int ret;						//The first error: the stream can not go on after it
+	size_t length;					//Decrypt and extract: the input length, 0 if unknown. Wrap: the NVRAM image length
+	uint64_t pos;					//Configuration bytes processed, whole blocks
+	uint64_t payload;				//Extract: the NVRAM image bytes still to output
+	unsigned int sum;				//Checksum words sum of the plain configuration so far
+	unsigned char header[NTGRBAK_HEADER_SIZE];		//The plain configuration header
+	unsigned char partial[CODEC_BLOCK_SIZE];		//The input bytes of an incomplete block
+	int partial_len;
+	unsigned int magic;				//Wrap: the header fields
+	unsigned int version;
+};
+
+
+static void * stream_malloc (void *opaque, size_t size)
+{
+	return malloc (size);
+}
+
+static void stream_free (void *opaque, void *ptr)
+{
+	free (ptr);
+}
+
+
+/* Keeps the first error of a stream */
+static int stream_error (struct ntgrbak_stream *stream, int err)
+{
+	if (!stream->ret)
+		stream->ret = err;
+	return err;
+}
+
+
+/* Decrypts or encrypts whole blocks of the stream, deriving their keys on the fly STREAM_KEY_BLOCKS at a time
+ * stream:		The stream
+ * blk:			The configuration block of the first input block
+ * in:			The input blocks
+ * out:			The output blocks
+ * blocks:		The number of blocks
+ * codec:		0: Decryption, 1: Encryption
+ * RETURN:		0: Success, 1: Failure
+ */
+static int stream_codec (struct ntgrbak_stream *stream, uint64_t blk, const unsigned char *in, unsigned char *out, size_t blocks, unsigned char codec)
+{
+	int n;
+
+	while (blocks)
+	{
+		n = blocks < STREAM_KEY_BLOCKS ? (int) blocks : STREAM_KEY_BLOCKS;
+		if (run_codec_keyed (in, out, (int) (blk % CODEC_KEY_PERIOD), n, codec))
+			return 1;
+		in += n * CODEC_BLOCK_SIZE;
+		out += n * CODEC_BLOCK_SIZE;
+		blk += n;
+		blocks -= n;
+	}
+
+	return 0;
+}
+
+
+/* Checks the header of a decrypted configuration against the input length, before any of its NVRAM image is output */
+static int stream_header_check (struct ntgrbak_stream *stream)
+{
+	const struct ntgrbak_opts *opt = stream->opt;
+	size_t config_len;
+
+	if (!strcmp (get_model (get_magic (stream->header)), "unknown"))
+		trace_count (stream_trace (opt), TRACE_UNKNOWN_MODELS, 1);
+	if (stream_verbose (opt))
+	{
+		stream_output (opt, "Router Model: %s\n", get_model (get_magic (stream->header)));
+		stream_output (opt, "Configuration version: %u\n", get_config_version (stream->header));
+		stream_output (opt, "Configuration magic: 0x%08x\n", get_magic (stream->header));
+	}
+
+	config_len = get_config_length (stream->header);
+	if (stream->length && config_len != stream->length)
+	{
+		if (!stream_force (opt))
+		{
+			stream_output (opt, "Configuration NVRAM image size is not what expected. Expecting %u bytes instead of %u bytes\n",
+					(unsigned int) (config_len - NTGRBAK_HEADER_SIZE), (unsigned int) (stream->length - NTGRBAK_HEADER_SIZE));
+			return NTGRBAK_ERR_LENGTH;
+		}
+		if (stream_verbose (opt)) stream_output (opt, "Skipping length check.\n");
+		if (config_len > stream->length)
+			config_len = stream->length;
+	}
+	if (config_len < NTGRBAK_HEADER_SIZE)
+	{
+		if (!stream_force (opt))
+		{
+			stream_output (opt, "Configuration length is shorter than its header. (%u bytes)\n", (unsigned int) config_len);
+			return NTGRBAK_ERR_LENGTH;
+		}
+		config_len = NTGRBAK_HEADER_SIZE;
+	}
+
+	stream->payload = config_len - NTGRBAK_HEADER_SIZE;
+	if (stream_verbose (opt)) stream_output (opt, "Configuration NVRAM image size: %u bytes\n", (unsigned int) stream->payload);
+
+	return NTGRBAK_OK;
+}
+
+
+/* Decrypts whole blocks of a decrypt or extract stream
+ * RETURN:		NTGRBAK_OK or the error code
+ */
+static int stream_unwrap_blocks (struct ntgrbak_stream *stream, const unsigned char *in, size_t blocks, unsigned char *out, size_t *out_len)
+{
+	size_t len;
+	int ret;
+
+	*out_len = 0;
+
+	/* The header blocks are kept, extracting strips them once checked */
+	while (blocks && stream->pos < NTGRBAK_HEADER_SIZE)
+	{
+		if (stream_codec (stream, stream->pos / CODEC_BLOCK_SIZE, in, stream->header + stream->pos, 1, 0))
+			return NTGRBAK_ERR_CODEC;
+		stream->sum = checksum_update (stream->sum, stream->header + stream->pos, CODEC_BLOCK_SIZE);
+		if (stream->mode == NTGRBAK_STREAM_DECRYPT)
+		{
+			memcpy (out + *out_len, stream->header + stream->pos, CODEC_BLOCK_SIZE);
+			*out_len += CODEC_BLOCK_SIZE;
+		}
+		stream->pos += CODEC_BLOCK_SIZE;
+		in += CODEC_BLOCK_SIZE;
+		blocks--;
+
+		if (stream->pos == NTGRBAK_HEADER_SIZE && stream->mode == NTGRBAK_STREAM_EXTRACT)
+		{
+			ret = stream_header_check (stream);
+			if (ret)
+				return ret;
+		}
+	}
+	if (!blocks)
+		return NTGRBAK_OK;
+
+	if (stream_codec (stream, stream->pos / CODEC_BLOCK_SIZE, in, out + *out_len, blocks, 0))
+		return NTGRBAK_ERR_CODEC;
+	len = blocks * CODEC_BLOCK_SIZE;
+	stream->sum = checksum_update (stream->sum, out + *out_len, (int) len);
+	stream->pos += len;
+
+	/* The bytes past the configuration length are only checksummed */
+	if (stream->mode == NTGRBAK_STREAM_EXTRACT)
+	{
+		if (len > stream->payload)
+			len = (size_t) stream->payload;
+		stream->payload -= len;
+	}
+	*out_len += len;
+
+	return NTGRBAK_OK;
+}
+
+
+/* Builds the header of a wrap stream, with no checksum, and encrypts it
+ * RETURN:		NTGRBAK_OK or the error code
+ */
+static int stream_wrap_header (struct ntgrbak_stream *stream, unsigned char *out)
+{
+	memset (stream->header, 0x00, NTGRBAK_HEADER_SIZE);
+	set_magic (stream->header, stream->magic);
+	set_config_length (stream->header, (int) (stream->length + NTGRBAK_HEADER_SIZE));
+	set_config_version (stream->header, (int) stream->version);
+	stream->sum = checksum_update (0, stream->header, NTGRBAK_HEADER_SIZE);
+
+	if (stream_codec (stream, 0, stream->header, out, NTGRBAK_HEADER_SIZE / CODEC_BLOCK_SIZE, 1))
+		return NTGRBAK_ERR_CODEC;
+	stream->pos = NTGRBAK_HEADER_SIZE;
+
+	return NTGRBAK_OK;
+}
+
+
+/* Encrypts whole blocks of a wrap stream, after its header
+ * RETURN:		NTGRBAK_OK or the error code
+ */
+static int stream_wrap_blocks (struct ntgrbak_stream *stream, const unsigned char *in, size_t blocks, unsigned char *out, size_t *out_len)
+{
+	size_t len;
+	int ret;
+
+	*out_len = 0;
+	if (!stream->pos)
+	{
+		ret = stream_wrap_header (stream, out);
+		if (ret)
+			return ret;
+		*out_len = NTGRBAK_HEADER_SIZE;
+	}
+	if (!blocks)
+		return NTGRBAK_OK;
+
+	len = blocks * CODEC_BLOCK_SIZE;
+	if (stream->pos - NTGRBAK_HEADER_SIZE + len > stream->length)
+	{
+		stream_output (stream->opt, "The NVRAM image is longer than announced. (%u bytes)\n", (unsigned int) stream->length);
+		return NTGRBAK_ERR_LENGTH;
+	}
+
+	if (stream_codec (stream, stream->pos / CODEC_BLOCK_SIZE, in, out + *out_len, blocks, 1))
+		return NTGRBAK_ERR_CODEC;
+	stream->sum = checksum_update (stream->sum, in, (int) len);
+	stream->pos += len;
+	*out_len += len;
+
+	return NTGRBAK_OK;
+}
+
+
+/* Processes whole blocks of a stream */
+static int stream_blocks (struct ntgrbak_stream *stream, const unsigned char *in, size_t blocks, unsigned char *out, size_t *out_len)
+{
+	uint64_t span;
+	int ret;
+
+	span = trace_begin (stream_trace (stream->opt));
+	if (stream->mode == NTGRBAK_STREAM_WRAP)
+		ret = stream_wrap_blocks (stream, in, blocks, out, out_len);
+	else
+		ret = stream_unwrap_blocks (stream, in, blocks, out, out_len);
+	trace_end (stream_trace (stream->opt), stream->mode == NTGRBAK_STREAM_WRAP ? "encrypt" : "decrypt", span, blocks * CODEC_BLOCK_SIZE);
+
+	return ret;
+}
+
+
+/* Creates a stream
+ * opt:			The call options, kept until the stream is released
+ * mode:		NTGRBAK_STREAM_DECRYPT, NTGRBAK_STREAM_EXTRACT or NTGRBAK_STREAM_WRAP
+ * length:		Decrypt and extract: the configuration length if known (checked against the header up front), 0 otherwise
+ *				Wrap: the NVRAM image length (a multiple of 8 bytes)
+ * magic:		Wrap: the configuration magic (see ntgrbak_model_magic())
+ * version:		Wrap: the configuration version
+ * alloc:		The stream memory allocator, NULL for malloc()
+ * RETURN:		The stream, NULL on failure
+ */
+struct ntgrbak_stream * ntgrbak_stream_new (const struct ntgrbak_opts *opt, int mode, size_t length, unsigned int magic, unsigned int version, const struct ntgrbak_allocator *alloc)
+{
+	static const struct ntgrbak_allocator alloc_default = { stream_malloc, stream_free, NULL };
+	struct ntgrbak_stream *stream;
+
+	if (mode < NTGRBAK_STREAM_DECRYPT || mode > NTGRBAK_STREAM_WRAP)
+		return NULL;
+	if (!alloc)
+		alloc = &alloc_default;
+
+	stream = alloc->alloc (alloc->opaque, sizeof (struct ntgrbak_stream));
+	if (!stream)
+		return NULL;
+	memset (stream, 0, sizeof (struct ntgrbak_stream));
+	stream->opt = opt;
+	stream->alloc = *alloc;
+	stream->mode = mode;
+	stream->length = length;
+	stream->magic = magic;
+	stream->version = version;
+
+	return stream;
+}
+
+
+/* Releases a stream
+ * stream:		The stream
+ */
+void ntgrbak_stream_free (struct ntgrbak_stream *stream)
+{
+	if (!stream)
+		return;
+
+	stream->alloc.free (stream->alloc.opaque, stream);
+}
+
+
+/* Processes the next piece of the input of a stream
+ * stream:		The stream
+ * in:			The piece, of any length
+ * in_len:		The piece length
+ * out:			The output buffer
+ * out_max:		The output buffer size (in_len + NTGRBAK_STREAM_SLACK bytes is enough)
+ * out_len:		The output length
+ * RETURN:		NTGRBAK_OK or the error code
+ */
+int ntgrbak_stream_update (struct ntgrbak_stream *stream, const unsigned char *in, size_t in_len, unsigned char *out, size_t out_max, size_t *out_len)
+{
+	size_t len, blocks;
+	int n, ret;
+
+	if (!stream || (!in && in_len) || !out || !out_len)
+		return NTGRBAK_ERR_ARGS;
+	*out_len = 0;
+	if (stream->ret)
+		return stream->ret;
+	if (out_max < in_len + NTGRBAK_STREAM_SLACK)
+		return stream_error (stream, NTGRBAK_ERR_BUFFER);
+
+	/* Complete the block left over by the previous piece */
+	if (stream->partial_len)
+	{
+		n = CODEC_BLOCK_SIZE - stream->partial_len;
+		if ((size_t) n > in_len)
+			n = (int) in_len;
+		memcpy (stream->partial + stream->partial_len, in, n);
+		stream->partial_len += n;
+		in += n;
+		in_len -= n;
+		if (stream->partial_len < CODEC_BLOCK_SIZE)
+			return NTGRBAK_OK;
+
+		ret = stream_blocks (stream, stream->partial, 1, out, out_len);
+		if (ret)
+			return stream_error (stream, ret);
+		stream->partial_len = 0;
+	}
+
+	blocks = in_len / CODEC_BLOCK_SIZE;
+	ret = stream_blocks (stream, in, blocks, out + *out_len, &len);
+	if (ret)
+		return stream_error (stream, ret);
+	*out_len += len;
+
+	stream->partial_len = (int) (in_len - blocks * CODEC_BLOCK_SIZE);
+	memcpy (stream->partial, in + blocks * CODEC_BLOCK_SIZE, stream->partial_len);
+
+	return NTGRBAK_OK;
+}
+
+
+/* Ends a stream, running the checks needing all of its input
+ * stream:		The stream
+ * out:			The output buffer: the complete wrap header, to write over the first NTGRBAK_HEADER_SIZE bytes of the output
+ * out_max:		The output buffer size (NTGRBAK_HEADER_SIZE bytes is enough)
+ * out_len:		The output length, 0 but for the wrap streams
+ * info:		Extract: the configuration info, NULL if not needed
+ * RETURN:		NTGRBAK_OK or the error code
+ * NOTE: The checksum is only known here, the output of a failed stream must be discarded
+ */
+int ntgrbak_stream_final (struct ntgrbak_stream *stream, unsigned char *out, size_t out_max, size_t *out_len, struct ntgrbak_info *info)
+{
+	const struct ntgrbak_opts *opt;
+	uint64_t span;
+	int ret;
+
+	if (!stream || !out || !out_len)
+		return NTGRBAK_ERR_ARGS;
+	*out_len = 0;
+	if (stream->ret)
+		return stream->ret;
+	opt = stream->opt;
+
+	if (stream->partial_len)
+	{
+		stream_output (opt, "Error processing the input!\nMake sure the input data size is a multiple of 8 bytes.\n");
+		return stream_error (stream, NTGRBAK_ERR_BLOCK);
+	}
+
+	/* Wrap: apply the checksum to the header */
+	if (stream->mode == NTGRBAK_STREAM_WRAP)
+	{
+		if (out_max < NTGRBAK_HEADER_SIZE)
+			return stream_error (stream, NTGRBAK_ERR_BUFFER);
+		if (!stream->pos && (ret = stream_wrap_header (stream, out)))
+			return stream_error (stream, ret);
+		if (stream->pos - NTGRBAK_HEADER_SIZE != stream->length)
+		{
+			stream_output (opt, "The NVRAM image is shorter than announced. (%u bytes instead of %u bytes)\n",
+					(unsigned int) (stream->pos - NTGRBAK_HEADER_SIZE), (unsigned int) stream->length);
+			return stream_error (stream, NTGRBAK_ERR_LENGTH);
+		}
+
+		set_checksum (stream->header, checksum_final (stream->sum));
+		if (stream_verbose (opt))
+		{
+			stream_output (opt, "Generated configuration:\n");
+			stream_output (opt, "Router Model: %s\n", get_model (get_magic (stream->header)));
+			stream_output (opt, "Configuration version: %u\n", get_config_version (stream->header));
+		}
+		if (stream_codec (stream, 0, stream->header, out, NTGRBAK_HEADER_SIZE / CODEC_BLOCK_SIZE, 1))
+			return stream_error (stream, NTGRBAK_ERR_CODEC);
+		*out_len = NTGRBAK_HEADER_SIZE;
+
+		if (stream_verbose (opt)) stream_output (opt, "Successfully encoded configuration.\n");
+		return NTGRBAK_OK;
+	}
+	if (stream->mode == NTGRBAK_STREAM_DECRYPT)
+		return NTGRBAK_OK;
+
+	/* Extract: the checksum of the whole input, then the lengths */
+	if (stream->pos < NTGRBAK_HEADER_SIZE)
+	{
+		stream_output (opt, "Input is too short to hold a configuration header.\n");
+		return stream_error (stream, NTGRBAK_ERR_LENGTH);
+	}
+	if (stream_force (opt))
+	{
+		if (stream_verbose (opt)) stream_output (opt, "Skipping checksum verify.\n");
+	}
+	else
+	{
+		span = trace_begin (stream_trace (opt));
+		if (checksum_final (stream->sum))
+		{
+			trace_count (stream_trace (opt), TRACE_CHECKSUM_FAILURES, 1);
+			stream_output (opt, "Checksum verify failed.\n");
+			return stream_error (stream, NTGRBAK_ERR_CHECKSUM);
+		}
+		trace_end (stream_trace (opt), "checksum_verify", span, 0);
+		if (stream_verbose (opt)) stream_output (opt, "Checksum verify passed.\n");
+
+		if (stream->pos != get_config_length (stream->header))
+		{
+			stream_output (opt, "Configuration NVRAM image size is not what expected. Expecting %u bytes instead of %u bytes\n",
+					(unsigned int) (get_config_length (stream->header) - NTGRBAK_HEADER_SIZE), (unsigned int) (stream->pos - NTGRBAK_HEADER_SIZE));
+			return stream_error (stream, NTGRBAK_ERR_LENGTH);
+		}
+	}
+
+	if (info)
+	{
+		info->magic = get_magic (stream->header);
+		info->version = get_config_version (stream->header);
+		info->length = get_config_length (stream->header);
+		info->model = get_model (info->magic);
+	}
+
+	return NTGRBAK_OK;
+}
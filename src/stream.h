@@ -0,0 +1,9 @@
+#ifndef SRC_STREAM_H_
+#define SRC_STREAM_H_
+
+#include "libntgrbak.h"
+
+/* Constant memory streams of configurations, see ntgrbak_stream_new() */
+#define STREAM_KEY_BLOCKS	2048		//Blocks whose keys are derived in a run: 16 KB
+
+#endif /* SRC_STREAM_H_ */
@@ -0,0 +1,1326 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <endian.h>
+#if defined(__x86_64__) && defined(__GNUC__)
+#define TEXT_X86
+#include <immintrin.h>
+#endif
+#include "nvram.h"
+#include "text.h"
+#include "trace.h"
+
+#define TEXT_CHUNK			0x1000		//Bytes translated, then fed to the CRC8, at once: they are still in the L1 cache
+#define TEXT_TEST_SIZE		0x10000
+#define TEXT_TEST_ROUNDS	200
+#define TEXT_TEST_IMAGE_SIZE	64		//Of the records wrap test, filled by 22 empty records, and of the leading nulls one
+#define TEXT_TEST_RECORDS		40
+
+typedef void (*text_translate_fn) (const unsigned char*, unsigned char*, size_t);
+typedef size_t (*text_extract_fn) (const unsigned char*, size_t, unsigned char*, unsigned char*);
+
+
+/* Passes a message to the caller log, if any */
+void text_output (const struct ntgrbak_opts *opt, char *format, ...)
+{
+	char line[256];
+	va_list args;
+
+	if (!opt || !opt->log)
+		return;
+
+	va_start(args, format);
+	vsnprintf(line, sizeof (line), format, args);
+	va_end(args);
+
+	opt->log (opt->log_opaque, line);
+}
+
+
+/* Copies a text swapping new lines with null bytes, one byte at a time
+ * in:			The text
+ * out:			The output
+ * len:			The text length
+ */
+static void text_to_nvram_scalar (const unsigned char* in, unsigned char* out, size_t len)
+{
+	size_t i;
+
+	for (i = 0; i < len; i++)
+		out[i] = in[i] == '\n' ? '\0' : in[i];
+}
+
+
+/* Copies a text swapping new lines with null bytes, 8 bytes at a time in a 64 bit word
+ * in:			The text
+ * out:			The output
+ * len:			The text length
+ */
+static void text_to_nvram_64 (const unsigned char* in, unsigned char* out, size_t len)
+{
+	const uint64_t lo = 0x7F7F7F7F7F7F7F7FULL;
+	uint64_t word, x, nl;
+
+	for (; len >= 8; in += 8, out += 8, len -= 8)
+	{
+		memcpy (&word, in, 8);
+
+		/* The bytes that are 0 after xoring the new line get their high bit set, then widened to a byte mask */
+		x = word ^ 0x0A0A0A0A0A0A0A0AULL;
+		nl = ~(((x & lo) + lo) | x | lo);
+		word &= ~((nl >> 7) * 0xFF);
+		memcpy (out, &word, 8);
+	}
+
+	text_to_nvram_scalar (in, out, len);
+}
+
+
+/* Finds the first null byte, or the first other byte, one byte at a time
+ * buffer:		The data
+ * len:			The data length
+ * nul:			1: Find a null byte, 0: Find a byte that is not null
+ * RETURN:		Its offset, len if there is none
+ */
+static size_t text_scan_scalar (const unsigned char* buffer, size_t len, int nul)
+{
+	size_t i;
+
+	for (i = 0; i < len && !buffer[i] == !nul; i++)
+		;
+
+	return i;
+}
+
+
+/* Finds the first null byte, or the first other byte, 8 bytes at a time in a 64 bit word
+ * buffer:		The data
+ * len:			The data length
+ * nul:			1: Find a null byte, 0: Find a byte that is not null
+ * RETURN:		Its offset, len if there is none
+ */
+static size_t text_scan_64 (const unsigned char* buffer, size_t len, int nul)
+{
+	const uint64_t lo = 0x7F7F7F7F7F7F7F7FULL;
+	uint64_t word, zero;
+	size_t i;
+
+	for (i = 0; i + 8 <= len; i += 8)
+	{
+		memcpy (&word, buffer + i, 8);
+
+		/* High bit set in the null bytes, the others are found by their complement */
+		zero = ~(((word & lo) + lo) | word | lo);
+		if (!nul)
+			zero ^= ~lo;
+		if (zero)
+			return i + __builtin_ctzll (le64toh (zero)) / 8;
+	}
+
+	return i + text_scan_scalar (buffer + i, len - i, nul);
+}
+
+
+/* Copies the records of a NVRAM image swapping every run of null bytes with a newline, one byte at a time.
+ * The runs following a newline are skipped
+ * in:			The NVRAM image data
+ * len:			The data length
+ * out:			The output text
+ * last:		The last byte of the text so far, '\n' at the start (updated)
+ * RETURN:		The text length
+ */
+static size_t text_from_nvram_scalar (const unsigned char* in, size_t len, unsigned char* out, unsigned char* last)
+{
+	size_t i, j;
+
+	for (i = 0, j = 0; i < len; i++)
+	{
+		if (in[i])
+			out[j++] = *last = in[i];
+		else if (*last != '\n')
+			out[j++] = *last = '\n';
+	}
+
+	return j;
+}
+
+
+/* Copies the records of a NVRAM image swapping every run of null bytes with a newline, a whole record at a time.
+ * The runs following a newline are skipped
+ * in:			The NVRAM image data
+ * len:			The data length
+ * out:			The output text
+ * last:		The last byte of the text so far, '\n' at the start (updated)
+ * RETURN:		The text length
+ */
+static size_t text_from_nvram_64 (const unsigned char* in, size_t len, unsigned char* out, unsigned char* last)
+{
+	size_t i, j, n;
+
+	for (i = 0, j = 0; i < len; i += n)
+	{
+		n = text_scan_64 (in + i, len - i, 1);
+		if (n)
+		{
+			memcpy (out + j, in + i, n);
+			j += n;
+			*last = in[i + n - 1];
+			i += n;
+		}
+		if (i == len)
+			break;
+
+		n = text_scan_64 (in + i, len - i, 0);
+		if (*last != '\n')
+			out[j++] = *last = '\n';
+	}
+
+	return j;
+}
+
+#ifdef TEXT_X86
+/* Copies a text swapping new lines with null bytes, 16 bytes at a time with SSE2
+ * in:			The text
+ * out:			The output
+ * len:			The text length
+ */
+static void text_to_nvram_sse2 (const unsigned char* in, unsigned char* out, size_t len)
+{
+	const __m128i nl = _mm_set1_epi8 ('\n');
+	__m128i v;
+
+	for (; len >= 16; in += 16, out += 16, len -= 16)
+	{
+		v = _mm_loadu_si128 ((const __m128i *) in);
+		_mm_storeu_si128 ((__m128i *) out, _mm_andnot_si128 (_mm_cmpeq_epi8 (v, nl), v));
+	}
+
+	text_to_nvram_64 (in, out, len);
+}
+
+
+/* Copies a text swapping new lines with null bytes, 32 bytes at a time with AVX2
+ * in:			The text
+ * out:			The output
+ * len:			The text length
+ */
+__attribute__ ((target ("avx2")))
+static void text_to_nvram_avx2 (const unsigned char* in, unsigned char* out, size_t len)
+{
+	const __m256i nl = _mm256_set1_epi8 ('\n');
+	__m256i v;
+
+	for (; len >= 32; in += 32, out += 32, len -= 32)
+	{
+		v = _mm256_loadu_si256 ((const __m256i *) in);
+		_mm256_storeu_si256 ((__m256i *) out, _mm256_andnot_si256 (_mm256_cmpeq_epi8 (v, nl), v));
+	}
+
+	text_to_nvram_sse2 (in, out, len);
+}
+
+
+/* Copies the records of a window of a NVRAM image, swapping every run of null bytes with a newline
+ * in:			The window
+ * out:			The output text
+ * nul:			The window null bytes, a bit each
+ * width:		The window width (16 or 32)
+ * last:		The last byte of the text so far (updated)
+ * RETURN:		The text length
+ * NOTE: Every record is moved a whole window width at once, so width bytes past the window must be readable and
+ * width bytes past the record writable: the text is never longer than the data, the caller keeps a window of margin
+ */
+static inline __attribute__ ((always_inline)) size_t text_from_nvram_window (const unsigned char* in, unsigned char* out, uint32_t nul, int width, unsigned char* last)
+{
+	uint32_t rest;
+	size_t j;
+	int pos, n;
+
+	j = 0;
+	for (pos = 0; pos < width; pos += n)
+	{
+		/* The record up to the next null byte, or the end of the window */
+		rest = nul >> pos;
+		n = rest ? __builtin_ctz (rest) : width - pos;
+		if (n)
+		{
+			memcpy (out + j, in + pos, width);
+			j += n;
+			*last = in[pos + n - 1];
+			pos += n;
+		}
+		if (pos == width)
+			break;
+
+		/* The null bytes run, up to the end of the window (the next one carries on with last) */
+		rest = ~nul >> pos;
+		n = rest ? __builtin_ctz (rest) : width - pos;
+		if (*last != '\n')
+			out[j++] = *last = '\n';
+	}
+
+	return j;
+}
+
+
+/* Copies the records of a NVRAM image swapping every run of null bytes with a newline, 16 bytes at a time with SSE2
+ * in:			The NVRAM image data
+ * len:			The data length
+ * out:			The output text
+ * last:		The last byte of the text so far, '\n' at the start (updated)
+ * RETURN:		The text length
+ */
+static size_t text_from_nvram_sse2 (const unsigned char* in, size_t len, unsigned char* out, unsigned char* last)
+{
+	__m128i v;
+	uint32_t nul;
+	size_t i, j;
+
+	for (i = 0, j = 0; i + 2*16 <= len; i += 16)
+	{
+		v = _mm_loadu_si128 ((const __m128i *) (in + i));
+		nul = (uint32_t) _mm_movemask_epi8 (_mm_cmpeq_epi8 (v, _mm_setzero_si128 ()));
+		if (!nul)
+		{
+			/* A window within a record, the most common */
+			_mm_storeu_si128 ((__m128i *) (out + j), v);
+			j += 16;
+			*last = in[i + 15];
+		}
+		else
+			j += text_from_nvram_window (in + i, out + j, nul, 16, last);
+	}
+
+	return j + text_from_nvram_64 (in + i, len - i, out + j, last);
+}
+
+
+/* Copies the records of a NVRAM image swapping every run of null bytes with a newline, 32 bytes at a time with AVX2
+ * in:			The NVRAM image data
+ * len:			The data length
+ * out:			The output text
+ * last:		The last byte of the text so far, '\n' at the start (updated)
+ * RETURN:		The text length
+ */
+__attribute__ ((target ("avx2")))
+static size_t text_from_nvram_avx2 (const unsigned char* in, size_t len, unsigned char* out, unsigned char* last)
+{
+	__m256i v;
+	uint32_t nul;
+	size_t i, j;
+
+	for (i = 0, j = 0; i + 2*32 <= len; i += 32)
+	{
+		v = _mm256_loadu_si256 ((const __m256i *) (in + i));
+		nul = (uint32_t) _mm256_movemask_epi8 (_mm256_cmpeq_epi8 (v, _mm256_setzero_si256 ()));
+		if (!nul)
+		{
+			/* A window within a record, the most common */
+			_mm256_storeu_si256 ((__m256i *) (out + j), v);
+			j += 32;
+			*last = in[i + 31];
+		}
+		else
+			j += text_from_nvram_window (in + i, out + j, nul, 32, last);
+	}
+
+	return j + text_from_nvram_sse2 (in + i, len - i, out + j, last);
+}
+
+/* Picks the widest translation kernel supported by the CPU, once, when the program is loaded */
+static text_translate_fn text_to_nvram_resolve (void)
+{
+	__builtin_cpu_init ();
+	if (__builtin_cpu_supports ("avx2"))
+		return text_to_nvram_avx2;
+	return text_to_nvram_sse2;
+}
+
+static void text_to_nvram (const unsigned char*, unsigned char*, size_t) __attribute__ ((ifunc ("text_to_nvram_resolve")));
+
+
+
+/* Picks the widest extraction kernel supported by the CPU, once, when the program is loaded */
+static text_extract_fn text_from_nvram_resolve (void)
+{
+	__builtin_cpu_init ();
+	if (__builtin_cpu_supports ("avx2"))
+		return text_from_nvram_avx2;
+	return text_from_nvram_sse2;
+}
+
+static size_t text_from_nvram (const unsigned char*, size_t, unsigned char*, unsigned char*) __attribute__ ((ifunc ("text_from_nvram_resolve")));
+#else
+#define text_to_nvram	text_to_nvram_64
+#define text_from_nvram	text_from_nvram_64
+#endif
+
+
+/* Checks the header and the CRC8 of a NVRAM image
+ * opt:					The conversion options
+ * buffer_input:		The NVRAM image
+ * buffer_input_len:	The NVRAM image length
+ * data_end:			The end of the data, within the input (truncated when forced)
+ * RETURN:				NTGRBAK_OK or the error code
+ */
+static int text_check (const struct ntgrbak_opts *opt, const unsigned char* buffer_input, int buffer_input_len, uint32_t* data_end)
+{
+	uint32_t magic;
+	uint32_t length;
+	uint8_t crc, crc_calc;
+	uint64_t span;
+
+	/* Acquire infos */
+	if (buffer_input_len < NVRAM_INDEX_DATA)
+	{
+		text_output (opt, "Input is too short to hold a NVRAM header!\n");
+		return NTGRBAK_ERR_LENGTH;
+	}
+	magic = get_nvram_magic((uint8_t *) buffer_input);
+	length = get_length((uint8_t *) buffer_input);
+	crc = get_crc((uint8_t *) buffer_input);
+
+	/* Magic check */
+	if (text_verbose(opt)) text_output (opt, "NVRAM Magic: %08x\n", magic);
+	if (text_force(opt))
+	{
+		if (text_verbose(opt)) text_output (opt, "Skipping magic check.\n");
+	}
+	else
+	{
+		if (magic != NVRAM_CONTENT_MAGIC)
+		{
+			trace_count (text_trace(opt), TRACE_MAGIC_MISMATCHES, 1);
+			text_output (opt, "Magic check failed!\n");
+			return NTGRBAK_ERR_MAGIC;
+		}
+		if (text_verbose(opt)) text_output (opt, "Magic check passed.\n");
+	}
+
+	/* Length check */
+	if (text_verbose(opt)) text_output (opt, "NVRAM Length: %u bytes\n", length);
+	if (length > NVRAM_SIZE_DATA_MAX)
+	{
+		if (text_force(opt))
+		{
+			length = NVRAM_SIZE_DATA_MAX;
+			text_output (opt, "Data size is too big! Output will be truncated to %u bytes.\n", length);
+		}
+		else
+		{
+			text_output (opt, "Data size is too big!\n");
+			return NTGRBAK_ERR_TOO_BIG;
+		}
+	}
+	if (length > buffer_input_len)
+	{
+		if (text_force(opt))
+		{
+			length = buffer_input_len;
+			text_output (opt, "Input is shorter than the data size! Output will be truncated to %u bytes.\n", length);
+		}
+		else
+		{
+			text_output (opt, "Input is shorter than the data size!\n");
+			return NTGRBAK_ERR_LENGTH;
+		}
+	}
+
+	/* CRC8 check */
+	if (text_verbose(opt)) text_output (opt, "NVRAM CRC8: %02x\n", crc);
+	if (text_force(opt))
+	{
+		if (text_verbose(opt)) text_output (opt, "Skipping CRC8 check.\n");
+	}
+	else
+	{
+		span = trace_begin (text_trace(opt));
+		crc_calc = calculate_crc((uint8_t *) buffer_input);
+		trace_end (text_trace(opt), "crc", span, length);
+		if (text_verbose(opt)) text_output (opt, "NVRAM calculated CRC8: %02x\n", crc_calc);
+		if (crc != crc_calc)
+		{
+			trace_count (text_trace(opt), TRACE_CRC_FAILURES, 1);
+			text_output (opt, "CRC8 check failed!\n");
+			return NTGRBAK_ERR_CRC;
+		}
+		if (text_verbose(opt)) text_output (opt, "CRC8 check passed.\n");
+	}
+
+	*data_end = length;
+	return NTGRBAK_OK;
+}
+
+
+/* Extracts the editable text from a NVRAM image
+ * opt:					The conversion options
+ * buffer_input:		The NVRAM image
+ * buffer_input_len:	The NVRAM image length
+ * buffer_output:		The output text buffer
+ * buffer_output_max:	The output text buffer size (the data size is enough)
+ * buffer_output_len:	The output text length
+ * RETURN:				NTGRBAK_OK or the error code
+ */
+int text_extract (const struct ntgrbak_opts *opt, const unsigned char* buffer_input, int buffer_input_len, unsigned char* buffer_output, int buffer_output_max, int* buffer_output_len)
+{
+	uint32_t length;
+	uint64_t span;
+	unsigned char last;
+	int j, ret;
+
+	ret = text_check (opt, buffer_input, buffer_input_len, &length);
+	if (ret)
+		return ret;
+
+	if (length > NVRAM_INDEX_DATA && length - NVRAM_INDEX_DATA > buffer_output_max)
+	{
+		text_output (opt, "Output buffer is too small!\n");
+		return NTGRBAK_ERR_BUFFER;
+	}
+
+	/* Copy the input buffer data to the output a record at a time, swapping every run of null bytes with a newline.
+	 * The runs following a newline, or the start of the data, are skipped */
+	span = trace_begin (text_trace(opt));
+	last = '\n';
+	j = length > NVRAM_INDEX_DATA ? (int) text_from_nvram (buffer_input + NVRAM_INDEX_DATA, length - NVRAM_INDEX_DATA, buffer_output, &last) : 0;
+	*buffer_output_len = j;
+	trace_end (text_trace(opt), "text_extract", span, length);
+
+	return NTGRBAK_OK;
+}
+
+
+/* Sets the fields of a NVRAM image being built
+ * image:		The NVRAM image
+ * RETURN:		The CRC8 of the fields, the data CRC8 starts from it
+ */
+static uint8_t text_image_start (unsigned char* image)
+{
+	uint8_t crc;
+
+	/* The fields come before the data in the CRC8 */
+	set_field1(image);
+	set_field2(image);
+	crc = crc8(image + NVRAM_INDEX_FIELD1, NVRAM_SIZE_FIELD1, NVRAM_CRC_START);
+	return crc8(image + NVRAM_INDEX_FIELD2, NVRAM_SIZE_FIELD2, crc);
+}
+
+
+/* Completes a NVRAM image once its data is in
+ * image:		The NVRAM image
+ * end:			The end of the data
+ * crc:			The CRC8 of the fields and the data
+ * image_size:	The NVRAM image size (the data is at most (image_size - NVRAM_INDEX_DATA) / 4 * 4 bytes)
+ */
+static void text_image_finish (unsigned char* image, int end, uint8_t crc, int image_size)
+{
+	int n;
+
+	/* Even the output data to multiple of 4 bytes */
+	n = (4 - end % 4) % 4;
+	memset (image + end, '\0', n);
+	crc = crc8(image + end, n, crc);
+	end += n;
+
+	/* Setup the header */
+	set_nvram_magic(image, NVRAM_CONTENT_MAGIC);
+	set_length(image, end);
+	set_crc(image, crc);
+
+	/* Add the padding */
+	memset (image + end, NVRAM_CONTENT_PADDING, image_size - end);
+}
+
+
+/* Wraps an editable text to a NVRAM image
+ * opt:					The conversion options
+ * buffer_input:		The text
+ * buffer_input_len:	The text length
+ * buffer_output:		The output NVRAM image buffer
+ * buffer_output_max:	The NVRAM image size: the image is padded to it (at most NVRAM_IMAGE_SIZE_MAX bytes)
+ * buffer_output_len:	The output NVRAM image length
+ * RETURN:				NTGRBAK_OK or the error code
+ * NOTE: The text is translated a chunk at a time, each chunk is fed to the CRC8 while it is still in the cache
+ */
+int text_wrap (const struct ntgrbak_opts *opt, const unsigned char* buffer_input, int buffer_input_len, unsigned char* buffer_output, int buffer_output_max, int* buffer_output_len)
+{
+	uint64_t span;
+	uint8_t crc;
+	int i, j, n;
+
+	if (buffer_output_max < NVRAM_INDEX_DATA || buffer_output_max > NVRAM_IMAGE_SIZE_MAX)
+	{
+		text_output (opt, "Invalid NVRAM image size! (%d bytes)\n", buffer_output_max);
+		return NTGRBAK_ERR_ARGS;
+	}
+	if (buffer_input_len > (buffer_output_max - NVRAM_INDEX_DATA) / 4 * 4)
+	{
+		text_output (opt, "Data size is too big! (%u bytes, max: %u bytes)\n", buffer_input_len, (buffer_output_max - NVRAM_INDEX_DATA) / 4 * 4);
+		return NTGRBAK_ERR_TOO_BIG;
+	}
+
+	crc = text_image_start (buffer_output);
+
+	/* Copy the input data to the buffer swapping new lines with null bytes */
+	span = trace_begin (text_trace(opt));
+	j = NVRAM_INDEX_DATA;
+	for (i = 0; i < buffer_input_len; i += n)
+	{
+		n = buffer_input_len - i < TEXT_CHUNK ? buffer_input_len - i : TEXT_CHUNK;
+		text_to_nvram (buffer_input + i, buffer_output + j, n);
+		crc = crc8(buffer_output + j, n, crc);
+		j += n;
+	}
+
+	trace_end (text_trace(opt), "text_wrap", span, buffer_input_len);
+
+	text_image_finish (buffer_output, j, crc, buffer_output_max);
+	*buffer_output_len = buffer_output_max;
+	return NTGRBAK_OK;
+}
+
+
+/* Writes a varint: 7 bits a byte, the lowest first, the high bit set on all but the last byte (LEB128)
+ * out:			The output
+ * out_max:		The output room
+ * value:		The value
+ * RETURN:		The bytes written, 0 if there is no room
+ */
+static int text_varint_put (unsigned char* out, int out_max, uint32_t value)
+{
+	int n;
+
+	for (n = 0; n < out_max; n++)
+	{
+		out[n] = (value & 0x7F) | (value > 0x7F ? 0x80 : 0);
+		value >>= 7;
+		if (!(out[n] & 0x80))
+			return n + 1;
+	}
+
+	return 0;
+}
+
+
+/* Reads a varint, see text_varint_put()
+ * in:			The input
+ * in_len:		The input length
+ * value:		The value
+ * RETURN:		The bytes read, 0 if it is truncated or longer than 32 bits
+ */
+static int text_varint_get (const unsigned char* in, int in_len, uint32_t* value)
+{
+	int n;
+
+	*value = 0;
+	for (n = 0; n < in_len && n < 5; n++)
+	{
+		if (n == 4 && in[n] > 0x0F)
+			return 0;
+		*value |= (uint32_t) (in[n] & 0x7F) << (7 * n);
+		if (!(in[n] & 0x80))
+			return n + 1;
+	}
+
+	return 0;
+}
+
+
+/* Gets the length of the UTF-8 sequence starting a buffer
+ * in:			The buffer
+ * len:			The buffer length
+ * RETURN:		The sequence length, 0 if it is not a valid one
+ */
+static int text_utf8_len (const unsigned char* in, int len)
+{
+	unsigned char lo, hi;
+	int n, i;
+
+	if (in[0] < 0x80)
+		return 1;
+
+	/* The first continuation byte range depends on the lead byte: no overlong forms, surrogates or code points past U+10FFFF */
+	lo = 0x80;
+	hi = 0xBF;
+	if (in[0] >= 0xC2 && in[0] <= 0xDF)
+		n = 2;
+	else if (in[0] >= 0xE0 && in[0] <= 0xEF)
+	{
+		n = 3;
+		if (in[0] == 0xE0)
+			lo = 0xA0;
+		if (in[0] == 0xED)
+			hi = 0x9F;
+	}
+	else if (in[0] >= 0xF0 && in[0] <= 0xF4)
+	{
+		n = 4;
+		if (in[0] == 0xF0)
+			lo = 0x90;
+		if (in[0] == 0xF4)
+			hi = 0x8F;
+	}
+	else
+		return 0;
+
+	if (len < n || in[1] < lo || in[1] > hi)
+		return 0;
+	for (i = 2; i < n; i++)
+		if (in[i] < 0x80 || in[i] > 0xBF)
+			return 0;
+
+	return n;
+}
+
+
+/* Escapes the bytes of a JSON string: the valid UTF-8 sequences are kept, any other byte X becomes the lone surrogate \uDCXX
+ * in:			The bytes
+ * len:			The bytes length
+ * out:			The output
+ * out_max:		The output room (6 bytes a byte is enough)
+ * RETURN:		The bytes written, -1 if there is no room
+ */
+static int text_json_escape (const unsigned char* in, int len, unsigned char* out, int out_max)
+{
+	static const char hex[] = "0123456789abcdef";
+	const char *escape;
+	int i, j, n;
+
+	for (i = 0, j = 0; i < len; i += n)
+	{
+		n = 1;
+		escape = NULL;
+		switch (in[i])
+		{
+		case '"':	escape = "\\\"";	break;
+		case '\\':	escape = "\\\\";	break;
+		case '\n':	escape = "\\n";		break;
+		case '\r':	escape = "\\r";		break;
+		case '\t':	escape = "\\t";		break;
+		case '\b':	escape = "\\b";		break;
+		case '\f':	escape = "\\f";		break;
+		}
+
+		if (escape)
+		{
+			if (j + 2 > out_max)
+				return -1;
+			memcpy (out + j, escape, 2);
+			j += 2;
+		}
+		else if (in[i] >= 0x20 && (n = text_utf8_len (in + i, len - i)))
+		{
+			if (j + n > out_max)
+				return -1;
+			memcpy (out + j, in + i, n);
+			j += n;
+		}
+		else
+		{
+			/* The control characters are code points, the bytes out of UTF-8 lone surrogates */
+			n = 1;
+			if (j + 6 > out_max)
+				return -1;
+			memcpy (out + j, in[i] < 0x20 ? "\\u00" : "\\udc", 4);
+			out[j + 4] = hex[in[i] >> 4];
+			out[j + 5] = hex[in[i] & 0xF];
+			j += 6;
+		}
+	}
+
+	return j;
+}
+
+
+/* Finds the end of a JSON string
+ * in:			The string content, past its opening quote
+ * len:			The input length
+ * RETURN:		The offset of the closing quote, -1 if there is none or the string holds a raw control character
+ */
+static int text_json_string (const unsigned char* in, int len)
+{
+	int i;
+
+	for (i = 0; i < len; i++)
+	{
+		if (in[i] == '"')
+			return i;
+		if (in[i] < 0x20)
+			return -1;
+		if (in[i] == '\\')
+			i++;
+	}
+
+	return -1;
+}
+
+
+/* Reads the 4 hex digits of a \u escape
+ * RETURN:		The code unit, -1 if they are not hex digits
+ */
+static int text_json_hex4 (const unsigned char* in, int len)
+{
+	int i, value, digit;
+
+	if (len < 4)
+		return -1;
+
+	value = 0;
+	for (i = 0; i < 4; i++)
+	{
+		if (in[i] >= '0' && in[i] <= '9')
+			digit = in[i] - '0';
+		else if ((in[i] | 0x20) >= 'a' && (in[i] | 0x20) <= 'f')
+			digit = (in[i] | 0x20) - 'a' + 10;
+		else
+			return -1;
+		value = value << 4 | digit;
+	}
+
+	return value;
+}
+
+
+/* Unescapes the content of a JSON string, see text_json_escape(): the lone surrogates \uDC80 to \uDCFF are bytes, the other code points UTF-8
+ * in:			The string content, between its quotes
+ * len:			The content length
+ * out:			The output
+ * out_max:		The output room (len bytes are enough)
+ * RETURN:		The bytes written, -1 if the string is malformed, -2 if there is no room
+ */
+static int text_json_unescape (const unsigned char* in, int len, unsigned char* out, int out_max)
+{
+	int i, j, cp, lo, n;
+
+	for (i = 0, j = 0; i < len; )
+	{
+		if (in[i] != '\\')
+		{
+			if (j >= out_max)
+				return -2;
+			out[j++] = in[i++];
+			continue;
+		}
+		if (i + 1 >= len)
+			return -1;
+
+		cp = -1;
+		switch (in[i + 1])
+		{
+		case '"':	cp = '"';	break;
+		case '\\':	cp = '\\';	break;
+		case '/':	cp = '/';	break;
+		case 'n':	cp = '\n';	break;
+		case 'r':	cp = '\r';	break;
+		case 't':	cp = '\t';	break;
+		case 'b':	cp = '\b';	break;
+		case 'f':	cp = '\f';	break;
+		case 'u':
+			cp = text_json_hex4 (in + i + 2, len - i - 2);
+			i += 4;
+			if (cp >= 0xD800 && cp <= 0xDBFF && i + 8 <= len && in[i + 2] == '\\' && in[i + 3] == 'u'
+					&& (lo = text_json_hex4 (in + i + 4, len - i - 4)) >= 0xDC00 && lo <= 0xDFFF)
+			{
+				/* A surrogate pair */
+				cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+				i += 6;
+			}
+			else if (cp >= 0xDC80 && cp <= 0xDCFF)
+			{
+				/* A byte out of UTF-8 */
+				if (j >= out_max)
+					return -2;
+				out[j++] = cp & 0xFF;
+				i += 2;
+				continue;
+			}
+			else if (cp >= 0xD800 && cp <= 0xDFFF)
+				return -1;
+			break;
+		}
+		if (cp < 0)
+			return -1;
+		i += 2;
+
+		/* The code point as UTF-8 */
+		n = cp < 0x80 ? 1 : cp < 0x800 ? 2 : cp < 0x10000 ? 3 : 4;
+		if (j + n > out_max)
+			return -2;
+		if (n == 1)
+			out[j] = cp;
+		else
+		{
+			out[j] = (0xF00 >> n) | (cp >> (6 * (n - 1)));
+			for (lo = 1; lo < n; lo++)
+				out[j + lo] = 0x80 | ((cp >> (6 * (n - 1 - lo))) & 0x3F);
+		}
+		j += n;
+	}
+
+	return j;
+}
+
+
+/* Finds the key and the value of a JSON Lines record: {"key":"...","value":"..."}, in any order, the other string members are ignored
+ * line:		The line
+ * len:			The line length
+ * key:			The key content, still escaped
+ * key_len:		The key content length
+ * value:		The value content, still escaped
+ * value_len:	The value content length
+ * RETURN:		0: Success, 1: The line is not a record
+ */
+static int text_json_parse (const unsigned char* line, int len, const unsigned char** key, int* key_len, const unsigned char** value, int* value_len)
+{
+	const unsigned char *name;
+	int i, name_len, n;
+
+	*key = *value = NULL;
+	*key_len = *value_len = 0;
+	for (i = 0; i < len && strchr (" \t\r", line[i]); i++)
+		;
+	if (i == len || line[i++] != '{')
+		return 1;
+
+	for (;;)
+	{
+		for (; i < len && strchr (" \t\r", line[i]); i++)
+			;
+		if (i == len || line[i++] != '"' || (name_len = text_json_string (line + i, len - i)) < 0)
+			return 1;
+		name = line + i;
+		i += name_len + 1;
+
+		for (; i < len && strchr (" \t\r", line[i]); i++)
+			;
+		if (i == len || line[i++] != ':')
+			return 1;
+		for (; i < len && strchr (" \t\r", line[i]); i++)
+			;
+		if (i == len || line[i++] != '"' || (n = text_json_string (line + i, len - i)) < 0)
+			return 1;
+
+		if (name_len == 3 && !memcmp (name, "key", 3))
+		{
+			if (*key)
+				return 1;
+			*key = line + i;
+			*key_len = n;
+		}
+		else if (name_len == 5 && !memcmp (name, "value", 5))
+		{
+			if (*value)
+				return 1;
+			*value = line + i;
+			*value_len = n;
+		}
+		i += n + 1;
+
+		for (; i < len && strchr (" \t\r", line[i]); i++)
+			;
+		if (i < len && line[i] == ',')
+		{
+			i++;
+			continue;
+		}
+		if (i == len || line[i++] != '}')
+			return 1;
+		break;
+	}
+
+	for (; i < len && strchr (" \t\r", line[i]); i++)
+		;
+
+	return i != len || !*key || !*value;
+}
+
+
+/* Extracts the records of a NVRAM image as a binary or JSON Lines stream
+ * opt:					The conversion options
+ * buffer_input:		The NVRAM image
+ * buffer_input_len:	The NVRAM image length
+ * format:				NTGRBAK_FORMAT_BINARY or NTGRBAK_FORMAT_JSONL
+ * buffer_output:		The output stream buffer
+ * buffer_output_max:	The output stream buffer size (see NTGRBAK_RECORDS_SIZE())
+ * buffer_output_len:	The output stream length
+ * RETURN:				NTGRBAK_OK or the error code
+ * NOTE: The binary stream is NTGRBAK_RECORDS_MAGIC, then every record as the varint key length, the varint value length, the key and the value.
+ * A JSON Lines record is {"key":"...","value":"..."}: the bytes out of UTF-8 are lone surrogates (\uDC80 to \uDCFF), so any value gets through
+ */
+int text_records_extract (const struct ntgrbak_opts *opt, const unsigned char* buffer_input, int buffer_input_len, int format, unsigned char* buffer_output, int buffer_output_max, int* buffer_output_len)
+{
+	const unsigned char *record, *nul, *eq;
+	uint32_t length;
+	uint64_t span;
+	int i, j, end, key_len, value_len, n, ret;
+
+	ret = text_check (opt, buffer_input, buffer_input_len, &length);
+	if (ret)
+		return ret;
+
+	span = trace_begin (text_trace(opt));
+	j = 0;
+	if (format == NTGRBAK_FORMAT_BINARY)
+	{
+		if (buffer_output_max < NTGRBAK_RECORDS_MAGIC_SIZE)
+		{
+			text_output (opt, "Output buffer is too small!\n");
+			return NTGRBAK_ERR_BUFFER;
+		}
+		memcpy (buffer_output, NTGRBAK_RECORDS_MAGIC, NTGRBAK_RECORDS_MAGIC_SIZE);
+		j = NTGRBAK_RECORDS_MAGIC_SIZE;
+	}
+
+	/* Every null terminated string is a record, the runs of null bytes are skipped */
+	for (i = NVRAM_INDEX_DATA; i < length; i = end + 1)
+	{
+		record = buffer_input + i;
+		nul = memchr (record, '\0', length - i);
+		end = nul ? nul - buffer_input : length;
+		if (end == i)
+			continue;
+
+		eq = memchr (record, '=', end - i);
+		if (!eq)
+		{
+			if (text_force(opt))
+			{
+				text_output (opt, "Skipping the record without a '=' at offset %d.\n", i);
+				continue;
+			}
+			text_output (opt, "Record without a '=' at offset %d!\n", i);
+			return NTGRBAK_ERR_FORMAT;
+		}
+		key_len = eq - record;
+		value_len = end - i - key_len - 1;
+
+		n = -1;
+		if (format == NTGRBAK_FORMAT_BINARY)
+		{
+			if ((n = text_varint_put (buffer_output + j, buffer_output_max - j, key_len)))
+				j += n;
+			if (n && (n = text_varint_put (buffer_output + j, buffer_output_max - j, value_len)))
+				j += n;
+			if (n && j + key_len + value_len <= buffer_output_max)
+			{
+				memcpy (buffer_output + j, record, key_len);
+				memcpy (buffer_output + j + key_len, eq + 1, value_len);
+				j += key_len + value_len;
+			}
+			else
+				n = -1;
+		}
+		else if (buffer_output_max - j >= 22)
+		{
+			/* 22 bytes of JSON around the key and the value */
+			memcpy (buffer_output + j, "{\"key\":\"", 8);
+			j += 8;
+			if ((n = text_json_escape (record, key_len, buffer_output + j, buffer_output_max - j - 14)) >= 0)
+			{
+				j += n;
+				memcpy (buffer_output + j, "\",\"value\":\"", 11);
+				j += 11;
+				n = text_json_escape (eq + 1, value_len, buffer_output + j, buffer_output_max - j - 3);
+			}
+			if (n >= 0)
+			{
+				j += n;
+				memcpy (buffer_output + j, "\"}\n", 3);
+				j += 3;
+			}
+		}
+		if (n < 0)
+		{
+			text_output (opt, "Output buffer is too small!\n");
+			return NTGRBAK_ERR_BUFFER;
+		}
+	}
+	*buffer_output_len = j;
+	trace_end (text_trace(opt), "records_extract", span, length);
+
+	return NTGRBAK_OK;
+}
+
+
+/* Wraps a binary or JSON Lines records stream to a NVRAM image, see text_records_extract()
+ * opt:					The conversion options
+ * buffer_input:		The records stream
+ * buffer_input_len:	The records stream length
+ * format:				NTGRBAK_FORMAT_BINARY or NTGRBAK_FORMAT_JSONL
+ * buffer_output:		The output NVRAM image buffer
+ * buffer_output_max:	The NVRAM image size: the image is padded to it (at most NVRAM_IMAGE_SIZE_MAX bytes)
+ * buffer_output_len:	The output NVRAM image length
+ * RETURN:				NTGRBAK_OK or the error code
+ * NOTE: The keys can not hold '=' and null bytes, the values null bytes; the empty JSON lines are skipped
+ */
+int text_records_wrap (const struct ntgrbak_opts *opt, const unsigned char* buffer_input, int buffer_input_len, int format, unsigned char* buffer_output, int buffer_output_max, int* buffer_output_len)
+{
+	const unsigned char *key, *value, *nl;
+	uint32_t key_len, value_len;
+	uint64_t span;
+	uint8_t crc;
+	int i, j, line, limit, len, n, k, v;
+
+	if (buffer_output_max < NVRAM_INDEX_DATA || buffer_output_max > NVRAM_IMAGE_SIZE_MAX)
+	{
+		text_output (opt, "Invalid NVRAM image size! (%d bytes)\n", buffer_output_max);
+		return NTGRBAK_ERR_ARGS;
+	}
+	limit = NVRAM_INDEX_DATA + (buffer_output_max - NVRAM_INDEX_DATA) / 4 * 4;
+
+	i = 0;
+	if (format == NTGRBAK_FORMAT_BINARY)
+	{
+		if (buffer_input_len < NTGRBAK_RECORDS_MAGIC_SIZE || memcmp (buffer_input, NTGRBAK_RECORDS_MAGIC, NTGRBAK_RECORDS_MAGIC_SIZE))
+		{
+			text_output (opt, "Not a binary records stream!\n");
+			return NTGRBAK_ERR_FORMAT;
+		}
+		i = NTGRBAK_RECORDS_MAGIC_SIZE;
+	}
+
+	span = trace_begin (text_trace(opt));
+	j = NVRAM_INDEX_DATA;
+	for (line = 1; i < buffer_input_len; line++)
+	{
+		if (format == NTGRBAK_FORMAT_BINARY)
+		{
+			/* The lengths, then the key and the value in place */
+			k = text_varint_get (buffer_input + i, buffer_input_len - i, &key_len);
+			v = k ? text_varint_get (buffer_input + i + k, buffer_input_len - i - k, &value_len) : 0;
+			if (!v || key_len > buffer_input_len - i - k - v || value_len > buffer_input_len - i - k - v - key_len)
+			{
+				text_output (opt, "Truncated binary record at offset %d!\n", i);
+				return NTGRBAK_ERR_FORMAT;
+			}
+			key = buffer_input + i + k + v;
+			value = key + key_len;
+			i += k + v + key_len + value_len;
+
+			if (memchr (key, '=', key_len) || memchr (key, '\0', key_len) || memchr (value, '\0', value_len))
+			{
+				text_output (opt, "Record %d holds a null byte, or a '=' in its key!\n", line);
+				return NTGRBAK_ERR_FORMAT;
+			}
+			if (key_len + value_len + 2 > limit - j)
+			{
+				text_output (opt, "Data size is too big! (max: %d bytes)\n", limit - NVRAM_INDEX_DATA);
+				return NTGRBAK_ERR_TOO_BIG;
+			}
+			memcpy (buffer_output + j, key, key_len);
+			buffer_output[j + key_len] = '=';
+			memcpy (buffer_output + j + key_len + 1, value, value_len);
+			j += key_len + value_len + 1;
+			buffer_output[j++] = '\0';
+		}
+		else
+		{
+			nl = memchr (buffer_input + i, '\n', buffer_input_len - i);
+			len = (nl ? nl - buffer_input : buffer_input_len) - i;
+			n = i;
+			i += len + 1;
+			for (k = 0; k < len && strchr (" \t\r", buffer_input[n + k]); k++)
+				;
+			if (k == len)
+				continue;
+
+			if (text_json_parse (buffer_input + n, len, &key, &k, &value, &v))
+			{
+				text_output (opt, "Malformed JSON record at line %d!\n", line);
+				return NTGRBAK_ERR_FORMAT;
+			}
+
+			/* Unescaped straight to the image, the key, '=', the value and its null byte */
+			n = limit - j < 2 ? -2 : text_json_unescape (key, k, buffer_output + j, limit - j - 2);
+			if (n >= 0 && (memchr (buffer_output + j, '=', n) || memchr (buffer_output + j, '\0', n)))
+				n = -1;
+			if (n >= 0)
+			{
+				j += n;
+				buffer_output[j++] = '=';
+				n = text_json_unescape (value, v, buffer_output + j, limit - j - 1);
+				if (n >= 0 && memchr (buffer_output + j, '\0', n))
+					n = -1;
+			}
+			if (n == -2)
+			{
+				text_output (opt, "Data size is too big! (max: %d bytes)\n", limit - NVRAM_INDEX_DATA);
+				return NTGRBAK_ERR_TOO_BIG;
+			}
+			if (n < 0)
+			{
+				text_output (opt, "Malformed JSON record at line %d! (bad escape, null byte, or '=' in the key)\n", line);
+				return NTGRBAK_ERR_FORMAT;
+			}
+			j += n;
+			buffer_output[j++] = '\0';
+		}
+	}
+	trace_end (text_trace(opt), "records_wrap", span, buffer_input_len);
+
+	span = trace_begin (text_trace(opt));
+	crc = text_image_start (buffer_output);
+	crc = crc8(buffer_output + NVRAM_INDEX_DATA, j - NVRAM_INDEX_DATA, crc);
+	text_image_finish (buffer_output, j, crc, buffer_output_max);
+	trace_end (text_trace(opt), "crc", span, j);
+
+	*buffer_output_len = buffer_output_max;
+	return NTGRBAK_OK;
+}
+
+
+/* Checks that a records stream too big for its image is refused without writing past the image
+ * format:		NTGRBAK_FORMAT_BINARY or NTGRBAK_FORMAT_JSONL
+ * RETURN:		SELF_TEST_PASSED or SELF_TEST_FAILED
+ */
+static int text_records_self_test (int format)
+{
+	static const char record[] = "{\"key\":\"\",\"value\":\"\"}\n";
+	unsigned char stream[NTGRBAK_RECORDS_MAGIC_SIZE + TEXT_TEST_RECORDS * (sizeof (record) - 1)];
+	unsigned char image[TEXT_TEST_IMAGE_SIZE + 32];
+	int i, len, image_len, ret;
+
+	/* Empty records, the smallest ones: '=' and its null byte */
+	len = 0;
+	if (format == NTGRBAK_FORMAT_BINARY)
+	{
+		memcpy (stream, NTGRBAK_RECORDS_MAGIC, NTGRBAK_RECORDS_MAGIC_SIZE);
+		len = NTGRBAK_RECORDS_MAGIC_SIZE;
+		memset (stream + len, 0, 2 * TEXT_TEST_RECORDS);
+		len += 2 * TEXT_TEST_RECORDS;
+	}
+	else
+		for (i = 0; i < TEXT_TEST_RECORDS; i++, len += sizeof (record) - 1)
+			memcpy (stream + len, record, sizeof (record) - 1);
+
+	memset (image, 0xA5, sizeof (image));
+	ret = text_records_wrap (NULL, stream, len, format, image, TEXT_TEST_IMAGE_SIZE, &image_len);
+	for (i = TEXT_TEST_IMAGE_SIZE; i < sizeof (image) && image[i] == 0xA5; i++)
+		;
+
+	return ret == NTGRBAK_ERR_TOO_BIG && i == sizeof (image) ? SELF_TEST_PASSED : SELF_TEST_FAILED;
+}
+
+
+/* Checks that the null bytes starting the data of an image are skipped, not turned into a newline
+ * RETURN:		SELF_TEST_PASSED or SELF_TEST_FAILED
+ */
+static int text_extract_self_test (void)
+{
+	static const char data[] = "\0\0\0a=1\0\0b=2";
+	static const char text[] = "a=1\nb=2\n";
+	unsigned char image[TEXT_TEST_IMAGE_SIZE], out[TEXT_TEST_IMAGE_SIZE];
+	int end, out_len;
+	uint8_t crc;
+
+	/* data ends with the null byte of its last record */
+	crc = text_image_start (image);
+	memcpy (image + NVRAM_INDEX_DATA, data, sizeof (data));
+	end = NVRAM_INDEX_DATA + sizeof (data);
+	crc = crc8(image + NVRAM_INDEX_DATA, sizeof (data), crc);
+	text_image_finish (image, end, crc, TEXT_TEST_IMAGE_SIZE);
+
+	if (text_extract (NULL, image, TEXT_TEST_IMAGE_SIZE, out, sizeof (out), &out_len))
+		return SELF_TEST_FAILED;
+
+	return out_len == sizeof (text) - 1 && !memcmp (out, text, out_len) ? SELF_TEST_PASSED : SELF_TEST_FAILED;
+}
+
+
+/* Checks every text kernel the CPU supports against the byte at a time ones
+ * result:		The results, the wrap and the extraction of a kernel each, the leading nulls extraction, then the records wrap bounds
+ * result_max:	The results room
+ * RETURN:		The number of results, -1 if the test buffers can not be allocated
+ */
+int text_self_test (struct self_test_result *result, int result_max)
+{
+	static const struct {
+		const char *name;
+		text_translate_fn translate;
+		text_extract_fn extract;
+		int supported;
+	} kernels[] = {
+		{ "64 bit words", text_to_nvram_64, text_from_nvram_64, 1 },
+#ifdef TEXT_X86
+		{ "SSE2", text_to_nvram_sse2, text_from_nvram_sse2, 1 },
+		{ "AVX2", text_to_nvram_avx2, text_from_nvram_avx2, -1 },
+#endif
+		{ "dispatched", text_to_nvram, text_from_nvram, 1 },
+	};
+	unsigned char *buffer, *expected, *out;
+	unsigned char last, last_expected;
+	unsigned int seed;
+	size_t len, offset, out_len;
+	int round, k, n, mismatches[2];
+
+	buffer = malloc (3 * (TEXT_TEST_SIZE + 32));
+	if (!buffer)
+		return -1;
+	expected = buffer + TEXT_TEST_SIZE + 32;
+	out = expected + TEXT_TEST_SIZE + 32;
+
+	/* Text-like bytes, with plenty of new lines and the bytes next to them, and null bytes from dense runs to sparse ones */
+	seed = 0x464C5348;
+	for (len = 0; len < TEXT_TEST_SIZE + 32; len++)
+	{
+		if (!(rand_r (&seed) % (2 + (len / 0x400) % 64)))
+			buffer[len] = '\0';
+		else
+			buffer[len] = rand_r (&seed) % 4 ? (unsigned char) (0x08 + rand_r (&seed) % 5) : (unsigned char) rand_r (&seed);
+	}
+
+	n = 0;
+	for (k = 0; k < sizeof (kernels) / sizeof (kernels[0]) && n + 2 <= result_max; k++)
+	{
+		result[n].test = "Text wrap";
+		result[n + 1].test = "Text extract";
+		result[n].kernel = result[n + 1].kernel = kernels[k].name;
+		result[n].result = result[n + 1].result = SELF_TEST_SKIPPED;
+#ifdef TEXT_X86
+		if (kernels[k].supported < 0 && !__builtin_cpu_supports ("avx2"))
+		{
+			n += 2;
+			continue;
+		}
+#endif
+		mismatches[0] = mismatches[1] = 0;
+		for (round = 0; round < TEXT_TEST_ROUNDS; round++)
+		{
+			/* Random lengths at random alignments, including a whole test buffer */
+			len = round ? rand_r (&seed) % (TEXT_TEST_SIZE + 1) : TEXT_TEST_SIZE;
+			offset = rand_r (&seed) % 32;
+
+			text_to_nvram_scalar (buffer + offset, expected, len);
+			kernels[k].translate (buffer + offset, out + (offset ^ 7), len);
+			if (memcmp (out + (offset ^ 7), expected, len))
+				mismatches[0]++;
+
+			/* Starting from a newline or from any other byte */
+			last_expected = last = round % 2 ? '\n' : 'a';
+			out_len = text_from_nvram_scalar (buffer + offset, len, expected, &last_expected);
+			if (kernels[k].extract (buffer + offset, len, out + (offset ^ 7), &last) != out_len || last != last_expected || memcmp (out + (offset ^ 7), expected, out_len))
+				mismatches[1]++;
+		}
+		result[n++].result = mismatches[0] ? SELF_TEST_FAILED : SELF_TEST_PASSED;
+		result[n++].result = mismatches[1] ? SELF_TEST_FAILED : SELF_TEST_PASSED;
+	}
+	free (buffer);
+
+	if (n < result_max)
+	{
+		result[n].test = "Text extract";
+		result[n].kernel = "leading NUL";
+		result[n++].result = text_extract_self_test ();
+	}
+
+	for (k = NTGRBAK_FORMAT_BINARY; k <= NTGRBAK_FORMAT_JSONL && n < result_max; k++, n++)
+	{
+		result[n].test = "Records wrap";
+		result[n].kernel = k == NTGRBAK_FORMAT_BINARY ? "binary" : "JSON Lines";
+		result[n].result = text_records_self_test (k);
+	}
+
+	return n;
+}
@@ -0,0 +1,19 @@
+#ifndef SRC_TEXT_H_
+#define SRC_TEXT_H_
+
+#include "libntgrbak.h"
+#include "selftest.h"
+
+/* NVRAM image <-> editable text file conversion */
+#define text_verbose(opt)	((opt) && ((opt)->flags & NTGRBAK_VERBOSE))
+#define text_force(opt)		((opt) && ((opt)->flags & NTGRBAK_FORCE))
+#define text_trace(opt)		((opt) ? (opt)->trace : NULL)
+
+void			text_output			(const struct ntgrbak_opts*, char*, ...);
+int				text_extract		(const struct ntgrbak_opts*, const unsigned char*, int, unsigned char*, int, int*);
+int				text_wrap			(const struct ntgrbak_opts*, const unsigned char*, int, unsigned char*, int, int*);
+int				text_records_extract	(const struct ntgrbak_opts*, const unsigned char*, int, int, unsigned char*, int, int*);
+int				text_records_wrap	(const struct ntgrbak_opts*, const unsigned char*, int, int, unsigned char*, int, int*);
+int				text_self_test		(struct self_test_result*, int);
+
+#endif /* SRC_TEXT_H_ */
@@ -0,0 +1,466 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include "metrics.h"
+#include "trace.h"
+
+#define TRACE_EVENTS_MIN	1024
+#define TRACE_EVENTS_MAX	(1 << 20)		//40 MB: a server records for as long as it runs
+#define TRACE_STAGES_MAX	32
+
+
+struct trace_event {
+	const char * name;		//A string literal
+	uint64_t begin;			//ns since the trace creation
+	uint64_t duration;
+	size_t bytes;
+	int tid;
+};
+
+/* Per stage totals, of the summary and of the metrics */
+struct trace_stage {
+	const char * name;
+	int count;
+	uint64_t duration;
+	uint64_t bytes;
+	struct metrics_histogram histogram;
+};
+
+/* Metrics of a thread: only the thread writes them, they are merged when written out */
+struct trace_thread {
+	struct trace_thread * next;
+	int tid;
+	int stages;
+	struct trace_stage stage[TRACE_STAGES_MAX];
+	uint64_t counter[TRACE_COUNTERS];
+};
+
+struct ntgrbak_trace {
+	unsigned int flags;
+	uint64_t id;					//Unique for the process lifetime, tells the threads caches apart
+	struct trace_event * event;
+	int events;
+	int events_max;
+	uint64_t dropped;				//Spans past TRACE_EVENTS_MAX
+	struct trace_thread * thread;
+	uint64_t origin;
+	pthread_mutex_t lock;
+};
+
+static const char * const trace_counter_name[TRACE_COUNTERS][2] = {
+	{ "ntgrbak_files_total",				"Files processed." },
+	{ "ntgrbak_files_failed_total",			"Files whose processing failed." },
+	{ "ntgrbak_bytes_in_total",				"Bytes read." },
+	{ "ntgrbak_bytes_out_total",			"Bytes written." },
+	{ "ntgrbak_checksum_failures_total",	"Configurations failing the checksum verify." },
+	{ "ntgrbak_crc_failures_total",			"NVRAM images failing the CRC8 check." },
+	{ "ntgrbak_magic_mismatches_total",		"NVRAM images with a wrong magic." },
+	{ "ntgrbak_unknown_models_total",		"Configurations of an unknown router model." },
+};
+
+static uint64_t trace_ids;
+
+/* The metrics of the calling thread in the last trace it recorded to */
+static __thread uint64_t trace_local_id;
+static __thread struct trace_thread *trace_local;
+
+
+static uint64_t trace_now (void)
+{
+	struct timespec ts;
+
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+
+/* Creates a trace
+ * flags:		NTGRBAK_TRACE_* flags, what to record
+ * RETURN:		The trace, NULL on failure
+ */
+struct ntgrbak_trace * ntgrbak_trace_new (unsigned int flags)
+{
+	struct ntgrbak_trace *trace;
+
+	trace = calloc (1, sizeof (struct ntgrbak_trace));
+	if (!trace)
+		return NULL;
+
+	trace->flags = flags;
+	trace->id = __atomic_add_fetch (&trace_ids, 1, __ATOMIC_RELAXED);
+	if (flags & NTGRBAK_TRACE_EVENTS)
+	{
+		trace->events_max = TRACE_EVENTS_MIN;
+		trace->event = malloc (sizeof (struct trace_event) * trace->events_max);
+		if (!trace->event)
+		{
+			free (trace);
+			return NULL;
+		}
+	}
+	pthread_mutex_init (&trace->lock, NULL);
+	trace->origin = trace_now ();
+
+	return trace;
+}
+
+
+/* Releases a trace
+ * trace:		The trace
+ */
+void ntgrbak_trace_free (struct ntgrbak_trace *trace)
+{
+	struct trace_thread *thread;
+
+	if (!trace)
+		return;
+
+	while ((thread = trace->thread))
+	{
+		trace->thread = thread->next;
+		free (thread);
+	}
+	pthread_mutex_destroy (&trace->lock);
+	free (trace->event);
+	free (trace);
+}
+
+
+/* Gets the metrics of the calling thread, cached after the first time
+ * trace:		The trace
+ * RETURN:		The thread metrics, NULL on failure
+ */
+static struct trace_thread * trace_thread_get (struct ntgrbak_trace *trace)
+{
+	struct trace_thread *thread;
+	int tid;
+
+	if (trace_local_id == trace->id)
+		return trace_local;
+
+	tid = (int) syscall (SYS_gettid);
+	pthread_mutex_lock (&trace->lock);
+	for (thread = trace->thread; thread && thread->tid != tid; thread = thread->next);
+	if (!thread)
+	{
+		thread = calloc (1, sizeof (struct trace_thread));
+		if (thread)
+		{
+			thread->tid = tid;
+			thread->next = trace->thread;
+			trace->thread = thread;
+		}
+	}
+	pthread_mutex_unlock (&trace->lock);
+
+	if (thread)
+	{
+		trace_local_id = trace->id;
+		trace_local = thread;
+	}
+	return thread;
+}
+
+
+/* Finds the totals of a stage, adding them if new
+ * stage:		The stages
+ * stages:		The number of stages, increased when added
+ * name:		The stage name
+ * RETURN:		The stage totals, NULL when there are too many stages
+ */
+static struct trace_stage * trace_stage_get (struct trace_stage *stage, int *stages, const char *name)
+{
+	int s;
+
+	/* The names are literals: the pointers match unless they come from another object file */
+	for (s = 0; s < *stages; s++)
+		if (stage[s].name == name || !strcmp (stage[s].name, name))
+			return &stage[s];
+
+	if (*stages == TRACE_STAGES_MAX)
+		return NULL;
+	memset (&stage[s], 0, sizeof (struct trace_stage));
+	stage[s].name = name;
+	(*stages)++;
+	return &stage[s];
+}
+
+
+/* Starts a span
+ * trace:		The trace, NULL for none
+ * RETURN:		The span start, to pass to trace_end()
+ */
+uint64_t trace_begin (const struct ntgrbak_trace *trace)
+{
+	if (!trace)
+		return 0;
+
+	return trace_now ();
+}
+
+
+/* Ends a span and records it
+ * trace:		The trace, NULL for none
+ * name:		The stage name, a string literal
+ * begin:		The span start, from trace_begin()
+ * bytes:		The bytes processed by the stage, 0 if not meaningful
+ * NOTE: A span that cannot be stored, or past TRACE_EVENTS_MAX, is dropped and counted, the trace is diagnostics only
+ */
+void trace_end (struct ntgrbak_trace *trace, const char *name, uint64_t begin, size_t bytes)
+{
+	struct trace_event *event;
+	struct trace_thread *thread;
+	struct trace_stage *stage;
+	uint64_t end;
+
+	if (!trace)
+		return;
+	end = trace_now ();
+
+	/* The histograms are per thread: no lock */
+	if (trace->flags & NTGRBAK_TRACE_METRICS)
+	{
+		thread = trace_thread_get (trace);
+		stage = thread ? trace_stage_get (thread->stage, &thread->stages, name) : NULL;
+		if (stage)
+		{
+			stage->bytes += bytes;
+			metrics_histogram_record (&stage->histogram, end - begin);
+		}
+	}
+
+	if (!(trace->flags & NTGRBAK_TRACE_EVENTS))
+		return;
+
+	pthread_mutex_lock (&trace->lock);
+	if (trace->events == trace->events_max)
+	{
+		event = trace->events_max < TRACE_EVENTS_MAX ? realloc (trace->event, sizeof (struct trace_event) * trace->events_max * 2) : NULL;
+		if (!event)
+		{
+			trace->dropped++;
+			pthread_mutex_unlock (&trace->lock);
+			return;
+		}
+		trace->event = event;
+		trace->events_max *= 2;
+	}
+
+	event = &trace->event[trace->events++];
+	event->name = name;
+	event->begin = begin - trace->origin;
+	event->duration = end - begin;
+	event->bytes = bytes;
+	event->tid = (int) syscall (SYS_gettid);
+	pthread_mutex_unlock (&trace->lock);
+}
+
+
+/* Adds to a counter
+ * trace:		The trace, NULL for none
+ * counter:		The TRACE_* counter
+ * value:		The amount
+ */
+void trace_count (struct ntgrbak_trace *trace, int counter, uint64_t value)
+{
+	struct trace_thread *thread;
+
+	if (!trace || !(trace->flags & NTGRBAK_TRACE_METRICS))
+		return;
+
+	thread = trace_thread_get (trace);
+	if (thread)
+		thread->counter[counter] += value;
+}
+
+
+/* Writes the spans as Chrome trace events (chrome://tracing, Perfetto) */
+static void trace_write_json (const struct ntgrbak_trace *trace, FILE *file)
+{
+	const struct trace_event *event;
+	int i, pid;
+
+	pid = (int) getpid ();
+	fprintf (file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+	for (i = 0; i < trace->events; i++)
+	{
+		event = &trace->event[i];
+		fprintf (file, "{\"name\":\"%s\",\"cat\":\"ntgrbak\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%d,\"args\":{\"bytes\":%zu}}%s\n",
+				event->name, event->begin / 1e3, event->duration / 1e3, pid, event->tid, event->bytes, i + 1 < trace->events ? "," : "");
+	}
+	fprintf (file, "]");
+	if (trace->dropped)
+		fprintf (file, ",\"otherData\":{\"dropped\":%llu}", (unsigned long long) trace->dropped);
+	fprintf (file, "}\n");
+}
+
+
+/* Writes the totals of every stage, in order of first appearance */
+static void trace_write_summary (const struct ntgrbak_trace *trace, FILE *file)
+{
+	struct trace_stage *stage, *total;
+	const struct trace_event *event;
+	int i, s, stages;
+
+	stage = malloc (sizeof (struct trace_stage) * TRACE_STAGES_MAX);
+	if (!stage)
+		return;
+
+	stages = 0;
+	for (i = 0; i < trace->events; i++)
+	{
+		event = &trace->event[i];
+		total = trace_stage_get (stage, &stages, event->name);
+		if (!total)
+			continue;
+		total->count++;
+		total->duration += event->duration;
+		total->bytes += event->bytes;
+	}
+
+	fprintf (file, "%-16s %8s %12s %12s %10s\n", "Stage", "Count", "Total ms", "Mean us", "MB/s");
+	for (s = 0; s < stages; s++)
+	{
+		fprintf (file, "%-16s %8d %12.3f %12.3f ", stage[s].name, stage[s].count, stage[s].duration / 1e6, stage[s].duration / 1e3 / stage[s].count);
+		if (stage[s].bytes && stage[s].duration)
+			fprintf (file, "%10.1f\n", stage[s].bytes * 1e3 / stage[s].duration);
+		else
+			fprintf (file, "%10s\n", "-");
+	}
+	if (trace->dropped)
+		fprintf (file, "%llu spans dropped past %d\n", (unsigned long long) trace->dropped, TRACE_EVENTS_MAX);
+
+	free (stage);
+}
+
+
+/* Writes the spans of a trace
+ * trace:		The trace, recording NTGRBAK_TRACE_EVENTS
+ * path:		A ".json" file gets the Chrome trace events, any other the text summary by stage, "-" is stderr
+ * RETURN:		0: Success, 1: Failure
+ */
+int ntgrbak_trace_write (const struct ntgrbak_trace *trace, const char *path)
+{
+	FILE *file;
+	size_t len;
+	int ret;
+
+	if (!trace || !path || !(trace->flags & NTGRBAK_TRACE_EVENTS))
+		return 1;
+
+	file = strcmp (path, "-") ? fopen (path, "w") : stderr;
+	if (!file)
+		return 1;
+
+	pthread_mutex_lock ((pthread_mutex_t *) &trace->lock);
+	len = strlen (path);
+	if (len >= 5 && !strcmp (path + len - 5, ".json"))
+		trace_write_json (trace, file);
+	else
+		trace_write_summary (trace, file);
+	pthread_mutex_unlock ((pthread_mutex_t *) &trace->lock);
+
+	ret = ferror (file) ? 1 : 0;
+	if (file != stderr && fclose (file))
+		ret = 1;
+	return ret;
+}
+
+
+/* Writes the metrics of a trace in the Prometheus text format, replacing the file at once (node-exporter textfile collector)
+ * trace:		The trace, recording NTGRBAK_TRACE_METRICS
+ * path:		The metrics file
+ * labels:		The labels of all the series, without braces (eg. "tool=\"NtgrBak\""), NULL for none
+ * RETURN:		0: Success, 1: Failure
+ * NOTE: The threads metrics are merged here: the traced calls must have returned
+ */
+int ntgrbak_trace_write_metrics (const struct ntgrbak_trace *trace, const char *path, const char *labels)
+{
+	const struct trace_thread *thread;
+	struct trace_stage *stage, *total;
+	uint64_t counter[TRACE_COUNTERS];
+	char series[512];
+	char path_tmp[4096];
+	static const double quantile[] = { 0.5, 0.9, 0.99, 0.999 };
+	FILE *file;
+	int c, s, q, stages, ret;
+
+	if (!trace || !path || !(trace->flags & NTGRBAK_TRACE_METRICS))
+		return 1;
+	if (!labels)
+		labels = "";
+
+	stage = malloc (sizeof (struct trace_stage) * TRACE_STAGES_MAX);
+	if (!stage)
+		return 1;
+
+	/* Merge the threads */
+	memset (counter, 0, sizeof (counter));
+	stages = 0;
+	pthread_mutex_lock ((pthread_mutex_t *) &trace->lock);
+	for (thread = trace->thread; thread; thread = thread->next)
+	{
+		for (c = 0; c < TRACE_COUNTERS; c++)
+			counter[c] += thread->counter[c];
+		for (s = 0; s < thread->stages; s++)
+		{
+			total = trace_stage_get (stage, &stages, thread->stage[s].name);
+			if (!total)
+				continue;
+			total->bytes += thread->stage[s].bytes;
+			metrics_histogram_merge (&total->histogram, &thread->stage[s].histogram);
+		}
+	}
+	pthread_mutex_unlock ((pthread_mutex_t *) &trace->lock);
+
+	/* Written aside, then renamed over: the collector never reads half a file */
+	snprintf (path_tmp, sizeof (path_tmp), "%s.tmp", path);
+	file = fopen (path_tmp, "w");
+	if (!file)
+	{
+		free (stage);
+		return 1;
+	}
+
+	for (c = 0; c < TRACE_COUNTERS; c++)
+	{
+		fprintf (file, "# HELP %s %s\n# TYPE %s counter\n", trace_counter_name[c][0], trace_counter_name[c][1], trace_counter_name[c][0]);
+		fprintf (file, "%s%s%s%s %llu\n", trace_counter_name[c][0], *labels ? "{" : "", labels, *labels ? "}" : "", (unsigned long long) counter[c]);
+	}
+
+	fprintf (file, "# HELP ntgrbak_stage_bytes_total Bytes processed by each stage.\n# TYPE ntgrbak_stage_bytes_total counter\n");
+	for (s = 0; s < stages; s++)
+		fprintf (file, "ntgrbak_stage_bytes_total{%s%sstage=\"%s\"} %llu\n", labels, *labels ? "," : "", stage[s].name, (unsigned long long) stage[s].bytes);
+
+	fprintf (file, "# HELP ntgrbak_stage_duration_seconds Duration of each stage.\n# TYPE ntgrbak_stage_duration_seconds histogram\n");
+	for (s = 0; s < stages; s++)
+	{
+		snprintf (series, sizeof (series), "%s%sstage=\"%s\"", labels, *labels ? "," : "", stage[s].name);
+		metrics_histogram_write (file, "ntgrbak_stage_duration_seconds", series, &stage[s].histogram);
+	}
+
+	fprintf (file, "# HELP ntgrbak_stage_duration_quantile_seconds Duration quantiles of each stage, within 12.5%%.\n# TYPE ntgrbak_stage_duration_quantile_seconds gauge\n");
+	for (s = 0; s < stages; s++)
+		for (q = 0; q < sizeof (quantile) / sizeof (quantile[0]); q++)
+			fprintf (file, "ntgrbak_stage_duration_quantile_seconds{%s%sstage=\"%s\",quantile=\"%g\"} %.9f\n", labels, *labels ? "," : "", stage[s].name,
+					quantile[q], metrics_histogram_quantile (&stage[s].histogram, quantile[q]) / 1e9);
+
+	fprintf (file, "# HELP ntgrbak_last_run_timestamp_seconds When the run ended.\n# TYPE ntgrbak_last_run_timestamp_seconds gauge\n");
+	fprintf (file, "ntgrbak_last_run_timestamp_seconds%s%s%s %lld\n", *labels ? "{" : "", labels, *labels ? "}" : "", (long long) time (NULL));
+	free (stage);
+
+	ret = ferror (file) ? 1 : 0;
+	if (fclose (file))
+		ret = 1;
+	if (ret || rename (path_tmp, path))
+	{
+		remove (path_tmp);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,29 @@
+#ifndef SRC_TRACE_H_
+#define SRC_TRACE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "libntgrbak.h"
+
+/* Counters of a metrics trace */
+enum {
+	TRACE_FILES = 0,
+	TRACE_FILES_FAILED,
+	TRACE_BYTES_IN,
+	TRACE_BYTES_OUT,
+	TRACE_CHECKSUM_FAILURES,
+	TRACE_CRC_FAILURES,
+	TRACE_MAGIC_MISMATCHES,
+	TRACE_UNKNOWN_MODELS,
+
+	TRACE_COUNTERS
+};
+
+/* Stage spans, recorded by any thread: trace_begin() then trace_end() with the same trace
+ * A NULL trace records nothing and costs a branch
+ */
+uint64_t		trace_begin			(const struct ntgrbak_trace*);
+void			trace_end			(struct ntgrbak_trace*, const char*, uint64_t, size_t);
+void			trace_count			(struct ntgrbak_trace*, int, uint64_t);
+
+#endif /* SRC_TRACE_H_ */